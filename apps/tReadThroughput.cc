@@ -0,0 +1,121 @@
+//
+// @file tReadThroughput.cc : benchmark of the read throughput of the
+//                            table-based data access layer
+//
+/// @details This program iterates over the given measurement set and
+/// touches visibility, flag and noise cubes for every chunk. It reports
+/// the number of rows read per second which can be used to compare
+/// performance of different versions of the accessor code on the same
+/// dataset. An optional second parameter limits the number of rows per
+/// chunk (by default, the whole time-step is returned in one chunk).
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+
+
+#include <askap/dataaccess/TableDataSource.h>
+#include <askap_accessors.h>
+#include <askap/askap/AskapLogging.h>
+ASKAP_LOGGER(logger, ".tReadThroughput");
+
+#include <askap/askap/AskapError.h>
+#include <askap/askap/AskapUtil.h>
+#include <askap/dataaccess/SharedIter.h>
+
+// casa
+#include <casacore/casa/OS/Timer.h>
+
+// std
+#include <stdexcept>
+#include <iostream>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+using namespace askap;
+using namespace accessors;
+
+/// @brief read all data and report throughput
+/// @param[in] ds data source to work with
+/// @param[in] name name of the test to report
+void doThroughputTest(const IConstDataSource &ds, const std::string &name)
+{
+  IDataSelectorPtr sel=ds.createSelector();
+  IDataConverterPtr conv=ds.createConverter();
+  casacore::Timer timer;
+  size_t nRows = 0;
+  size_t nChunks = 0;
+  // sum of something from each cube, so the reading is not optimised away
+  double checksum = 0.;
+  timer.mark();
+  for (IConstDataSharedIter it=ds.createConstIterator(sel,conv);it!=it.end();++it) {
+       const casacore::Cube<casacore::Complex> &vis = it->visibility();
+       const casacore::Cube<casacore::Bool> &flag = it->flag();
+       const casacore::Cube<casacore::Complex> &noise = it->noise();
+       if (vis.nelements()) {
+           checksum += casacore::real(vis(0,0,0)) + casacore::real(noise(0,0,0)) + (flag(0,0,0) ? 1. : 0.);
+       }
+       nRows += it->nRow();
+       ++nChunks;
+  }
+  const double elapsed = timer.real();
+  cout<<name<<": "<<nRows<<" rows in "<<nChunks<<" chunks read in "<<elapsed<<" s";
+  if (elapsed > 0.) {
+      cout<<", "<<double(nRows) / elapsed<<" rows/s";
+  }
+  cout<<" (checksum "<<checksum<<")"<<endl;
+}
+
+int main(int argc, char **argv) {
+  try {
+     if (argc != 2 && argc != 3) {
+         cerr<<"Usage "<<argv[0]<<" measurement_set [max_rows_per_chunk]"<<endl;
+         return -2;
+     }
+
+     TableDataSource ds(argv[1]);
+     if (argc == 3) {
+         const casacore::uInt maxChunkSize = utility::fromString<casacore::uInt>(argv[2]);
+         ds.configureMaxChunkSize(maxChunkSize);
+     }
+     // the first pass warms up the file system cache, the second pass is the actual measurement
+     doThroughputTest(ds, "Cold pass");
+     doThroughputTest(ds, "Warm pass");
+  }
+  catch(const AskapError &ce) {
+     cerr<<"AskapError has been caught. "<<ce.what()<<endl;
+     return -1;
+  }
+  catch(const std::exception &ex) {
+     cerr<<"std::exception has been caught. "<<ex.what()<<endl;
+     return -1;
+  }
+  catch(...) {
+     cerr<<"An unexpected exception has been caught"<<endl;
+     return -1;
+  }
+  return 0;
+}
@@ -188,6 +188,29 @@ void BasicDataConverter::direction(const casacore::MDirection &in,
   out=(*itsDirectionConverter)(in);
 }
 
+/// @brief convert a number of directions given in the same frame
+/// @details The conversion machinery is set up once for all directions (see
+/// IDirectionConverter::convert).
+/// @param[in] inRef reference frame of the input directions
+/// @param[in] in input directions
+/// @param[out] out converted directions (resized to match the input)
+void BasicDataConverter::direction(const casacore::MDirection::Ref &inRef,
+                      const casacore::Vector<casacore::MVDirection> &in,
+                      casacore::Vector<casacore::MVDirection> &out) const
+{
+  itsDirectionConverter->convert(inRef, in, out);
+}
+
+/// @brief check whether the direction conversion depends on the position
+/// @details If it doesn't, the directions for all antennas can be converted with
+/// the same frame.
+/// @param[in] inRef reference frame of the input directions
+/// @return true, if the result depends on the position set with setMeasFrame
+bool BasicDataConverter::isDirectionPositionDependent(const casacore::MDirection::Ref &inRef) const
+{
+  return itsDirectionConverter->isPositionDependent(inRef);
+}
+
 /// convert frequencies
 /// @param in input frequency given as an MFrequency object
 /// @return output frequency as a Double
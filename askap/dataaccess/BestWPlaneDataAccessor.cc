@@ -59,7 +59,8 @@ ASKAP_LOGGER(logger,".casaAccessors")
 /// in the constructor call itself.
 BestWPlaneDataAccessor::BestWPlaneDataAccessor(const double tolerance, const bool checkResidual) : itsCheckResidual(checkResidual), 
        itsWTolerance(tolerance),
-       itsCoeffA(0.), itsCoeffB(0.), itsUVWChangeMonitor(changeMonitor()), itsPredictWPlane(false)
+       itsCoeffA(0.), itsCoeffB(0.), itsUVWChangeMonitor(changeMonitor()), itsFloatUVWValid(false),
+       itsPredictWPlane(false), itsScheduleWindow(0)
 {
    
 }
@@ -70,8 +71,11 @@ BestWPlaneDataAccessor::BestWPlaneDataAccessor(const double tolerance, const boo
 BestWPlaneDataAccessor::BestWPlaneDataAccessor(const BestWPlaneDataAccessor &other) : 
     itsCheckResidual(other.itsCheckResidual), itsWTolerance(other.itsWTolerance), itsCoeffA(other.itsCoeffA),
     itsCoeffB(other.itsCoeffB), itsUVWChangeMonitor(changeMonitor()), itsPlaneChangeMonitor(changeMonitor()),
-    itsRotatedUVW(other.itsRotatedUVW.copy()), itsLastTangentPoint(other.itsLastTangentPoint),
-    itsPredictWPlane(other.itsPredictWPlane), itsPredictTimeInterval(other.itsPredictTimeInterval) {}
+    itsRotatedUVW(other.itsRotatedUVW.copy()), itsRotatedUVWComponents(other.itsRotatedUVWComponents),
+    itsRotatedUVWComponentsFloat(other.itsRotatedUVWComponentsFloat), itsFloatUVWValid(other.itsFloatUVWValid),
+    itsLastTangentPoint(other.itsLastTangentPoint),
+    itsPredictWPlane(other.itsPredictWPlane), itsPredictTimeInterval(other.itsPredictTimeInterval),
+    itsPlaneSchedule(other.itsPlaneSchedule), itsScheduleWindow(other.itsScheduleWindow) {}
 
 /// @brief assignment operator
 /// @details We need it because we have data members of non-trivial types
@@ -86,9 +90,14 @@ BestWPlaneDataAccessor& BestWPlaneDataAccessor::operator=(const BestWPlaneDataAc
       itsUVWChangeMonitor.notifyOfChanges();
       itsPlaneChangeMonitor.notifyOfChanges();
       itsRotatedUVW.assign(other.itsRotatedUVW.copy());
+      itsRotatedUVWComponents = other.itsRotatedUVWComponents;
+      itsRotatedUVWComponentsFloat = other.itsRotatedUVWComponentsFloat;
+      itsFloatUVWValid = other.itsFloatUVWValid;
       itsLastTangentPoint = other.itsLastTangentPoint;
       itsPredictWPlane = other.itsPredictWPlane;
       itsPredictTimeInterval = other.itsPredictTimeInterval;
+      itsPlaneSchedule = other.itsPlaneSchedule;
+      itsScheduleWindow = other.itsScheduleWindow;
   }
   return *this;
 }
@@ -124,9 +133,6 @@ const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >&
    // the current type is in the apparent frame (APP) and in geocentric.
  
    const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& originalUVW = acc.rotatedUVW(tangentPoint);
-   if (itsRotatedUVW.nelements() != originalUVW.nelements()) {
-       itsRotatedUVW.resize(originalUVW.nelements());
-   }
    
    // compute tolerance in metres to match units of originalUVW
    const casacore::Vector<double>& freq = acc.frequency();
@@ -137,13 +143,14 @@ const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >&
    ASKAPDEBUGASSERT(maxFreq > 0.); 
    const double tolInMetres = itsWTolerance * casacore::C::c / maxFreq;
    
+   // the plane is subtracted (and itsRotatedUVW filled) by the following methods
    double maxDeviation = 0.;
-   
-   if (itsPredictWPlane == false) {
-       maxDeviation = updatePlaneIfNecessary(originalUVW, tolInMetres);
-   }
-   else {
+   if (itsPlaneSchedule) {
+       maxDeviation = updateScheduledPlane(originalUVW, acc.time(), tolInMetres);
+   } else if (itsPredictWPlane) {
        maxDeviation = updateAdvancedTimePlaneIfNecessary(tolInMetres, tangentPoint);
+   } else {
+       maxDeviation = updatePlaneIfNecessary(originalUVW, tolInMetres);
    }
    if (itsCheckResidual) {
        ASKAPCHECK(maxDeviation < tolInMetres, "The antenna layout is significantly non-coplanar. "
@@ -151,37 +158,191 @@ const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >&
               itsWTolerance<<" wavelengths equivalent to "<<tolInMetres<<" metres.");
    }
 
-    
-   for (casacore::uInt row=0; row<originalUVW.nelements(); ++row) {
-        const casacore::RigidVector<casacore::Double, 3> currentUVW = originalUVW[row];
-        itsRotatedUVW[row] = currentUVW;
-        // subtract the current plane
-        itsRotatedUVW[row](2) -= coeffA()*currentUVW(0) + coeffB()*currentUVW(1);
-   }
-   
-
    return itsRotatedUVW;
 }	         
 
-/// @brief calculate the largest deviation from the current fitted plane
-/// @details This helper method iterates through the given uvw's and returns
-/// the largest deviation of the w-term from the current best fit plane.
+/// @brief use the precomputed schedule of planes
+/// @details In this mode, the plane coefficients are taken from the schedule for the
+/// time of the current chunk instead of being fitted. The plane change monitor is updated
+/// when a new validity window is entered. The deviation from the scheduled plane is still
+/// checked, and a new plane is fitted if the deviation exceeds the tolerance or if the time
+/// is outside the schedule. The fitted plane is used until the next validity window is
+/// entered. Pass an empty shared pointer to switch this mode off.
+/// @param[in] schedule shared pointer to the schedule
+void BestWPlaneDataAccessor::setPlaneSchedule(const boost::shared_ptr<WPlaneSchedule const> &schedule)
+{
+   itsPlaneSchedule = schedule;
+   itsScheduleWindow = schedule ? schedule->size() : 0;
+}
+
+/// @brief uvw after rotation stored as separate arrays of u, v and w
+/// @details This is the same information as returned by rotatedUVW (i.e. with
+/// the best plane subtracted), both representations are filled at the same time.
+/// @param[in] tangentPoint tangent point to rotate the coordinates to
+/// @return rotated uvw components with corrected w
+const UVWComponents<casacore::Double>&
+         BestWPlaneDataAccessor::rotatedUVWComponents(const casacore::MDirection &tangentPoint) const
+{
+   rotatedUVW(tangentPoint);
+   ASKAPDEBUGASSERT(itsRotatedUVWComponents.nelements() == itsRotatedUVW.nelements());
+   return itsRotatedUVWComponents;
+}
+
+/// @brief uvw after rotation stored as separate arrays of u, v and w in single precision
+/// @details See rotatedUVWComponents. The single precision copy is made on demand.
+/// @param[in] tangentPoint tangent point to rotate the coordinates to
+/// @return rotated uvw components with corrected w
+const UVWComponents<casacore::Float>&
+         BestWPlaneDataAccessor::rotatedUVWComponentsFloat(const casacore::MDirection &tangentPoint) const
+{
+   rotatedUVW(tangentPoint);
+   if (!itsFloatUVWValid) {
+       itsRotatedUVWComponentsFloat.assignFrom(itsRotatedUVWComponents);
+       itsFloatUVWValid = true;
+   }
+   return itsRotatedUVWComponentsFloat;
+}
+
+/// @brief solve the normal equations
+/// @param[out] coeffA fit coefficient A
+/// @param[out] coeffB fit coefficient B
+/// @return false if the determinant is too close to zero (the coefficients are not changed in this case)
+bool BestWPlaneDataAccessor::PlaneFitSums::solve(double &coeffA, double &coeffB) const
+{
+   // we need a non-zero determinant for a successful fitting
+   // some tolerance has to be put on the determinant to avoid unconstrained fits
+   // we just accept the current fit results if the new fit is not possible
+   const double D = itsSU2 * itsSV2 - casacore::square(itsSUV);
+
+   if (fabs(D) < 1e-7) {
+       return false;
+   }
+   coeffA = (itsSV2 * itsSUW - itsSUV * itsSVW) / D;
+   coeffB = (itsSU2 * itsSVW - itsSUV * itsSUW) / D;
+   return true;
+}
+
+/// @brief subtract the current plane from w-terms
+/// @details This method fills the buffers returned by rotatedUVW and rotatedUVWComponents
+/// with the given uvw's after subtraction of the current plane. The sums of the fit and
+/// the largest deviation from the current plane are obtained in the same pass.
 /// @param[in] uvw a vector with uvw's
+/// @param[out] sums sums of the fit (reset by this method)
 /// @return the largest w-term deviation from the current plane (same units as uvw's)
-double BestWPlaneDataAccessor::maxWDeviation(const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& uvw) const
+double BestWPlaneDataAccessor::subtractPlane(const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& uvw,
+                 PlaneFitSums &sums) const
 {
-   double maxDeviation = 0.;
+   const casacore::uInt nRows = uvw.nelements();
+   if (itsRotatedUVW.nelements() != nRows) {
+       itsRotatedUVW.resize(nRows);
+   }
+   itsRotatedUVWComponents.resize(nRows);
+   itsFloatUVWValid = false;
 
-   // we fit w=Au+Bv, the following lines compute the largest deviation from the current plane.
+   // local copies, so the compiler doesn't have to assume that the outputs overlap them
+   const double a = coeffA();
+   const double b = coeffB();
+   double su2 = 0., sv2 = 0., suv = 0., suw = 0., svw = 0., maxDeviation = 0.;
 
-   for (casacore::uInt row=0; row<uvw.nelements(); ++row) {
-        const casacore::RigidVector<casacore::Double, 3> currentUVW = uvw[row];
-        const double deviation = fabs(coeffA()*currentUVW(0) + coeffB()*currentUVW(1) - currentUVW(2));
-        if (deviation > maxDeviation) {
-            maxDeviation = deviation;
-        }
+   casacore::Bool deleteIt;
+   const casacore::RigidVector<casacore::Double, 3> *in = uvw.getStorage(deleteIt);
+   casacore::RigidVector<casacore::Double, 3> *out = itsRotatedUVW.data();
+   casacore::Double *u = itsRotatedUVWComponents.uData();
+   casacore::Double *v = itsRotatedUVWComponents.vData();
+   casacore::Double *w = itsRotatedUVWComponents.wData();
+   const int nRowsInt = int(nRows);
+#if defined(_OPENMP) && _OPENMP >= 201307
+   // simd construct requires OpenMP 4.0
+   #pragma omp simd reduction(+:su2,sv2,suv,suw,svw) reduction(max:maxDeviation)
+#endif
+   for (int row = 0; row < nRowsInt; ++row) {
+        const double uIn = in[row](0);
+        const double vIn = in[row](1);
+        const double wIn = in[row](2);
+        su2 += uIn * uIn;
+        sv2 += vIn * vIn;
+        suv += uIn * vIn;
+        suw += uIn * wIn;
+        svw += vIn * wIn;
+        const double wOut = wIn - a * uIn - b * vIn;
+        const double deviation = fabs(wOut);
+        maxDeviation = deviation > maxDeviation ? deviation : maxDeviation;
+        out[row](0) = uIn;
+        out[row](1) = vIn;
+        out[row](2) = wOut;
+        u[row] = uIn;
+        v[row] = vIn;
+        w[row] = wOut;
    }
-   
+   uvw.freeStorage(in, deleteIt);
+
+   sums.itsSU2 = su2;
+   sums.itsSV2 = sv2;
+   sums.itsSUV = suv;
+   sums.itsSUW = suw;
+   sums.itsSVW = svw;
+   return maxDeviation;
+}
+
+/// @brief accumulate the sums of the fit
+/// @details The sums are accumulated in a single pass without altering the buffers of this adapter.
+/// @param[in] uvw a vector with uvw's
+/// @param[out] sums sums of the fit (reset by this method)
+void BestWPlaneDataAccessor::accumulateFit(const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& uvw,
+                 PlaneFitSums &sums)
+{
+   double su2 = 0., sv2 = 0., suv = 0., suw = 0., svw = 0.;
+
+   casacore::Bool deleteIt;
+   const casacore::RigidVector<casacore::Double, 3> *in = uvw.getStorage(deleteIt);
+   const int nRows = int(uvw.nelements());
+#if defined(_OPENMP) && _OPENMP >= 201307
+   #pragma omp simd reduction(+:su2,sv2,suv,suw,svw)
+#endif
+   for (int row = 0; row < nRows; ++row) {
+        const double uIn = in[row](0);
+        const double vIn = in[row](1);
+        const double wIn = in[row](2);
+        su2 += uIn * uIn;
+        sv2 += vIn * vIn;
+        suv += uIn * vIn;
+        suw += uIn * wIn;
+        svw += vIn * wIn;
+   }
+   uvw.freeStorage(in, deleteIt);
+
+   sums.itsSU2 = su2;
+   sums.itsSV2 = sv2;
+   sums.itsSUV = suv;
+   sums.itsSUW = suw;
+   sums.itsSVW = svw;
+}
+
+/// @brief calculate the largest deviation from the given plane
+/// @details This helper method iterates through the given uvw's and returns
+/// the largest deviation of the w-term from the plane w=Au+Bv.
+/// @param[in] uvw a vector with uvw's
+/// @param[in] coeffA coefficient A of the plane
+/// @param[in] coeffB coefficient B of the plane
+/// @return the largest w-term deviation from the plane (same units as uvw's)
+double BestWPlaneDataAccessor::maxWDeviation(const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& uvw,
+                 double coeffA, double coeffB)
+{
+   double maxDeviation = 0.;
+
+   // we fit w=Au+Bv, the following lines compute the largest deviation from the given plane.
+   casacore::Bool deleteIt;
+   const casacore::RigidVector<casacore::Double, 3> *in = uvw.getStorage(deleteIt);
+   const int nRows = int(uvw.nelements());
+#if defined(_OPENMP) && _OPENMP >= 201307
+   #pragma omp simd reduction(max:maxDeviation)
+#endif
+   for (int row = 0; row < nRows; ++row) {
+        const double deviation = fabs(coeffA * in[row](0) + coeffB * in[row](1) - in[row](2));
+        maxDeviation = deviation > maxDeviation ? deviation : maxDeviation;
+   }
+   uvw.freeStorage(in, deleteIt);
+
    return maxDeviation;
 }
 
@@ -209,7 +370,9 @@ double BestWPlaneDataAccessor::updateAdvancedTimePlaneIfNecessary(double toleran
    double tmpCoeffA = 0.0;
    double tmpCoeffB = 0.0;
 
-   double AdvancedDeviation = maxWDeviation(uvw); // using current plane
+   // the current plane is subtracted and the sums of the LSF problem are accumulated in the same pass
+   PlaneFitSums sums;
+   double AdvancedDeviation = subtractPlane(uvw, sums); // using current plane
    
    if (verbose) {
        ASKAPLOG_INFO_STR(logger, "BestWPlaneDataAccessor::On entry current deviation (using the current plane) " << AdvancedDeviation << " tolerance " << tolerance);
@@ -221,53 +384,13 @@ double BestWPlaneDataAccessor::updateAdvancedTimePlaneIfNecessary(double toleran
    }
     
    // we are out of our tolerance range - get a new plane
-   // First thing we should do is use the existing update plane to get a plane that minimises W-deviation
-   // This fragment breaks the rules of code-reuse - but means I dont have to worry about the changemonitor picking this up
-   // we fit w=Au+Bv, the following lines accumulate the necessary sums of the LSF problem
-       
-   double su2 = 0.; // sum of u-squared
-   double sv2 = 0.; // sum of v-squared
-   double suv = 0.; // sum of uv-products
-   double suw = 0.; // sum of uw-products
-   double svw = 0.; // sum of vw-products
-       
-   for (casacore::uInt row=0; row<uvw.nelements(); ++row) {
-       const casacore::RigidVector<casacore::Double, 3> currentUVW = uvw[row];
-           
-       su2 += casacore::square(currentUVW(0));
-       sv2 += casacore::square(currentUVW(1));
-       suv += currentUVW(0) * currentUVW(1);
-       suw += currentUVW(0) * currentUVW(2);
-       svw += currentUVW(1) * currentUVW(2);
-   }
-       
-   // we need a non-zero determinant for a successful fitting
-   // some tolerance has to be put on the determinant to avoid unconstrained fits
-   // we just accept the current fit results if the new fit is not possible
-   double D = su2 * sv2 - casacore::square(suv);
-       
-   if (fabs(D) < 1e-7) {
+   // First thing we should do is use the sums to get a plane that minimises W-deviation now
+   if (!sums.solve(tmpCoeffA, tmpCoeffB)) {
        ASKAPLOG_INFO_STR(logger, "BestWPlaneDataAccessor::updateAdvancedTimePlaneIfNecessary::Matrix has almost 0 determinant fit not likely to be valid");
        return AdvancedDeviation;
    }
        
-   // make an update to the coefficients
-   tmpCoeffA = (sv2 * suw - suv * svw) / D;
-   tmpCoeffB = (su2 * svw - suv * suw) / D;
-       
-       
-   // this fragment basically replicates the maxDeviation functionality
-     
-   AdvancedDeviation = 0.;
-       // we fit w=Au+Bv, the following lines compute the largest deviation from the current plane.
-       
-   for (casacore::uInt row=0; row<uvw.nelements(); ++row) {
-       const casacore::RigidVector<casacore::Double, 3> currentUVW = uvw[row];
-       const double deviation = fabs(tmpCoeffA*currentUVW(0) + tmpCoeffB*currentUVW(1) - currentUVW(2));
-       if (deviation > AdvancedDeviation) {
-           AdvancedDeviation = deviation;
-       }
-   }
+   AdvancedDeviation = maxWDeviation(uvw, tmpCoeffA, tmpCoeffB);
    if (AdvancedDeviation > tolerance) {
        ASKAPLOG_INFO_STR(logger, "BestWPlaneDataAccessor::updateAdvancedTimePlaneIfNecessary Current deviation (after next plane fit) " << AdvancedDeviation);
        return AdvancedDeviation; // we cannot get below tolerance at all - let alone in the future - the calling function will pick this up
@@ -288,18 +411,7 @@ double BestWPlaneDataAccessor::updateAdvancedTimePlaneIfNecessary(double toleran
        newTangentPoint.shiftLongitude(TimeShift*angle.getValue("rad"),true);
        TotalShift = TotalShift+TimeShift;
     
-       const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& test_uvw = acc.rotatedUVW(newTangentPoint);
-           
-       AdvancedDeviation = 0.; //reset
-           // we fit w=Au+Bv, the following lines compute the largest deviation from the current plane.
-           
-       for (casacore::uInt row=0; row<uvw.nelements(); ++row) {
-           const casacore::RigidVector<casacore::Double, 3> currentUVW = test_uvw[row];
-           const double deviation = fabs(tmpCoeffA*currentUVW(0) + tmpCoeffB*currentUVW(1) - currentUVW(2));
-           if (deviation > AdvancedDeviation) {
-               AdvancedDeviation = deviation;
-           }
-       }
+       AdvancedDeviation = maxWDeviation(acc.rotatedUVW(newTangentPoint), tmpCoeffA, tmpCoeffB);
        if (verbose) {
           ASKAPLOG_INFO_STR(logger, "BestWPlaneDataAccessor::Current deviation (after  " << TotalShift << " seconds) " << AdvancedDeviation);
        }
@@ -308,42 +420,15 @@ double BestWPlaneDataAccessor::updateAdvancedTimePlaneIfNecessary(double toleran
    // Lets pull back one time step then evaluate the plane for then.
    double on_exit_deviation = 0.;
    do {
-       const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& on_exit_uvw = acc.rotatedUVW(tangentPoint);
-       on_exit_deviation = maxWDeviation(on_exit_uvw);
+       on_exit_deviation = maxWDeviation(acc.rotatedUVW(tangentPoint));
     
        newTangentPoint.shiftLongitude(-1.0*TimeShift*angle.getValue("rad"),true);
-       const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >&advanced_uvw = acc.rotatedUVW(newTangentPoint);
-       
-     // we fit w=Au+Bv, the following lines accumulate the necessary sums of the LSF problem
+       PlaneFitSums advancedSums;
+       accumulateFit(acc.rotatedUVW(newTangentPoint), advancedSums);
        
-       su2 = 0.; // sum of u-squared
-       sv2 = 0.; // sum of v-squared
-       suv = 0.; // sum of uv-products
-       suw = 0.; // sum of uw-products
-       svw = 0.; // sum of vw-products
-       
-       for (casacore::uInt row=0; row<uvw.nelements(); ++row) {
-           const casacore::RigidVector<casacore::Double, 3> currentUVW = advanced_uvw[row];
-           
-           su2 += casacore::square(currentUVW(0));
-           sv2 += casacore::square(currentUVW(1));
-           suv += currentUVW(0) * currentUVW(1);
-           suw += currentUVW(0) * currentUVW(2);
-           svw += currentUVW(1) * currentUVW(2);
+       if (!advancedSums.solve(itsCoeffA, itsCoeffB)) {
+           break;
        }
-       
-       // we need a non-zero determinant for a successful fitting
-       // some tolerance has to be put on the determinant to avoid unconstrained fits
-       // we just accept the current fit results if the new fit is not possible
-       D = su2 * sv2 - casacore::square(suv);
-       
-       if (fabs(D) < 1e-7) {
-           return on_exit_deviation;
-       }
-       
-       // make an update to the coefficients
-       itsCoeffA = (sv2 * suw - suv * svw) / D;
-       itsCoeffB = (su2 * svw - suv * suw) / D;
        itsPlaneChangeMonitor.notifyOfChanges();
    
    } while (on_exit_deviation > tolerance);
@@ -353,15 +438,18 @@ double BestWPlaneDataAccessor::updateAdvancedTimePlaneIfNecessary(double toleran
            ASKAPLOG_INFO_STR(logger, "BestWPlaneDataAccessor:: w = u * " << coeffA() << " + v * " << coeffB());
    }
    
-   return maxWDeviation(uvw);
-
-
+   // uvw's for the tangent point are obtained again as the buffer of the original accessor
+   // could have been reused for the advanced tangent points
+   return subtractPlane(acc.rotatedUVW(tangentPoint), sums);
 }
     
 /// @brief fit a new plane and update coefficients if necessary
-/// @details This method iterates over given uvw's, checks whether the
-/// largest deviation of the w-term from the current plane is above the 
-/// tolerance and updates the fit coefficients if it is. 
+/// @details This method subtracts the current plane from the given uvw's (filling the
+/// buffers returned by rotatedUVW and rotatedUVWComponents) and accumulates the sums of
+/// the fit in the same pass. If the largest deviation of the w-term from the current plane
+/// is above the tolerance, the fit coefficients are updated from these sums and the
+/// new plane is subtracted. Therefore, the coefficients are carried forward from chunk
+/// to chunk and there is only one pass over the data unless a new fit is required.
 /// planeChangeMonitor() can be used to detect the change in the fit plane.
 /// 
 /// @param[in] uvw a vector with uvw's
@@ -375,8 +463,8 @@ double BestWPlaneDataAccessor::updateAdvancedTimePlaneIfNecessary(double toleran
 double BestWPlaneDataAccessor::updatePlaneIfNecessary(const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& uvw,
                  double tolerance) const
 {
-
-   const double maxDeviation = maxWDeviation(uvw);
+   PlaneFitSums sums;
+   const double maxDeviation = subtractPlane(uvw, sums);
     
    // we need at least two rows for a successful fitting, don't bother doing anything if the
    // number of rows is too small or the deviation is below the tolerance
@@ -384,38 +472,46 @@ double BestWPlaneDataAccessor::updatePlaneIfNecessary(const casacore::Vector<cas
        return maxDeviation;
    }
    
-   // we fit w=Au+Bv, the following lines accumulate the necessary sums of the LSF problem
-   
-   double su2 = 0.; // sum of u-squared
-   double sv2 = 0.; // sum of v-squared
-   double suv = 0.; // sum of uv-products
-   double suw = 0.; // sum of uw-products
-   double svw = 0.; // sum of vw-products
-   
-   for (casacore::uInt row=0; row<uvw.nelements(); ++row) {
-        const casacore::RigidVector<casacore::Double, 3> currentUVW = uvw[row];
-
-        su2 += casacore::square(currentUVW(0));
-        sv2 += casacore::square(currentUVW(1));
-        suv += currentUVW(0) * currentUVW(1);
-        suw += currentUVW(0) * currentUVW(2);
-        svw += currentUVW(1) * currentUVW(2);                
-   }
-   
-   // we need a non-zero determinant for a successful fitting
-   // some tolerance has to be put on the determinant to avoid unconstrained fits
-   // we just accept the current fit results if the new fit is not possible
-   const double D = su2 * sv2 - casacore::square(suv);
-
-   if (fabs(D) < 1e-7) {
+   // make an update to the coefficients, the sums have been accumulated in the first pass
+   if (!sums.solve(itsCoeffA, itsCoeffB)) {
        return maxDeviation;
    }
-
-   // make an update to the coefficients
-   itsCoeffA = (sv2 * suw - suv * svw) / D;
-   itsCoeffB = (su2 * svw - suv * suw) / D;
    itsPlaneChangeMonitor.notifyOfChanges();
   
-   return maxWDeviation(uvw);
+   return subtractPlane(uvw, sums);
 }
 
+/// @brief use the plane from the schedule and update coefficients if necessary
+/// @details The coefficients are set from the validity window of the schedule corresponding
+/// to the given time (if this window is entered for the first time) and the plane is
+/// subtracted like in updatePlaneIfNecessary (which means that a new plane is fitted if
+/// the scheduled one doesn't meet the tolerance).
+/// @param[in] uvw a vector with uvw's
+/// @param[in] time time of the current chunk
+/// @param[in] tolerance tolerance in the same units as uvw's
+/// @return the largest w-term deviation from the plane (same units as uvw's)
+double BestWPlaneDataAccessor::updateScheduledPlane(const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& uvw,
+                 double time, double tolerance) const
+{
+   ASKAPDEBUGASSERT(itsPlaneSchedule);
+   const size_t window = itsPlaneSchedule->find(time);
+   // the scheduled plane is only applied when a new window is entered, so a plane fitted
+   // because the scheduled one has not met the tolerance is carried forward until then
+   if ((window < itsPlaneSchedule->size()) && (window != itsScheduleWindow)) {
+       itsScheduleWindow = window;
+       const double scheduledA = itsPlaneSchedule->coeffA(window);
+       const double scheduledB = itsPlaneSchedule->coeffB(window);
+       if ((scheduledA != itsCoeffA) || (scheduledB != itsCoeffB)) {
+           itsCoeffA = scheduledA;
+           itsCoeffB = scheduledB;
+           itsPlaneChangeMonitor.notifyOfChanges();
+       }
+   }
+   const scimath::ChangeMonitor planeMonitor = itsPlaneChangeMonitor;
+   const double maxDeviation = updatePlaneIfNecessary(uvw, tolerance);
+   if (planeMonitor != itsPlaneChangeMonitor) {
+       ASKAPLOG_DEBUG_STR(logger, "The scheduled w-plane doesn't meet the tolerance at time="<<time<<
+                          ", a new plane has been fitted");
+   }
+   return maxDeviation;
+}
@@ -41,8 +41,13 @@
 
 // own includes
 #include <askap/dataaccess/DataAccessorAdapter.h>
+#include <askap/dataaccess/UVWComponents.h>
+#include <askap/dataaccess/WPlaneSchedule.h>
 #include <askap/scimath/utils/ChangeMonitor.h>
 
+// boost includes
+#include <boost/shared_ptr.hpp>
+
 
 namespace askap {
 
@@ -91,6 +96,19 @@ public:
    /// the required tolerance on w-term cannot be met.
    virtual const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >&
 	         rotatedUVW(const casacore::MDirection &tangentPoint) const;
+
+   /// @brief uvw after rotation stored as separate arrays of u, v and w
+   /// @details This is the same information as returned by rotatedUVW (i.e. with
+   /// the best plane subtracted), both representations are filled at the same time.
+   /// @param[in] tangentPoint tangent point to rotate the coordinates to
+   /// @return rotated uvw components with corrected w
+   const UVWComponents<casacore::Double>& rotatedUVWComponents(const casacore::MDirection &tangentPoint) const;
+
+   /// @brief uvw after rotation stored as separate arrays of u, v and w in single precision
+   /// @details See rotatedUVWComponents. The single precision copy is made on demand.
+   /// @param[in] tangentPoint tangent point to rotate the coordinates to
+   /// @return rotated uvw components with corrected w
+   const UVWComponents<casacore::Float>& rotatedUVWComponentsFloat(const casacore::MDirection &tangentPoint) const;
    
    // fitted plane parameters
    
@@ -120,12 +138,56 @@ public:
    inline void setPredictWPlaneMode(const double timeinterval=10.0) {
        itsPredictWPlane = true; itsPredictTimeInterval = timeinterval;}
 
+   /// @brief use the precomputed schedule of planes
+   /// @details In this mode, the plane coefficients are taken from the schedule for the
+   /// time of the current chunk instead of being fitted. The plane change monitor is updated
+   /// when a new validity window is entered, so the regridding boundaries can be planned ahead
+   /// using the schedule. The deviation from the scheduled plane is still checked (in the same
+   /// pass as the plane is subtracted), and a new plane is fitted if the deviation exceeds the
+   /// tolerance or if the time is outside the schedule (the fitted plane is then used until the
+   /// next validity window is entered). This mode takes precedence over the
+   /// predictive mode. Pass an empty shared pointer to switch it off.
+   /// @param[in] schedule shared pointer to the schedule
+   void setPlaneSchedule(const boost::shared_ptr<WPlaneSchedule const> &schedule);
+
+   /// @brief obtain the schedule of planes
+   /// @return shared pointer to the schedule (empty if the schedule is not used)
+   inline const boost::shared_ptr<WPlaneSchedule const>& planeSchedule() const { return itsPlaneSchedule; }
+
 protected:
 
+   /// @brief sums of the least-squares problem
+   /// @details We fit w=Au+Bv, these are the sums forming the normal equations.
+   /// They are accumulated in a single pass over the rows (see subtractPlane and accumulateFit).
+   struct PlaneFitSums {
+      /// @brief construct zero sums
+      PlaneFitSums() : itsSU2(0.), itsSV2(0.), itsSUV(0.), itsSUW(0.), itsSVW(0.) {}
+
+      /// @brief solve the normal equations
+      /// @param[out] coeffA fit coefficient A
+      /// @param[out] coeffB fit coefficient B
+      /// @return false if the determinant is too close to zero (the coefficients are not changed in this case)
+      bool solve(double &coeffA, double &coeffB) const;
+
+      /// @brief sum of u-squared
+      double itsSU2;
+      /// @brief sum of v-squared
+      double itsSV2;
+      /// @brief sum of uv-products
+      double itsSUV;
+      /// @brief sum of uw-products
+      double itsSUW;
+      /// @brief sum of vw-products
+      double itsSVW;
+   };
+
    /// @brief fit a new plane and update coefficients if necessary
-   /// @details This method iterates over given uvw's, checks whether the 
-   /// largest deviation of the w-term from the current plane is above the 
-   /// tolerance and updates the fit coefficients if it is. 
+   /// @details This method subtracts the current plane from the given uvw's (filling the
+   /// buffers returned by rotatedUVW and rotatedUVWComponents) and accumulates the sums of
+   /// the fit in the same pass. If the largest deviation of the w-term from the current plane
+   /// is above the tolerance, the fit coefficients are updated from these sums and the
+   /// new plane is subtracted. Therefore, the coefficients are carried forward from chunk
+   /// to chunk and there is only one pass over the data unless a new fit is required.
    /// planeChangeMonitor() can be used to detect the change in the fit plane.
    /// 
    /// @param[in] uvw a vector with uvw's
@@ -149,9 +211,9 @@ protected:
    /// this fit is greater than tolerance. Which provides as indication of how quickly the W deviation grows.
    /// We then find the coefficents of the best fit plane at that time in the future. Reasoning that the current
    /// deviation from that plane will be within tolerance - trend to 0 with time and then increase to beyond
-   /// tolerence.
-   /// @param[in] uvw a vector with uvw's
+   /// tolerence. The plane is subtracted from uvw's like in updatePlaneIfNecessary.
    /// @param[in] tolerance tolerance in the same units as uvw's
+   /// @param[in] tangentPoint tangent point to rotate the coordinates to
    /// @return the largest w-term deviation from the fitted plane (same units as uvw's)
    /// @note If a new fit is performed, the devitation is reported with respect to the
    /// new fit (it takes place if the deviation from initial plane exceeds the given tolerance).
@@ -159,13 +221,53 @@ protected:
    /// non-coplanar, so the required tolerance cannot be achieved.
    /// This method has a conceptual constness as it doesn't change the original accessor.
    double updateAdvancedTimePlaneIfNecessary(double tolerance, const casacore::MDirection &tangentPoint) const;
-    
+
+   /// @brief use the plane from the schedule and update coefficients if necessary
+   /// @details The coefficients are set from the validity window of the schedule corresponding
+   /// to the given time (if this window is entered for the first time) and the plane is
+   /// subtracted like in updatePlaneIfNecessary (which means that a new plane is fitted if
+   /// the scheduled one doesn't meet the tolerance).
+   /// @param[in] uvw a vector with uvw's
+   /// @param[in] time time of the current chunk
+   /// @param[in] tolerance tolerance in the same units as uvw's
+   /// @return the largest w-term deviation from the plane (same units as uvw's)
+   double updateScheduledPlane(const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& uvw,
+                 double time, double tolerance) const;
+
+   /// @brief subtract the current plane from w-terms
+   /// @details This method fills the buffers returned by rotatedUVW and rotatedUVWComponents
+   /// with the given uvw's after subtraction of the current plane. The sums of the fit and
+   /// the largest deviation from the current plane are obtained in the same pass.
+   /// @param[in] uvw a vector with uvw's
+   /// @param[out] sums sums of the fit (reset by this method)
+   /// @return the largest w-term deviation from the current plane (same units as uvw's)
+   double subtractPlane(const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& uvw,
+                 PlaneFitSums &sums) const;
+
+   /// @brief accumulate the sums of the fit
+   /// @details The sums are accumulated in a single pass without altering the buffers of this adapter.
+   /// @param[in] uvw a vector with uvw's
+   /// @param[out] sums sums of the fit (reset by this method)
+   static void accumulateFit(const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& uvw,
+                 PlaneFitSums &sums);
+
+   /// @brief calculate the largest deviation from the given plane
+   /// @details This helper method iterates through the given uvw's and returns
+   /// the largest deviation of the w-term from the plane w=Au+Bv.
+   /// @param[in] uvw a vector with uvw's
+   /// @param[in] coeffA coefficient A of the plane
+   /// @param[in] coeffB coefficient B of the plane
+   /// @return the largest w-term deviation from the plane (same units as uvw's)
+   static double maxWDeviation(const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& uvw,
+                 double coeffA, double coeffB);
+
    /// @brief calculate the largest deviation from the current fitted plane
    /// @details This helper method iterates through the given uvw's and returns
    /// the largest deviation of the w-term from the current best fit plane.
    /// @param[in] uvw a vector with uvw's
    /// @return the largest w-term deviation from the current plane (same units as uvw's)
-   double maxWDeviation(const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& uvw) const;
+   inline double maxWDeviation(const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& uvw) const
+      { return maxWDeviation(uvw, coeffA(), coeffB()); }
    
   
 private:
@@ -200,6 +302,15 @@ private:
       
    /// @brief buffer for rotated UVW vector with corrected w
    mutable casacore::Vector<casacore::RigidVector<casacore::Double, 3> > itsRotatedUVW;   
+
+   /// @brief buffer for rotated uvw with corrected w stored as separate arrays of u, v and w
+   mutable UVWComponents<casacore::Double> itsRotatedUVWComponents;
+
+   /// @brief single precision copy of itsRotatedUVWComponents
+   mutable UVWComponents<casacore::Float> itsRotatedUVWComponentsFloat;
+
+   /// @brief true if itsRotatedUVWComponentsFloat corresponds to itsRotatedUVWComponents
+   mutable bool itsFloatUVWValid;
    
    /// @brief last tangent point
    /// @details This field is added just to be able to do extra checks
@@ -213,6 +324,13 @@ private:
     
    /// @brief The time interval between assesments of the predicted W Plane
    double itsPredictTimeInterval;
+
+   /// @brief precomputed schedule of planes (empty if not used)
+   boost::shared_ptr<WPlaneSchedule const> itsPlaneSchedule;
+
+   /// @brief index of the validity window of the schedule used for the current plane
+   /// @details It is equal to the size of the schedule, if no window has been used yet.
+   mutable size_t itsScheduleWindow;
 };
 
 } // namespace accessors
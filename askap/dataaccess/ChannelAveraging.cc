@@ -0,0 +1,181 @@
+/// @file ChannelAveraging.cc
+///
+/// @brief helper methods to average adjacent spectral channels
+/// @details The data selector allows to average a number of adjacent spectral
+/// channels on read (see IDataSelector::chooseChannels). The methods defined in this
+/// file do such averaging for the arrays in the measurement set order, i.e.
+/// nPol x nChan x nRow, as returned by ArrayColumn::getColumnRange.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#include <askap_accessors.h>
+
+// std includes
+#include <cmath>
+#include <vector>
+
+// ASKAPsoft includes
+#include <askap/askap/AskapError.h>
+
+// own includes
+#include <askap/dataaccess/ChannelAveraging.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief check the shape of the input for averaging and set up the output
+/// @details This helper method is used in all averaging methods
+/// @param[in] inShape shape of the input array (nPol x nChan*nAvg x nRow)
+/// @param[in] nAvg number of adjacent channels to average
+/// @return shape of the output array (nPol x nChan x nRow)
+casacore::IPosition averagedShape(const casacore::IPosition &inShape, casacore::uInt nAvg)
+{
+  ASKAPCHECK(nAvg > 0, "Number of channels to average should be positive");
+  ASKAPCHECK(inShape.nelements() == 3, "Expect a 3D array for channel averaging, shape = "<<inShape);
+  ASKAPCHECK(inShape[1] % nAvg == 0, "Number of channels "<<inShape[1]<<
+             " is not a multiple of the averaging factor "<<nAvg);
+  return casacore::IPosition(3, inShape[0], inShape[1] / nAvg, inShape[2]);
+}
+
+/// @brief average flags in the measurement set order
+/// @details The averaged sample is flagged if all samples in the bin are flagged
+/// @param[in] in input flags (nPol x nChan*nAvg x nRow)
+/// @param[in] nAvg number of adjacent channels to average
+/// @param[out] out output flags (resized to nPol x nChan x nRow)
+void averageFlagsNative(const casacore::Array<casacore::Bool> &in, casacore::uInt nAvg,
+                        casacore::Array<casacore::Bool> &out)
+{
+  out.resize(averagedShape(in.shape(), nAvg));
+  if (out.nelements() == 0) {
+      return;
+  }
+  const size_t nPol = in.shape()[0];
+  const size_t nOutPerRow = out.nelements() / in.shape()[2];
+  const size_t nInPerRow = nOutPerRow * nAvg;
+  const size_t nRow = in.shape()[2];
+
+  bool deleteIn, deleteOut;
+  const casacore::Bool *src = in.getStorage(deleteIn);
+  casacore::Bool *dst = out.getStorage(deleteOut);
+
+  for (size_t row = 0; row < nRow; ++row) {
+       const casacore::Bool *rowFlags = src + row * nInPerRow;
+       casacore::Bool *rowOut = dst + row * nOutPerRow;
+       for (size_t i = 0; i < nOutPerRow; ++i) {
+            rowOut[i] = casacore::True;
+       }
+       for (size_t outIndex = 0, inIndex = 0; outIndex < nOutPerRow; outIndex += nPol) {
+            for (size_t chan = 0; chan < nAvg; ++chan, inIndex += nPol) {
+                 for (size_t pol = 0; pol < nPol; ++pol) {
+                      rowOut[outIndex + pol] &= rowFlags[inIndex + pol];
+                 }
+            }
+       }
+  }
+
+  in.freeStorage(src, deleteIn);
+  out.putStorage(dst, deleteOut);
+}
+
+/// @brief propagate noise through the averaging
+/// @details The noise of the mean of n unflagged samples with noise sigma_i is
+/// sqrt(sum sigma_i^2) / n. If all samples in the bin are flagged, all samples are used
+/// (consistent with averageChannelsNative).
+/// @param[in] in input noise (nPol x nChan*nAvg x nRow)
+/// @param[in] flags input flags of the same shape as in
+/// @param[in] nAvg number of adjacent channels to average
+/// @param[out] out output noise (resized to nPol x nChan x nRow)
+void averageNoiseNative(const casacore::Array<casacore::Float> &in, const casacore::Array<casacore::Bool> &flags,
+                        casacore::uInt nAvg, casacore::Array<casacore::Float> &out)
+{
+  ASKAPCHECK(flags.shape().isEqual(in.shape()), "Shape of flags "<<flags.shape()<<
+             " doesn't match the shape of noise "<<in.shape());
+  out.resize(averagedShape(in.shape(), nAvg));
+  if (out.nelements() == 0) {
+      return;
+  }
+  const size_t nPol = in.shape()[0];
+  const size_t nOutPerRow = out.nelements() / in.shape()[2];
+  const size_t nInPerRow = nOutPerRow * nAvg;
+  const size_t nRow = in.shape()[2];
+
+  bool deleteIn, deleteFlags, deleteOut;
+  const casacore::Float *src = in.getStorage(deleteIn);
+  const casacore::Bool *flagSrc = flags.getStorage(deleteFlags);
+  casacore::Float *dst = out.getStorage(deleteOut);
+
+  // the sum of squares is accumulated straight in the output, only the weights of one
+  // row are kept aside (allocated once)
+  std::vector<casacore::Float> weight(nOutPerRow);
+  casacore::Float *wt = weight.data();
+  for (size_t row = 0; row < nRow; ++row) {
+       const casacore::Float *rowNoise = src + row * nInPerRow;
+       const casacore::Bool *rowFlags = flagSrc + row * nInPerRow;
+       casacore::Float *rowOut = dst + row * nOutPerRow;
+       for (size_t i = 0; i < nOutPerRow; ++i) {
+            rowOut[i] = 0.f;
+            wt[i] = 0.f;
+       }
+       for (size_t outIndex = 0, inIndex = 0; outIndex < nOutPerRow; outIndex += nPol) {
+            for (size_t chan = 0; chan < nAvg; ++chan, inIndex += nPol) {
+                 for (size_t pol = 0; pol < nPol; ++pol) {
+                      const casacore::Float w = rowFlags[inIndex + pol] ? 0.f : 1.f;
+                      const casacore::Float sigma = rowNoise[inIndex + pol];
+                      rowOut[outIndex + pol] += sigma * sigma * w;
+                      wt[outIndex + pol] += w;
+                 }
+            }
+       }
+       bool allFlaggedBin = false;
+       for (size_t i = 0; i < nOutPerRow; ++i) {
+            allFlaggedBin |= (wt[i] == 0.f);
+            rowOut[i] = std::sqrt(rowOut[i]) / (wt[i] > 0.f ? wt[i] : 1.f);
+       }
+       if (allFlaggedBin) {
+           // rare case: all samples are used for fully flagged bins
+           for (size_t i = 0; i < nOutPerRow; ++i) {
+                if (wt[i] == 0.f) {
+                    const size_t pol = i % nPol;
+                    const casacore::Float *binNoise = rowNoise + (i - pol) * nAvg + pol;
+                    casacore::Float sumSq = 0.f;
+                    for (size_t chan = 0; chan < nAvg; ++chan) {
+                         sumSq += binNoise[chan * nPol] * binNoise[chan * nPol];
+                    }
+                    rowOut[i] = std::sqrt(sumSq) / casacore::Float(nAvg);
+                }
+           }
+       }
+  }
+
+  in.freeStorage(src, deleteIn);
+  flags.freeStorage(flagSrc, deleteFlags);
+  out.putStorage(dst, deleteOut);
+}
+
+} // namespace accessors
+
+} // namespace askap
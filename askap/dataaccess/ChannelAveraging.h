@@ -0,0 +1,93 @@
+/// @file ChannelAveraging.h
+///
+/// @brief helper methods to average adjacent spectral channels
+/// @details The data selector allows to average a number of adjacent spectral
+/// channels on read (see IDataSelector::chooseChannels). The methods declared in this
+/// file do such averaging for the arrays in the measurement set order, i.e.
+/// nPol x nChan x nRow, as returned by ArrayColumn::getColumnRange. Flagged samples
+/// are excluded from the average, the averaged sample is flagged only if all samples
+/// in the bin are flagged. The inner loops are written without branches (flags are
+/// turned into weights), so they can be vectorised by the compiler.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#ifndef ASKAP_ACCESSORS_CHANNEL_AVERAGING_H
+#define ASKAP_ACCESSORS_CHANNEL_AVERAGING_H
+
+// casa includes
+#include <casacore/casa/aips.h>
+#include <casacore/casa/Arrays/Array.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief check the shape of the input for averaging and set up the output
+/// @details This helper method is used in all averaging methods
+/// @param[in] inShape shape of the input array (nPol x nChan*nAvg x nRow)
+/// @param[in] nAvg number of adjacent channels to average
+/// @return shape of the output array (nPol x nChan x nRow)
+casacore::IPosition averagedShape(const casacore::IPosition &inShape, casacore::uInt nAvg);
+
+/// @brief average data in the measurement set order
+/// @details The input array is nPol x (nChan * nAvg) x nRow, the output array is
+/// resized to nPol x nChan x nRow. Each output element is the mean of unflagged input
+/// samples of the bin. If all samples are flagged, the mean of all samples is taken
+/// (the output is flagged in this case, see averageFlagsNative).
+/// @param[in] in input array (nPol x nChan*nAvg x nRow)
+/// @param[in] flags input flags of the same shape as in
+/// @param[in] nAvg number of adjacent channels to average
+/// @param[out] out output array (resized to nPol x nChan x nRow)
+template<typename T>
+void averageChannelsNative(const casacore::Array<T> &in, const casacore::Array<casacore::Bool> &flags,
+                           casacore::uInt nAvg, casacore::Array<T> &out);
+
+/// @brief average flags in the measurement set order
+/// @details The averaged sample is flagged if all samples in the bin are flagged
+/// @param[in] in input flags (nPol x nChan*nAvg x nRow)
+/// @param[in] nAvg number of adjacent channels to average
+/// @param[out] out output flags (resized to nPol x nChan x nRow)
+void averageFlagsNative(const casacore::Array<casacore::Bool> &in, casacore::uInt nAvg,
+                        casacore::Array<casacore::Bool> &out);
+
+/// @brief propagate noise through the averaging
+/// @details The noise of the mean of n unflagged samples with noise sigma_i is
+/// sqrt(sum sigma_i^2) / n. If all samples in the bin are flagged, all samples are used
+/// (consistent with averageChannelsNative).
+/// @param[in] in input noise (nPol x nChan*nAvg x nRow)
+/// @param[in] flags input flags of the same shape as in
+/// @param[in] nAvg number of adjacent channels to average
+/// @param[out] out output noise (resized to nPol x nChan x nRow)
+void averageNoiseNative(const casacore::Array<casacore::Float> &in, const casacore::Array<casacore::Bool> &flags,
+                        casacore::uInt nAvg, casacore::Array<casacore::Float> &out);
+
+} // namespace accessors
+
+} // namespace askap
+
+#include <askap/dataaccess/ChannelAveraging.tcc>
+
+#endif // #ifndef ASKAP_ACCESSORS_CHANNEL_AVERAGING_H
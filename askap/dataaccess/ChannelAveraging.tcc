@@ -0,0 +1,134 @@
+/// @file ChannelAveraging.tcc
+///
+/// @brief helper methods to average adjacent spectral channels
+/// @details The data selector allows to average a number of adjacent spectral
+/// channels on read (see IDataSelector::chooseChannels). The methods defined in this
+/// file do such averaging for the arrays in the measurement set order, i.e.
+/// nPol x nChan x nRow, as returned by ArrayColumn::getColumnRange. Flagged samples
+/// are excluded from the average, the averaged sample is flagged only if all samples
+/// in the bin are flagged.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#ifndef ASKAP_ACCESSORS_CHANNEL_AVERAGING_TCC
+#define ASKAP_ACCESSORS_CHANNEL_AVERAGING_TCC
+
+// std includes
+#include <vector>
+
+// own includes
+#include <askap/askap/AskapError.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief average data in the measurement set order
+/// @details The input array is nPol x (nChan * nAvg) x nRow, the output array is
+/// resized to nPol x nChan x nRow. Each output element is the mean of unflagged input
+/// samples of the bin. If all samples are flagged, the mean of all samples is taken
+/// (the output is flagged in this case, see averageFlagsNative).
+/// @param[in] in input array (nPol x nChan*nAvg x nRow)
+/// @param[in] flags input flags of the same shape as in
+/// @param[in] nAvg number of adjacent channels to average
+/// @param[out] out output array (resized to nPol x nChan x nRow)
+template<typename T>
+void averageChannelsNative(const casacore::Array<T> &in, const casacore::Array<casacore::Bool> &flags,
+                           casacore::uInt nAvg, casacore::Array<T> &out)
+{
+  ASKAPCHECK(flags.shape().isEqual(in.shape()), "Shape of flags "<<flags.shape()<<
+             " doesn't match the shape of data "<<in.shape());
+  out.resize(averagedShape(in.shape(), nAvg));
+  if (out.nelements() == 0) {
+      return;
+  }
+  const size_t nPol = in.shape()[0];
+  // output elements of one row (all channels and polarisations) are contiguous, the same
+  // is true for the nAvg times larger block of input elements
+  const size_t nOutPerRow = out.nelements() / in.shape()[2];
+  const size_t nInPerRow = nOutPerRow * nAvg;
+  const size_t nRow = in.shape()[2];
+
+  bool deleteIn, deleteFlags, deleteOut;
+  const T *src = in.getStorage(deleteIn);
+  const casacore::Bool *flagSrc = flags.getStorage(deleteFlags);
+  T *dst = out.getStorage(deleteOut);
+
+  // the sum is accumulated straight in the output, only the weights of one row are
+  // kept aside (allocated once)
+  std::vector<casacore::Float> weight(nOutPerRow);
+  casacore::Float *wt = weight.data();
+  for (size_t row = 0; row < nRow; ++row) {
+       const T *rowData = src + row * nInPerRow;
+       const casacore::Bool *rowFlags = flagSrc + row * nInPerRow;
+       T *rowOut = dst + row * nOutPerRow;
+       for (size_t i = 0; i < nOutPerRow; ++i) {
+            rowOut[i] = T(0);
+            wt[i] = 0.f;
+       }
+       // channel-major order: the input is traversed contiguously, each run of nPol
+       // input samples is added to the run of nPol output samples of the same bin
+       for (size_t outIndex = 0, inIndex = 0; outIndex < nOutPerRow; outIndex += nPol) {
+            for (size_t chan = 0; chan < nAvg; ++chan, inIndex += nPol) {
+                 // flags are converted into weights to avoid branches in the inner loop
+                 for (size_t pol = 0; pol < nPol; ++pol) {
+                      const casacore::Float w = rowFlags[inIndex + pol] ? 0.f : 1.f;
+                      rowOut[outIndex + pol] += rowData[inIndex + pol] * w;
+                      wt[outIndex + pol] += w;
+                 }
+            }
+       }
+       bool allFlaggedBin = false;
+       for (size_t i = 0; i < nOutPerRow; ++i) {
+            allFlaggedBin |= (wt[i] == 0.f);
+            rowOut[i] /= (wt[i] > 0.f ? wt[i] : 1.f);
+       }
+       if (allFlaggedBin) {
+           // rare case: the mean of all samples is taken for fully flagged bins
+           for (size_t i = 0; i < nOutPerRow; ++i) {
+                if (wt[i] == 0.f) {
+                    const size_t pol = i % nPol;
+                    const T *binData = rowData + (i - pol) * nAvg + pol;
+                    T sum(0);
+                    for (size_t chan = 0; chan < nAvg; ++chan) {
+                         sum += binData[chan * nPol];
+                    }
+                    rowOut[i] = sum / casacore::Float(nAvg);
+                }
+           }
+       }
+  }
+
+  in.freeStorage(src, deleteIn);
+  flags.freeStorage(flagSrc, deleteFlags);
+  out.putStorage(dst, deleteOut);
+}
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_CHANNEL_AVERAGING_TCC
@@ -0,0 +1,98 @@
+/// @file CubeTranspose.h
+///
+/// @brief helper methods to reorder visibility-like cubes
+/// @details The measurement set stores visibilities, flags and noise
+/// figures as (pol, chan) arrays per row, i.e. polarisation is the fastest
+/// varying axis. The accessor interface returns cubes indexed as
+/// (row, chan, pol), i.e. row is the fastest varying axis. Converting
+/// between these two orders is a 3D transpose, which is memory bound and
+/// becomes expensive for large chunks if done element by element. The
+/// methods declared in this file do this conversion in cache-sized tiles
+/// working on the whole chunk at once.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#ifndef ASKAP_ACCESSORS_CUBE_TRANSPOSE_H
+#define ASKAP_ACCESSORS_CUBE_TRANSPOSE_H
+
+// casa includes
+#include <casacore/casa/Arrays/Array.h>
+#include <casacore/casa/Arrays/Cube.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief trivial element conversion used by default in the transpose
+/// @details The transpose methods accept an object function which is applied
+/// to every element while it is copied. This allows, e.g., to build the complex
+/// noise cube out of real-valued sigmas without a separate pass through the data.
+/// This is the default version which just does an assignment.
+/// @ingroup dataaccess_hlp
+template<typename InType, typename OutType>
+struct PlainCopy {
+  /// @brief conversion operator
+  /// @param[in] in input element
+  /// @return output element
+  inline OutType operator()(const InType &in) const { return OutType(in); }
+};
+
+/// @brief convert an array in the measurement set order into accessor order
+/// @details The input array is expected to have nPol x nChan x nRow
+/// elements with polarisation being the fastest varying axis (the layout
+/// returned by ArrayColumn::getColumnRange for a (pol,chan) column). The output
+/// cube should already have the shape nRow x nChan x nPol. Each element is
+/// passed through the given object function.
+/// @param[in] in input array in the measurement set order
+/// @param[in] out output cube in the accessor order (should already be of the right shape)
+/// @param[in] conv object function converting each element
+template<typename InType, typename OutType, typename Converter>
+void nativeToAccessorOrder(const casacore::Array<InType> &in, casacore::Cube<OutType> &out,
+                           const Converter &conv);
+
+/// @brief convert an array in the measurement set order into accessor order
+/// @details This version just copies elements (types of the input and output
+/// are the same).
+/// @param[in] in input array in the measurement set order (nPol x nChan x nRow)
+/// @param[in] out output cube in the accessor order (should already be of the right shape)
+template<typename T>
+void nativeToAccessorOrder(const casacore::Array<T> &in, casacore::Cube<T> &out);
+
+/// @brief convert a cube in the accessor order into the measurement set order
+/// @details This is the reverse operation to nativeToAccessorOrder. The output
+/// cube is resized to nPol x nChan x nRow if necessary.
+/// @param[in] in input cube in the accessor order (nRow x nChan x nPol)
+/// @param[in] out output cube in the measurement set order
+template<typename T>
+void accessorToNativeOrder(const casacore::Cube<T> &in, casacore::Cube<T> &out);
+
+} // namespace accessors
+
+} // namespace askap
+
+#include <askap/dataaccess/CubeTranspose.tcc>
+
+#endif // #ifndef ASKAP_ACCESSORS_CUBE_TRANSPOSE_H
@@ -0,0 +1,161 @@
+/// @file CubeTranspose.tcc
+///
+/// @brief helper methods to reorder visibility-like cubes
+/// @details The measurement set stores visibilities, flags and noise
+/// figures as (pol, chan) arrays per row, i.e. polarisation is the fastest
+/// varying axis. The accessor interface returns cubes indexed as
+/// (row, chan, pol), i.e. row is the fastest varying axis. Converting
+/// between these two orders is a 3D transpose, which is memory bound and
+/// becomes expensive for large chunks if done element by element. The
+/// methods defined in this file do this conversion in cache-sized tiles
+/// working on the whole chunk at once.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#ifndef ASKAP_ACCESSORS_CUBE_TRANSPOSE_TCC
+#define ASKAP_ACCESSORS_CUBE_TRANSPOSE_TCC
+
+// std includes
+#include <algorithm>
+
+// own includes
+#include <askap/askap/AskapError.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief size of the tile (in rows and channels) used in the transpose
+/// @details With 4 polarisations and complex data, 32x32 tile occupies 32 kB,
+/// which fits in L1 cache of most modern CPUs (both source and destination).
+/// @ingroup dataaccess_hlp
+struct CubeTransposeTile {
+  /// @brief number of rows and channels in one tile
+  enum { size = 32 };
+};
+
+/// @brief convert an array in the measurement set order into accessor order
+/// @details The input array is expected to have nPol x nChan x nRow
+/// elements with polarisation being the fastest varying axis (the layout
+/// returned by ArrayColumn::getColumnRange for a (pol,chan) column). The output
+/// cube should already have the shape nRow x nChan x nPol. Each element is
+/// passed through the given object function.
+/// @param[in] in input array in the measurement set order
+/// @param[in] out output cube in the accessor order (should already be of the right shape)
+/// @param[in] conv object function converting each element
+template<typename InType, typename OutType, typename Converter>
+void nativeToAccessorOrder(const casacore::Array<InType> &in, casacore::Cube<OutType> &out,
+                           const Converter &conv)
+{
+  const size_t nRow = out.nrow();
+  const size_t nChan = out.ncolumn();
+  const size_t nPol = out.nplane();
+  ASKAPCHECK(in.nelements() == nRow * nChan * nPol, "Unable to transpose array with "<<in.nelements()<<
+             " elements into the cube of "<<out.shape()<<" shape");
+  if (out.nelements() == 0) {
+      return;
+  }
+  bool deleteIn, deleteOut;
+  const InType *src = in.getStorage(deleteIn);
+  OutType *dst = out.getStorage(deleteOut);
+
+  // stride between two consecutive rows in the input array
+  const size_t srcRowStride = nPol * nChan;
+  const size_t tile = CubeTransposeTile::size;
+  for (size_t row0 = 0; row0 < nRow; row0 += tile) {
+       const size_t nRowsInTile = std::min(tile, nRow - row0);
+       for (size_t chan0 = 0; chan0 < nChan; chan0 += tile) {
+            const size_t chan1 = std::min(chan0 + tile, nChan);
+            for (size_t pol = 0; pol < nPol; ++pol) {
+                 for (size_t chan = chan0; chan < chan1; ++chan) {
+                      const InType *srcPtr = src + pol + nPol * chan + srcRowStride * row0;
+                      OutType *dstPtr = dst + row0 + nRow * (chan + nChan * pol);
+                      for (size_t i = 0; i < nRowsInTile; ++i, srcPtr += srcRowStride) {
+                           dstPtr[i] = conv(*srcPtr);
+                      }
+                 }
+            }
+       }
+  }
+  in.freeStorage(src, deleteIn);
+  out.putStorage(dst, deleteOut);
+}
+
+/// @brief convert an array in the measurement set order into accessor order
+/// @details This version just copies elements (types of the input and output
+/// are the same).
+/// @param[in] in input array in the measurement set order (nPol x nChan x nRow)
+/// @param[in] out output cube in the accessor order (should already be of the right shape)
+template<typename T>
+void nativeToAccessorOrder(const casacore::Array<T> &in, casacore::Cube<T> &out)
+{
+  nativeToAccessorOrder(in, out, PlainCopy<T,T>());
+}
+
+/// @brief convert a cube in the accessor order into the measurement set order
+/// @details This is the reverse operation to nativeToAccessorOrder. The output
+/// cube is resized to nPol x nChan x nRow if necessary.
+/// @param[in] in input cube in the accessor order (nRow x nChan x nPol)
+/// @param[in] out output cube in the measurement set order
+template<typename T>
+void accessorToNativeOrder(const casacore::Cube<T> &in, casacore::Cube<T> &out)
+{
+  const size_t nRow = in.nrow();
+  const size_t nChan = in.ncolumn();
+  const size_t nPol = in.nplane();
+  out.resize(nPol, nChan, nRow);
+  if (in.nelements() == 0) {
+      return;
+  }
+  bool deleteIn, deleteOut;
+  const T *src = in.getStorage(deleteIn);
+  T *dst = out.getStorage(deleteOut);
+
+  const size_t tile = CubeTransposeTile::size;
+  for (size_t row0 = 0; row0 < nRow; row0 += tile) {
+       const size_t row1 = std::min(row0 + tile, nRow);
+       for (size_t chan0 = 0; chan0 < nChan; chan0 += tile) {
+            const size_t chan1 = std::min(chan0 + tile, nChan);
+            for (size_t row = row0; row < row1; ++row) {
+                 for (size_t chan = chan0; chan < chan1; ++chan) {
+                      T *dstPtr = dst + nPol * (chan + nChan * row);
+                      const T *srcPtr = src + row + nRow * chan;
+                      for (size_t pol = 0; pol < nPol; ++pol) {
+                           dstPtr[pol] = srcPtr[nRow * nChan * pol];
+                      }
+                 }
+            }
+       }
+  }
+  in.freeStorage(src, deleteIn);
+  out.putStorage(dst, deleteOut);
+}
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_CUBE_TRANSPOSE_TCC
@@ -218,6 +218,14 @@ const casacore::Cube<casacore::Bool>& DataAccessorAdapter::flag() const
   return getROAccessor().flag();
 }
 
+/// @brief flags in the measurement set order
+/// @return a reference to nPol x nChannel x nRow cube with flag
+///         information. If True, the corresponding element is flagged.
+const casacore::Cube<casacore::Bool>& DataAccessorAdapter::flagNative() const
+{
+  return getROAccessor().flagNative();
+}
+
 
 /// @brief UVW
 /// @return a reference to vector containing uvw-coordinates
@@ -316,6 +324,14 @@ const casacore::Cube<casacore::Complex>& DataAccessorAdapter::visibility() const
 {
   return getROAccessor().visibility();
 }
+
+/// @brief visibilities in the measurement set order
+/// @return a reference to nPol x nChannel x nRow cube, containing
+/// all visibility data
+const casacore::Cube<casacore::Complex>& DataAccessorAdapter::visibilityNative() const
+{
+  return getROAccessor().visibilityNative();
+}
 	
 /// @brief Read-write access to visibilities 
 /// @details (a cube is nRow x nChannel x nPol;
@@ -166,6 +166,11 @@ public:
   ///         information. If True, the corresponding element is flagged.
   virtual const casacore::Cube<casacore::Bool>& flag() const;
 
+  /// @brief flags in the measurement set order
+  /// @return a reference to nPol x nChannel x nRow cube with flag
+  ///         information. If True, the corresponding element is flagged.
+  virtual const casacore::Cube<casacore::Bool>& flagNative() const;
+
   /// UVW
   /// @return a reference to vector containing uvw-coordinates
   /// packed into a 3-D rigid vector
@@ -234,6 +239,11 @@ public:
   /// all visibility data
   ///
   virtual const casacore::Cube<casacore::Complex>& visibility() const;
+
+  /// @brief visibilities in the measurement set order
+  /// @return a reference to nPol x nChannel x nRow cube, containing
+  /// all visibility data
+  virtual const casacore::Cube<casacore::Complex>& visibilityNative() const;
 	
   /// @brief Read-write access to visibilities 
   /// @details (a cube is nRow x nChannel x nPol;
@@ -41,6 +41,7 @@
 // own includes
 #include <askap/dataaccess/DataAccessorStub.h>
 #include <askap/dataaccess/DataAccessError.h>
+#include <askap/dataaccess/CubeTranspose.h>
 
 using std::vector;
 
@@ -303,6 +304,26 @@ namespace askap
                   return itsFlag;
                 }
 
+                /// @brief visibilities in the measurement set order
+                /// @details The cube is formed from the visibility() buffer on each call
+                /// @return a reference to nPol x nChannel x nRow cube, containing
+                /// all visibility data
+                const casacore::Cube<casacore::Complex>& DataAccessorStub::visibilityNative() const
+                {
+                  accessorToNativeOrder(itsVisibility, itsVisibilityNative);
+                  return itsVisibilityNative;
+                }
+
+                /// @brief flags in the measurement set order
+                /// @details The cube is formed from the flag() buffer on each call
+                /// @return a reference to nPol x nChannel x nRow cube with flag
+                ///         information. If True, the corresponding element is flagged.
+                const casacore::Cube<casacore::Bool>& DataAccessorStub::flagNative() const
+                {
+                  accessorToNativeOrder(flag(), itsFlagNative);
+                  return itsFlagNative;
+                }
+
                 /// UVW
                 /// @return a reference to vector containing uvw-coordinates
                 /// packed into a 3-D rigid vector
@@ -139,6 +139,18 @@ struct DataAccessorStub : virtual public IFlagDataAccessor
      ///         information. If True, the corresponding element is flagged.
      virtual casacore::Cube<casacore::Bool>& rwFlag();
 
+     /// @brief visibilities in the measurement set order
+     /// @details The cube is formed from the visibility() buffer on each call
+     /// @return a reference to nPol x nChannel x nRow cube, containing
+     /// all visibility data
+     virtual const casacore::Cube<casacore::Complex>& visibilityNative() const;
+
+     /// @brief flags in the measurement set order
+     /// @details The cube is formed from the flag() buffer on each call
+     /// @return a reference to nPol x nChannel x nRow cube with flag
+     ///         information. If True, the corresponding element is flagged.
+     virtual const casacore::Cube<casacore::Bool>& flagNative() const;
+
      
      /// Noise level required for a proper weighting
      /// @return a reference to nRow x nChannel x nPol cube with
@@ -228,6 +240,10 @@ struct DataAccessorStub : virtual public IFlagDataAccessor
      mutable casacore::Cube<casacore::Complex> itsVisibility;
      /// cached flag
      mutable casacore::Cube<casacore::Bool> itsFlag;
+     /// visibility in the measurement set order
+     mutable casacore::Cube<casacore::Complex> itsVisibilityNative;
+     /// flag in the measurement set order
+     mutable casacore::Cube<casacore::Bool> itsFlagNative;
      /// cached uvw
      mutable casacore::Vector<casacore::RigidVector<casacore::Double, 3> > itsUVW;
      /// cached noise
@@ -60,6 +60,62 @@ casacore::MVDirection
                              itsTargetFrame)(in).getValue();    
 }
 
+/// @brief convert a number of directions given in the same frame
+/// @details The conversion machinery is set up once and used for all directions,
+/// the frame set with setMeasFrame applies to all of them. If the input and target
+/// frames are the same and the conversion doesn't depend on the frame (e.g. J2000
+/// to J2000), the input is copied without conversion.
+/// @param[in] inRef reference frame of the input directions
+/// @param[in] in input directions
+/// @param[out] out converted directions (resized to match the input)
+void DirectionConverter::convert(const casacore::MDirection::Ref &inRef,
+                                 const casacore::Vector<casacore::MVDirection> &in,
+                                 casacore::Vector<casacore::MVDirection> &out) const
+{
+  out.resize(in.nelements());
+  if ((inRef.getType() == itsTargetFrame.getType()) && !isPositionDependent(inRef)) {
+      // no conversion is required, e.g. J2000 to J2000
+      out = in;
+      return;
+  }
+  MDirection::Convert converter(inRef, itsTargetFrame);
+  for (casacore::uInt elem = 0; elem < in.nelements(); ++elem) {
+       out[elem] = converter(in[elem]).getValue();
+  }
+}
+
+/// @brief check whether the conversion depends on the position
+/// @details The conversion to or from a topocentric frame (e.g. AZEL or HADEC)
+/// depends on the position given in the frame, so it is different for each antenna.
+/// Conversions between celestial frames can be done once for all antennas.
+/// @param[in] inRef reference frame of the input directions
+/// @return true, if the result depends on the position set with setMeasFrame
+bool DirectionConverter::isPositionDependent(const casacore::MDirection::Ref &inRef) const
+{
+  return isTopocentric(MDirection::castType(inRef.getType())) ||
+         isTopocentric(MDirection::castType(itsTargetFrame.getType()));
+}
+
+/// @brief check whether the frame type is topocentric
+/// @param[in] type frame type to test
+/// @return true, if the direction in this frame depends on the position of the observer
+bool DirectionConverter::isTopocentric(casacore::MDirection::Types type)
+{
+  switch (type) {
+     case MDirection::HADEC:
+     case MDirection::AZEL:
+     case MDirection::AZELSW:
+     case MDirection::AZELGEO:
+     case MDirection::AZELSWGEO:
+     case MDirection::ITRF:
+     case MDirection::TOPO:
+          return true;
+     default:
+          // solar system objects are treated as topocentric to be on the safe side
+          return type >= MDirection::N_Types;
+  }
+}
+
 /// set a frame (i.e. time and/or position), where the
 /// conversion is performed
 /// @param frame  MeasFrame object (can be constructed from
@@ -62,12 +62,37 @@ struct DirectionConverter : public IDirectionConverter {
     /// @param in an epoch to convert. 
     virtual casacore::MVDirection operator()(const casacore::MDirection &in) const;
 
+    /// @brief convert a number of directions given in the same frame
+    /// @details The conversion machinery is set up once and used for all directions,
+    /// the frame set with setMeasFrame applies to all of them. If the input and target
+    /// frames are the same and the conversion doesn't depend on the frame (e.g. J2000
+    /// to J2000), the input is copied without conversion.
+    /// @param[in] inRef reference frame of the input directions
+    /// @param[in] in input directions
+    /// @param[out] out converted directions (resized to match the input)
+    virtual void convert(const casacore::MDirection::Ref &inRef,
+                         const casacore::Vector<casacore::MVDirection> &in,
+                         casacore::Vector<casacore::MVDirection> &out) const;
+
+    /// @brief check whether the conversion depends on the position
+    /// @details The conversion to or from a topocentric frame (e.g. AZEL or HADEC)
+    /// depends on the position given in the frame, so it is different for each antenna.
+    /// Conversions between celestial frames can be done once for all antennas.
+    /// @param[in] inRef reference frame of the input directions
+    /// @return true, if the result depends on the position set with setMeasFrame
+    virtual bool isPositionDependent(const casacore::MDirection::Ref &inRef) const;
+
     /// set a frame (i.e. time and/or position), where the
     /// conversion is performed
     /// @param frame  MeasFrame object (can be constructed from
     ///               MPosition or MEpoch on-the-fly)
     virtual void setMeasFrame(const casacore::MeasFrame &frame);
 
+    /// @brief check whether the frame type is topocentric
+    /// @param[in] type frame type to test
+    /// @return true, if the direction in this frame depends on the position of the observer
+    static bool isTopocentric(casacore::MDirection::Types type);
+
 private:
     casacore::MDirection::Ref itsTargetFrame;    
 };
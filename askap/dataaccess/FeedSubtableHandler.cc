@@ -47,9 +47,12 @@
 #include <askap/askap/AskapError.h>
 #include <askap/dataaccess/DataAccessError.h>
 
+// std includes
+#include <algorithm>
+#include <set>
+
 // casa includes
 #include <casacore/tables/Tables/TableRecord.h>
-#include <casacore/tables/TaQL/ExprNode.h>
 #include <casacore/tables/Tables/ScalarColumn.h>
 #include <casacore/tables/Tables/ArrayColumn.h>
 #include <casacore/casa/Arrays/Array.h>
@@ -72,7 +75,7 @@ FeedSubtableHandler::FeedSubtableHandler(const casacore::Table &ms) :
           TableHolder(ms.keywordSet().asTable("FEED")),
           itsCachedSpWindow(-2),
           itsCachedStartTime(0.), itsCachedStopTime(0.),
-          itsAllCachedOffsetsZero(false), itsIntervalFactor(1.)
+          itsCachedStopInclusive(true), itsAllCachedOffsetsZero(false), itsIntervalFactor(1.)
 { 
   const casacore::Array<casacore::String> &intervalUnits=table().tableDesc().
           columnDesc("INTERVAL").keywordSet().asArrayString("QuantumUnits");
@@ -86,6 +89,121 @@ FeedSubtableHandler::FeedSubtableHandler(const casacore::Table &ms) :
             getTime(casacore::Unit(intervalUnits(casacore::IPosition(1,0)))).getValue();
   ASKAPDEBUGASSERT(itsIntervalFactor != 0);
   itsIntervalFactor = 1./itsIntervalFactor;
+  buildIntervalIndex();
+}
+
+/// @brief read the whole FEED subtable and build the interval index
+/// @details This method fills itsIntervals. It is called from the constructor.
+void FeedSubtableHandler::buildIntervalIndex()
+{
+  itsIntervals.clear();
+  const casacore::rownr_t nRow = table().nrow();
+  if (nRow == 0) {
+      return;
+  }
+  const casacore::Vector<casacore::Double> times =
+        casacore::ROScalarColumn<casacore::Double>(table(),"TIME").getColumn();
+  const casacore::Vector<casacore::Double> intervals =
+        casacore::ROScalarColumn<casacore::Double>(table(),"INTERVAL").getColumn();
+  const casacore::Vector<casacore::Int> spWindows =
+        casacore::ROScalarColumn<casacore::Int>(table(),"SPECTRAL_WINDOW_ID").getColumn();
+  const casacore::Vector<casacore::Int> antIDs =
+        casacore::ROScalarColumn<casacore::Int>(table(),"ANTENNA_ID").getColumn();
+  const casacore::Vector<casacore::Int> feedIDs =
+        casacore::ROScalarColumn<casacore::Int>(table(),"FEED_ID").getColumn();
+  casacore::ROArrayColumn<casacore::Double>  rcptrOffsets(table(),"BEAM_OFFSET");
+  casacore::ROArrayColumn<casacore::Double>  rcptrPAs(table(),"RECEPTOR_ANGLE");
+
+  // offsets, angles and validity ranges are computed once for each row
+  std::vector<casacore::RigidVector<casacore::Double, 2> > offsets(nRow);
+  std::vector<casacore::Double> angles(nRow);
+  std::vector<casacore::Double> startTimes(nRow);
+  std::vector<casacore::Double> stopTimes(nRow);
+  std::set<casacore::Int> keys;
+  keys.insert(-1);
+  for (casacore::rownr_t row=0; row<nRow; ++row) {
+       if ((antIDs[row] < 0) || (feedIDs[row] < 0)) {
+           ASKAPTHROW(DataAccessError,"Negative indices in FEED_ID and ANTENNA_ID "
+              "columns of the FEED subtable are not allowed");
+       }
+       computeBeamOffset(rcptrOffsets(row),offsets[row]);
+       angles[row] = computePositionAngle(rcptrPAs(row));
+       // (temporary) work around for zero interval (happens for ATCA data)
+       // probably an appropriate filler has to be fixed as it doesn't
+       // seem to conform with the measurement set standard
+       const casacore::Double halfInterval = intervals[row] == 0. ? 1e30 :
+                                             intervals[row] * itsIntervalFactor / 2.;
+       startTimes[row] = times[row] - halfInterval;
+       stopTimes[row] = times[row] + halfInterval;
+       keys.insert(spWindows[row]);
+  }
+
+  for (std::set<casacore::Int>::const_iterator ci = keys.begin(); ci != keys.end(); ++ci) {
+       const casacore::Int key = *ci;
+       // boundaries of all rows matching this spectral window split the time axis
+       // into elementary intervals, the set of matching rows is fixed within each of them
+       std::vector<casacore::rownr_t> rows;
+       std::vector<casacore::Double> boundaries;
+       for (casacore::rownr_t row=0; row<nRow; ++row) {
+            if ((spWindows[row] == key) || (spWindows[row] == -1)) {
+                rows.push_back(row);
+                boundaries.push_back(startTimes[row]);
+                boundaries.push_back(stopTimes[row]);
+            }
+       }
+       std::sort(boundaries.begin(), boundaries.end());
+       boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+       std::vector<std::vector<casacore::rownr_t> > members(boundaries.size() > 1 ? boundaries.size() - 1 : 0);
+       for (std::vector<casacore::rownr_t>::const_iterator rowIt = rows.begin(); rowIt != rows.end(); ++rowIt) {
+            const size_t first = std::lower_bound(boundaries.begin(), boundaries.end(),
+                                 startTimes[*rowIt]) - boundaries.begin();
+            const size_t last = std::lower_bound(boundaries.begin(), boundaries.end(),
+                                 stopTimes[*rowIt]) - boundaries.begin();
+            for (size_t interval = first; interval < last; ++interval) {
+                 members[interval].push_back(*rowIt);
+            }
+       }
+
+       std::vector<boost::shared_ptr<FeedInterval const> > &result = itsIntervals[key];
+       for (size_t interval = 0; interval < members.size(); ++interval) {
+            const std::vector<casacore::rownr_t> &cRows = members[interval];
+            if (cRows.empty()) {
+                // a gap in the FEED table, it will be reported if accessed
+                continue;
+            }
+            boost::shared_ptr<FeedInterval> fi(new FeedInterval);
+            fi->itsStartTime = boundaries[interval];
+            fi->itsStopTime = boundaries[interval + 1];
+            // the stop time belongs to the next interval, if there is one starting at it
+            fi->itsStopInclusive = (interval + 1 == members.size()) || members[interval + 1].empty();
+            fi->itsAllOffsetsZero = true;
+            fi->itsBeamOffsets.resize(cRows.size());
+            fi->itsPositionAngles.resize(cRows.size());
+            fi->itsAntennaIDs.resize(cRows.size());
+            fi->itsFeedIDs.resize(cRows.size());
+            casacore::Int nAnt = 0, nFeed = 0;
+            for (size_t elem = 0; elem < cRows.size(); ++elem) {
+                 const casacore::rownr_t row = cRows[elem];
+                 fi->itsBeamOffsets[elem] = offsets[row];
+                 if ((std::abs(offsets[row](0)) > 1e-15) || (std::abs(offsets[row](1)) > 1e-15)) {
+                     fi->itsAllOffsetsZero = false;
+                 }
+                 fi->itsPositionAngles[elem] = angles[row];
+                 fi->itsAntennaIDs[elem] = antIDs[row];
+                 fi->itsFeedIDs[elem] = feedIDs[row];
+                 nAnt = std::max(nAnt, antIDs[row] + 1);
+                 nFeed = std::max(nFeed, feedIDs[row] + 1);
+            }
+            ASKAPDEBUGASSERT(nAnt*nFeed == casacore::Int(cRows.size()));
+            fi->itsIndices.resize(nAnt,nFeed);
+            // negative value is a flag, which means an uninitialized index
+            fi->itsIndices.set(-2);
+            for (size_t elem = 0; elem < cRows.size(); ++elem) {
+                 fi->itsIndices(fi->itsAntennaIDs[elem],fi->itsFeedIDs[elem]) = casacore::Int(elem);
+            }
+            result.push_back(fi);
+       }
+  }
 }
  
 /// obtain the offsets of each beam with respect to dish pointing
@@ -183,7 +301,10 @@ bool FeedSubtableHandler::newBeamDetails(const casacore::MEpoch &time,
                                     casacore::uInt spWinID) const
 {
   const casacore::Double dTime=tableTime(time);
-  if (dTime>=itsCachedStartTime && dTime<=itsCachedStopTime &&
+  // the stop time is excluded if the next interval starts at it, so the cached
+  // interval is the one fillCache would find for the same time
+  if (dTime>=itsCachedStartTime && (dTime<itsCachedStopTime ||
+      (itsCachedStopInclusive && dTime==itsCachedStopTime)) &&
       (casacore::Int(spWinID)==itsCachedSpWindow || itsCachedSpWindow==-1)) {
       // cache is valid
       return false;
@@ -192,8 +313,9 @@ bool FeedSubtableHandler::newBeamDetails(const casacore::MEpoch &time,
 }                                    
 
 
-/// read the data to fill the cache, a call to isCacheValid allows to check
-/// whether reading is necessary
+/// fill the cache from the interval index (a binary search over the intervals
+/// precomputed for the spectral window), a call to newBeamDetails allows to check
+/// whether it is necessary
 /// @param[in] time a full epoch of interest (feed table can be time-
 /// dependent
 /// @param[in] spWinID spectral window ID of interest (feed table can be
@@ -201,91 +323,50 @@ bool FeedSubtableHandler::newBeamDetails(const casacore::MEpoch &time,
 void FeedSubtableHandler::fillCache(const casacore::MEpoch &time, 
                        casacore::uInt spWinID) const
 {
-  // if we really need to optimize the performance, we can cache dTime
   const casacore::Double dTime=tableTime(time);
-  const casacore::TableExprNode halfInterval = table().col("INTERVAL")*itsIntervalFactor/2.;
-
-  // (temporary) work around for zero interval (happens for ATCA data)
-  // probably an appropriate filler has to be fixed as it doesn't
-  // seem to conform with the measurement set standard
-
-  const casacore::TableExprNode expression = ((table().col("SPECTRAL_WINDOW_ID") ==
-                static_cast<casacore::Int>(spWinID)) || 
-                    (table().col("SPECTRAL_WINDOW_ID") == -1)) &&
-               (((table().col("TIME") - halfInterval <= dTime) &&
-                (table().col("TIME") + halfInterval >= dTime)) ||
-                (halfInterval == 0.));
-  casacore::Table selection=table()(expression);
-  if (selection.nrow()==0u) {
+  // rows valid for any spectral window are included in all entries of the index,
+  // key -1 corresponds to the spectral windows without specific rows
+  std::map<casacore::Int, std::vector<boost::shared_ptr<FeedInterval const> > >::const_iterator ci =
+        itsIntervals.find(static_cast<casacore::Int>(spWinID));
+  if (ci == itsIntervals.end()) {
+      ci = itsIntervals.find(-1);
+  }
+  boost::shared_ptr<FeedInterval const> found;
+  if (ci != itsIntervals.end()) {
+      const std::vector<boost::shared_ptr<FeedInterval const> > &intervals = ci->second;
+      // the last interval starting at or before dTime, i.e. the later one if dTime
+      // is the boundary between two adjacent intervals
+      size_t first = 0, last = intervals.size();
+      while (first < last) {
+             const size_t middle = (first + last) / 2;
+             if (intervals[middle]->itsStartTime <= dTime) {
+                 first = middle + 1;
+             } else {
+                 last = middle;
+             }
+      }
+      if ((first > 0) && (dTime <= intervals[first - 1]->itsStopTime)) {
+          found = intervals[first - 1];
+      }
+  }
+  if (!found) {
       ASKAPTHROW(DataAccessError,
                  "FEED subtable is empty or feed data missing for "
                   <<time<<" and spectral window: "<<spWinID);
   }
-  itsBeamOffsets.resize(selection.nrow());
-  itsPositionAngles.resize(selection.nrow());
-  casacore::ROScalarColumn<casacore::Int> antIDs(selection,"ANTENNA_ID");
-  antIDs.getColumn(itsAntennaIDs,casacore::True);
-  casacore::Int minAntID=-1,maxAntID=-1;
-  casacore::minMax(minAntID,maxAntID,itsAntennaIDs);
-  casacore::ROScalarColumn<casacore::Int> feedIDs(selection,"FEED_ID");
-  feedIDs.getColumn(itsFeedIDs,casacore::True);
-  casacore::Int minFeedID=-1,maxFeedID=-1;
-  casacore::minMax(minFeedID,maxFeedID,itsFeedIDs);
-  if (minAntID<0 || maxAntID<0 || minFeedID<0 || maxFeedID<0) {
-      ASKAPTHROW(DataAccessError,"Negative indices in FEED_ID and ANTENNA_ID "
-         "columns of the FEED subtable are not allowed");
-  }
-  ++maxAntID; ++maxFeedID; // now we have numbers of feeds and antennae
-  ASKAPDEBUGASSERT(maxAntID*maxFeedID == casacore::Int(selection.nrow()));
-  itsIndices.resize(maxAntID,maxFeedID);
-  itsIndices.set(-2); // negative value is a flag, which means an 
-                      // uninitialized index
-  casacore::ROArrayColumn<casacore::Double>  rcptrOffsets(selection,"BEAM_OFFSET");
-  casacore::ROArrayColumn<casacore::Double>  rcptrPAs(selection,"RECEPTOR_ANGLE");
-  // update start and stop times as well as the spectral window ID 
-  // used in the cache management within the same loop
-  casacore::ROScalarColumn<casacore::Double> timeCol(selection,"TIME");
-  casacore::ROScalarColumn<casacore::Double> intervalCol(selection,"INTERVAL");
-  casacore::ROScalarColumn<casacore::Int> spWinCol(selection,"SPECTRAL_WINDOW_ID");
-  itsCachedSpWindow = spWinCol(0);
-  // we will set this flag to false later, if a non-zero offset is found
-  itsAllCachedOffsetsZero = true; 
-  for (casacore::rownr_t row=0; row<selection.nrow(); ++row) {
-       casacore::RigidVector<casacore::Double, 2> &cOffset = itsBeamOffsets[row];
-       computeBeamOffset(rcptrOffsets(row),cOffset);
-       if ((std::abs(cOffset(0)) > 1e-15) || (std::abs(cOffset(1)) > 1e-15)) {
-           itsAllCachedOffsetsZero = false;
-           //std::cerr<<"non zero offset "<<cOffset(0)<<" "<<cOffset(1)<<std::endl; 
-       }
-       itsPositionAngles[row]=computePositionAngle(rcptrPAs(row));
-       itsIndices(antIDs(row),feedIDs(row))=row;
-       
-       casacore::Double cStartTime = timeCol(row) -
-                          intervalCol(row) * itsIntervalFactor/2.;
-       casacore::Double cStopTime = timeCol(row) +
-                          intervalCol(row) * itsIntervalFactor/2.;
-       // (temporary) work around for zero interval (happens for ATCA data)
-       // probably an appropriate filler has to be fixed as it doesn't
-       // seem to conform with the measurement set standard
-       if (intervalCol(row) == 0.) {
-           // not a very clean way, but
-	       // we need large offsets here
-           cStartTime = timeCol(row) - 1e30;
-	       cStopTime = timeCol(row) + 1e30; 
-       }
-       if (!row || itsCachedStartTime<cStartTime) {
-           itsCachedStartTime=cStartTime;	   
-       }
-       if (!row || itsCachedStopTime>cStopTime) {
-           itsCachedStopTime=cStopTime;
-       }
-       if (spWinCol(row) != -1) {
-           ASKAPDEBUGASSERT((itsCachedSpWindow == -1) || 
-                             (spWinCol(row) == itsCachedSpWindow));
-           itsCachedSpWindow = spWinCol(row);
-       }
-  }
-            
+  // arrays reference the precomputed interval, no copy is made
+  itsBeamOffsets.reference(found->itsBeamOffsets);
+  itsPositionAngles.reference(found->itsPositionAngles);
+  itsAntennaIDs.reference(found->itsAntennaIDs);
+  itsFeedIDs.reference(found->itsFeedIDs);
+  itsIndices.reference(found->itsIndices);
+  itsAllCachedOffsetsZero = found->itsAllOffsetsZero;
+  itsCachedStartTime = found->itsStartTime;
+  itsCachedStopTime = found->itsStopTime;
+  itsCachedStopInclusive = found->itsStopInclusive;
+  // the cache can be reused for other spectral windows only if no row is
+  // specific to a spectral window, otherwise their rows could differ
+  itsCachedSpWindow = itsIntervals.size() == 1 ? -1 : static_cast<casacore::Int>(spWinID);
 }
                        
 
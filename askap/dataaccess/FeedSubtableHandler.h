@@ -2,13 +2,10 @@
 /// @brief A class to access FEED subtable
 /// @details This file contains a class implementing IFeedSubtableHandler interface to
 /// the content of the FEED subtable (which provides offsets of each physical
-/// feed from the dish pointing centre and its position anlge). Although this 
-/// implementation caches the values for the last requested time-range and 
-/// the spectral window, it reads the data on-demand. This is the difference
-/// from some other subtables which are implemented by Mem... classes reading
-/// all the required data in the constructor. If the table is trivial 
-/// (no time- and spectral window dependence), it will be fully cached on the
-/// first request.
+/// feed from the dish pointing centre and its position anlge). The whole table
+/// is read in the constructor and split into non-overlapping time intervals for
+/// each spectral window, so the values for any time and spectral window are
+/// found with a binary search without querying the table.
 /// @note The measurement set format specifies offsets for each receptor,
 /// rather than feed (i.e. for each polarization separately). We handle possible
 /// squints together with other image plane effects and therefore need just
@@ -42,6 +39,13 @@
 #ifndef ASKAP_ACCESSORS_FEED_SUBTABLE_HANDLER_H
 #define ASKAP_ACCESSORS_FEED_SUBTABLE_HANDLER_H
 
+// std includes
+#include <map>
+#include <vector>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+
 // casa includes
 #include <casacore/tables/Tables/Table.h>
 #include <casacore/casa/Arrays/Vector.h>
@@ -62,13 +66,13 @@ namespace accessors {
 /// @brief A class to access FEED subtable
 /// @details This file contains a class implementing IFeedSubtableHandler interface to
 /// the content of the FEED subtable (which provides offsets of each physical
-/// feed from the dish pointing centre and its position anlge). Although this 
-/// implementation caches the values for the last requested time-range and 
-/// the spectral window, it reads the data on-demand. This is the difference
-/// from some other subtables which are implemented by Mem... classes reading
-/// all the required data in the constructor. If the table is trivial 
-/// (no time- and spectral window dependence), it will be fully cached on the
-/// first request.
+/// feed from the dish pointing centre and its position anlge). The table is
+/// read once in the constructor. For each spectral window, the time axis is split
+/// into intervals where the set of matching rows doesn't change and beam offsets,
+/// position angles and the index matrix are precomputed for each interval. The values
+/// for the last requested interval are exposed via the cache (which just references
+/// the precomputed arrays), a cache miss is resolved with a binary search over
+/// the intervals.
 /// @note The measurement set format specifies offsets for each receptor,
 /// rather than feed (i.e. for each polarization separately). We handle possible
 /// squints together with other image plane effects and therefore need just
@@ -199,8 +203,9 @@ struct FeedSubtableHandler : virtual public IFeedSubtableHandler,
   virtual bool allBeamOffsetsZero(const casacore::MEpoch &time, casacore::uInt spWinID) const;
   
 protected:
-  /// read the data to fill the cache, a call to isCacheValid allows to check
-  /// whether reading is necessary
+  /// fill the cache from the interval index (a binary search over the intervals
+  /// precomputed for the spectral window), a call to newBeamDetails allows to check
+  /// whether it is necessary
   /// @param[in] time a full epoch of interest (feed table can be time-
   /// dependent
   /// @param[in] spWinID spectral window ID of interest (feed table can be
@@ -239,8 +244,43 @@ protected:
   /// @return the angle corresponding to the beam (curretly that of the first 
   /// receptor) 
   static casacore::Double computePositionAngle(const casacore::Array<casacore::Double>
-                               &rcptAngles);             
+                               &rcptAngles);
+
+  /// @brief read the whole FEED subtable and build the interval index
+  /// @details This method fills itsIntervals. It is called from the constructor.
+  void buildIntervalIndex();
 private:
+
+  /// @brief precomputed content of the FEED subtable for one time interval
+  /// @details All rows matching the spectral window and any time within
+  /// the interval are included.
+  struct FeedInterval {
+    /// start time of the interval (in the native frame/units of the FEED table)
+    casacore::Double itsStartTime;
+    /// stop time of the interval (in the native frame/units of the FEED table)
+    casacore::Double itsStopTime;
+    /// true if the stop time belongs to this interval (i.e. no adjacent interval starts at it)
+    bool itsStopInclusive;
+    /// beam offsets for each row
+    casacore::Vector<casacore::RigidVector<casacore::Double, 2> > itsBeamOffsets;
+    /// position angles for each row
+    casacore::Vector<casacore::Double> itsPositionAngles;
+    /// true if all beam offsets are zero
+    bool itsAllOffsetsZero;
+    /// look-up table to convert (ant,feed) into an index
+    casacore::Matrix<casacore::Int> itsIndices;
+    /// antenna IDs for each row
+    casacore::Vector<casacore::Int> itsAntennaIDs;
+    /// feed IDs for each row
+    casacore::Vector<casacore::Int> itsFeedIDs;
+  };
+
+  /// @brief interval index
+  /// @details The key is the spectral window ID. Rows which are valid for any spectral
+  /// window (SPECTRAL_WINDOW_ID = -1) are included for all keys, key -1 is used for the
+  /// spectral windows which have no specific rows. The intervals are sorted by time and
+  /// don't overlap.
+  std::map<casacore::Int, std::vector<boost::shared_ptr<FeedInterval const> > > itsIntervals;
  
   /// the spectral window for which the cache is valid. -1 means for any
   /// spectral window (if the table is spectral window-independent). 
@@ -254,6 +294,10 @@ private:
   /// stop time of the time range for which the cache is valid. 
   /// See itsCachedStartTimes for more details.
   mutable casacore::Double itsCachedStopTime;
+
+  /// @brief true if the cache is valid at itsCachedStopTime
+  /// @details At the boundary between two adjacent intervals the later one is used.
+  mutable bool itsCachedStopInclusive;
   
   /// a cache of beam offsets
   mutable casacore::Vector<casacore::RigidVector<casacore::Double, 2> > itsBeamOffsets;
@@ -38,6 +38,7 @@
 // casa includes
 #include <casacore/measures/Measures/MPosition.h>
 #include <casacore/casa/BasicSL/String.h>
+#include <casacore/casa/Arrays/Vector.h>
 
 // own includes
 #include <askap/dataaccess/IHolder.h>
@@ -56,6 +57,23 @@ namespace accessors {
 /// @ingroup dataaccess_tab
 struct IAntennaSubtableHandler : virtual public IHolder {
 
+  /// @brief mount types understood by the code
+  /// @details The MOUNT column of the ANTENNA subtable is a string. It is
+  /// parsed once, when the subtable is read, so the code computing parallactic
+  /// angles doesn't need to compare strings for every antenna and time step.
+  enum MountType {
+     /// equatorial mount, no parallactic angle rotation
+     EQUATORIAL = 0,
+     /// alt-az mount, feeds rotate with the parallactic angle
+     ALT_AZ,
+     /// X-Y mount, treated as equatorial at the moment
+     X_Y,
+     /// fixed antenna (e.g. LOFAR), no parallactic angle rotation
+     FIXED,
+     /// mount type which is not supported
+     UNKNOWN
+  };
+
   /// @brief obtain the position of the given antenna
   /// @details
   /// @param[in] antID antenna ID to return the position for
@@ -67,6 +85,24 @@ struct IAntennaSubtableHandler : virtual public IHolder {
   /// @param[in] antID antenna ID to return the position for
   /// @return a string describing the mount type
   virtual const casacore::String& getMount(casacore::uInt antID) const = 0;
+
+  /// @brief obtain the parsed mount type for the given antenna
+  /// @details
+  /// @param[in] antID antenna ID to return the mount type for
+  /// @return mount type (UNKNOWN if the mount string is not recognised)
+  virtual MountType getMountType(casacore::uInt antID) const = 0;
+
+  /// @brief obtain latitudes of all antennas
+  /// @details Latitudes are geocentric (i.e. derived from the ITRF position
+  /// vector), which is what casacore uses for the AZEL and HADEC frames.
+  /// @return vector with latitudes in radians, one element per antenna
+  virtual const casacore::Vector<casacore::Double>& getLatitudes() const = 0;
+
+  /// @brief obtain longitudes of all antennas
+  /// @details Longitudes are derived from the ITRF position vector and are
+  /// positive to the east.
+  /// @return vector with longitudes in radians, one element per antenna
+  virtual const casacore::Vector<casacore::Double>& getLongitudes() const = 0;
   
   /// @brief check whether all antennas are equatorialy mounted
   /// @details
@@ -139,6 +139,25 @@ public:
 	///         information. If True, the corresponding element is flagged.
 	virtual const casacore::Cube<casacore::Bool>& flag() const = 0;
 
+	/// @brief visibilities in the measurement set order
+	/// @details This method returns the same data as visibility(), but
+	/// ordered the way they are stored in the measurement set, i.e. polarisation
+	/// is the fastest varying axis. Using this method avoids the transpose
+	/// required to form the cube returned by visibility(), which is beneficial
+	/// for clients (e.g. gridders) which process all polarisations of a given
+	/// row and channel together.
+	/// @return a reference to nPol x nChannel x nRow cube, containing
+	/// all visibility data
+	virtual const casacore::Cube<casacore::Complex>& visibilityNative() const = 0;
+
+	/// @brief flags in the measurement set order
+	/// @details This is a companion method to visibilityNative. It returns the
+	/// same information as flag(), but ordered the way it is stored in the
+	/// measurement set (polarisation is the fastest varying axis).
+	/// @return a reference to nPol x nChannel x nRow cube with flag
+	///         information. If True, the corresponding element is flagged.
+	virtual const casacore::Cube<casacore::Bool>& flagNative() const = 0;
+
 	/// UVW
 	/// @return a reference to vector containing uvw-coordinates
 	/// packed into a 3-D rigid vector
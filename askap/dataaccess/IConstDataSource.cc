@@ -29,6 +29,7 @@
 ///
 
 #include <askap/dataaccess/IConstDataSource.h>
+#include <askap/askap/AskapError.h>
 
 namespace askap {
 
@@ -98,6 +99,26 @@ boost::shared_ptr<IConstDataIterator>
     return createConstIterator(createSelector(),conv);
 }
 
+/// @brief get several iterators over disjoint parts of the selected data
+/// @details This method allows several threads to traverse the same dataset
+/// in parallel. Whether the parts are also read concurrently depends on the
+/// implementation. The default implementation doesn't split the data
+/// and returns a single iterator created by the most general createConstIterator(...)
+/// call. Override it in the derived classes, if partitioning is supported.
+///
+/// @param[in] sel a shared pointer to the selector object defining
+///            which subset of the data is used
+/// @param[in] conv a shared pointer to the converter object defining
+///            reference frames and units to be used
+/// @param[in] nParts desired number of parts (should be positive)
+/// @return a vector of shared pointers to iterators, one per part
+std::vector<boost::shared_ptr<IConstDataIterator> >
+    IConstDataSource::createConstIterators(const IDataSelectorConstPtr &sel,
+            const IDataConverterConstPtr &conv, casacore::uInt nParts) const {
+    ASKAPCHECK(nParts > 0, "Number of parts should be positive");
+    return std::vector<boost::shared_ptr<IConstDataIterator> >(1, createConstIterator(sel,conv));
+}
+
 } // end of namespace accessors
 
 } // end of namespace askap
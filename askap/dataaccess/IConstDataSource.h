@@ -31,6 +31,9 @@
 #ifndef ASKAP_ACCESSORS_I_CONST_DATA_SOURCE_H
 #define ASKAP_ACCESSORS_I_CONST_DATA_SOURCE_H
 
+// std includes
+#include <vector>
+
 // boost includes
 #include <boost/shared_ptr.hpp>
 
@@ -188,6 +191,27 @@ public:
 	           IDataSelectorConstPtr &sel, const
 		   IDataConverterConstPtr &conv) const = 0;
 
+	/// @brief get several iterators over disjoint parts of the selected data
+	/// @details This method allows several threads to traverse the same dataset
+	/// in parallel. The selected data are split into (up to) nParts parts, each covering
+	/// a contiguous range of time, and an independent iterator (with its own accessor and
+	/// caches) is created for each part. Whether the parts are also read concurrently
+	/// depends on the implementation (e.g. the table-based one serialises all I/O, so only
+	/// the processing of the data runs in parallel). The default implementation doesn't split the data
+	/// and returns a single iterator created by the most general createConstIterator(...)
+	/// call. Override it in the derived classes, if partitioning is supported.
+	///
+	/// @param[in] sel a shared pointer to the selector object defining
+	///            which subset of the data is used
+	/// @param[in] conv a shared pointer to the converter object defining
+	///            reference frames and units to be used
+	/// @param[in] nParts desired number of parts (should be positive)
+	/// @return a vector of shared pointers to iterators, one per part (the number of parts
+	///         can be less than requested, but there is always at least one iterator)
+	virtual std::vector<boost::shared_ptr<IConstDataIterator> > createConstIterators(const
+	           IDataSelectorConstPtr &sel, const IDataConverterConstPtr &conv,
+	           casacore::uInt nParts) const;
+
 	/// create a selector object corresponding to this type of the
 	/// DataSource
 	///
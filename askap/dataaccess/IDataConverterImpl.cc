@@ -0,0 +1,61 @@
+/// @file IDataConverterImpl.cc
+/// @brief A rich interface to describe on-the-fly conversions
+/// @details This file contains the default implementations of the batch
+/// direction conversion methods, which work via the conversion of a single
+/// direction.
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#include <askap/dataaccess/IDataConverterImpl.h>
+
+using namespace askap;
+using namespace askap::accessors;
+
+/// @brief convert a number of directions given in the same frame
+/// @details This default implementation converts each direction separately via
+/// the single direction version of this method. Derived classes can set up the
+/// conversion machinery once for all directions.
+/// @param[in] inRef reference frame of the input directions
+/// @param[in] in input directions
+/// @param[out] out converted directions (resized to match the input)
+void IDataConverterImpl::direction(const casacore::MDirection::Ref &inRef,
+                                   const casacore::Vector<casacore::MVDirection> &in,
+                                   casacore::Vector<casacore::MVDirection> &out) const
+{
+  out.resize(in.nelements());
+  for (casacore::uInt elem = 0; elem < in.nelements(); ++elem) {
+       direction(casacore::MDirection(in[elem], inRef), out[elem]);
+  }
+}
+
+/// @brief check whether the direction conversion depends on the position
+/// @details This default implementation always returns true, i.e. the directions
+/// are converted separately for each antenna unless a derived class knows better.
+/// @return true
+bool IDataConverterImpl::isDirectionPositionDependent(const casacore::MDirection::Ref &) const
+{
+  return true;
+}
@@ -41,6 +41,7 @@
 #include <casacore/measures/Measures/MDirection.h>
 #include <casacore/measures/Measures/MEpoch.h>
 #include <casacore/measures/Measures/MRadialVelocity.h>
+#include <casacore/casa/Arrays/Vector.h>
 
 // own includes
 #include <askap/dataaccess/IDataConverter.h>
@@ -79,6 +80,24 @@ public:
     virtual void direction(const casacore::MDirection &in,
                            casacore::MVDirection &out) const = 0;
 
+    /// @brief convert a number of directions given in the same frame
+    /// @details The conversion machinery is set up once for all directions (see
+    /// IDirectionConverter::convert). The default implementation converts each
+    /// direction separately via the method above.
+    /// @param[in] inRef reference frame of the input directions
+    /// @param[in] in input directions
+    /// @param[out] out converted directions (resized to match the input)
+    virtual void direction(const casacore::MDirection::Ref &inRef,
+                           const casacore::Vector<casacore::MVDirection> &in,
+                           casacore::Vector<casacore::MVDirection> &out) const;
+
+    /// @brief check whether the direction conversion depends on the position
+    /// @details If it doesn't, the directions for all antennas can be converted with
+    /// the same frame. The default implementation always returns true.
+    /// @param[in] inRef reference frame of the input directions
+    /// @return true, if the result depends on the position set with setMeasFrame
+    virtual bool isDirectionPositionDependent(const casacore::MDirection::Ref &inRef) const;
+
     /// test whether the frequency conversion is void
     /// @param[in] testRef reference frame to test
     /// @param[in] testUnit units to test
@@ -36,6 +36,7 @@
 // CASA includes
 #include <casacore/measures/Measures/MDirection.h>
 #include <casacore/casa/Quanta/MVDirection.h>
+#include <casacore/casa/Arrays/Vector.h>
 
 // own includes
 #include <askap/dataaccess/IConverterBase.h>
@@ -56,6 +57,28 @@ struct IDirectionConverter : virtual public IConverterBase {
     /// property of the actual instance of the derived class
     virtual casacore::MVDirection operator()(const casacore::MDirection &in) const = 0;
 
+    /// @brief convert a number of directions given in the same frame
+    /// @details The conversion machinery is set up once and used for all directions,
+    /// the frame set with setMeasFrame applies to all of them. If the input and target
+    /// frames are the same and the conversion doesn't depend on the frame (e.g. J2000
+    /// to J2000), the input is copied without conversion. The default implementation
+    /// converts each direction separately via operator().
+    /// @param[in] inRef reference frame of the input directions
+    /// @param[in] in input directions
+    /// @param[out] out converted directions (resized to match the input)
+    virtual void convert(const casacore::MDirection::Ref &inRef,
+                         const casacore::Vector<casacore::MVDirection> &in,
+                         casacore::Vector<casacore::MVDirection> &out) const;
+
+    /// @brief check whether the conversion depends on the position
+    /// @details The conversion to or from a topocentric frame (e.g. AZEL or HADEC)
+    /// depends on the position given in the frame, so it is different for each antenna.
+    /// Conversions between celestial frames can be done once for all antennas.
+    /// The default implementation always returns true.
+    /// @param[in] inRef reference frame of the input directions
+    /// @return true, if the result depends on the position set with setMeasFrame
+    virtual bool isPositionDependent(const casacore::MDirection::Ref &inRef) const;
+
     /// using statement to have setMeasFrame public.
     using IConverterBase::setMeasFrame;
 };
@@ -41,6 +41,8 @@
 
 // casa includes
 #include <casacore/tables/TaQL/ExprNode.h>
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/measures/Measures/Stokes.h>
 
 // own includes
 #include <askap/dataaccess/IDataConverterImpl.h>
@@ -129,12 +131,45 @@ public:
   /// the second element gives the start channel (0-based)
   virtual std::pair<int,int> getChannelSelection() const throw() = 0;
 
+  /// @brief obtain the number of adjacent channels to average
+  /// @details This number is given as the nAvg parameter of chooseChannels and is
+  /// only meaningful if channelsSelected returns true. Each channel returned by the
+  /// accessor is an average of this many adjacent channels of the measurement set,
+  /// i.e. the range of raw channels read starts from the start channel and covers
+  /// nChan * nAvg channels.
+  /// @return number of channels to average (1 means no averaging)
+  virtual casacore::uInt getChannelAveraging() const throw() = 0;
+
+  /// @brief check whether polarisation selection has been done
+  /// @details By default all polarisation products stored in the dataset are returned.
+  /// However, if choosePolarizations has been called, the products are converted into
+  /// the requested ones on read. This method returns true if this is the case.
+  /// @return true, if polarisation products have been selected
+  virtual bool polarisationsSelected() const throw() = 0;
+
+  /// @brief obtain polarisation selection
+  /// @details This method returns the polarisation products requested via
+  /// choosePolarizations. The vector is empty if no selection has been done.
+  /// @return vector with the requested polarisation products
+  virtual const casacore::Vector<casacore::Stokes::StokesTypes>& getPolarisationSelection() const throw() = 0;
+
   /// @brief obtain frequency selection
   /// @details By default all channels are selected. However, if chooseFrequencies
   /// has been called, less channels are returned by the accessor. This method
   /// returns the number of channels, the start frequency and the increment (Hz)
   virtual std::tuple<int,casacore::MFrequency,double> getFrequencySelection() const throw() = 0;
 
+  /// @brief obtain a description of the row selection
+  /// @details This method returns a string which uniquely describes the rows selected
+  /// by getTableSelector, e.g. to check whether an index built for one selection can be
+  /// used for another one. Two selectors with the same key select the same rows of the same
+  /// table. Selection of channels and polarisations is not included.
+  /// @param[in] conv  a shared pointer to the converter, which is used to sort
+  ///              out epochs and other measures used in the selection
+  /// @return selection key
+  virtual std::string getSelectionKey(const
+               boost::shared_ptr<IDataConverterImpl const> &conv) const = 0;
+
 };
 
 } // namespace accessors
@@ -43,6 +43,9 @@
 // boost includes
 #include <boost/shared_ptr.hpp>
 
+// std includes
+#include <string>
+
 namespace askap {
 
 namespace accessors {
@@ -72,6 +75,11 @@ public:
    ///
    /// @param[in] tex a reference to table expression to use
    virtual void updateTableExpression(casacore::TableExprNode &tex) const = 0;
+
+   /// @brief obtain a description of the selection
+   /// @details The converter should be set prior to the call to this method.
+   /// @return a string which uniquely describes the selection done by updateTableExpression
+   virtual std::string selectionKey() const = 0;
 };
 
 } // namespace askap
@@ -44,6 +44,7 @@
 #include <casacore/tables/Tables/ScalarColumn.h>
 #include <casacore/tables/Tables/TableRecord.h>
 #include <casacore/measures/TableMeasures/ScalarMeasColumn.h>
+#include <casacore/measures/Measures/MCPosition.h>
 #include <casacore/casa/Arrays/Array.h>
 
 using namespace askap;
@@ -63,17 +64,47 @@ MemAntennaSubtableHandler::MemAntennaSubtableHandler(const casacore::Table &ms)
   casacore::ROScalarMeasColumn<casacore::MPosition> posCol(antennaSubtable,"POSITION");
   mountCol.getColumn(itsMounts,casacore::True);
   itsPositions.resize(itsMounts.nelements());
+  itsMountTypes.resize(itsMounts.nelements());
+  itsLatitudes.resize(itsMounts.nelements());
+  itsLongitudes.resize(itsMounts.nelements());
   casacore::Vector<casacore::MPosition>::iterator it=itsPositions.begin();
   casacore::Vector<casacore::String>::const_iterator cit=itsMounts.begin();
   for (casacore::uInt ant=0; it!=itsPositions.end(); ++it,++ant,++cit) {
        *it=posCol(ant);
-       const casacore::String &cMount = *cit;
-       if (cMount != "EQUATORIAL" && cMount != "equatorial") {
+       itsMountTypes[ant] = parseMount(*cit);
+       if (itsMountTypes[ant] != EQUATORIAL) {
            itsAllEquatorial = false;
        }
+       // latitude and longitude are used for analytic parallactic angle calculation
+       const casacore::MVPosition itrfPos = casacore::MPosition::Convert(*it,
+                    casacore::MPosition::Ref(casacore::MPosition::ITRF))().getValue();
+       itsLatitudes[ant] = itrfPos.getLat();
+       itsLongitudes[ant] = itrfPos.getLong();
   }  
 }
 
+/// @brief parse the mount type string
+/// @details The comparison is case-insensitive.
+/// @param[in] mount mount type as given in the MOUNT column
+/// @return mount type (UNKNOWN if the string is not recognised)
+IAntennaSubtableHandler::MountType MemAntennaSubtableHandler::parseMount(const casacore::String &mount)
+{
+  const casacore::String mountUpper = casacore::upcase(mount);
+  if (mountUpper == "ALT-AZ") {
+      return ALT_AZ;
+  }
+  if (mountUpper == "EQUATORIAL") {
+      return EQUATORIAL;
+  }
+  if (mountUpper == "X-Y") {
+      return X_Y;
+  }
+  if (mountUpper == "FIXED") {
+      return FIXED;
+  }
+  return UNKNOWN;
+}
+
 /// @brief get the number of antennas
 /// @details
 /// This method returns the number of antennas (i.e. all antID indices
@@ -108,6 +139,34 @@ const casacore::String& MemAntennaSubtableHandler::getMount(casacore::uInt antID
   return itsMounts[antID];
 }
 
+/// @brief obtain the parsed mount type for the given antenna
+/// @details
+/// @param[in] antID antenna ID to return the mount type for
+/// @return mount type (UNKNOWN if the mount string is not recognised)
+IAntennaSubtableHandler::MountType MemAntennaSubtableHandler::getMountType(casacore::uInt antID) const
+{
+  ASKAPDEBUGASSERT(antID<itsMountTypes.size());
+  return itsMountTypes[antID];
+}
+
+/// @brief obtain latitudes of all antennas
+/// @details Latitudes are geocentric (i.e. derived from the ITRF position
+/// vector), which is what casacore uses for the AZEL and HADEC frames.
+/// @return vector with latitudes in radians, one element per antenna
+const casacore::Vector<casacore::Double>& MemAntennaSubtableHandler::getLatitudes() const
+{
+  return itsLatitudes;
+}
+
+/// @brief obtain longitudes of all antennas
+/// @details Longitudes are derived from the ITRF position vector and are
+/// positive to the east.
+/// @return vector with longitudes in radians, one element per antenna
+const casacore::Vector<casacore::Double>& MemAntennaSubtableHandler::getLongitudes() const
+{
+  return itsLongitudes;
+}
+
 /// @brief check whether all antennas are equatorialy mounted
 /// @details
 /// This method checks the mount type for all antennas to be 
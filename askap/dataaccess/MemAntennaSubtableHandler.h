@@ -36,6 +36,9 @@
 #include <casacore/tables/Tables/Table.h>
 #include <casacore/casa/Arrays/Vector.h>
 
+// std includes
+#include <vector>
+
 // own includes
 #include <askap/dataaccess/IAntennaSubtableHandler.h>
 
@@ -66,6 +69,24 @@ struct MemAntennaSubtableHandler : virtual public IAntennaSubtableHandler {
   /// @param[in] antID antenna ID to return the position for
   /// @return a string describing the mount type
   virtual const casacore::String& getMount(casacore::uInt antID) const;
+
+  /// @brief obtain the parsed mount type for the given antenna
+  /// @details
+  /// @param[in] antID antenna ID to return the mount type for
+  /// @return mount type (UNKNOWN if the mount string is not recognised)
+  virtual MountType getMountType(casacore::uInt antID) const;
+
+  /// @brief obtain latitudes of all antennas
+  /// @details Latitudes are geocentric (i.e. derived from the ITRF position
+  /// vector), which is what casacore uses for the AZEL and HADEC frames.
+  /// @return vector with latitudes in radians, one element per antenna
+  virtual const casacore::Vector<casacore::Double>& getLatitudes() const;
+
+  /// @brief obtain longitudes of all antennas
+  /// @details Longitudes are derived from the ITRF position vector and are
+  /// positive to the east.
+  /// @return vector with longitudes in radians, one element per antenna
+  virtual const casacore::Vector<casacore::Double>& getLongitudes() const;
   
   /// @brief check whether all antennas are equatorialy mounted
   /// @details
@@ -84,9 +105,24 @@ struct MemAntennaSubtableHandler : virtual public IAntennaSubtableHandler {
   /// @return total number of antennas 
   virtual casacore::uInt getNumberOfAntennas() const;
     
+  /// @brief parse the mount type string
+  /// @details The comparison is case-insensitive.
+  /// @param[in] mount mount type as given in the MOUNT column
+  /// @return mount type (UNKNOWN if the string is not recognised)
+  static MountType parseMount(const casacore::String &mount);
+
 private:
   /// a cache of antenna mounts
   casacore::Vector<casacore::String> itsMounts;
+
+  /// mount types parsed from itsMounts
+  std::vector<MountType> itsMountTypes;
+
+  /// geocentric latitudes of all antennas (in radians)
+  casacore::Vector<casacore::Double> itsLatitudes;
+
+  /// longitudes of all antennas (in radians)
+  casacore::Vector<casacore::Double> itsLongitudes;
   
   /// a cache of antenna positions
   casacore::Vector<casacore::MPosition> itsPositions;
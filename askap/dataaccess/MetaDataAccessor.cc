@@ -42,6 +42,7 @@
 
 
 #include <askap/dataaccess/MetaDataAccessor.h>
+#include <askap/dataaccess/CubeTranspose.h>
 
 using namespace askap::accessors;
 
@@ -171,6 +172,30 @@ const casacore::Cube<casacore::Bool>& MetaDataAccessor::flag() const
   return itsROAccessor.flag();
 }
 
+/// @brief flags in the measurement set order
+/// @details Flags are taken from the associated const accessor,
+/// consistent with flag()
+/// @return a reference to nPol x nChannel x nRow cube with flag
+///         information. If True, the corresponding element is flagged.
+const casacore::Cube<casacore::Bool>& MetaDataAccessor::flagNative() const
+{
+  return itsROAccessor.flagNative();
+}
+
+/// @brief visibilities in the measurement set order
+/// @details Visibilities are not handled by this class, derived classes
+/// typically provide their own buffers. Therefore, this method forms the
+/// cube from the output of visibility() on each call. Derived classes
+/// which return visibilities of the associated const accessor can override
+/// this method to avoid the transpose.
+/// @return a reference to nPol x nChannel x nRow cube, containing
+/// all visibility data
+const casacore::Cube<casacore::Complex>& MetaDataAccessor::visibilityNative() const
+{
+  accessorToNativeOrder(visibility(), itsVisibilityNative);
+  return itsVisibilityNative;
+}
+
 
 /// UVW
 /// @return a reference to vector containing uvw-coordinates
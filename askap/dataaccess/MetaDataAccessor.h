@@ -150,6 +150,23 @@ public:
   ///         information. If True, the corresponding element is flagged.
   virtual const casacore::Cube<casacore::Bool>& flag() const;
 
+  /// @brief flags in the measurement set order
+  /// @details Flags are taken from the associated const accessor,
+  /// consistent with flag()
+  /// @return a reference to nPol x nChannel x nRow cube with flag
+  ///         information. If True, the corresponding element is flagged.
+  virtual const casacore::Cube<casacore::Bool>& flagNative() const;
+
+  /// @brief visibilities in the measurement set order
+  /// @details Visibilities are not handled by this class, derived classes
+  /// typically provide their own buffers. Therefore, this method forms the
+  /// cube from the output of visibility() on each call. Derived classes
+  /// which return visibilities of the associated const accessor can override
+  /// this method to avoid the transpose.
+  /// @return a reference to nPol x nChannel x nRow cube, containing
+  /// all visibility data
+  virtual const casacore::Cube<casacore::Complex>& visibilityNative() const;
+
   /// UVW
   /// @return a reference to vector containing uvw-coordinates
   /// packed into a 3-D rigid vector
@@ -220,6 +237,9 @@ protected:
 private:
   // a reference to the associated read-only accessor
   const IConstDataAccessor& itsROAccessor;
+
+  /// @brief buffer for visibilities in the measurement set order
+  mutable casacore::Cube<casacore::Complex> itsVisibilityNative;
 };
 
 
@@ -34,6 +34,7 @@
 
 // own includes
 #include <askap/dataaccess/OnDemandNoiseAndFlagDA.h>
+#include <askap/dataaccess/CubeTranspose.h>
 
 using namespace askap;
 using namespace askap::accessors;
@@ -93,3 +94,18 @@ casacore::Cube<casacore::Bool>& OnDemandNoiseAndFlagDA::rwFlag()
   }
   return itsFlagBuffer;
 }
+
+/// @brief flags in the measurement set order
+/// @details If the flags have been substituted, the cube is formed from
+/// the flag buffer on each call, otherwise the request is passed to the
+/// associated accessor.
+/// @return a reference to nPol x nChannel x nRow cube with flag
+///         information. If True, the corresponding element is flagged.
+const casacore::Cube<casacore::Bool>& OnDemandNoiseAndFlagDA::flagNative() const
+{
+  if (itsFlagSubstituted) {
+      accessorToNativeOrder(itsFlagBuffer, itsFlagNativeBuffer);
+      return itsFlagNativeBuffer;
+  }
+  return getROAccessor().flagNative();
+}
@@ -81,6 +81,14 @@ public:
   /// @return a reference to nRow x nChannel x nPol cube with the flag
   ///         information. If True, the corresponding element is flagged.
   virtual casacore::Cube<casacore::Bool>& rwFlag();
+
+  /// @brief flags in the measurement set order
+  /// @details If the flags have been substituted, the cube is formed from
+  /// the flag buffer on each call, otherwise the request is passed to the
+  /// associated accessor.
+  /// @return a reference to nPol x nChannel x nRow cube with flag
+  ///         information. If True, the corresponding element is flagged.
+  virtual const casacore::Cube<casacore::Bool>& flagNative() const;
   
 private:  
   /// @brief if true, the flag buffer is to be used instead of metadata
@@ -91,6 +99,9 @@ private:
 
   /// @brief buffer for noise (used if itsNoiseSubstituted is true)
   casacore::Cube<casacore::Bool> itsFlagBuffer;  
+
+  /// @brief flag buffer in the measurement set order (used if itsFlagSubstituted is true)
+  mutable casacore::Cube<casacore::Bool> itsFlagNativeBuffer;
   
   /// @brief buffer for noise (used if itsNoiseSubstituted is true)
   casacore::Cube<casacore::Complex> itsNoiseBuffer;   
@@ -0,0 +1,291 @@
+/// @file PackedFlags.cc
+/// @brief flags stored as a bit mask
+/// @details The accessor returns flags as a cube of casacore::Bool, i.e. one byte
+/// per sample. For spectral-line data with many channels this is a significant amount
+/// of memory for the information which fits in one bit. This class stores flags as a
+/// bit mask and provides bit-parallel operations used when flags are read from the
+/// measurement set (e.g. flagging of whole rows based on FLAG_ROW).
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#include <askap_accessors.h>
+
+// std includes
+#include <bitset>
+
+// ASKAPsoft includes
+#include <askap/askap/AskapError.h>
+
+// own includes
+#include <askap/dataaccess/PackedFlags.h>
+
+using namespace askap;
+using namespace askap::accessors;
+
+/// @brief construct an empty object
+PackedFlags::PackedFlags() : itsNRow(0), itsNChan(0), itsNPol(0) {}
+
+/// @brief construct the object of the given shape
+/// @param[in] nRow number of rows
+/// @param[in] nChan number of channels
+/// @param[in] nPol number of polarisation products
+/// @param[in] value initial value of all flags
+PackedFlags::PackedFlags(casacore::uInt nRow, casacore::uInt nChan, casacore::uInt nPol, bool value) :
+       itsNRow(0), itsNChan(0), itsNPol(0)
+{
+  resize(nRow, nChan, nPol, value);
+}
+
+/// @brief change the shape
+/// @details All flags are set to the given value.
+/// @param[in] nRow number of rows
+/// @param[in] nChan number of channels
+/// @param[in] nPol number of polarisation products
+/// @param[in] value value of all flags
+void PackedFlags::resize(casacore::uInt nRow, casacore::uInt nChan, casacore::uInt nPol, bool value)
+{
+  itsNRow = nRow;
+  itsNChan = nChan;
+  itsNPol = nPol;
+  itsWords.assign((nelements() + theirBitsPerWord - 1) / theirBitsPerWord, 0u);
+  if (value) {
+      flagAll();
+  }
+}
+
+/// @brief set the flag of a sample
+/// @param[in] row row
+/// @param[in] chan channel
+/// @param[in] pol polarisation product
+/// @param[in] value new value of the flag
+void PackedFlags::set(casacore::uInt row, casacore::uInt chan, casacore::uInt pol, bool value)
+{
+  ASKAPDEBUGASSERT((row < itsNRow) && (chan < itsNChan) && (pol < itsNPol));
+  const size_t bit = bitIndex(row, chan, pol);
+  const casacore::uInt64 mask = casacore::uInt64(1) << (bit % theirBitsPerWord);
+  if (value) {
+      itsWords[bit / theirBitsPerWord] |= mask;
+  } else {
+      itsWords[bit / theirBitsPerWord] &= ~mask;
+  }
+}
+
+/// @brief flag all samples of the given row
+/// @param[in] row row to flag
+void PackedFlags::flagRow(casacore::uInt row)
+{
+  ASKAPDEBUGASSERT(row < itsNRow);
+  const size_t rowSize = size_t(itsNChan) * itsNPol;
+  setBits(row * rowSize, (row + 1) * rowSize);
+}
+
+/// @brief flag all samples
+void PackedFlags::flagAll()
+{
+  setBits(0, nelements());
+}
+
+/// @brief count flagged samples
+/// @return number of flagged samples
+size_t PackedFlags::nFlagged() const
+{
+  size_t result = 0;
+  for (std::vector<casacore::uInt64>::const_iterator ci = itsWords.begin(); ci != itsWords.end(); ++ci) {
+       result += std::bitset<64>(*ci).count();
+  }
+  return result;
+}
+
+/// @brief set a range of bits
+/// @param[in] first the first bit to set
+/// @param[in] last the bit after the last one to set
+void PackedFlags::setBits(size_t first, size_t last)
+{
+  ASKAPDEBUGASSERT((first <= last) && (last <= nelements()));
+  if (first == last) {
+      return;
+  }
+  const size_t firstWord = first / theirBitsPerWord;
+  const size_t lastWord = (last - 1) / theirBitsPerWord;
+  const casacore::uInt64 allBits = ~casacore::uInt64(0);
+  // bits from the first one to the end of the first word
+  const casacore::uInt64 firstMask = allBits << (first % theirBitsPerWord);
+  // bits from the start of the last word to the last one
+  const casacore::uInt64 lastMask = allBits >> (theirBitsPerWord - 1 - (last - 1) % theirBitsPerWord);
+  if (firstWord == lastWord) {
+      itsWords[firstWord] |= firstMask & lastMask;
+  } else {
+      itsWords[firstWord] |= firstMask;
+      for (size_t word = firstWord + 1; word < lastWord; ++word) {
+           itsWords[word] = allBits;
+      }
+      itsWords[lastWord] |= lastMask;
+  }
+}
+
+/// @brief set flags from the cube in the measurement set order
+/// @details The object is resized to match the input.
+/// @param[in] native flags (nPol x nChannel x nRow)
+void PackedFlags::pack(const casacore::Array<casacore::Bool> &native)
+{
+  ASKAPCHECK(native.ndim() == 3, "Expect 3-dimensional array of flags, you have shape "<<native.shape());
+  resize(native.shape()[2], native.shape()[1], native.shape()[0]);
+  casacore::Bool deleteIt;
+  const casacore::Bool *in = native.getStorage(deleteIt);
+  packBits(in, 0, nelements());
+  native.freeStorage(in, deleteIt);
+}
+
+/// @brief set flags of a block of rows from the cube in the measurement set order
+/// @details This allows to pack flags read in blocks of rows without holding the unpacked
+/// flags of all rows in memory. The shape is not changed, the number of channels and
+/// polarisations of the input should match. The first row should be a multiple of
+/// rowAlignment, so the block starts at the word boundary.
+/// @param[in] native flags (nPol x nChannel x nRows) for the block
+/// @param[in] startRow the first row of the block
+void PackedFlags::packRows(const casacore::Array<casacore::Bool> &native, casacore::uInt startRow)
+{
+  ASKAPCHECK(native.ndim() == 3, "Expect 3-dimensional array of flags, you have shape "<<native.shape());
+  ASKAPCHECK((casacore::uInt(native.shape()[0]) == itsNPol) && (casacore::uInt(native.shape()[1]) == itsNChan) &&
+             (startRow + casacore::uInt(native.shape()[2]) <= itsNRow), "Block of flags of shape "<<
+             native.shape()<<" starting at row "<<startRow<<" doesn't fit into packed flags of "<<
+             itsNRow<<" rows, "<<itsNChan<<" channels and "<<itsNPol<<" polarisations");
+  ASKAPCHECK(startRow % rowAlignment(itsNChan, itsNPol) == 0, "Block of flags should start at the word boundary");
+  casacore::Bool deleteIt;
+  const casacore::Bool *in = native.getStorage(deleteIt);
+  const size_t firstBit = size_t(startRow) * itsNChan * itsNPol;
+  packBits(in, firstBit / theirBitsPerWord, native.nelements());
+  native.freeStorage(in, deleteIt);
+}
+
+/// @brief number of rows corresponding to a whole number of words
+/// @details A block of rows starting at a multiple of this number starts at the word
+/// boundary of the bit mask.
+/// @param[in] nChan number of channels
+/// @param[in] nPol number of polarisation products
+/// @return number of rows
+casacore::uInt PackedFlags::rowAlignment(casacore::uInt nChan, casacore::uInt nPol)
+{
+  // the greatest common divisor of the word size and the number of bits per row
+  size_t a = theirBitsPerWord;
+  size_t b = size_t(nChan) * nPol;
+  while (b != 0) {
+         const size_t rem = a % b;
+         a = b;
+         b = rem;
+  }
+  return casacore::uInt(theirBitsPerWord / a);
+}
+
+/// @brief pack the given number of flags starting at the word boundary
+/// @details The words covering the flags are overwritten, the bits of the last word
+/// beyond the given flags are cleared.
+/// @param[in] in flags to pack
+/// @param[in] firstWord the first word of the mask to fill
+/// @param[in] nBits number of flags to pack
+void PackedFlags::packBits(const casacore::Bool *in, size_t firstWord, size_t nBits)
+{
+  const size_t nFullWords = nBits / theirBitsPerWord;
+  ASKAPDEBUGASSERT(firstWord + (nBits + theirBitsPerWord - 1) / theirBitsPerWord <= itsWords.size());
+  // the inner loop has a fixed length and no branches, so it can be vectorised
+  for (size_t word = 0; word < nFullWords; ++word) {
+       const casacore::Bool *bits = in + word * theirBitsPerWord;
+       casacore::uInt64 value = 0;
+       for (size_t bit = 0; bit < theirBitsPerWord; ++bit) {
+            value |= casacore::uInt64(bits[bit] ? 1 : 0) << bit;
+       }
+       itsWords[firstWord + word] = value;
+  }
+  if (nFullWords * theirBitsPerWord < nBits) {
+      casacore::uInt64 value = 0;
+      for (size_t bit = 0; nFullWords * theirBitsPerWord + bit < nBits; ++bit) {
+           value |= casacore::uInt64(in[nFullWords * theirBitsPerWord + bit] ? 1 : 0) << bit;
+      }
+      itsWords[firstWord + nFullWords] = value;
+  }
+}
+
+/// @brief copy the first rows of another object
+/// @details The object is resized to nRow rows and the shape of the other object
+/// for channels and polarisations. As all flags of a row are contiguous, this is a copy
+/// of the leading words of the bit mask.
+/// @param[in] other object to copy from
+/// @param[in] nRow number of rows to copy (should not exceed other.nRow())
+void PackedFlags::assignRows(const PackedFlags &other, casacore::uInt nRow)
+{
+  ASKAPCHECK(nRow <= other.nRow(), "Unable to copy "<<nRow<<" rows of packed flags, only "<<
+             other.nRow()<<" rows are available");
+  itsNRow = nRow;
+  itsNChan = other.nChannel();
+  itsNPol = other.nPol();
+  const size_t nElements = nelements();
+  const size_t nWords = (nElements + theirBitsPerWord - 1) / theirBitsPerWord;
+  if (&other == this) {
+      itsWords.resize(nWords);
+  } else {
+      itsWords.assign(other.itsWords.begin(), other.itsWords.begin() + nWords);
+  }
+  // unused bits of the last word should be zero
+  if (nElements % theirBitsPerWord != 0) {
+      itsWords.back() &= ~casacore::uInt64(0) >> (theirBitsPerWord - nElements % theirBitsPerWord);
+  }
+}
+
+/// @brief unpack flags into a cube in the accessor order
+/// @param[out] flag cube to fill (resized to nRow x nChannel x nPol)
+void PackedFlags::unpack(casacore::Cube<casacore::Bool> &flag) const
+{
+  flag.resize(itsNRow, itsNChan, itsNPol);
+  casacore::Bool deleteIt;
+  casacore::Bool *out = flag.getStorage(deleteIt);
+  // bits are traversed in the storage order, the output is written with a stride
+  const size_t chanStride = itsNRow;
+  const size_t polStride = size_t(itsNRow) * itsNChan;
+  size_t bit = 0;
+  for (casacore::uInt row = 0; row < itsNRow; ++row) {
+       for (casacore::uInt chan = 0; chan < itsNChan; ++chan) {
+            casacore::Bool *dest = out + row + chan * chanStride;
+            for (casacore::uInt pol = 0; pol < itsNPol; ++pol, ++bit) {
+                 dest[pol * polStride] = (itsWords[bit / theirBitsPerWord] >> (bit % theirBitsPerWord)) & 1u;
+            }
+       }
+  }
+  flag.putStorage(out, deleteIt);
+}
+
+/// @brief unpack flags into a cube in the measurement set order
+/// @param[out] flag cube to fill (resized to nPol x nChannel x nRow)
+void PackedFlags::unpackNative(casacore::Cube<casacore::Bool> &flag) const
+{
+  flag.resize(itsNPol, itsNChan, itsNRow);
+  casacore::Bool deleteIt;
+  casacore::Bool *out = flag.getStorage(deleteIt);
+  const size_t nElements = nelements();
+  for (size_t bit = 0; bit < nElements; ++bit) {
+       out[bit] = (itsWords[bit / theirBitsPerWord] >> (bit % theirBitsPerWord)) & 1u;
+  }
+  flag.putStorage(out, deleteIt);
+}
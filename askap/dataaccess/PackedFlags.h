@@ -0,0 +1,203 @@
+/// @file PackedFlags.h
+/// @brief flags stored as a bit mask
+/// @details The accessor returns flags as a cube of casacore::Bool, i.e. one byte
+/// per sample. For spectral-line data with many channels this is a significant amount
+/// of memory for the information which fits in one bit. This class stores flags as a
+/// bit mask and provides bit-parallel operations used when flags are read from the
+/// measurement set (e.g. flagging of whole rows based on FLAG_ROW).
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#ifndef ASKAP_ACCESSORS_PACKED_FLAGS_H
+#define ASKAP_ACCESSORS_PACKED_FLAGS_H
+
+// std includes
+#include <vector>
+
+// casa includes
+#include <casacore/casa/aips.h>
+#include <casacore/casa/Arrays/Array.h>
+#include <casacore/casa/Arrays/Cube.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief flags stored as a bit mask
+/// @details Flags are indexed by row, channel and polarisation like the cube returned
+/// by IConstDataAccessor::flag(). The bits are stored in the measurement set order, i.e.
+/// polarisation is the fastest changing index and all flags of a row are contiguous.
+/// Therefore, flags read from the table can be packed in one pass and the whole row
+/// can be flagged by setting a range of bits (whole 64-bit words at a time).
+/// If the bit is set, the corresponding sample is flagged.
+/// @ingroup dataaccess_tab
+class PackedFlags {
+public:
+  /// @brief construct an empty object
+  PackedFlags();
+
+  /// @brief construct the object of the given shape
+  /// @param[in] nRow number of rows
+  /// @param[in] nChan number of channels
+  /// @param[in] nPol number of polarisation products
+  /// @param[in] value initial value of all flags
+  PackedFlags(casacore::uInt nRow, casacore::uInt nChan, casacore::uInt nPol, bool value = false);
+
+  /// @brief change the shape
+  /// @details All flags are set to the given value.
+  /// @param[in] nRow number of rows
+  /// @param[in] nChan number of channels
+  /// @param[in] nPol number of polarisation products
+  /// @param[in] value value of all flags
+  void resize(casacore::uInt nRow, casacore::uInt nChan, casacore::uInt nPol, bool value = false);
+
+  /// @return number of rows
+  inline casacore::uInt nRow() const { return itsNRow; }
+
+  /// @return number of channels
+  inline casacore::uInt nChannel() const { return itsNChan; }
+
+  /// @return number of polarisation products
+  inline casacore::uInt nPol() const { return itsNPol; }
+
+  /// @return total number of flags (i.e. samples)
+  inline size_t nelements() const { return size_t(itsNRow) * itsNChan * itsNPol; }
+
+  /// @brief obtain the flag of a sample
+  /// @param[in] row row
+  /// @param[in] chan channel
+  /// @param[in] pol polarisation product
+  /// @return true if the sample is flagged
+  inline bool operator()(casacore::uInt row, casacore::uInt chan, casacore::uInt pol) const
+     { const size_t bit = bitIndex(row, chan, pol);
+       return (itsWords[bit / theirBitsPerWord] >> (bit % theirBitsPerWord)) & 1u; }
+
+  /// @brief set the flag of a sample
+  /// @param[in] row row
+  /// @param[in] chan channel
+  /// @param[in] pol polarisation product
+  /// @param[in] value new value of the flag
+  void set(casacore::uInt row, casacore::uInt chan, casacore::uInt pol, bool value);
+
+  /// @brief flag all samples of the given row
+  /// @param[in] row row to flag
+  void flagRow(casacore::uInt row);
+
+  /// @brief flag all samples
+  void flagAll();
+
+  /// @brief count flagged samples
+  /// @return number of flagged samples
+  size_t nFlagged() const;
+
+  /// @brief set flags from the cube in the measurement set order
+  /// @details The object is resized to match the input.
+  /// @param[in] native flags (nPol x nChannel x nRow)
+  void pack(const casacore::Array<casacore::Bool> &native);
+
+  /// @brief set flags of a block of rows from the cube in the measurement set order
+  /// @details This allows to pack flags read in blocks of rows without holding the unpacked
+  /// flags of all rows in memory. The shape is not changed, the number of channels and
+  /// polarisations of the input should match. The first row should be a multiple of
+  /// rowAlignment, so the block starts at the word boundary.
+  /// @param[in] native flags (nPol x nChannel x nRows) for the block
+  /// @param[in] startRow the first row of the block
+  void packRows(const casacore::Array<casacore::Bool> &native, casacore::uInt startRow);
+
+  /// @brief number of rows corresponding to a whole number of words
+  /// @details A block of rows starting at a multiple of this number starts at the word
+  /// boundary of the bit mask.
+  /// @param[in] nChan number of channels
+  /// @param[in] nPol number of polarisation products
+  /// @return number of rows
+  static casacore::uInt rowAlignment(casacore::uInt nChan, casacore::uInt nPol);
+
+  /// @brief copy the first rows of another object
+  /// @details The object is resized to nRow rows and the shape of the other object
+  /// for channels and polarisations. As all flags of a row are contiguous, this is a copy
+  /// of the leading words of the bit mask.
+  /// @param[in] other object to copy from
+  /// @param[in] nRow number of rows to copy (should not exceed other.nRow())
+  void assignRows(const PackedFlags &other, casacore::uInt nRow);
+
+  /// @brief unpack flags into a cube in the accessor order
+  /// @param[out] flag cube to fill (resized to nRow x nChannel x nPol)
+  void unpack(casacore::Cube<casacore::Bool> &flag) const;
+
+  /// @brief unpack flags into a cube in the measurement set order
+  /// @param[out] flag cube to fill (resized to nPol x nChannel x nRow)
+  void unpackNative(casacore::Cube<casacore::Bool> &flag) const;
+
+  /// @brief direct access to the bit mask
+  /// @details Bit i of the mask is stored in the word i / 64 at position i % 64.
+  /// The unused bits of the last word are always zero.
+  /// @return vector of 64-bit words
+  inline const std::vector<casacore::uInt64>& words() const { return itsWords; }
+
+protected:
+  /// @brief index of the bit corresponding to the given sample
+  /// @param[in] row row
+  /// @param[in] chan channel
+  /// @param[in] pol polarisation product
+  /// @return index of the bit
+  inline size_t bitIndex(casacore::uInt row, casacore::uInt chan, casacore::uInt pol) const
+     { return (size_t(row) * itsNChan + chan) * itsNPol + pol; }
+
+  /// @brief set a range of bits
+  /// @param[in] first the first bit to set
+  /// @param[in] last the bit after the last one to set
+  void setBits(size_t first, size_t last);
+
+  /// @brief pack the given number of flags starting at the word boundary
+  /// @details The words covering the flags are overwritten, the bits of the last word
+  /// beyond the given flags are cleared.
+  /// @param[in] in flags to pack
+  /// @param[in] firstWord the first word of the mask to fill
+  /// @param[in] nBits number of flags to pack
+  void packBits(const casacore::Bool *in, size_t firstWord, size_t nBits);
+
+private:
+  /// @brief number of bits in each word of the mask
+  static const size_t theirBitsPerWord = 64;
+
+  /// @brief number of rows
+  casacore::uInt itsNRow;
+
+  /// @brief number of channels
+  casacore::uInt itsNChan;
+
+  /// @brief number of polarisation products
+  casacore::uInt itsNPol;
+
+  /// @brief bit mask
+  std::vector<casacore::uInt64> itsWords;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_PACKED_FLAGS_H
@@ -128,3 +128,38 @@ void askap::accessors::operator<<(const boost::shared_ptr<IDataSelector> &sel,
       sel->chooseScanNumber(static_cast<casacore::uInt>(parset.getUint32("ScanNumber")));
   }
 }
+
+// @brief configure table-based data source according to the given parset object
+// @details The following keywords are recognised (all are optional):
+// ReducedFootprint (bool) - enable reduced footprint mode
+// (see TableConstDataSource::configureReducedFootprint), CompactFlags (bool) - hold
+// flags read in advance as a bit mask (only used with ReducedFootprint = true).
+// MaxChunkMemory (double) - maximum memory in bytes per chunk (see
+// TableConstDataSource::configureMaxChunkMemory), ChunkMemoryPerThread (bool, default true) -
+// if false, the budget is shared between concurrent iterators.
+// RotatedUVWCacheSize (int) - number of tangent points for which rotated uvw and
+// delays are cached (see TableConstDataSource::configureRotatedUVWCache).
+// ValidateParallacticAngle (bool) - cross-check parallactic angles against casacore
+// measures (see TableConstDataSource::configureParallacticAngleValidation).
+// @param[in] ds data source to be configured
+// @param[in] parset a parset object to read the parameters from
+void askap::accessors::operator<<(TableConstDataSource &ds, const LOFAR::ParameterSet &parset)
+{
+  if (parset.isDefined("ReducedFootprint")) {
+      const bool compactFlags = parset.getBool("CompactFlags", false);
+      ds.configureReducedFootprint(parset.getBool("ReducedFootprint"), compactFlags);
+  }
+  if (parset.isDefined("MaxChunkMemory")) {
+      const double maxBytes = parset.getDouble("MaxChunkMemory");
+      ASKAPCHECK(maxBytes >= 0, "MaxChunkMemory should be a non-negative number, you have "<<maxBytes);
+      ds.configureMaxChunkMemory(size_t(maxBytes), parset.getBool("ChunkMemoryPerThread", true));
+  }
+  if (parset.isDefined("RotatedUVWCacheSize")) {
+      const int nTangentPoints = parset.getInt32("RotatedUVWCacheSize");
+      ASKAPCHECK(nTangentPoints > 0, "RotatedUVWCacheSize should be a positive number, you have "<<nTangentPoints);
+      ds.configureRotatedUVWCache(size_t(nTangentPoints));
+  }
+  if (parset.isDefined("ValidateParallacticAngle")) {
+      ds.configureParallacticAngleValidation(parset.getBool("ValidateParallacticAngle"));
+  }
+}
@@ -38,6 +38,7 @@
 // own includes
 #include <askap/dataaccess/IDataConverter.h>
 #include <askap/dataaccess/IDataSelector.h>
+#include <askap/dataaccess/TableConstDataSource.h>
 #include <Common/ParameterSet.h>
 
 // boost includes
@@ -55,6 +56,23 @@ namespace accessors {
 void operator<<(const boost::shared_ptr<IDataSelector> &sel,
                           const LOFAR::ParameterSet &parset);
 
+/// @brief configure table-based data source according to the given parset object
+/// @details The following keywords are recognised (all are optional):
+/// ReducedFootprint (bool) - enable reduced footprint mode
+/// (see TableConstDataSource::configureReducedFootprint), CompactFlags (bool) - hold
+/// flags read in advance as a bit mask (only used with ReducedFootprint = true).
+/// MaxChunkMemory (double) - maximum memory in bytes per chunk (see
+/// TableConstDataSource::configureMaxChunkMemory), ChunkMemoryPerThread (bool, default true) -
+/// if false, the budget is shared between concurrent iterators.
+/// RotatedUVWCacheSize (int) - number of tangent points for which rotated uvw and
+/// delays are cached (see TableConstDataSource::configureRotatedUVWCache).
+/// ValidateParallacticAngle (bool) - cross-check parallactic angles against casacore
+/// measures (see TableConstDataSource::configureParallacticAngleValidation).
+/// @param[in] ds data source to be configured
+/// @param[in] parset a parset object to read the parameters from
+/// @ingroup dataaccess_hlp
+void operator<<(TableConstDataSource &ds, const LOFAR::ParameterSet &parset);
+
 } // namespace accessors
 
 } // namespace askap
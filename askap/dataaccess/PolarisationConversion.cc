@@ -0,0 +1,230 @@
+/// @file PolarisationConversion.cc
+///
+/// @brief helper methods to convert polarisation products on read
+/// @details The data selector allows to choose the polarisation products returned
+/// by the accessor (see IDataSelector::choosePolarizations). Any requested product
+/// is a linear combination of the products stored in the measurement set. The
+/// methods defined in this file apply such a linear transformation to the
+/// arrays in the measurement set order, i.e. nPol x nChan x nRow.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#include <askap_accessors.h>
+
+// std includes
+#include <cmath>
+#include <complex>
+#include <vector>
+
+// ASKAPsoft includes
+#include <askap/askap/AskapError.h>
+#include <askap/scimath/utils/PolConverter.h>
+
+// own includes
+#include <askap/dataaccess/PolarisationConversion.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief obtain the matrix of the polarisation conversion
+/// @details This method uses scimath::PolConverter to build the nPolOut x nPolIn
+/// matrix of coefficients. An exception is thrown if the requested products cannot
+/// be obtained from the products available.
+/// @param[in] polFrameIn polarisation products available (e.g. in the measurement set)
+/// @param[in] polFrameOut polarisation products required
+/// @return conversion matrix (nPolOut x nPolIn)
+casacore::Matrix<casacore::Complex> polarisationTransform(
+           const casacore::Vector<casacore::Stokes::StokesTypes> &polFrameIn,
+           const casacore::Vector<casacore::Stokes::StokesTypes> &polFrameOut)
+{
+  const scimath::PolConverter polConv(polFrameIn, polFrameOut);
+  casacore::Matrix<casacore::Complex> transform(polFrameOut.nelements(), polFrameIn.nelements());
+  // the matrix is obtained column by column by converting unit vectors
+  casacore::Vector<casacore::Complex> unit(polFrameIn.nelements(), casacore::Complex(0.,0.));
+  for (casacore::uInt pol = 0; pol < unit.nelements(); ++pol) {
+       unit[pol] = casacore::Complex(1.,0.);
+       const casacore::Vector<casacore::Complex> column = polConv(unit);
+       ASKAPDEBUGASSERT(column.nelements() == transform.nrow());
+       transform.column(pol) = column;
+       unit[pol] = casacore::Complex(0.,0.);
+  }
+  return transform;
+}
+
+/// @brief helper method to check the input shape and resize the output
+/// @param[in] inShape shape of the input array (nPolIn x nChan x nRow)
+/// @param[in] transform conversion matrix (nPolOut x nPolIn)
+/// @return shape of the output array (nPolOut x nChan x nRow)
+static casacore::IPosition convertedShape(const casacore::IPosition &inShape,
+           const casacore::Matrix<casacore::Complex> &transform)
+{
+  ASKAPCHECK(inShape.nelements() == 3, "Expect a 3D array for polarisation conversion, shape = "<<inShape);
+  ASKAPCHECK(casacore::uInt(inShape[0]) == transform.ncolumn(), "Number of polarisations "<<inShape[0]<<
+             " doesn't match the conversion matrix ("<<transform.ncolumn()<<")");
+  return casacore::IPosition(3, transform.nrow(), inShape[1], inShape[2]);
+}
+
+/// @brief convert visibilities in the measurement set order
+/// @param[in] in input visibilities (nPolIn x nChan x nRow)
+/// @param[in] transform conversion matrix (nPolOut x nPolIn)
+/// @param[out] out output visibilities (resized to nPolOut x nChan x nRow)
+void convertPolarisationsNative(const casacore::Array<casacore::Complex> &in,
+           const casacore::Matrix<casacore::Complex> &transform, casacore::Array<casacore::Complex> &out)
+{
+  out.resize(convertedShape(in.shape(), transform));
+  if (out.nelements() == 0) {
+      return;
+  }
+  const size_t nPolIn = transform.ncolumn();
+  const size_t nPolOut = transform.nrow();
+  const size_t nSamples = out.nelements() / nPolOut;
+
+  bool deleteIn, deleteOut, deleteCoeffs;
+  const casacore::Complex *src = in.getStorage(deleteIn);
+  // the matrix is stored column by column, i.e. element (out, in) is at in * nPolOut + out
+  const casacore::Complex *coeffs = transform.getStorage(deleteCoeffs);
+  casacore::Complex *dst = out.getStorage(deleteOut);
+
+  for (size_t sample = 0; sample < nSamples; ++sample) {
+       const casacore::Complex *sampleIn = src + sample * nPolIn;
+       casacore::Complex *sampleOut = dst + sample * nPolOut;
+       for (size_t polOut = 0; polOut < nPolOut; ++polOut) {
+            sampleOut[polOut] = casacore::Complex(0.,0.);
+       }
+       for (size_t polIn = 0; polIn < nPolIn; ++polIn) {
+            const casacore::Complex *column = coeffs + polIn * nPolOut;
+            for (size_t polOut = 0; polOut < nPolOut; ++polOut) {
+                 sampleOut[polOut] += column[polOut] * sampleIn[polIn];
+            }
+       }
+  }
+
+  in.freeStorage(src, deleteIn);
+  transform.freeStorage(coeffs, deleteCoeffs);
+  out.putStorage(dst, deleteOut);
+}
+
+/// @brief convert flags in the measurement set order
+/// @details An output product is flagged if any of the input products it depends on is flagged
+/// @param[in] in input flags (nPolIn x nChan x nRow)
+/// @param[in] transform conversion matrix (nPolOut x nPolIn)
+/// @param[out] out output flags (resized to nPolOut x nChan x nRow)
+void convertPolarisationFlagsNative(const casacore::Array<casacore::Bool> &in,
+           const casacore::Matrix<casacore::Complex> &transform, casacore::Array<casacore::Bool> &out)
+{
+  out.resize(convertedShape(in.shape(), transform));
+  if (out.nelements() == 0) {
+      return;
+  }
+  const size_t nPolIn = transform.ncolumn();
+  const size_t nPolOut = transform.nrow();
+  const size_t nSamples = out.nelements() / nPolOut;
+
+  // dependency mask, element (out, in) is at in * nPolOut + out
+  std::vector<casacore::Bool> depends(nPolIn * nPolOut);
+  for (size_t polIn = 0; polIn < nPolIn; ++polIn) {
+       for (size_t polOut = 0; polOut < nPolOut; ++polOut) {
+            depends[polIn * nPolOut + polOut] = std::norm(transform(polOut, polIn)) > 0.;
+       }
+  }
+
+  bool deleteIn, deleteOut;
+  const casacore::Bool *src = in.getStorage(deleteIn);
+  casacore::Bool *dst = out.getStorage(deleteOut);
+
+  for (size_t sample = 0; sample < nSamples; ++sample) {
+       const casacore::Bool *sampleIn = src + sample * nPolIn;
+       casacore::Bool *sampleOut = dst + sample * nPolOut;
+       for (size_t polOut = 0; polOut < nPolOut; ++polOut) {
+            sampleOut[polOut] = casacore::False;
+       }
+       for (size_t polIn = 0; polIn < nPolIn; ++polIn) {
+            const casacore::Bool *column = depends.data() + polIn * nPolOut;
+            for (size_t polOut = 0; polOut < nPolOut; ++polOut) {
+                 sampleOut[polOut] = sampleOut[polOut] || (column[polOut] && sampleIn[polIn]);
+            }
+       }
+  }
+
+  in.freeStorage(src, deleteIn);
+  out.putStorage(dst, deleteOut);
+}
+
+/// @brief propagate noise through the polarisation conversion
+/// @details The noise of the output product is sqrt(sum |c_i|^2 sigma_i^2), where c_i are
+/// the coefficients of the conversion. The same noise is assumed for real and imaginary parts.
+/// @param[in] in input noise (nPolIn x nChan x nRow)
+/// @param[in] transform conversion matrix (nPolOut x nPolIn)
+/// @param[out] out output noise (resized to nPolOut x nChan x nRow)
+void convertPolarisationNoiseNative(const casacore::Array<casacore::Float> &in,
+           const casacore::Matrix<casacore::Complex> &transform, casacore::Array<casacore::Float> &out)
+{
+  out.resize(convertedShape(in.shape(), transform));
+  if (out.nelements() == 0) {
+      return;
+  }
+  const size_t nPolIn = transform.ncolumn();
+  const size_t nPolOut = transform.nrow();
+  const size_t nSamples = out.nelements() / nPolOut;
+
+  // squared amplitudes of the coefficients, element (out, in) is at in * nPolOut + out
+  std::vector<casacore::Float> weights(nPolIn * nPolOut);
+  for (size_t polIn = 0; polIn < nPolIn; ++polIn) {
+       for (size_t polOut = 0; polOut < nPolOut; ++polOut) {
+            weights[polIn * nPolOut + polOut] = std::norm(transform(polOut, polIn));
+       }
+  }
+
+  bool deleteIn, deleteOut;
+  const casacore::Float *src = in.getStorage(deleteIn);
+  casacore::Float *dst = out.getStorage(deleteOut);
+
+  for (size_t sample = 0; sample < nSamples; ++sample) {
+       const casacore::Float *sampleIn = src + sample * nPolIn;
+       casacore::Float *sampleOut = dst + sample * nPolOut;
+       for (size_t polOut = 0; polOut < nPolOut; ++polOut) {
+            sampleOut[polOut] = 0.;
+       }
+       for (size_t polIn = 0; polIn < nPolIn; ++polIn) {
+            const casacore::Float *column = weights.data() + polIn * nPolOut;
+            const casacore::Float variance = sampleIn[polIn] * sampleIn[polIn];
+            for (size_t polOut = 0; polOut < nPolOut; ++polOut) {
+                 sampleOut[polOut] += column[polOut] * variance;
+            }
+       }
+       for (size_t polOut = 0; polOut < nPolOut; ++polOut) {
+            sampleOut[polOut] = std::sqrt(sampleOut[polOut]);
+       }
+  }
+
+  in.freeStorage(src, deleteIn);
+  out.putStorage(dst, deleteOut);
+}
+
+} // namespace accessors
+
+} // namespace askap
@@ -0,0 +1,89 @@
+/// @file PolarisationConversion.h
+///
+/// @brief helper methods to convert polarisation products on read
+/// @details The data selector allows to choose the polarisation products returned
+/// by the accessor (see IDataSelector::choosePolarizations). Any requested product
+/// is a linear combination of the products stored in the measurement set. The
+/// methods declared in this file apply such a linear transformation to the
+/// arrays in the measurement set order, i.e. nPol x nChan x nRow.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#ifndef ASKAP_ACCESSORS_POLARISATION_CONVERSION_H
+#define ASKAP_ACCESSORS_POLARISATION_CONVERSION_H
+
+// casa includes
+#include <casacore/casa/aips.h>
+#include <casacore/casa/Arrays/Array.h>
+#include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/casa/BasicSL/Complex.h>
+#include <casacore/measures/Measures/Stokes.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief obtain the matrix of the polarisation conversion
+/// @details This method uses scimath::PolConverter to build the nPolOut x nPolIn
+/// matrix of coefficients. An exception is thrown if the requested products cannot
+/// be obtained from the products available.
+/// @param[in] polFrameIn polarisation products available (e.g. in the measurement set)
+/// @param[in] polFrameOut polarisation products required
+/// @return conversion matrix (nPolOut x nPolIn)
+casacore::Matrix<casacore::Complex> polarisationTransform(
+           const casacore::Vector<casacore::Stokes::StokesTypes> &polFrameIn,
+           const casacore::Vector<casacore::Stokes::StokesTypes> &polFrameOut);
+
+/// @brief convert visibilities in the measurement set order
+/// @param[in] in input visibilities (nPolIn x nChan x nRow)
+/// @param[in] transform conversion matrix (nPolOut x nPolIn)
+/// @param[out] out output visibilities (resized to nPolOut x nChan x nRow)
+void convertPolarisationsNative(const casacore::Array<casacore::Complex> &in,
+           const casacore::Matrix<casacore::Complex> &transform, casacore::Array<casacore::Complex> &out);
+
+/// @brief convert flags in the measurement set order
+/// @details An output product is flagged if any of the input products it depends on is flagged
+/// @param[in] in input flags (nPolIn x nChan x nRow)
+/// @param[in] transform conversion matrix (nPolOut x nPolIn)
+/// @param[out] out output flags (resized to nPolOut x nChan x nRow)
+void convertPolarisationFlagsNative(const casacore::Array<casacore::Bool> &in,
+           const casacore::Matrix<casacore::Complex> &transform, casacore::Array<casacore::Bool> &out);
+
+/// @brief propagate noise through the polarisation conversion
+/// @details The noise of the output product is sqrt(sum |c_i|^2 sigma_i^2), where c_i are
+/// the coefficients of the conversion. The same noise is assumed for real and imaginary parts.
+/// @param[in] in input noise (nPolIn x nChan x nRow)
+/// @param[in] transform conversion matrix (nPolOut x nPolIn)
+/// @param[out] out output noise (resized to nPolOut x nChan x nRow)
+void convertPolarisationNoiseNative(const casacore::Array<casacore::Float> &in,
+           const casacore::Matrix<casacore::Complex> &transform, casacore::Array<casacore::Float> &out);
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_POLARISATION_CONVERSION_H
@@ -0,0 +1,80 @@
+/// @file TableAccessGuard.h
+/// @brief helper class to serialise access to the table
+/// @details casacore tables are not thread-safe. The table may be accessed from
+/// several threads (read-ahead job, iterators over partitions of the same table), so
+/// all access is serialised with a recursive mutex shared by all users of the table.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#ifndef ASKAP_ACCESSORS_TABLE_ACCESS_GUARD_H
+#define ASKAP_ACCESSORS_TABLE_ACCESS_GUARD_H
+
+// boost includes
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief helper class to serialise access to the table
+/// @details If read-ahead is enabled, the table is read from the background thread
+/// as well. Iterators over partitions of the same table (see TablePartitionPlan) can be
+/// used from different threads and share the table and the subtable handlers.
+/// casacore tables are not thread-safe, so all access has to be serialised.
+/// This class locks the given table mutex for the lifetime of the
+/// object and does nothing if no mutex is given (i.e. the table is only accessed
+/// from one thread).
+/// @ingroup dataaccess_tab
+struct TableAccessGuard : private boost::noncopyable {
+  /// @brief constructor, locks the mutex
+  /// @param[in] mutex mutex to lock (can be an empty shared pointer)
+  explicit TableAccessGuard(const boost::shared_ptr<boost::recursive_mutex> &mutex) :
+        itsMutex(mutex.get())
+  {
+    if (itsMutex != NULL) {
+        itsMutex->lock();
+    }
+  }
+
+  /// @brief destructor, unlocks the mutex
+  ~TableAccessGuard()
+  {
+    if (itsMutex != NULL) {
+        itsMutex->unlock();
+    }
+  }
+private:
+  /// @brief mutex to work with (NULL if the table is only accessed from one thread)
+  boost::recursive_mutex *itsMutex;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_TABLE_ACCESS_GUARD_H
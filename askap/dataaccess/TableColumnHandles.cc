@@ -0,0 +1,167 @@
+/// @file TableColumnHandles.cc
+/// @brief column objects attached to the current iteration
+/// @details Construction of a casacore column object requires a lookup of the column
+/// by name and some setup in the table system. For small chunks of data, this
+/// overhead dominates if a new column object is created each time the data are read.
+/// This class holds column objects attached to the current iteration of the table
+/// iterator, so they can be reused by all fill methods and all chunks within the same
+/// iteration.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#include <askap_accessors.h>
+
+// std includes
+#include <algorithm>
+
+// casa includes
+#include <casacore/casa/Arrays/Vector.h>
+
+// own includes
+#include <askap/dataaccess/TableColumnHandles.h>
+#include <askap/dataaccess/TableAccessGuard.h>
+
+using namespace askap;
+using namespace askap::accessors;
+
+/// @brief set the mutex serialising the access to the table
+/// @details The mutex is shared with other users of the same table (e.g. the read-ahead
+/// job or iterators over other partitions). An empty shared pointer means that the table
+/// is only accessed from one thread and no locking is done.
+/// @param[in] mutex table mutex (can be an empty shared pointer)
+void TableColumnHandles::setTableMutex(const boost::shared_ptr<boost::recursive_mutex> &mutex)
+{
+  itsTableMutex = mutex;
+}
+
+/// @brief set the table to work with
+/// @details All columns attached to the previous table are released.
+/// @param[in] tab table to attach columns to (i.e. the current iteration)
+void TableColumnHandles::attach(const casacore::Table &tab)
+{
+  TableAccessGuard guard(itsTableMutex);
+  detach();
+  itsTable = tab;
+}
+
+/// @brief release all columns and the table
+void TableColumnHandles::detach()
+{
+  TableAccessGuard guard(itsTableMutex);
+  // columns should be released before the table
+  itsScalarColumns.clear();
+  itsArrayColumns.clear();
+  itsTimeMeasColumn.reset();
+  itsColumnRuns.clear();
+  itsTable = casacore::Table();
+}
+
+/// @brief check whether the table has the given column
+/// @param[in] name name of the column
+/// @return true if the column exists
+bool TableColumnHandles::hasColumn(const std::string &name) const
+{
+  TableAccessGuard guard(itsTableMutex);
+  ASKAPDEBUGASSERT(!itsTable.isNull());
+  return itsTable.tableDesc().isColumn(name);
+}
+
+/// @brief obtain the TIME column as a measure column
+/// @return a reference to the measure column object attached to the current table
+const casacore::ScalarMeasColumn<casacore::MEpoch>& TableColumnHandles::timeMeasColumn() const
+{
+  TableAccessGuard guard(itsTableMutex);
+  if (!itsTimeMeasColumn) {
+      ASKAPDEBUGASSERT(!itsTable.isNull());
+      itsTimeMeasColumn.reset(new casacore::ScalarMeasColumn<casacore::MEpoch>(itsTable, "TIME"));
+  }
+  return *itsTimeMeasColumn;
+}
+
+/// @brief obtain the value of an integer column and the extent of the run of equal values
+/// @details The whole column is read with a single call when it is first requested
+/// for the current table and split into runs of consecutive rows with the same value.
+/// The runs are cached, so subsequent calls (e.g. for later chunks of the same
+/// iteration) do not access the table.
+/// @param[in] name name of the column (e.g. DATA_DESC_ID)
+/// @param[in] row row of the table
+/// @param[out] runEnd the first row after the run of equal values containing the given row
+/// @return value of the column at the given row
+casacore::Int TableColumnHandles::intColumnRun(const std::string &name, casacore::rownr_t row,
+                                               casacore::rownr_t &runEnd) const
+{
+  TableAccessGuard guard(itsTableMutex);
+  std::map<std::string, ColumnRuns>::iterator it = itsColumnRuns.find(name);
+  if (it == itsColumnRuns.end()) {
+      it = itsColumnRuns.insert(std::make_pair(name, ColumnRuns())).first;
+      buildColumnRuns(scalarColumn<casacore::Int>(name).getColumn(), it->second);
+  }
+  const ColumnRuns &runs = it->second;
+  ASKAPCHECK(row < runs.itsStartRows.back(), "Row "<<row<<" is beyond the end of the table ("<<
+             runs.itsStartRows.back()<<" rows) for column "<<name);
+  // the first start row which is greater than the given row, i.e. the end of the run
+  const std::vector<casacore::rownr_t>::const_iterator ci =
+        std::upper_bound(runs.itsStartRows.begin(), runs.itsStartRows.end(), row);
+  ASKAPDEBUGASSERT(ci != runs.itsStartRows.begin());
+  ASKAPDEBUGASSERT(ci != runs.itsStartRows.end());
+  runEnd = *ci;
+  return runs.itsValues[ci - runs.itsStartRows.begin() - 1];
+}
+
+/// @brief set runs of an integer column obtained elsewhere
+/// @details This allows to avoid reading the column if the runs are already known
+/// (e.g. stored in the time index). The runs are released by the next call to attach or detach.
+/// @param[in] name name of the column (e.g. DATA_DESC_ID)
+/// @param[in] runs runs of equal values for the current table
+void TableColumnHandles::setColumnRuns(const std::string &name, const ColumnRuns &runs)
+{
+  TableAccessGuard guard(itsTableMutex);
+  ASKAPDEBUGASSERT(!itsTable.isNull());
+  ASKAPCHECK(!runs.itsStartRows.empty() && (runs.itsStartRows.back() == itsTable.nrow()),
+             "Runs of column "<<name<<" don't match the number of rows in the table");
+  itsColumnRuns[name] = runs;
+}
+
+/// @brief split an integer column into runs of equal values
+/// @param[in] values values of the column for all rows
+/// @param[out] runs runs of equal values (previous content is discarded)
+void TableColumnHandles::buildColumnRuns(const casacore::Vector<casacore::Int> &values, ColumnRuns &runs)
+{
+  runs.itsStartRows.clear();
+  runs.itsValues.clear();
+  const casacore::rownr_t nRow = values.nelements();
+  if (nRow > 0) {
+      runs.itsStartRows.push_back(0);
+      runs.itsValues.push_back(values[0]);
+      for (casacore::rownr_t r = 1; r < nRow; ++r) {
+           if (values[r] != values[r - 1]) {
+               runs.itsStartRows.push_back(r);
+               runs.itsValues.push_back(values[r]);
+           }
+      }
+  }
+  runs.itsStartRows.push_back(nRow);
+}
@@ -0,0 +1,184 @@
+/// @file TableColumnHandles.h
+/// @brief column objects attached to the current iteration
+/// @details Construction of a casacore column object requires a lookup of the column
+/// by name and some setup in the table system. For small chunks of data, this
+/// overhead dominates if a new column object is created each time the data are read.
+/// This class holds column objects attached to the current iteration of the table
+/// iterator, so they can be reused by all fill methods and all chunks within the same
+/// iteration.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#ifndef ASKAP_ACCESSORS_TABLE_COLUMN_HANDLES_H
+#define ASKAP_ACCESSORS_TABLE_COLUMN_HANDLES_H
+
+// std includes
+#include <string>
+#include <map>
+#include <vector>
+
+// boost includes
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+
+// casa includes
+#include <casacore/casa/aips.h>
+#include <casacore/tables/Tables/Table.h>
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/tables/Tables/TableColumn.h>
+#include <casacore/tables/Tables/ScalarColumn.h>
+#include <casacore/tables/Tables/ArrayColumn.h>
+#include <casacore/measures/TableMeasures/ScalarMeasColumn.h>
+#include <casacore/measures/Measures/MEpoch.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief column objects attached to the current iteration
+/// @details Columns are attached on demand, when they are first requested after
+/// the table has been set with attach. They stay valid until the next call to attach
+/// or detach. If the table mutex is set (see setTableMutex), the cached columns and runs
+/// are looked up and filled with the mutex locked, so the handles can be used from several
+/// threads. Reading data through the returned column objects is not covered by this lock,
+/// the caller is responsible for serialising it with the same mutex (see TableAccessGuard).
+/// @ingroup dataaccess_tab
+class TableColumnHandles : private boost::noncopyable {
+public:
+  /// @brief runs of equal values in an integer column
+  struct ColumnRuns {
+     /// @brief the first row of each run plus the total number of rows as the last element
+     std::vector<casacore::rownr_t> itsStartRows;
+     /// @brief value of each run
+     std::vector<casacore::Int> itsValues;
+  };
+
+  /// @brief split an integer column into runs of equal values
+  /// @param[in] values values of the column for all rows
+  /// @param[out] runs runs of equal values (previous content is discarded)
+  static void buildColumnRuns(const casacore::Vector<casacore::Int> &values, ColumnRuns &runs);
+
+  /// @brief set the mutex serialising the access to the table
+  /// @details The mutex is shared with other users of the same table (e.g. the read-ahead
+  /// job or iterators over other partitions). An empty shared pointer means that the table
+  /// is only accessed from one thread and no locking is done.
+  /// @param[in] mutex table mutex (can be an empty shared pointer)
+  void setTableMutex(const boost::shared_ptr<boost::recursive_mutex> &mutex);
+
+  /// @brief set the table to work with
+  /// @details All columns attached to the previous table are released.
+  /// @param[in] tab table to attach columns to (i.e. the current iteration)
+  void attach(const casacore::Table &tab);
+
+  /// @brief release all columns and the table
+  void detach();
+
+  /// @brief check whether a table has been set
+  /// @return true if attach has been called since construction or the last detach
+  inline bool isAttached() const { return !itsTable.isNull(); }
+
+  /// @brief check whether the table has the given column
+  /// @param[in] name name of the column
+  /// @return true if the column exists
+  bool hasColumn(const std::string &name) const;
+
+  /// @brief obtain a scalar column
+  /// @param[in] name name of the column
+  /// @return a reference to the column object attached to the current table
+  template<typename T>
+  const casacore::ScalarColumn<T>& scalarColumn(const std::string &name) const;
+
+  /// @brief obtain an array column
+  /// @param[in] name name of the column
+  /// @return a reference to the column object attached to the current table
+  template<typename T>
+  const casacore::ArrayColumn<T>& arrayColumn(const std::string &name) const;
+
+  /// @brief obtain the TIME column as a measure column
+  /// @return a reference to the measure column object attached to the current table
+  const casacore::ScalarMeasColumn<casacore::MEpoch>& timeMeasColumn() const;
+
+  /// @brief obtain the value of an integer column and the extent of the run of equal values
+  /// @details The whole column is read with a single call when it is first requested
+  /// for the current table and split into runs of consecutive rows with the same value.
+  /// The runs are cached, so subsequent calls (e.g. for later chunks of the same
+  /// iteration) do not access the table.
+  /// @param[in] name name of the column (e.g. DATA_DESC_ID)
+  /// @param[in] row row of the table
+  /// @param[out] runEnd the first row after the run of equal values containing the given row
+  /// @return value of the column at the given row
+  casacore::Int intColumnRun(const std::string &name, casacore::rownr_t row,
+                             casacore::rownr_t &runEnd) const;
+
+  /// @brief set runs of an integer column obtained elsewhere
+  /// @details This allows to avoid reading the column if the runs are already known
+  /// (e.g. stored in the time index). The runs are released by the next call to attach or detach.
+  /// @param[in] name name of the column (e.g. DATA_DESC_ID)
+  /// @param[in] runs runs of equal values for the current table
+  void setColumnRuns(const std::string &name, const ColumnRuns &runs);
+
+protected:
+  /// @brief helper method to get a column of the given type
+  /// @details Columns are stored as TableColumn objects indexed by name. Both scalar
+  /// and array columns derive from TableColumn, so a single map is used for each kind.
+  /// The map is searched and updated with the table mutex locked. The returned reference
+  /// stays valid until the next call to attach or detach.
+  /// @param[in] columns map of columns to search in and to add the new column to
+  /// @param[in] name name of the column
+  /// @return a reference to the column object
+  template<typename Col>
+  const Col& getColumn(std::map<std::string, boost::shared_ptr<casacore::TableColumn> > &columns,
+                       const std::string &name) const;
+
+private:
+  /// @brief table the columns are attached to
+  casacore::Table itsTable;
+
+  /// @brief mutex serialising the access to the table and the caches below
+  /// @details It is an empty shared pointer if the table is only accessed from one thread
+  boost::shared_ptr<boost::recursive_mutex> itsTableMutex;
+
+  /// @brief runs of integer columns cached so far
+  mutable std::map<std::string, ColumnRuns> itsColumnRuns;
+
+  /// @brief scalar columns attached so far
+  mutable std::map<std::string, boost::shared_ptr<casacore::TableColumn> > itsScalarColumns;
+
+  /// @brief array columns attached so far
+  mutable std::map<std::string, boost::shared_ptr<casacore::TableColumn> > itsArrayColumns;
+
+  /// @brief measure column for TIME (empty shared pointer if not yet attached)
+  mutable boost::shared_ptr<casacore::ScalarMeasColumn<casacore::MEpoch> > itsTimeMeasColumn;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#include <askap/dataaccess/TableColumnHandles.tcc>
+
+#endif // #ifndef ASKAP_ACCESSORS_TABLE_COLUMN_HANDLES_H
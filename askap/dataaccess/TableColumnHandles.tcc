@@ -0,0 +1,94 @@
+/// @file TableColumnHandles.tcc
+/// @brief column objects attached to the current iteration
+/// @details This file contains the implementation of template methods of
+/// TableColumnHandles.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#ifndef ASKAP_ACCESSORS_TABLE_COLUMN_HANDLES_TCC
+#define ASKAP_ACCESSORS_TABLE_COLUMN_HANDLES_TCC
+
+// own includes
+#include <askap/askap/AskapError.h>
+#include <askap/dataaccess/DataAccessError.h>
+#include <askap/dataaccess/TableAccessGuard.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief obtain a scalar column
+/// @param[in] name name of the column
+/// @return a reference to the column object attached to the current table
+template<typename T>
+const casacore::ScalarColumn<T>& TableColumnHandles::scalarColumn(const std::string &name) const
+{
+  return getColumn<casacore::ScalarColumn<T> >(itsScalarColumns, name);
+}
+
+/// @brief obtain an array column
+/// @param[in] name name of the column
+/// @return a reference to the column object attached to the current table
+template<typename T>
+const casacore::ArrayColumn<T>& TableColumnHandles::arrayColumn(const std::string &name) const
+{
+  return getColumn<casacore::ArrayColumn<T> >(itsArrayColumns, name);
+}
+
+/// @brief helper method to get a column of the given type
+/// @details Columns are stored as TableColumn objects indexed by name. Both scalar
+/// and array columns derive from TableColumn, so a single map is used for each kind.
+/// The map is searched and updated with the table mutex locked. The returned reference
+/// stays valid until the next call to attach or detach.
+/// @param[in] columns map of columns to search in and to add the new column to
+/// @param[in] name name of the column
+/// @return a reference to the column object
+template<typename Col>
+const Col& TableColumnHandles::getColumn(std::map<std::string,
+               boost::shared_ptr<casacore::TableColumn> > &columns, const std::string &name) const
+{
+  TableAccessGuard guard(itsTableMutex);
+  ASKAPDEBUGASSERT(!itsTable.isNull());
+  const std::map<std::string, boost::shared_ptr<casacore::TableColumn> >::const_iterator ci =
+        columns.find(name);
+  if (ci != columns.end()) {
+      const Col* col = dynamic_cast<const Col*>(ci->second.get());
+      ASKAPCHECK(col != NULL, "Column "<<name<<" has been requested with different data types");
+      return *col;
+  }
+  if (!hasColumn(name)) {
+      ASKAPTHROW(DataAccessError, "The column "<<name<<" is missing in the measurement set");
+  }
+  boost::shared_ptr<Col> col(new Col(itsTable, name));
+  columns[name] = col;
+  return *col;
+}
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_TABLE_COLUMN_HANDLES_TCC
@@ -36,6 +36,7 @@
 /// own includes
 #include <askap/dataaccess/TableConstDataAccessor.h>
 #include <askap/dataaccess/TableConstDataIterator.h>
+#include <askap/dataaccess/CubeTranspose.h>
 
 using namespace askap;
 using namespace askap::accessors;
@@ -75,8 +76,7 @@ casacore::uInt TableConstDataAccessor::nPol() const throw()
 /// all visibility data
 const casacore::Cube<casacore::Complex>& TableConstDataAccessor::visibility() const
 {
-  return itsVisibility.value(itsIterator,
-                        &TableConstDataIterator::fillVisibility);
+  return itsVisibility.value(*this, &TableConstDataAccessor::readVisibility);
 }
 
 /// Cube of flags corresponding to the output of visibility() 
@@ -84,7 +84,69 @@ const casacore::Cube<casacore::Complex>& TableConstDataAccessor::visibility() co
 ///         information. If True, the corresponding element is flagged.
 const casacore::Cube<casacore::Bool>& TableConstDataAccessor::flag() const
 {
-  return itsFlag.value(itsIterator, &TableConstDataIterator::fillFlag);
+  return itsFlag.value(*this, &TableConstDataAccessor::readFlag);
+}
+
+/// @brief visibilities in the measurement set order
+/// @details The data are read without a transpose. Note, the cube returned by
+/// visibility() is formed from this one if the latter is requested first, but
+/// not vice versa. This keeps the order of locking of the caches the same.
+/// @return a reference to nPol x nChannel x nRow cube, containing
+/// all visibility data
+const casacore::Cube<casacore::Complex>& TableConstDataAccessor::visibilityNative() const
+{
+  return itsVisibilityNative.value(itsIterator, &TableConstDataIterator::fillVisibilityNative);
+}
+
+/// @brief flags in the measurement set order
+/// @details The flags are read without a transpose, see also visibilityNative.
+/// @return a reference to nPol x nChannel x nRow cube with flag
+///         information. If True, the corresponding element is flagged.
+const casacore::Cube<casacore::Bool>& TableConstDataAccessor::flagNative() const
+{
+  return itsFlagNative.value(itsIterator, &TableConstDataIterator::fillFlagNative);
+}
+
+/// @brief flags stored as a bit mask
+/// @details This is the same information as returned by flag(), but takes one bit per
+/// sample. If flag() is requested after this method, the cube is unpacked from the bit mask
+/// rather than read from the table again. This method is specific for the table-based
+/// implementation.
+/// @return a reference to the packed flags (nRow x nChannel x nPol)
+const PackedFlags& TableConstDataAccessor::packedFlag() const
+{
+  return itsPackedFlag.value(itsIterator, &TableConstDataIterator::fillPackedFlag);
+}
+
+/// @brief a helper method to fill the visibility cache
+/// @details If the cache of visibilities in the measurement set order is valid,
+/// the data are transposed from there, otherwise they're read from the iterator.
+/// @param[in] vis a reference to nRow x nChannel x nPol cube to fill
+void TableConstDataAccessor::readVisibility(casacore::Cube<casacore::Complex> &vis) const
+{
+  if (itsVisibilityNative.isValid()) {
+      vis.resize(nRow(), nChannel(), nPol());
+      nativeToAccessorOrder(itsVisibilityNative.value(), vis);
+  } else {
+      itsIterator.fillVisibility(vis);
+  }
+}
+
+/// @brief a helper method to fill the flag cache
+/// @details If the cache of flags in the measurement set order or the packed flags
+/// are valid, the data are transposed or unpacked from there, otherwise they're read
+/// from the iterator.
+/// @param[in] flag a reference to nRow x nChannel x nPol cube to fill
+void TableConstDataAccessor::readFlag(casacore::Cube<casacore::Bool> &flag) const
+{
+  if (itsFlagNative.isValid()) {
+      flag.resize(nRow(), nChannel(), nPol());
+      nativeToAccessorOrder(itsFlagNative.value(), flag);
+  } else if (itsPackedFlag.isValid()) {
+      itsPackedFlag.value().unpack(flag);
+  } else {
+      itsIterator.fillFlag(flag);
+  }
 }
 
 /// UVW
@@ -108,6 +170,76 @@ const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >&
   return itsRotatedUVW.uvw(*this, tangentPoint);
 }	           
 	         
+/// @brief uvw stored as separate arrays of u, v and w
+/// @details This is the same information as returned by uvw(), but each component is
+/// contiguous in memory, which suits vectorised code. The components are de-interleaved
+/// straight from the UVW column (or from the cache of uvw(), if it is valid). This method
+/// is specific for the table-based implementation.
+/// @return a reference to uvw components
+const UVWComponents<casacore::Double>& TableConstDataAccessor::uvwComponents() const
+{
+  return itsUVWComponents.value(*this, &TableConstDataAccessor::readUVWComponents);
+}
+
+/// @brief uvw stored as separate arrays of u, v and w in single precision
+/// @details See uvwComponents. This method is specific for the table-based implementation.
+/// @return a reference to uvw components
+const UVWComponents<casacore::Float>& TableConstDataAccessor::uvwComponentsFloat() const
+{
+  return itsUVWComponentsFloat.value(*this, &TableConstDataAccessor::readUVWComponentsFloat);
+}
+
+/// @brief a helper method to fill the cache of uvw components
+/// @details If the cache of uvw is valid, the components are copied from there,
+/// otherwise they're read from the iterator. The reverse is not done to keep the
+/// order of locking of the caches the same.
+/// @param[in] uvw a reference to uvw components to fill
+void TableConstDataAccessor::readUVWComponents(UVWComponents<casacore::Double> &uvw) const
+{
+  if (itsUVW.isValid()) {
+      uvw.assign(itsUVW.value());
+  } else {
+      itsIterator.fillUVWComponents(uvw);
+  }
+}
+
+/// @brief a helper method to fill the cache of single precision uvw components
+/// @details In the reduced footprint mode, the double precision components are not
+/// cached unless they have been requested via uvwComponents.
+/// @param[in] uvw a reference to uvw components to fill
+void TableConstDataAccessor::readUVWComponentsFloat(UVWComponents<casacore::Float> &uvw) const
+{
+  if (itsIterator.reducedFootprint() && !itsUVWComponents.isValid()) {
+      UVWComponents<casacore::Double> buf;
+      readUVWComponents(buf);
+      uvw.assignFrom(buf);
+  } else {
+      uvw.assignFrom(uvwComponents());
+  }
+}
+
+/// @brief uvw after rotation stored as separate arrays of u, v and w
+/// @details This is the same information as returned by rotatedUVW, the cache of both
+/// representations is filled at the same time. This method is specific for the
+/// table-based implementation.
+/// @param[in] tangentPoint tangent point to rotate the coordinates to
+/// @return a reference to rotated uvw components
+const UVWComponents<casacore::Double>&
+TableConstDataAccessor::rotatedUVWComponents(const casacore::MDirection &tangentPoint) const
+{
+  return itsRotatedUVW.uvwComponents(*this, tangentPoint);
+}
+
+/// @brief uvw after rotation stored as separate arrays of u, v and w in single precision
+/// @details See rotatedUVWComponents. This method is specific for the table-based implementation.
+/// @param[in] tangentPoint tangent point to rotate the coordinates to
+/// @return a reference to rotated uvw components
+const UVWComponents<casacore::Float>&
+TableConstDataAccessor::rotatedUVWComponentsFloat(const casacore::MDirection &tangentPoint) const
+{
+  return itsRotatedUVW.uvwComponentsFloat(*this, tangentPoint);
+}
+
 /// @brief delay associated with uvw rotation
 /// @details This is a companion method to rotatedUVW. It returns delays corresponding
 /// to the baseline coordinate rotation. An additional delay corresponding to the 
@@ -132,6 +264,35 @@ const casacore::Vector<casacore::Double>& TableConstDataAccessor::frequency() co
   return itsFrequency.value(itsIterator,&TableConstDataIterator::fillFrequency);
 }
 
+/// @brief frequency for each channel in single precision
+/// @details See frequency(). In the reduced footprint mode (see
+/// TableConstDataIterator::enableReducedFootprint), the double precision frequencies are
+/// not cached unless frequency() is called. This method is specific for the table-based
+/// implementation.
+/// @return a reference to vector containing frequencies for each spectral channel
+const casacore::Vector<casacore::Float>& TableConstDataAccessor::frequencyFloat() const
+{
+  return itsFrequencyFloat.value(*this, &TableConstDataAccessor::readFrequencyFloat);
+}
+
+/// @brief a helper method to fill the cache of single precision frequencies
+/// @details In the reduced footprint mode, the frequencies are read from the iterator
+/// into a temporary buffer unless the cache of frequency() is valid.
+/// @param[in] freq a reference to vector to fill
+void TableConstDataAccessor::readFrequencyFloat(casacore::Vector<casacore::Float> &freq) const
+{
+  casacore::Vector<casacore::Double> buf;
+  if (itsIterator.reducedFootprint() && !itsFrequency.isValid()) {
+      itsIterator.fillFrequency(buf);
+  } else {
+      buf.reference(frequency());
+  }
+  freq.resize(buf.nelements());
+  for (casacore::uInt chan = 0; chan < buf.nelements(); ++chan) {
+       freq[chan] = casacore::Float(buf[chan]);
+  }
+}
+
 /// a helper adapter method to set the time via non-const reference
 /// @param[in] time a reference to buffer to fill with the current time 
 void TableConstDataAccessor::readTime(casacore::Double &time) const
@@ -247,7 +408,72 @@ const casacore::Vector<casacore::MVDirection>& TableConstDataAccessor::dishPoint
 ///         complex noise estimates
 const casacore::Cube<casacore::Complex>& TableConstDataAccessor::noise() const
 {
-  return itsNoise.value(itsIterator, &TableConstDataIterator::fillNoise);
+  return itsNoise.value(*this, &TableConstDataAccessor::readNoise);
+}
+
+/// @brief check whether the noise is the same for all spectral channels
+/// @details If true, compactNoise can be used instead of noise() to avoid
+/// expanding the noise to all channels. This method is specific for the table-based
+/// implementation.
+/// @return true if the noise is given per row and polarisation
+bool TableConstDataAccessor::noiseSpectrallyConstant() const
+{
+  return itsIterator.noiseSpectrallyConstant();
+}
+
+/// @brief noise given per row and polarisation
+/// @details This method can only be used if noiseSpectrallyConstant returns true. The noise
+/// applies to all spectral channels and to both real and imaginary parts. If noise() is
+/// requested after this method, the cube is expanded from this matrix rather than read
+/// from the table again. This method is specific for the table-based implementation.
+/// @return a reference to nRow x nPol matrix with the noise figures
+const casacore::Matrix<casacore::Float>& TableConstDataAccessor::compactNoise() const
+{
+  return itsCompactNoise.value(itsIterator, &TableConstDataIterator::fillCompactNoise);
+}
+
+/// @brief real-valued noise
+/// @details This is the same information as returned by noise(), but one value per sample
+/// is stored because the noise is the same for real and imaginary parts. If noise() is
+/// requested after this method, the complex cube is built from this one rather than read
+/// from the table again. This method is specific for the table-based implementation.
+/// @return a reference to nRow x nChannel x nPol cube with the noise figures
+const casacore::Cube<casacore::Float>& TableConstDataAccessor::noiseReal() const
+{
+  return itsNoiseReal.value(*this, &TableConstDataAccessor::readNoiseReal);
+}
+
+/// @brief a helper method to fill the cache of real-valued noise
+/// @details If the cache of the compact noise is valid, the cube is expanded from there,
+/// otherwise the noise is read from the iterator.
+/// @param[in] noise a reference to nRow x nChannel x nPol cube to fill
+void TableConstDataAccessor::readNoiseReal(casacore::Cube<casacore::Float> &noise) const
+{
+  if (itsCompactNoise.isValid()) {
+      TableConstDataIterator::broadcastNoise(itsCompactNoise.value(), nChannel(), noise);
+  } else {
+      itsIterator.fillNoiseReal(noise);
+  }
+}
+
+/// @brief a helper method to fill the noise cache
+/// @details If the cache of the compact or real-valued noise is valid, the cube is built
+/// from there, otherwise the noise is read from the iterator.
+/// @param[in] noise a reference to nRow x nChannel x nPol cube to fill
+void TableConstDataAccessor::readNoise(casacore::Cube<casacore::Complex> &noise) const
+{
+  if (itsCompactNoise.isValid()) {
+      TableConstDataIterator::broadcastNoise(itsCompactNoise.value(), nChannel(), noise);
+  } else if (itsNoiseReal.isValid()) {
+      const casacore::Cube<casacore::Float> &sigma = itsNoiseReal.value();
+      noise.resize(sigma.shape());
+      casacore::Cube<casacore::Complex>::iterator out = noise.begin();
+      for (casacore::Cube<casacore::Float>::const_iterator ci = sigma.begin(); ci != sigma.end(); ++ci, ++out) {
+           *out = casacore::Complex(*ci, *ci);
+      }
+  } else {
+      itsIterator.fillNoise(noise);
+  }
 }
   
 /// Velocity for each channel
@@ -257,7 +483,7 @@ const casacore::Cube<casacore::Complex>& TableConstDataAccessor::noise() const
 ///         the DataSource object (via IDataConverter).
 const casacore::Vector<casacore::Double>& TableConstDataAccessor::velocity() const
 {
-  throw AskapError("TableConstDataAccessor::velocity has not been implemented.");
+  return itsVelocity.value(itsIterator, &TableConstDataIterator::fillVelocity);
 }
  
 /// @brief polarisation type for each product
@@ -275,7 +501,12 @@ void TableConstDataAccessor::invalidateIterationCaches() const throw()
 {
   itsVisibility.invalidate();
   itsFlag.invalidate();
+  itsVisibilityNative.invalidate();
+  itsFlagNative.invalidate();
+  itsPackedFlag.invalidate();
   itsUVW.invalidate();
+  itsUVWComponents.invalidate();
+  itsUVWComponentsFloat.invalidate();
   itsRotatedUVW.invalidate();
   itsTime.invalidate();
   itsAntenna1.invalidate();
@@ -289,6 +520,8 @@ void TableConstDataAccessor::invalidateIterationCaches() const throw()
   itsDishPointing1.invalidate();
   itsDishPointing2.invalidate();
   itsNoise.invalidate();
+  itsCompactNoise.invalidate();
+  itsNoiseReal.invalidate();
 }
 
 /// @brief invalidate all fields  corresponding to the spectral axis
@@ -296,6 +529,8 @@ void TableConstDataAccessor::invalidateIterationCaches() const throw()
 void TableConstDataAccessor::invalidateSpectralCaches() const throw()
 {
   itsFrequency.invalidate();
+  itsFrequencyFloat.invalidate();
+  itsVelocity.invalidate();
   // polarisation info is attached to a spectral info (i.e. both are controlled by 
   // data descriptor ID, which is a sort of correlator setup ID)
   itsStokes.invalidate();
@@ -309,6 +544,35 @@ void TableConstDataAccessor::invalidateRotatedUVW() const throw()
   itsRotatedUVW.invalidate();
 }
 
+/// @brief change the number of tangent points in the cache of rotated uvw and delays
+/// @details Rotated uvw and delays are cached for the given number of tangent points,
+/// so alternating access to different tangent points within one chunk (e.g. for faceted
+/// imaging) doesn't require recalculation.
+/// @param[in] nTangentPoints a number of tangent points (should be positive)
+void TableConstDataAccessor::setRotatedUVWCacheSize(size_t nTangentPoints)
+{
+  itsRotatedUVW.setTangentPointCacheSize(nTangentPoints);
+}
+
+/// @brief memory used by the cache of rotated uvw and delays
+/// @details This method is specific for the table-based implementation.
+/// @return memory in bytes
+size_t TableConstDataAccessor::rotatedUVWMemory() const
+{
+  return itsRotatedUVW.memoryUsage();
+}
+
+/// @brief invalidate caches of the visibilities and flags in the measurement set order
+/// @details The read-write accessor modifies the cubes returned by visibility() and
+/// flag() in situ. This method allows it to ensure that the cubes in the measurement set
+/// order (and the packed flags) are not used after such modification.
+void TableConstDataAccessor::invalidateNativeCaches() const throw()
+{
+  itsVisibilityNative.invalidate();
+  itsFlagNative.invalidate();
+  itsPackedFlag.invalidate();
+}
+
 
 /// @brief Obtain a const reference to associated iterator.
 /// @details This method is mainly intended to be used in the derived
@@ -40,6 +40,8 @@
 #include <askap/dataaccess/DataAccessError.h>
 #include <askap/dataaccess/CachedAccessorField.h>
 #include <askap/dataaccess/UVWRotationHandler.h>
+#include <askap/dataaccess/PackedFlags.h>
+#include <askap/dataaccess/UVWComponents.h>
 
 namespace askap {
 	
@@ -117,6 +119,28 @@ public:
   ///         information. If True, the corresponding element is flagged.
   virtual const casacore::Cube<casacore::Bool>& flag() const;
 
+  /// @brief visibilities in the measurement set order
+  /// @details The data are read without a transpose. Note, the cube returned by
+  /// visibility() is formed from this one if the latter is requested first, but
+  /// not vice versa. This keeps the order of locking of the caches the same.
+  /// @return a reference to nPol x nChannel x nRow cube, containing
+  /// all visibility data
+  virtual const casacore::Cube<casacore::Complex>& visibilityNative() const;
+
+  /// @brief flags in the measurement set order
+  /// @details The flags are read without a transpose, see also visibilityNative.
+  /// @return a reference to nPol x nChannel x nRow cube with flag
+  ///         information. If True, the corresponding element is flagged.
+  virtual const casacore::Cube<casacore::Bool>& flagNative() const;
+
+  /// @brief flags stored as a bit mask
+  /// @details This is the same information as returned by flag(), but takes one bit per
+  /// sample. If flag() is requested after this method, the cube is unpacked from the bit mask
+  /// rather than read from the table again. This method is specific for the table-based
+  /// implementation.
+  /// @return a reference to the packed flags (nRow x nChannel x nPol)
+  const PackedFlags& packedFlag() const;
+
   /// UVW
   /// @return a reference to vector containing uvw-coordinates
   /// packed into a 3-D rigid vector
@@ -130,6 +154,33 @@ public:
   /// @return uvw after rotation to the new coordinate system for each row
   virtual const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >&
 	           rotatedUVW(const casacore::MDirection &tangentPoint) const;
+
+  /// @brief uvw stored as separate arrays of u, v and w
+  /// @details This is the same information as returned by uvw(), but each component is
+  /// contiguous in memory, which suits vectorised code. The components are de-interleaved
+  /// straight from the UVW column (or from the cache of uvw(), if it is valid). This method
+  /// is specific for the table-based implementation.
+  /// @return a reference to uvw components
+  const UVWComponents<casacore::Double>& uvwComponents() const;
+
+  /// @brief uvw stored as separate arrays of u, v and w in single precision
+  /// @details See uvwComponents. This method is specific for the table-based implementation.
+  /// @return a reference to uvw components
+  const UVWComponents<casacore::Float>& uvwComponentsFloat() const;
+
+  /// @brief uvw after rotation stored as separate arrays of u, v and w
+  /// @details This is the same information as returned by rotatedUVW, the cache of both
+  /// representations is filled at the same time. This method is specific for the
+  /// table-based implementation.
+  /// @param[in] tangentPoint tangent point to rotate the coordinates to
+  /// @return a reference to rotated uvw components
+  const UVWComponents<casacore::Double>& rotatedUVWComponents(const casacore::MDirection &tangentPoint) const;
+
+  /// @brief uvw after rotation stored as separate arrays of u, v and w in single precision
+  /// @details See rotatedUVWComponents. This method is specific for the table-based implementation.
+  /// @param[in] tangentPoint tangent point to rotate the coordinates to
+  /// @return a reference to rotated uvw components
+  const UVWComponents<casacore::Float>& rotatedUVWComponentsFloat(const casacore::MDirection &tangentPoint) const;
 	         
   /// @brief delay associated with uvw rotation
   /// @details This is a companion method to rotatedUVW. It returns delays corresponding
@@ -149,6 +200,14 @@ public:
   ///         the DataSource object
   virtual const casacore::Vector<casacore::Double>& frequency() const;
 
+  /// @brief frequency for each channel in single precision
+  /// @details See frequency(). In the reduced footprint mode (see
+  /// TableConstDataIterator::enableReducedFootprint), the double precision frequencies are
+  /// not cached unless frequency() is called. This method is specific for the table-based
+  /// implementation.
+  /// @return a reference to vector containing frequencies for each spectral channel
+  const casacore::Vector<casacore::Float>& frequencyFloat() const;
+
   /// Timestamp for each row
   /// @return a timestamp for this buffer (it is always the same
   ///         for all rows. The timestamp is returned as 
@@ -190,6 +249,29 @@ public:
   /// @return a reference to nRow x nChannel x nPol cube with
   ///         complex noise estimates
   virtual const casacore::Cube<casacore::Complex>& noise() const;
+
+  /// @brief check whether the noise is the same for all spectral channels
+  /// @details If true, compactNoise can be used instead of noise() to avoid
+  /// expanding the noise to all channels. This method is specific for the table-based
+  /// implementation.
+  /// @return true if the noise is given per row and polarisation
+  bool noiseSpectrallyConstant() const;
+
+  /// @brief noise given per row and polarisation
+  /// @details This method can only be used if noiseSpectrallyConstant returns true. The noise
+  /// applies to all spectral channels and to both real and imaginary parts. If noise() is
+  /// requested after this method, the cube is expanded from this matrix rather than read
+  /// from the table again. This method is specific for the table-based implementation.
+  /// @return a reference to nRow x nPol matrix with the noise figures
+  const casacore::Matrix<casacore::Float>& compactNoise() const;
+
+  /// @brief real-valued noise
+  /// @details This is the same information as returned by noise(), but one value per sample
+  /// is stored because the noise is the same for real and imaginary parts. If noise() is
+  /// requested after this method, the complex cube is built from this one rather than read
+  /// from the table again. This method is specific for the table-based implementation.
+  /// @return a reference to nRow x nChannel x nPol cube with the noise figures
+  const casacore::Cube<casacore::Float>& noiseReal() const;
   
   /// Velocity for each channel
   /// @return a reference to vector containing velocities for each
@@ -224,6 +306,24 @@ public:
   /// method to access private field
   void invalidateRotatedUVW() const throw();
 
+  /// @brief change the number of tangent points in the cache of rotated uvw and delays
+  /// @details Rotated uvw and delays are cached for the given number of tangent points,
+  /// so alternating access to different tangent points within one chunk (e.g. for faceted
+  /// imaging) doesn't require recalculation.
+  /// @param[in] nTangentPoints a number of tangent points (should be positive)
+  void setRotatedUVWCacheSize(size_t nTangentPoints);
+
+  /// @brief memory used by the cache of rotated uvw and delays
+  /// @details This method is specific for the table-based implementation.
+  /// @return memory in bytes
+  size_t rotatedUVWMemory() const;
+
+  /// @brief invalidate caches of the visibilities and flags in the measurement set order
+  /// @details The read-write accessor modifies the cubes returned by visibility() and
+  /// flag() in situ. This method allows it to ensure that the cubes in the measurement set
+  /// order (and the packed flags) are not used after such modification.
+  void invalidateNativeCaches() const throw();
+
   /// @brief Obtain a const reference to associated iterator.
   /// @details This method is mainly intended to be used in the derived
   /// non-const implementation, which works with a different type of the
@@ -234,7 +334,51 @@ private:
   /// a helper adapter method to set the time via non-const reference
   /// @param[in] time a reference to buffer to fill with the current time 
   void readTime(casacore::Double &time) const;
-  
+
+  /// @brief a helper method to fill the visibility cache
+  /// @details If the cache of visibilities in the measurement set order is valid,
+  /// the data are transposed from there, otherwise they're read from the iterator.
+  /// @param[in] vis a reference to nRow x nChannel x nPol cube to fill
+  void readVisibility(casacore::Cube<casacore::Complex> &vis) const;
+
+  /// @brief a helper method to fill the flag cache
+  /// @details If the cache of flags in the measurement set order or the packed flags
+  /// are valid, the data are transposed or unpacked from there, otherwise they're read
+  /// from the iterator.
+  /// @param[in] flag a reference to nRow x nChannel x nPol cube to fill
+  void readFlag(casacore::Cube<casacore::Bool> &flag) const;
+
+  /// @brief a helper method to fill the noise cache
+  /// @details If the cache of the compact noise is valid, the cube is expanded from there,
+  /// otherwise the noise is read from the iterator.
+  /// @param[in] noise a reference to nRow x nChannel x nPol cube to fill
+  void readNoise(casacore::Cube<casacore::Complex> &noise) const;
+
+  /// @brief a helper method to fill the cache of real-valued noise
+  /// @details If the cache of the compact noise is valid, the cube is expanded from there,
+  /// otherwise the noise is read from the iterator.
+  /// @param[in] noise a reference to nRow x nChannel x nPol cube to fill
+  void readNoiseReal(casacore::Cube<casacore::Float> &noise) const;
+
+  /// @brief a helper method to fill the cache of single precision frequencies
+  /// @details In the reduced footprint mode, the frequencies are read from the iterator
+  /// into a temporary buffer unless the cache of frequency() is valid.
+  /// @param[in] freq a reference to vector to fill
+  void readFrequencyFloat(casacore::Vector<casacore::Float> &freq) const;
+
+  /// @brief a helper method to fill the cache of uvw components
+  /// @details If the cache of uvw is valid, the components are copied from there,
+  /// otherwise they're read from the iterator. The reverse is not done to keep the
+  /// order of locking of the caches the same.
+  /// @param[in] uvw a reference to uvw components to fill
+  void readUVWComponents(UVWComponents<casacore::Double> &uvw) const;
+
+  /// @brief a helper method to fill the cache of single precision uvw components
+  /// @details In the reduced footprint mode, the double precision components are not
+  /// cached unless they have been requested via uvwComponents.
+  /// @param[in] uvw a reference to uvw components to fill
+  void readUVWComponentsFloat(UVWComponents<casacore::Float> &uvw) const;
+
   /// a reference to iterator managing this accessor
   const TableConstDataIterator& itsIterator;
   
@@ -243,9 +387,24 @@ private:
   
   /// internal buffer for flag
   CachedAccessorField<casacore::Cube<casacore::Bool> > itsFlag;
+
+  /// internal buffer for visibility in the measurement set order
+  CachedAccessorField<casacore::Cube<casacore::Complex> > itsVisibilityNative;
+
+  /// internal buffer for flag in the measurement set order
+  CachedAccessorField<casacore::Cube<casacore::Bool> > itsFlagNative;
+
+  /// internal buffer for flags stored as a bit mask
+  CachedAccessorField<PackedFlags> itsPackedFlag;
  
   /// internal buffer for uvw
   CachedAccessorField<casacore::Vector<casacore::RigidVector<casacore::Double, 3> > > itsUVW;
+
+  /// internal buffer for uvw stored as separate arrays of u, v and w
+  CachedAccessorField<UVWComponents<casacore::Double> > itsUVWComponents;
+
+  /// internal buffer for uvw components in single precision
+  CachedAccessorField<UVWComponents<casacore::Float> > itsUVWComponentsFloat;
   
   /// internal buffer for rotated uvw and associated delay
   UVWRotationHandler itsRotatedUVW; 
@@ -253,6 +412,12 @@ private:
   /// internal buffer for frequency
   CachedAccessorField<casacore::Vector<casacore::Double> > itsFrequency;
 
+  /// internal buffer for frequency in single precision
+  CachedAccessorField<casacore::Vector<casacore::Float> > itsFrequencyFloat;
+
+  /// internal buffer for velocity
+  CachedAccessorField<casacore::Vector<casacore::Double> > itsVelocity;
+
   /// internal buffer for time
   CachedAccessorField<casacore::Double> itsTime;
   
@@ -288,6 +453,12 @@ private:
   
   /// internal buffer for the noise figures
   CachedAccessorField<casacore::Cube<casacore::Complex> > itsNoise;
+
+  /// internal buffer for the noise figures given per row and polarisation
+  CachedAccessorField<casacore::Matrix<casacore::Float> > itsCompactNoise;
+
+  /// internal buffer for the real-valued noise figures
+  CachedAccessorField<casacore::Cube<casacore::Float> > itsNoiseReal;
   
   /// internal buffer for the polarisation types
   CachedAccessorField<casacore::Vector<casacore::Stokes::StokesTypes> > itsStokes;
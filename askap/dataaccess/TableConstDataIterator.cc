@@ -33,6 +33,10 @@
 
 #include <askap_accessors.h>
 
+/// std includes
+#include <algorithm>
+#include <cmath>
+
 /// ASKAPsoft includes
 #include <askap/askap/AskapLogging.h>
 #include <askap/askap/AskapError.h>
@@ -45,11 +49,22 @@
 #include <casacore/measures/Measures/MCFrequency.h>
 #include <casacore/casa/Arrays/Slicer.h>
 #include <casacore/casa/Arrays/IPosition.h>
+#include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
+#include <casacore/casa/Arrays/Slice.h>
+#include <casacore/casa/BasicSL/Constants.h>
+
+/// boost includes
+#include <boost/thread/recursive_mutex.hpp>
 
 /// Local package
 #include <askap/dataaccess/TableConstDataIterator.h>
 #include <askap/dataaccess/DataAccessError.h>
+#include <askap/dataaccess/TableAccessGuard.h>
 #include <askap/dataaccess/DirectionConverter.h>
+#include <askap/dataaccess/CubeTranspose.h>
+#include <askap/dataaccess/ChannelAveraging.h>
+#include <askap/dataaccess/PolarisationConversion.h>
 
 ASKAP_LOGGER(logger, "");
 
@@ -75,14 +90,18 @@ struct WholeRowFlagger
 {
   /// @brief constructor
   /// @details in the default version input parameter is not used
-  inline WholeRowFlagger(const casacore::Table &) {}
+  inline WholeRowFlagger(const TableColumnHandles &) {}
 
-  /// @brief determine whether element by element copy is needed
+  /// @brief apply row-based flags to the cube
   /// @details This method analyses other columns of the table specific
-  /// for a particular type and fills the cube with appropriate data.
-  /// If it can't do this, it returns true, which forces an element by element
-  /// processing. By default parameters are not used
-  inline bool copyRequired(casacore::uInt, casacore::Cube<T> &) { return true;}
+  /// for a particular type and updates the cube (already filled with the
+  /// data from the main column) with appropriate data. By default parameters
+  /// are not used and nothing is done.
+  inline void flagRows(casacore::rownr_t, casacore::Cube<T> &) {}
+
+  /// @brief apply row-based flags to the cube in the measurement set order
+  /// @details This is the same as flagRows, but the cube is nPol x nChannel x nRow.
+  inline void flagRowsNative(casacore::rownr_t, casacore::Cube<T> &) {}
 };
 
 
@@ -94,46 +113,130 @@ template<>
 struct WholeRowFlagger<casacore::Bool>
 {
   /// @brief constructor
-  /// @details in the default version input parameter is not used
-  /// @param[in] iteration current iteration (table returned by the iterator)
-  inline WholeRowFlagger(const casacore::Table &iteration);
-
-  /// @brief determine whether element by element copy is needed
-  /// @details This method analyses other columns of the table specific
-  /// for a particular type and fills the cube with appropriate data.
-  /// If it can't do this, it returns true, which forces an element by element
-  /// processing. By default parameters are not used
-  /// @param[in] row a row to work with
-  /// @param[in] cube cube to work with
-  inline bool copyRequired(casacore::uInt row, casacore::Cube<casacore::Bool> &cube);
+  /// @param[in] columns columns of the current iteration (table returned by the iterator)
+  inline WholeRowFlagger(const TableColumnHandles &columns);
+
+  /// @brief apply row-based flags to the cube
+  /// @details This method reads FLAG_ROW column (if present) and sets all
+  /// flags of the row in the cube if the whole row is flagged.
+  /// @param[in] topRow row of the table corresponding to the first row of the cube
+  /// @param[in] cube cube to work with (nRow x nChannel x nPol)
+  inline void flagRows(casacore::rownr_t topRow, casacore::Cube<casacore::Bool> &cube);
+
+  /// @brief apply row-based flags to the cube in the measurement set order
+  /// @details This is the same as flagRows, but the cube is nPol x nChannel x nRow.
+  /// @param[in] topRow row of the table corresponding to the first row of the cube
+  /// @param[in] cube cube to work with (nPol x nChannel x nRow)
+  inline void flagRowsNative(casacore::rownr_t topRow, casacore::Cube<casacore::Bool> &cube);
+
+  /// @brief apply row-based flags to the packed flags
+  /// @details Whole rows are flagged by setting ranges of bits.
+  /// @param[in] topRow row of the table corresponding to the first row of the flags
+  /// @param[in] flags packed flags to work with
+  inline void flagRowsPacked(casacore::rownr_t topRow, PackedFlags &flags);
+protected:
+  /// @brief read FLAG_ROW for a range of rows
+  /// @details The column is read with a single call.
+  /// @param[in] topRow the first row to read
+  /// @param[in] nRow number of rows to read
+  /// @return vector with row-based flags
+  inline casacore::Vector<casacore::Bool> rowFlags(casacore::rownr_t topRow, casacore::uInt nRow) const;
 private:
-  /// @brief accessor to the FLAG_ROW column
-  ROScalarColumn<casacore::Bool> itsFlagRowCol;
-  /// @brief true if the dataset has FLAG_ROW column
-  bool itsHasFlagRow;
+  /// @brief accessor to the FLAG_ROW column (NULL if the dataset has no FLAG_ROW column)
+  const ROScalarColumn<casacore::Bool> *itsFlagRowCol;
 };
 
-WholeRowFlagger<casacore::Bool>::WholeRowFlagger(const casacore::Table &iteration) :
-    itsHasFlagRow(iteration.tableDesc().isColumn("FLAG_ROW"))
+WholeRowFlagger<casacore::Bool>::WholeRowFlagger(const TableColumnHandles &columns) :
+    itsFlagRowCol(columns.hasColumn("FLAG_ROW") ? &columns.scalarColumn<casacore::Bool>("FLAG_ROW") : NULL)
+{
+}
+
+casacore::Vector<casacore::Bool> WholeRowFlagger<casacore::Bool>::rowFlags(casacore::rownr_t topRow,
+                 casacore::uInt nRow) const
+{
+  ASKAPDEBUGASSERT(itsFlagRowCol != NULL);
+  ASKAPDEBUGASSERT(!itsFlagRowCol->isNull());
+  return itsFlagRowCol->getColumnRange(Slicer(IPosition(1, topRow), IPosition(1, nRow)));
+}
+
+void WholeRowFlagger<casacore::Bool>::flagRows(casacore::rownr_t topRow,
+                 casacore::Cube<casacore::Bool> &cube)
 {
-  if (itsHasFlagRow) {
-      itsFlagRowCol.attach(iteration, "FLAG_ROW");
+  if ((itsFlagRowCol != NULL) && (cube.nrow() > 0)) {
+      const casacore::Vector<casacore::Bool> flagRow = rowFlags(topRow, cube.nrow());
+      for (casacore::uInt row = 0; row < cube.nrow(); ++row) {
+           if (flagRow[row]) {
+               cube.yzPlane(row) = true;
+           }
+      }
   }
 }
 
-bool WholeRowFlagger<casacore::Bool>::copyRequired(casacore::uInt row,
+void WholeRowFlagger<casacore::Bool>::flagRowsNative(casacore::rownr_t topRow,
                  casacore::Cube<casacore::Bool> &cube)
 {
-  ASKAPDEBUGASSERT(!itsFlagRowCol.isNull());
-  if (itsHasFlagRow) {
-      if (itsFlagRowCol.asBool(row)) {
-          cube.yzPlane(row) = true;
-          return false;
+  if ((itsFlagRowCol != NULL) && (cube.nplane() > 0)) {
+      const casacore::Vector<casacore::Bool> flagRow = rowFlags(topRow, cube.nplane());
+      for (casacore::uInt row = 0; row < cube.nplane(); ++row) {
+           if (flagRow[row]) {
+               cube.xyPlane(row) = true;
+           }
+      }
+  }
+}
+
+void WholeRowFlagger<casacore::Bool>::flagRowsPacked(casacore::rownr_t topRow,
+                 PackedFlags &flags)
+{
+  if ((itsFlagRowCol != NULL) && (flags.nRow() > 0)) {
+      const casacore::Vector<casacore::Bool> flagRow = rowFlags(topRow, flags.nRow());
+      for (casacore::uInt row = 0; row < flags.nRow(); ++row) {
+           if (flagRow[row]) {
+               flags.flagRow(row);
+           }
       }
   }
-  return true;
 }
 
+/// @brief helper object function to convert sigma into noise
+/// @details It is used with nativeToAccessorOrder to fill the noise
+/// cube from SIGMA_SPECTRUM. The same noise is assumed for both real and
+/// imaginary parts.
+/// @ingroup dataaccess_tab
+struct SigmaToNoise {
+  /// @brief conversion operator
+  /// @param[in] sigma noise figure read from the table
+  /// @return complex noise
+  inline casacore::Complex operator()(casacore::Float sigma) const
+  { return casacore::Complex(sigma, sigma); }
+};
+
+/// @brief helper traits class giving the value for the channels outside the band
+/// @details If the frequency selection extends beyond the band of the spectral window,
+/// the data for the missing channels are padded with this value. The general case
+/// (visibilities) is zero.
+/// @ingroup dataaccess_tab
+template<typename T>
+struct OutOfBandValue {
+  /// @return the value for the channels outside the band
+  static inline T value() { return T(0); }
+};
+
+/// @brief channels outside the band are flagged
+/// @ingroup dataaccess_tab
+template<>
+struct OutOfBandValue<casacore::Bool> {
+  /// @return the value for the channels outside the band
+  static inline casacore::Bool value() { return casacore::True; }
+};
+
+/// @brief unit noise is assumed for the channels outside the band
+/// @ingroup dataaccess_tab
+template<>
+struct OutOfBandValue<casacore::Float> {
+  /// @return the value for the channels outside the band
+  static inline casacore::Float value() { return 1.; }
+};
 
 } // namespace accessors
 
@@ -146,61 +249,125 @@ bool WholeRowFlagger<casacore::Bool>::copyRequired(casacore::uInt row,
 /// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads
 /// to initialisation of a new UVW Machine
 /// @param[in] maxChunkSize maximum number of rows per accessor
+/// @param[in] plan shared partition plan, if the iterator should only cover one
+/// partition of the selected rows (empty shared pointer means no partitioning)
+/// @param[in] part partition to iterate over (ignored if no partition plan is given)
 TableConstDataIterator::TableConstDataIterator(
             const boost::shared_ptr<ITableManager const> &msManager,
             const boost::shared_ptr<ITableDataSelectorImpl const> &sel,
             const boost::shared_ptr<IDataConverterImpl const> &conv,
             size_t cacheSize, double tolerance,
-            casacore::uInt maxChunkSize) :
+            casacore::uInt maxChunkSize,
+            const boost::shared_ptr<TablePartitionPlan const> &plan,
+            casacore::uInt part) :
         TableInfoAccessor(msManager),
         // it is essential that accessor is initialised after cache parameters!
-	    itsUVWCacheSize(cacheSize), itsUVWCacheTolerance(tolerance),
+	    itsUVWCacheSize(cacheSize), itsUVWCacheTolerance(tolerance), itsRotatedUVWCacheSize(1),
 	    itsAccessor(*this),
 #ifndef ASKAP_DEBUG
         itsSelector(sel->clone()),
 	    itsConverter(conv->clone()),
 #endif
 	    itsMaxChunkSize(maxChunkSize),
-        itsAtStart(false)
+        itsCurrentTopRow(0), itsNumberOfRows(0), itsIterationStartRow(0), itsIterationEndRow(0),
+        itsAtStart(false), itsFreqChannelAveraging(1), itsLeadingOutOfBand(0), itsTrailingOutOfBand(0),
+        itsIterationStep(0), itsTabIteratorAhead(false),
+        itsPartitionPlan(plan), itsPartition(part), itsUseTimeIndex(false), itsTimeIndexStep(0),
+        itsReducedFootprint(false), itsCompactFlags(false), itsChunkMemoryBudget(0),
+        itsValidateParallacticAngle(false),
+        itsTableMutex(plan ? plan->tableMutex() : boost::shared_ptr<boost::recursive_mutex>())
 {
   ASKAPDEBUGASSERT(conv);
   ASKAPDEBUGASSERT(sel);
+  ASKAPCHECK(!itsPartitionPlan || (itsPartition < itsPartitionPlan->nParts()), "Partition "<<itsPartition<<
+             " is requested, but the plan has only "<<itsPartitionPlan->nParts()<<" partition(s)");
   #ifdef ASKAP_DEBUG
     itsConverter = conv->clone();
     itsSelector  = sel->clone();
   #endif
+  // the column caches are filled with the table mutex locked, as the table is shared
+  // with the read-ahead job and iterators over other partitions
+  itsColumns.setTableMutex(itsTableMutex);
   init();
 }
 
+/// @brief destructor
+/// @details The read-ahead job is stopped first. Table objects are reference counted
+/// and the table may be shared with iterators used in other threads, so they are released
+/// with the table mutex locked.
+TableConstDataIterator::~TableConstDataIterator()
+{
+  itsReadAhead.reset();
+  TableAccessGuard guard(itsTableMutex);
+  itsColumns.detach();
+  itsTabIterator = casacore::TableIterator();
+  itsCurrentIteration = casacore::Table();
+  itsSelectedTable = casacore::Table();
+  itsTimeIndex.reset();
+  itsPartitionPlan.reset();
+}
+
 /// Restart the iteration from the beginning
 void TableConstDataIterator::init()
 {
     ASKAPTRACE("TableConstDataIterator::init");
   // avoid doing this if not required as it can be expensive
   if (!itsAtStart) {
-      itsCurrentTopRow=0;
-      itsCurrentDataDescID=-100; // this value can't be in the table,
-                                 // therefore it is a flag of a new data descriptor
-      itsCurrentFieldID = -100; // this value can't be in the table,
-                                // therefore it is a flag of a new field ID
-      // by default use FIELD_ID column if it exists, otherwise use time to select
-      // pointings
-      itsUseFieldID = table().actualTableDesc().isColumn("FIELD_ID");
-
-      const casacore::TableExprNode &exprNode =
-                  itsSelector->getTableSelector(itsConverter);
-      if (exprNode.isNull()) {
-          itsTabIterator=casacore::TableIterator(table(),"TIME",
-    	     casacore::TableIterator::Ascending,casacore::TableIterator::NoSort);
-      } else {
-          itsTabIterator=casacore::TableIterator(table()(itsSelector->
-                                   getTableSelector(itsConverter)),"TIME",
-    	     casacore::TableIterator::Ascending,casacore::TableIterator::NoSort);
+      if (itsReadAhead) {
+          // discard the data read for the previous iteration loop
+          itsReadAhead->reset();
       }
-      itsChannelsSelected = false;
-      itsFlagData = false;
-      setUpIteration();
-      itsAtStart = true;
+      {
+         TableAccessGuard guard(itsTableMutex);
+         itsTabIteratorAhead = false;
+         itsIterationStep = 0;
+         itsCurrentTopRow=0;
+         itsCurrentDataDescID=-100; // this value can't be in the table,
+                                    // therefore it is a flag of a new data descriptor
+         itsCurrentFieldID = -100; // this value can't be in the table,
+                                   // therefore it is a flag of a new field ID
+         // by default use FIELD_ID column if it exists, otherwise use time to select
+         // pointings
+         itsUseFieldID = table().actualTableDesc().isColumn("FIELD_ID");
+         // presence of the noise columns is checked once here, rather than for
+         // every chunk while the read-ahead job may be accessing the table
+         itsHasSigmaSpectrum = table().actualTableDesc().isColumn("SIGMA_SPECTRUM");
+         itsHasSigma = table().actualTableDesc().isColumn("SIGMA");
+
+         casacore::Table selectedTable;
+         if (itsPartitionPlan) {
+             // the selection is already applied to the partition
+             selectedTable = itsPartitionPlan->partition(itsPartition);
+         } else if (itsUseTimeIndex && !itsIndexFileDirectory.empty()) {
+             selectedTable = selectRowsWithIndexFile();
+         } else {
+             const casacore::TableExprNode &exprNode =
+                         itsSelector->getTableSelector(itsConverter);
+             selectedTable = exprNode.isNull() ? table() : table()(exprNode);
+         }
+         // columns are attached again in setUpIteration
+         itsColumns.detach();
+         if (itsUseTimeIndex) {
+             // the index is reused if it has been built (or given) for the same selection,
+             // a persistent index is only trusted if its key has been checked
+             const std::string selectionKey = itsSelector->getSelectionKey(itsConverter);
+             if (!itsTimeIndex || !itsTimeIndex->matches(selectedTable, selectionKey) ||
+                 (itsIndexFileDirectory.empty() && !itsTimeIndex->key().empty())) {
+                 itsTimeIndex.reset(new TableTimeIndex(selectedTable, selectionKey));
+             }
+             itsSelectedTable = selectedTable;
+             itsTimeIndexStep = 0;
+             itsTabIterator = casacore::TableIterator();
+         } else {
+             itsTabIterator=casacore::TableIterator(selectedTable,"TIME",
+           	     casacore::TableIterator::Ascending,casacore::TableIterator::NoSort);
+         }
+         itsChannelsSelected = false;
+         itsFlagData = false;
+         setUpIteration();
+         itsAtStart = true;
+      }
+      updateReadAhead();
   }
 }
 
@@ -215,10 +382,10 @@ const IConstDataAccessor& TableConstDataIterator::operator*() const
 /// @return True if there are more data available
 casacore::Bool TableConstDataIterator::hasMore() const throw()
 {
-  if (!itsTabIterator.pastEnd()) {
+  if (itsTabIteratorAhead || !timeIterationPastEnd()) {
       return true;
   }
-  if (itsCurrentTopRow+itsNumberOfRows<itsCurrentIteration.nrow()) {
+  if (itsCurrentTopRow+itsNumberOfRows<itsIterationEndRow) {
       return true;
   }
   return false;
@@ -230,45 +397,314 @@ casacore::Bool TableConstDataIterator::hasMore() const throw()
 casacore::Bool TableConstDataIterator::next()
 {
   ASKAPTRACE("TableConstDataIterator::next");
-  itsAtStart = false;
-  itsCurrentTopRow+=itsNumberOfRows;
-  if (itsCurrentTopRow>=itsCurrentIteration.nrow()) {
-      ASKAPDEBUGASSERT(!itsTabIterator.pastEnd());
-      itsCurrentTopRow=0;
-      // need to advance table iterator further
-      itsTabIterator.next();
-      if (!itsTabIterator.pastEnd()) {
-          setUpIteration();
+  {
+     // the table is accessed from the background thread if read-ahead is enabled
+     TableAccessGuard guard(itsTableMutex);
+     itsAtStart = false;
+     itsCurrentTopRow+=itsNumberOfRows;
+     if (itsCurrentTopRow>=itsIterationEndRow) {
+         ++itsIterationStep;
+         // need to advance table iterator further, unless it has
+         // already been done to read the next chunk in advance
+         if (itsTabIteratorAhead) {
+             itsTabIteratorAhead = false;
+         } else {
+             ASKAPDEBUGASSERT(!timeIterationPastEnd());
+             advanceTimeIteration();
+         }
+         if (!timeIterationPastEnd()) {
+             // this also sets the top row to the start of the new iteration
+             setUpIteration();
+         }
+     } else {
+         casacore::rownr_t remainder=itsIterationEndRow-itsCurrentTopRow;
+         itsNumberOfRows=remainder<=itsMaxChunkSize ?
+                         remainder : itsMaxChunkSize;
+         itsAccessor.invalidateIterationCaches();
+         // itsDirectionCache don't need invalidation because the time is the same
+         // as for the previous iteration
+
+         // determine whether DATA_DESC_ID is uniform in the whole chunk
+         // and reduce itsNumberOfRows if necessary
+         makeUniformDataDescID();
+
+         // the shape is known now, reduce itsNumberOfRows if the chunk
+         // doesn't fit into the memory budget
+         applyMemoryBudget();
+
+         // determine whether FIELD_ID is uniform in the whole chunk
+         // and reduce itsNumberOfRows if necessary
+         // invalidate direction cache if necessary.
+         // do nothing if itsUseFieldID is false
+         makeUniformFieldID();
+     }
+  }
+  updateReadAhead();
+  return hasMore();
+}
+
+/// @brief enable asynchronous read-ahead
+/// @details When enabled, visibilities, flags, noise and uvw for the next chunk
+/// are read in a background thread while the current chunk is processed.
+/// @param[in] maxMemory maximum memory in bytes for both current and next chunk buffers
+void TableConstDataIterator::enableReadAhead(size_t maxMemory)
+{
+  if (!itsReadAhead) {
+      if (!itsTableMutex) {
+          // the table will be accessed from the background thread
+          itsTableMutex.reset(new boost::recursive_mutex);
+          itsColumns.setTableMutex(itsTableMutex);
       }
-  } else {
-      casacore::rownr_t remainder=itsCurrentIteration.nrow()-itsCurrentTopRow;
-      itsNumberOfRows=remainder<=itsMaxChunkSize ?
-                      remainder : itsMaxChunkSize;
+      itsReadAhead.reset(new TableReadAheadBuffer(maxMemory, itsCompactFlags, itsTableMutex));
+      // the memory per row includes the read-ahead buffers now
+      if ((itsNumberOfRows > 0) && applyMemoryBudget()) {
+          itsAccessor.invalidateIterationCaches();
+      }
+      updateReadAhead();
+  }
+}
+
+/// @brief reduce the memory footprint of the bulk data
+/// @details In this mode, the single precision and real-valued representations of
+/// the accessor fields (see TableConstDataAccessor::uvwComponentsFloat, frequencyFloat and
+/// noiseReal) are filled without keeping the double precision or complex intermediates
+/// in the accessor cache. Optionally, flags read in advance are held as a bit mask.
+/// @param[in] compactFlags if true, the read-ahead buffer holds flags as a bit mask
+/// (this method should be called before enableReadAhead for this to take effect)
+/// @note This method should be called before setChunkMemoryBudget, as the memory
+/// estimate per row depends on this mode (an exception is thrown otherwise).
+void TableConstDataIterator::enableReducedFootprint(bool compactFlags)
+{
+  ASKAPCHECK(itsChunkMemoryBudget == 0, "The reduced footprint mode should be enabled before "
+             "the chunk memory budget is set");
+  itsReducedFootprint = true;
+  itsCompactFlags = compactFlags;
+}
+
+/// @brief limit the memory taken by each chunk
+/// @details The number of rows per chunk is derived from the memory budget and the
+/// estimated memory per row (see memoryPerRow), which depends on the number of channels
+/// and polarisations known after the shape of the data is determined for the current
+/// DATA_DESC_ID, as well as on the enabled features (read-ahead, reduced footprint mode).
+/// The limit on the number of rows given in the constructor still applies. At least
+/// one row is returned in every chunk regardless of the budget.
+/// @param[in] maxBytes memory budget in bytes (0 means no limit)
+/// @note This method should be called before enableReadAhead.
+void TableConstDataIterator::setChunkMemoryBudget(size_t maxBytes)
+{
+  ASKAPCHECK(!itsReadAhead, "The chunk memory budget should be set before read-ahead is enabled");
+  itsChunkMemoryBudget = maxBytes;
+  // the current chunk has been set up without the budget
+  if ((itsNumberOfRows > 0) && applyMemoryBudget()) {
       itsAccessor.invalidateIterationCaches();
-      // itsDirectionCache don't need invalidation because the time is the same
-      // as for the previous iteration
+  }
+}
 
-      // determine whether DATA_DESC_ID is uniform in the whole chunk
-      // and reduce itsNumberOfRows if necessary
-      makeUniformDataDescID();
+/// @brief set the number of tangent points in the cache of rotated uvw and delays
+/// @details Rotated uvw and delays are cached in the accessor for the given number of
+/// tangent points (see TableConstDataAccessor::setRotatedUVWCacheSize). This is taken into
+/// account in the memory estimate used with the chunk memory budget.
+/// @param[in] nTangentPoints a number of tangent points (should be positive)
+/// @note This method should be called before setChunkMemoryBudget (an exception is
+/// thrown otherwise).
+void TableConstDataIterator::setRotatedUVWCacheSize(size_t nTangentPoints)
+{
+  ASKAPCHECK(itsChunkMemoryBudget == 0, "The size of the rotated uvw cache should be set before "
+             "the chunk memory budget is set");
+  itsAccessor.setRotatedUVWCacheSize(nTangentPoints);
+  itsRotatedUVWCacheSize = nTangentPoints;
+}
 
-      // determine whether FIELD_ID is uniform in the whole chunk
-      // and reduce itsNumberOfRows if necessary
-      // invalidate direction cache if necessary.
-      // do nothing if itsUseFieldID is false
-      makeUniformFieldID();
+/// @brief enable or disable validation of parallactic angles
+/// @details Parallactic angles are computed analytically from the antenna latitudes,
+/// hour angle and declination. In the validation mode, they are also computed with
+/// casacore measures for each antenna (which is much slower) and an exception is thrown
+/// if the results disagree.
+/// @param[in] validate true to enable the validation mode
+void TableConstDataIterator::setParallacticAngleValidation(bool validate)
+{
+  itsValidateParallacticAngle = validate;
+  itsParallacticAngleCache.invalidate();
+  itsDirectionCache.invalidate();
+}
+
+/// @brief iterate over time steps using the time index
+/// @details Instead of casacore::TableIterator, which creates a reference table for each
+/// time step, the TIME column of the selected rows is scanned once and the chunks are served
+/// as row ranges of the selected table. The iterator is rewound to the start.
+/// @param[in] index index to use (e.g. obtained from another iterator with the same selection),
+/// a new index is built if the shared pointer is empty or the index doesn't match the selection
+void TableConstDataIterator::enableTimeIndex(const boost::shared_ptr<TableTimeIndex const> &index)
+{
+  itsUseTimeIndex = true;
+  itsTimeIndex = index;
+  // force the restart
+  itsAtStart = false;
+  init();
+}
+
+/// @brief activate the read-ahead buffer for the current chunk and schedule the next one
+/// @details This method does nothing if read-ahead is not enabled. It should be called
+/// when the iterator is set up for the new chunk, without the table mutex locked. The
+/// table iterator may be advanced beyond the current iteration here (see itsTabIteratorAhead).
+void TableConstDataIterator::updateReadAhead()
+{
+  if (!itsReadAhead) {
+      return;
+  }
+  if (!hasMore() || (inBandChannels() == 0)) {
+      // nothing to read if the whole frequency selection is outside the band
+      itsReadAhead->reset();
+      return;
+  }
+  TableReadAheadBuffer::Chunk current;
+  TableReadAheadBuffer::Chunk next;
+  {
+     TableAccessGuard guard(itsTableMutex);
+     const std::pair<casacore::uInt, casacore::uInt> chanRange = getChannelRange();
+     current.itsStep = itsIterationStep;
+     current.itsTopRow = itsCurrentTopRow;
+     current.itsNumberOfRows = itsNumberOfRows;
+     // raw channels are read, averaging (if any) is done on demand. The channels outside
+     // the band (if any) are padded after the data are taken from the buffer
+     current.itsNumberOfChannels = inBandChannels();
+     current.itsStartChannel = chanRange.second;
+     current.itsNumberOfPols = itsNumberOfPols;
+     current.itsDataColumn = getDataColumnName();
+     current.itsHasSigmaSpectrum = itsHasSigmaSpectrum;
+     // the next chunk is guessed assuming the same channels and polarisations, the data
+     // will be discarded if it doesn't match the actual chunk
+     next = current;
+     next.itsTopRow += itsNumberOfRows;
+     casacore::rownr_t nextEndRow = itsIterationEndRow;
+     if (next.itsTopRow < itsIterationEndRow) {
+         next.itsTable = itsCurrentIteration;
+     } else {
+         if (!itsTabIteratorAhead) {
+             advanceTimeIteration();
+             itsTabIteratorAhead = true;
+         }
+         next.itsTopRow = 0;
+         nextEndRow = 0;
+         ++next.itsStep;
+         if (!timeIterationPastEnd()) {
+             getTimeIteration(next.itsTable, next.itsTopRow, nextEndRow);
+         }
+     }
+     const casacore::rownr_t remainder = next.itsTable.isNull() ? 0 : nextEndRow - next.itsTopRow;
+     const casacore::uInt maxRows = maxRowsWithinBudget();
+     next.itsNumberOfRows = remainder <= maxRows ? remainder : maxRows;
+  }
+  itsReadAhead->activate(current);
+  if (itsNumberOfRows > 0) {
+      // cheap per-row metadata are read before the background job starts, so the
+      // processing of the current chunk doesn't need to wait for the table access
+      itsAccessor.time();
+      itsAccessor.antenna1();
+      itsAccessor.antenna2();
+      itsAccessor.feed1();
+      itsAccessor.feed2();
+  }
+  itsReadAhead->schedule(next);
+}
+
+/// @brief check whether all time steps have been processed
+/// @details This method encapsulates the difference between iteration with
+/// casacore::TableIterator and with the time index
+/// @return true, if the table iterator (or the position in the time index) is past the end
+bool TableConstDataIterator::timeIterationPastEnd() const throw()
+{
+  if (itsUseTimeIndex) {
+      return !itsTimeIndex || (itsTimeIndexStep >= itsTimeIndex->nSteps());
+  }
+  return itsTabIterator.pastEnd();
+}
+
+/// @brief advance the table iterator (or the position in the time index) to the next time step
+void TableConstDataIterator::advanceTimeIteration()
+{
+  if (itsUseTimeIndex) {
+      ++itsTimeIndexStep;
+  } else {
+      itsTabIterator.next();
+  }
+}
+
+/// @brief apply the selection using the index file
+/// @details The persistent time index is loaded from the file (unless the current index
+/// has the same key) and the selected rows are taken from it. If the file can't be used,
+/// the selection expression is evaluated, the index is built and written to the file.
+/// @return table with the selected rows
+casacore::Table TableConstDataIterator::selectRowsWithIndexFile()
+{
+  ASKAPDEBUGASSERT(itsUseTimeIndex && !itsPartitionPlan);
+  const std::string key = TableTimeIndex::makeKey(table(),
+                          itsSelector->getSelectionKey(itsConverter));
+  const std::string fileName = TableTimeIndex::fileName(itsIndexFileDirectory, table(), key);
+  if (!itsTimeIndex || (itsTimeIndex->key() != key)) {
+      itsTimeIndex = TableTimeIndex::load(fileName, key);
+  }
+  if (itsTimeIndex) {
+      return itsTimeIndex->selectRows(table());
+  }
+  const casacore::TableExprNode &exprNode = itsSelector->getTableSelector(itsConverter);
+  const casacore::Table selectedTable = exprNode.isNull() ? table() : table()(exprNode);
+  const boost::shared_ptr<TableTimeIndex> index(new TableTimeIndex(selectedTable, table(), key));
+  index->save(fileName);
+  itsTimeIndex = index;
+  return selectedTable;
+}
+
+/// @brief obtain the table and the rows of the time step the table iterator points to
+/// @details With casacore::TableIterator, the table is the reference table created by
+/// the iterator and all its rows are used. With the time index, it is the selected table and
+/// the rows are those of the current time step.
+/// @param[out] tab table to read the data from
+/// @param[out] startRow the first row of the time step
+/// @param[out] endRow the first row after the time step
+void TableConstDataIterator::getTimeIteration(casacore::Table &tab, casacore::rownr_t &startRow,
+                                              casacore::rownr_t &endRow) const
+{
+  if (itsUseTimeIndex) {
+      ASKAPDEBUGASSERT(itsTimeIndex);
+      tab = itsSelectedTable;
+      if (itsTimeIndexStep < itsTimeIndex->nSteps()) {
+          startRow = itsTimeIndex->startRow(itsTimeIndexStep);
+          endRow = itsTimeIndex->endRow(itsTimeIndexStep);
+      } else {
+          // empty selection
+          startRow = endRow = itsTimeIndex->nRows();
+      }
+  } else {
+      tab = itsTabIterator.table();
+      startRow = 0;
+      endRow = tab.nrow();
   }
-  return hasMore();
 }
 
 /// setup accessor for a new iteration of the table iterator
 void TableConstDataIterator::setUpIteration()
 {
-  itsCurrentIteration=itsTabIterator.table();
+  if (itsUseTimeIndex && itsColumns.isAttached()) {
+      // all time steps are row ranges of the same table, columns stay attached
+      casacore::Table dummy;
+      getTimeIteration(dummy, itsIterationStartRow, itsIterationEndRow);
+  } else {
+      getTimeIteration(itsCurrentIteration, itsIterationStartRow, itsIterationEndRow);
+      // columns are attached on demand
+      itsColumns.attach(itsCurrentIteration);
+      if (itsUseTimeIndex) {
+          // runs of DATA_DESC_ID and FIELD_ID stored in the persistent index
+          ASKAPDEBUGASSERT(itsTimeIndex);
+          itsTimeIndex->setColumnRuns(itsColumns);
+      }
+  }
+  itsCurrentTopRow = itsIterationStartRow;
   itsAccessor.invalidateIterationCaches();
 
-  itsNumberOfRows=itsCurrentIteration.nrow()<=itsMaxChunkSize ?
-                  itsCurrentIteration.nrow() : itsMaxChunkSize;
+  const casacore::rownr_t nRowsThisIteration = itsIterationEndRow - itsIterationStartRow;
+  itsNumberOfRows=nRowsThisIteration<=itsMaxChunkSize ?
+                  nRowsThisIteration : itsMaxChunkSize;
 
   if ((itsDirectionCache.isValid() || itsParallacticAngleCache.isValid())
        && itsCurrentDataDescID>=0) {
@@ -301,6 +737,10 @@ void TableConstDataIterator::setUpIteration()
       // set up visibility cube shape if necessary
       makeUniformDataDescID();
 
+      // the shape is known now, reduce itsNumberOfRows if the chunk
+      // doesn't fit into the memory budget
+      applyMemoryBudget();
+
       // determine whether FIELD_ID is uniform in the whole chink
       // and reduce itsNumberOfRows if necessary
       // invalidate direction cache if necessary.
@@ -331,14 +771,17 @@ void TableConstDataIterator::makeUniformDataDescID()
 {
   ASKAPDEBUGASSERT(itsNumberOfRows);
   ASKAPDEBUGASSERT(itsCurrentTopRow+itsNumberOfRows<=
-                    itsCurrentIteration.nrow());
+                    itsIterationEndRow);
 
-  ROScalarColumn<Int> dataDescCol(itsCurrentIteration,"DATA_DESC_ID");
-  const Int newDataDescID=dataDescCol(itsCurrentTopRow);
+  // the whole column is read once per iteration, later chunks use the cached runs
+  casacore::rownr_t runEnd = 0;
+  const Int newDataDescID = itsColumns.intColumnRun("DATA_DESC_ID", itsCurrentTopRow, runEnd);
   ASKAPDEBUGASSERT(newDataDescID>=0);
   if (itsCurrentDataDescID!=newDataDescID) {
       itsAccessor.invalidateSpectralCaches();
       itsCurrentDataDescID=newDataDescID;
+      // polarisation products may be different for the new DATA_DESC_ID
+      itsPolTransform.resize(0,0);
       if (itsDirectionCache.isValid()) {
           // if-statement, because it is pointless to do further checks in the
           // case when the cache is already invalid due to
@@ -358,7 +801,7 @@ void TableConstDataIterator::makeUniformDataDescID()
       }
 
       // determine the shape of the visibility cube
-      ROArrayColumn<Complex> visCol(itsCurrentIteration,getDataColumnName());
+      const ROArrayColumn<Complex> &visCol = itsColumns.arrayColumn<Complex>(getDataColumnName());
       const casacore::IPosition shape=visCol.shape(itsCurrentTopRow);
       ASKAPASSERT(shape.size() && (shape.size()<3));
       itsNumberOfPols=shape[0];
@@ -367,8 +810,10 @@ void TableConstDataIterator::makeUniformDataDescID()
       if (itsSelector->channelsSelected()) {
           // validity checks that selection doesn't extend beyond the channels available
           const std::pair<int,int> chanSelection = itsSelector->getChannelSelection();
-          ASKAPCHECK(itsNumberOfChannels >= casacore::uInt(chanSelection.first + chanSelection.second),
-               "Channel selection from "<<chanSelection.second+1<<" to "<<chanSelection.first+
+          const casacore::uInt nAvg = itsSelector->getChannelAveraging();
+          ASKAPCHECK(itsNumberOfChannels >= casacore::uInt(chanSelection.first) * nAvg +
+               casacore::uInt(chanSelection.second),
+               "Channel selection from "<<chanSelection.second+1<<" to "<<chanSelection.first * nAvg +
                chanSelection.second<<" (1-based) extends beyond "<<itsNumberOfChannels<<
                " channel(s) available in  the dataset");
       }
@@ -380,12 +825,74 @@ void TableConstDataIterator::makeUniformDataDescID()
       itsChannelsSelected = false;
   }
 
-  for (uInt row=1;row<itsNumberOfRows;++row) {
-       if (dataDescCol(row+itsCurrentTopRow)!=itsCurrentDataDescID) {
-           itsNumberOfRows=row;
-	   break;
-       }
+  ASKAPDEBUGASSERT(runEnd > itsCurrentTopRow);
+  if (runEnd - itsCurrentTopRow < itsNumberOfRows) {
+      itsNumberOfRows = runEnd - itsCurrentTopRow;
+  }
+}
+
+/// @brief estimate the memory taken by one row of the current chunk
+/// @details The estimate includes the bulk fields of the accessor (visibilities, flags,
+/// noise, uvw), per-row metadata and, if enabled, the read-ahead buffers for the current
+/// and the next chunk. Single precision and compact representations are assumed in the
+/// reduced footprint mode.
+/// @return memory in bytes per row
+size_t TableConstDataIterator::memoryPerRow() const
+{
+  const size_t nSamples = size_t(nChannel()) * nPol();
+  const size_t nRawSamples = size_t(nChannel()) * channelAveraging() * itsNumberOfPols;
+  // visibilities and flags
+  size_t result = nSamples * (sizeof(casacore::Complex) + sizeof(casacore::Bool));
+  // noise and uvw (together with rotated uvw)
+  if (itsReducedFootprint) {
+      result += nSamples * sizeof(casacore::Float) + 6 * sizeof(casacore::Float);
+  } else {
+      result += nSamples * sizeof(casacore::Complex) + 6 * sizeof(casacore::Double);
+  }
+  // rotated uvw, their components and delays for additional tangent points
+  result += (itsRotatedUVWCacheSize - 1) * 7 * sizeof(casacore::Double);
+  // antenna and feed indices, parallactic angles and pointing directions
+  result += 4 * sizeof(casacore::uInt) + 2 * sizeof(casacore::Float) + 4 * sizeof(casacore::MVDirection);
+  if ((nRawSamples != nSamples) || itsSelector->polarisationsSelected()) {
+      // raw data are read before averaging and polarisation conversion
+      result += nRawSamples * (sizeof(casacore::Complex) + sizeof(casacore::Bool));
+  }
+  if (itsReadAhead) {
+      // buffers for the current and the next chunk
+      const size_t flagSize = itsCompactFlags ? (nRawSamples + 7) / 8 : nRawSamples * sizeof(casacore::Bool);
+      result += 2 * (nRawSamples * (sizeof(casacore::Complex) + sizeof(casacore::Float)) + flagSize +
+                     3 * sizeof(casacore::Double));
   }
+  return result;
+}
+
+/// @brief maximum number of rows allowed by the memory budget
+/// @details The shape of the current chunk is used, the result never exceeds itsMaxChunkSize
+/// and is at least 1.
+/// @return maximum number of rows per chunk
+casacore::uInt TableConstDataIterator::maxRowsWithinBudget() const
+{
+  if (itsChunkMemoryBudget == 0) {
+      return itsMaxChunkSize;
+  }
+  const size_t nRows = std::max(itsChunkMemoryBudget / memoryPerRow(), size_t(1));
+  return nRows < itsMaxChunkSize ? casacore::uInt(nRows) : itsMaxChunkSize;
+}
+
+/// @brief method ensures that the current chunk fits into the memory budget
+/// @details This method reduces itsNumberOfRows if necessary. It does nothing
+/// if the memory budget is not set.
+/// @return true, if itsNumberOfRows has been reduced
+bool TableConstDataIterator::applyMemoryBudget()
+{
+  if (itsChunkMemoryBudget > 0) {
+      const casacore::uInt maxRows = maxRowsWithinBudget();
+      if (itsNumberOfRows > maxRows) {
+          itsNumberOfRows = maxRows;
+          return true;
+      }
+  }
+  return false;
 }
 
 /// @brief method ensures that the chunk has a uniform FIELD_ID
@@ -400,10 +907,11 @@ void TableConstDataIterator::makeUniformFieldID()
   if (itsUseFieldID) {
       ASKAPDEBUGASSERT(itsNumberOfRows);
       ASKAPDEBUGASSERT(itsCurrentTopRow+itsNumberOfRows<=
-                       itsCurrentIteration.nrow());
+                       itsIterationEndRow);
 
-      ROScalarColumn<Int> fieldIDCol(itsCurrentIteration,"FIELD_ID");
-      const Int newFieldID=fieldIDCol(itsCurrentTopRow);
+      // the whole column is read once per iteration, later chunks use the cached runs
+      casacore::rownr_t runEnd = 0;
+      const Int newFieldID = itsColumns.intColumnRun("FIELD_ID", itsCurrentTopRow, runEnd);
       ASKAPDEBUGASSERT(newFieldID>=0);
       if (newFieldID != itsCurrentFieldID) {
           itsCurrentFieldID = newFieldID;
@@ -414,13 +922,135 @@ void TableConstDataIterator::makeUniformFieldID()
           itsDishPointingCache.invalidate();
       }
       // break the iteration if necessary
-      for (uInt row=1;row<itsNumberOfRows;++row) {
-           if (fieldIDCol(row+itsCurrentTopRow)!=itsCurrentFieldID) {
-               itsNumberOfRows=row;
-	           break;
-           }
+      ASKAPDEBUGASSERT(runEnd > itsCurrentTopRow);
+      if (runEnd - itsCurrentTopRow < itsNumberOfRows) {
+          itsNumberOfRows = runEnd - itsCurrentTopRow;
+      }
+  }
+}
+
+/// @brief read a chunk of an array column in the table order
+/// @details This method reads all rows of the current chunk in one go
+/// (with a single call to casacore) and returns the data in the order they
+/// are stored in the measurement set, i.e. nPol x nChannel x nRow. Only selected
+/// channels are read. This is much faster than reading the column row by row,
+/// because the per-cell overheads of the table system are avoided. If channel
+/// averaging is requested, the raw channels are returned.
+/// Selected channels outside the band are padded (see padOutOfBandChannels).
+/// @param[in] buf array to fill (resized as necessary)
+/// @param[in] columnName a name of the column to read
+template<typename T>
+bool TableConstDataIterator::readColumnChunk(casacore::Array<T> &buf,
+               const std::string &columnName) const
+{
+  if (itsReadAhead && itsReadAhead->get(columnName, buf)) {
+      // only the channels inside the band are read in advance
+      ASKAPDEBUGASSERT(buf.nelements() == size_t(itsNumberOfRows) * inBandChannels() * itsNumberOfPols);
+      padOutOfBandChannels(buf);
+      return true;
+  }
+  readColumnRows(buf, columnName, 0, itsNumberOfRows);
+  return false;
+}
+
+/// @brief pad the data read for the channels inside the band
+/// @details The array read from the table for inBandChannels() raw channels is
+/// expanded to all selected raw channels. The channels outside the band are filled
+/// with the value returned by OutOfBandValue for the given type.
+/// @param[in] buf array in the measurement set order (nPol x nChannel x nRow) to pad
+template<typename T>
+void TableConstDataIterator::padOutOfBandChannels(casacore::Array<T> &buf) const
+{
+  if (!outOfBandChannels()) {
+      return;
+  }
+  const casacore::uInt nRawChan = nChannel() * channelAveraging();
+  const casacore::uInt nInBand = inBandChannels();
+  const casacore::uInt nRows = nInBand > 0 ? casacore::uInt(buf.nelements() / (nInBand * itsNumberOfPols)) :
+                               casacore::uInt(buf.shape()[2]);
+  casacore::Array<T> padded(casacore::IPosition(3, itsNumberOfPols, nRawChan, nRows));
+  padded.set(OutOfBandValue<T>::value());
+  if (nInBand > 0) {
+      ASKAPDEBUGASSERT(buf.nelements() == size_t(nRows) * nInBand * itsNumberOfPols);
+      bool deleteIn, deleteOut;
+      const T *src = buf.getStorage(deleteIn);
+      T *dst = padded.getStorage(deleteOut);
+      const size_t inPerRow = size_t(nInBand) * itsNumberOfPols;
+      const size_t outPerRow = size_t(nRawChan) * itsNumberOfPols;
+      const size_t offset = size_t(itsLeadingOutOfBand) * itsNumberOfPols;
+      for (casacore::uInt row = 0; row < nRows; ++row) {
+           std::copy(src + row * inPerRow, src + (row + 1) * inPerRow, dst + row * outPerRow + offset);
       }
+      buf.freeStorage(src, deleteIn);
+      padded.putStorage(dst, deleteOut);
+  }
+  buf.reference(padded);
+}
+
+/// @brief read a range of rows of an array column in the table order
+/// @details This is the same as readColumnChunk, but only the given rows of the current
+/// chunk are read (directly from the table). It allows processing of the chunk in blocks
+/// of rows without holding the whole column in memory. Row-based flags are not applied.
+/// @param[in] buf array to fill (resized to nPol x nChannel x nRows)
+/// @param[in] columnName a name of the column to read
+/// @param[in] startRow the first row to read (relative to the current chunk)
+/// @param[in] nRows number of rows to read
+template<typename T>
+void TableConstDataIterator::readColumnRows(casacore::Array<T> &buf, const std::string &columnName,
+               casacore::uInt startRow, casacore::uInt nRows) const
+{
+  ASKAPDEBUGASSERT(startRow + nRows <= itsNumberOfRows);
+  // raw channels are read if averaging is requested, only those inside the band
+  // are read from the table
+  const casacore::uInt nChan = inBandChannels();
+  if (nChan == 0) {
+      // the whole selection is outside the band, nothing to read
+      buf.resize(casacore::IPosition(3, itsNumberOfPols, 0, nRows));
+      padOutOfBandChannels(buf);
+      return;
+  }
+  TableAccessGuard guard(itsTableMutex);
+  const casacore::uInt startChan = startChannel();
+  const casacore::rownr_t topRow = itsCurrentTopRow + startRow;
+
+  const ROArrayColumn<T> &tableCol = itsColumns.arrayColumn<T>(columnName);
+  // the first row is checked here against the data description, consistency of the
+  // shape across the chunk is checked by casacore when the data are read
+  const casacore::IPosition shape = tableCol.shape(topRow);
+  ASKAPASSERT(shape.size() && (shape.size()<3));
+  const casacore::uInt thisRowNumberOfPols=shape[0];
+  const casacore::uInt thisRowNumberOfChannels = shape.size() > 1 ? shape[1] : 1;
+  if (thisRowNumberOfPols!=itsNumberOfPols) {
+      ASKAPTHROW(DataAccessError,"Number of polarizations is not "
+                 "conformant for row "<<topRow<<" of the "<<columnName<<
+                 " column");
+  }
+  if (thisRowNumberOfChannels!=itsNumberOfChannels) {
+      ASKAPTHROW(DataAccessError,"Number of channels is not "
+                 "conformant for row "<<topRow<<" of the "<<columnName<<
+                 " column");
+  }
+  const Slicer rowSlicer(IPosition(1,topRow),IPosition(1,nRows));
+  try {
+     if (shape.size() == 1) {
+         // degenerate channel axis, nothing to select
+         ASKAPDEBUGASSERT((nChan == 1) && (startChan == 0));
+         tableCol.getColumnRange(rowSlicer, buf, True);
+         // add the channel axis to get the same layout as in the general case
+         buf.reference(buf.reform(IPosition(3, itsNumberOfPols, 1, nRows)));
+     } else {
+         // Setup a slicer to extract the specified channel range only
+         const Slicer chanSlicer(Slice(),Slice(startChan,nChan));
+         tableCol.getColumnRange(rowSlicer, chanSlicer, buf, True);
+     }
+  }
+  catch (const casacore::AipsError &ae) {
+     ASKAPTHROW(DataAccessError, "Unable to read "<<nRows<<" rows of the "<<columnName<<
+                " column starting from row "<<topRow<<
+                ", most likely the shape is not conformant across the chunk. AipsError: "<<ae.what());
   }
+  ASKAPDEBUGASSERT(buf.nelements() == size_t(nRows) * nChan * itsNumberOfPols);
+  padOutOfBandChannels(buf);
 }
 
 /// @brief read an array column of the table into a cube
@@ -434,52 +1064,139 @@ template<typename T>
 void TableConstDataIterator::fillCube(casacore::Cube<T> &cube,
                const std::string &columnName) const
 {
-  const casacore::uInt nChan = nChannel();
-  const casacore::uInt startChan = startChannel();
+  cube.resize(itsNumberOfRows, nChannel(), nPol());
+  if (itsNumberOfRows == 0) {
+      return;
+  }
 
-  // Setup a slicer to extract the specified channel range only
-  const Slicer chanSlicer(Slice(),Slice(startChan,nChan));
-
-  cube.resize(itsNumberOfRows, nChan, itsNumberOfPols);
-  ROArrayColumn<T> tableCol(itsCurrentIteration,columnName);
-
-  // helper class, which does nothing for visibility cube, but checks
-  // FLAG_ROW for flagging
-  WholeRowFlagger<T> wrFlagger(itsCurrentIteration);
-
-  // temporary buffer declared outside the loop
-  casacore::Matrix<T> buf(itsNumberOfPols, nChan);
-  for (uInt row=0; row<itsNumberOfRows; ++row) {
-       const casacore::IPosition shape = tableCol.shape(row);
-       ASKAPASSERT(shape.size() && (shape.size()<3));
-       const casacore::uInt thisRowNumberOfPols=shape[0];
-       const casacore::uInt thisRowNumberOfChannels = shape.size() > 1 ? shape[1] : 1;
-       if (thisRowNumberOfPols!=itsNumberOfPols) {
-           ASKAPTHROW(DataAccessError,"Number of polarizations is not "
-	               "conformant for row "<<row<<" of the "<<columnName<<
-	               "column");
-       }
-       if (thisRowNumberOfChannels!=itsNumberOfChannels) {
-           ASKAPTHROW(DataAccessError,"Number of channels is not "
-	               "conformant for row "<<row<<" of the "<<columnName<<
-	               "column");
-       }
-       // for now just copy. In the future we will pass this array through
-       // the transformation which will do averaging, selection,
-       // polarization conversion
-
-       if (wrFlagger.copyRequired(row + itsCurrentTopRow, cube)) {
-           // Extract slice for this row
-           tableCol.getSlice(row + itsCurrentTopRow, chanSlicer, buf, False);
-
-           // Copy the slice into the cube
-           for (uInt chan = 0; chan < nChan; ++chan) {
-               for (uInt pol = 0; pol < itsNumberOfPols; ++pol) {
-                   cube(row,chan,pol) = buf(pol,chan);
-               }
-           }
-       }
+  // read the whole chunk in the table order (pol, chan, row), average
+  // channels and convert polarisations if necessary and transpose it
+  // into (row, chan, pol) in one pass.
+  casacore::Array<T> buf;
+  readConvertedChunk(buf, columnName);
+  nativeToAccessorOrder(buf, cube);
+}
+
+/// @brief read a chunk of an array column with row-based flags applied
+/// @details This is a wrapper around readColumnChunk which also takes FLAG_ROW into
+/// account (for flags only). The result is in the measurement set order and is not averaged.
+/// @param[in] buf array to fill (resized as necessary)
+/// @param[in] columnName a name of the column to read
+template<typename T>
+void TableConstDataIterator::readNativeChunk(casacore::Array<T> &buf,
+               const std::string &columnName) const
+{
+  const bool readInAdvance = readColumnChunk(buf, columnName);
+  if (!readInAdvance) {
+      // helper class, which does nothing for visibility cube, but checks
+      // FLAG_ROW for flagging
+      TableAccessGuard guard(itsTableMutex);
+      WholeRowFlagger<T> wrFlagger(itsColumns);
+      // cube references the buffer
+      casacore::Cube<T> cube(buf);
+      wrFlagger.flagRowsNative(itsCurrentTopRow, cube);
+  }
+}
+
+/// @brief read a chunk of an array column and apply the selection
+/// @details Channels are averaged and polarisation products are converted if required.
+/// The result is in the measurement set order and has nPol() polarisations and
+/// nChannel() channels.
+/// @param[in] buf array to fill (resized as necessary)
+/// @param[in] columnName a name of the column to read
+template<typename T>
+void TableConstDataIterator::readConvertedChunk(casacore::Array<T> &buf,
+               const std::string &columnName) const
+{
+  readNativeChunk(buf, columnName);
+  // averaging is done first as it reduces the volume of data to convert
+  if (channelAveraging() > 1) {
+      averageChunk(buf);
+  }
+  if (itsSelector->polarisationsSelected()) {
+      convertChunk(buf);
+  }
+}
+
+/// @brief average visibilities in the measurement set order
+/// @details Flags of the current chunk are read to exclude flagged samples from the average.
+/// @param[in] buf visibilities (nPol x nChannel*nAvg x nRow), replaced by the averaged array
+void TableConstDataIterator::averageChunk(casacore::Array<casacore::Complex> &buf) const
+{
+  casacore::Array<casacore::Bool> flags;
+  readNativeChunk(flags, "FLAG");
+  casacore::Array<casacore::Complex> averaged;
+  averageChannelsNative(buf, flags, channelAveraging(), averaged);
+  buf.reference(averaged);
+}
+
+/// @brief average flags in the measurement set order
+/// @details The averaged sample is flagged only if all samples in the bin are flagged
+/// @param[in] buf flags (nPol x nChannel*nAvg x nRow), replaced by the averaged array
+void TableConstDataIterator::averageChunk(casacore::Array<casacore::Bool> &buf) const
+{
+  casacore::Array<casacore::Bool> averaged;
+  averageFlagsNative(buf, channelAveraging(), averaged);
+  buf.reference(averaged);
+}
+
+/// @brief convert polarisation products of visibilities in the measurement set order
+/// @param[in] buf visibilities (nPolIn x nChannel x nRow), replaced by the converted array
+void TableConstDataIterator::convertChunk(casacore::Array<casacore::Complex> &buf) const
+{
+  casacore::Array<casacore::Complex> converted;
+  convertPolarisationsNative(buf, polTransform(), converted);
+  buf.reference(converted);
+}
+
+/// @brief convert polarisation products of flags in the measurement set order
+/// @details An output product is flagged if any input product it depends on is flagged
+/// @param[in] buf flags (nPolIn x nChannel x nRow), replaced by the converted array
+void TableConstDataIterator::convertChunk(casacore::Array<casacore::Bool> &buf) const
+{
+  casacore::Array<casacore::Bool> converted;
+  convertPolarisationFlagsNative(buf, polTransform(), converted);
+  buf.reference(converted);
+}
+
+/// @brief obtain the matrix of the polarisation conversion
+/// @details The matrix converts the products stored in the dataset for the current
+/// DATA_DESC_ID into the products requested via the selector. It is cached until
+/// DATA_DESC_ID changes.
+/// @return nPol() x (number of products in the dataset) matrix
+const casacore::Matrix<casacore::Complex>& TableConstDataIterator::polTransform() const
+{
+  if (itsPolTransform.nelements() == 0) {
+      ASKAPDEBUGASSERT(itsCurrentDataDescID>=0);
+      TableAccessGuard guard(itsTableMutex);
+      const casacore::Vector<casacore::Stokes::StokesTypes> dataPols =
+             subtableInfo().getPolarisation().getTypes(currentPolID());
+      ASKAPCHECK(dataPols.nelements() == itsNumberOfPols, "Number of polarisation products in the "
+             "POLARIZATION subtable ("<<dataPols.nelements()<<") doesn't match the data shape ("<<
+             itsNumberOfPols<<")");
+      itsPolTransform.reference(polarisationTransform(dataPols, itsSelector->getPolarisationSelection()));
+  }
+  return itsPolTransform;
+}
+
+/// @brief read an array column of the table into a cube in the table order
+/// @details This is a version of fillCube which doesn't reorder the data, i.e.
+/// the cube is nPol x nChannel x nRow like the measurement set itself. The cube
+/// references the buffer filled by casacore, so no copy is made.
+/// @param[in] cube a reference to the nPol x nChannel x nRow buffer
+///            cube to fill with the information from table
+/// @param[in] columnName a name of the column to read
+template<typename T>
+void TableConstDataIterator::fillCubeNative(casacore::Cube<T> &cube,
+               const std::string &columnName) const
+{
+  if (itsNumberOfRows == 0) {
+      cube.resize(nPol(), nChannel(), 0);
+      return;
   }
+  casacore::Array<T> buf;
+  readConvertedChunk(buf, columnName);
+  cube.reference(buf);
 }
 
 /// populate the buffer of visibilities with the values of current
@@ -505,6 +1222,72 @@ void TableConstDataIterator::fillFlag(casacore::Cube<casacore::Bool> &flag) cons
   }
 }
 
+/// @brief read flagging information as a bit mask
+/// @details This is the same information as returned by fillFlag, but one bit per sample
+/// is used. Flags are read in blocks of rows (see theirRowBlockSize) and each block is packed
+/// straight from the buffer in the measurement set order, then FLAG_ROW is applied to whole
+/// rows of bits (unless the flags have been read in advance, in which case FLAG_ROW is
+/// already applied).
+/// @param[in] flag packed flags to fill (nRow x nChannel x nPol)
+void TableConstDataIterator::fillPackedFlag(PackedFlags &flag) const
+{
+  if ((itsNumberOfRows == 0) || itsFlagData) {
+      // nothing to read, all samples are flagged if itsFlagData is set
+      flag.resize(itsNumberOfRows, nChannel(), nPol(), itsFlagData);
+      return;
+  }
+  casacore::Array<casacore::Bool> buf;
+  if ((channelAveraging() > 1) || itsSelector->polarisationsSelected() || outOfBandChannels()) {
+      // averaging, polarisation conversion and padding of the channels outside the band
+      // work with the unpacked flags
+      readConvertedChunk(buf, "FLAG");
+      flag.pack(buf);
+  } else if (itsReadAhead && itsReadAhead->get("FLAG", flag)) {
+      // the flags are taken from the read-ahead buffer (packed there if necessary), FLAG_ROW
+      // is already applied
+      ASKAPDEBUGASSERT(flag.nelements() == size_t(itsNumberOfRows) * nChannel() * itsNumberOfPols);
+  } else {
+      // FLAG is read and packed in blocks of rows, so the unpacked flags of the whole chunk
+      // are never held in memory. Blocks start at the word boundary of the bit mask.
+      const casacore::uInt nChan = nChannel();
+      flag.resize(itsNumberOfRows, nChan, itsNumberOfPols);
+      const size_t samplesPerRow = size_t(nChan) * itsNumberOfPols;
+      const casacore::uInt alignment = PackedFlags::rowAlignment(nChan, itsNumberOfPols);
+      casacore::uInt blockRows = casacore::uInt(std::max(theirRowBlockSize / samplesPerRow, size_t(1)));
+      blockRows = std::max(blockRows / alignment, casacore::uInt(1)) * alignment;
+      for (casacore::uInt row = 0; row < itsNumberOfRows; row += blockRows) {
+           readColumnRows(buf, "FLAG", row, std::min(blockRows, itsNumberOfRows - row));
+           flag.packRows(buf, row);
+      }
+      TableAccessGuard guard(itsTableMutex);
+      WholeRowFlagger<casacore::Bool> wrFlagger(itsColumns);
+      wrFlagger.flagRowsPacked(itsCurrentTopRow, flag);
+  }
+}
+
+/// @brief read visibilities in the measurement set order
+/// @details populate the buffer of visibilities with the values of current
+/// iteration without reordering them
+/// @param[in] vis a reference to the nPol x nChannel x nRow buffer
+///            cube to fill with the complex visibility data
+void TableConstDataIterator::fillVisibilityNative(casacore::Cube<casacore::Complex> &vis) const
+{
+  fillCubeNative(vis, getDataColumnName());
+}
+
+/// @brief read flagging information in the measurement set order
+/// @details populate the buffer of flags with the information
+/// read in the current iteration without reordering it
+/// @param[in] flag a reference to the nPol x nChannel x nRow buffer
+///            cube to fill with the flag information
+void TableConstDataIterator::fillFlagNative(casacore::Cube<casacore::Bool> &flag) const
+{
+  fillCubeNative(flag,"FLAG");
+  if (itsFlagData) {
+      flag = true;
+  }
+}
+
 /// populate the buffer of noise figures with the values of current
 /// iteration
 /// @param[in] noise a reference to the nRow x nChannel x nPol buffer
@@ -515,47 +1298,53 @@ void TableConstDataIterator::fillNoise(casacore::Cube<casacore::Complex> &noise)
   const casacore::uInt nChan = nChannel();
   const casacore::uInt startChan = startChannel();
 
-  // default action first - just resize the cube and assign 1.
-  noise.resize(itsNumberOfRows, nChan, itsNumberOfPols);
-  noise.set(casacore::Complex(1.,1.));
+  if (noiseSpectrallyConstant()) {
+      // noise is given per row and polarisation, read it compactly and expand
+      casacore::Matrix<casacore::Float> sigma;
+      fillCompactNoise(sigma);
+      broadcastNoise(sigma, nChan, noise);
+      return;
+  }
+
+  // default action first - just resize the cube and assign 1 (unless the whole cube
+  // is going to be overwritten by the sigma spectrum)
+  noise.resize(itsNumberOfRows, nChan, nPol());
+  const bool hasSigmaSpectrum = itsHasSigmaSpectrum;
+  const casacore::uInt nAvg = channelAveraging();
+  const bool polSelected = itsSelector->polarisationsSelected();
+  if (((nAvg > 1) || polSelected) && (itsNumberOfRows > 0)) {
+      // noise of the averaged channels and converted polarisations is derived from the
+      // noise of the raw data, which are assembled in the measurement set order first
+      casacore::Array<casacore::Float> sigma;
+      readNoiseChunk(sigma);
+      nativeToAccessorOrder(sigma, noise, SigmaToNoise());
+      return;
+  }
+  if (!hasSigmaSpectrum || (itsNumberOfRows == 0)) {
+      noise.set(casacore::Complex(1.,1.));
+  }
   // if the sigma spectrum exists, use those sigmas to fill the noise cube
-  if (table().actualTableDesc().isColumn("SIGMA_SPECTRUM")) {
-      // noise is given per channel and polarisation
-      // Setup a slicer to extract the specified channel range only
-      const Slicer chanSlicer(Slice(),Slice(startChan,nChan));
-      casa::Matrix<Float> buf(itsNumberOfPols,nChan);
-      ROArrayColumn<Float> sigmaCol(itsCurrentIteration,"SIGMA_SPECTRUM");
-      for (uInt row = 0; row<itsNumberOfRows; ++row) {
-#ifdef ASKAP_DEBUG
-           const casa::IPosition shape = sigmaCol.shape(row);
-           ASKAPDEBUGASSERT(shape.size()==2);
-           ASKAPDEBUGASSERT((shape[0] == casa::Int(itsNumberOfPols)) &&
-                            (shape[1] == casa::Int(itsNumberOfChannels)));
-#endif
-           sigmaCol.getSlice(row+itsCurrentTopRow,chanSlicer,buf,False);
-
-           // SIGMA_SPECTRUM is ordered (pol,chan), so need to transpose
-           for (casa::uInt chan=0; chan<nChan; chan++) {
-                for (casa::uInt pol=0; pol<itsNumberOfPols; pol++) {
-                     // same noise for both real and imaginary parts
-                     const casa::Float val = buf(pol,chan);
-                     noise(row,chan,pol) = casa::Complex(val,val);
-                }
-           }
-      } // loop over rows
+  if (hasSigmaSpectrum && (itsNumberOfRows > 0)) {
+      // noise is given per channel and polarisation, read the whole chunk at once
+      // SIGMA_SPECTRUM is ordered (pol,chan), so need to transpose
+      casacore::Array<casacore::Float> buf;
+      readColumnChunk(buf, "SIGMA_SPECTRUM");
+      nativeToAccessorOrder(buf, noise, SigmaToNoise());
   } // if-statement checking that SIGMA_SPECTRUM column is present
-  else if (table().actualTableDesc().isColumn("SIGMA")) {
-      ROArrayColumn<Float> sigmaCol(itsCurrentIteration,"SIGMA");
+  else if (itsHasSigma) {
+      TableAccessGuard guard(itsTableMutex);
+      const ROArrayColumn<Float> &sigmaCol = itsColumns.arrayColumn<Float>("SIGMA");
       casacore::Vector<Float> buf(itsNumberOfPols);
       for (uInt row = 0; row<itsNumberOfRows; ++row) {
-           const casacore::IPosition shape = sigmaCol.shape(row);
+           const casacore::rownr_t tableRow = row + itsCurrentTopRow;
+           const casacore::IPosition shape = sigmaCol.shape(tableRow);
            ASKAPDEBUGASSERT((shape.size()<=2) && (shape.size()!=0));
            if (shape.size() == 1) {
                // noise is given per polarisation, same for all spectral channels
                // IS SIGMA EVER NOT GOING TO BE THIS SIZE? (SEE SIGMA_SPECTRUM)
                ASKAPDEBUGASSERT(shape[0] == casacore::Int(itsNumberOfPols));
                //casacore::Array<Float> buf(casacore::IPosition(1,itsNumberOfPols));
-               sigmaCol.get(row+itsCurrentTopRow,buf,False);
+               sigmaCol.get(tableRow,buf,False);
                //casacore::Matrix<casacore::Complex> slice = noise.yzPlane(row);
                for (uInt chan = 0; chan< nChan; ++chan) {
                     //ASKAPDEBUGASSERT(chan< slice.nrow());
@@ -571,11 +1360,13 @@ void TableConstDataIterator::fillNoise(casacore::Cube<casacore::Complex> &noise)
                // noise is given per channel and polarisation
                // IS THIS EVER THE CASE, OR IS SIGMA_SPECTRUM (above) ALWAYS USED?
                // Should always use SIGMA_SPECTRUM for this case (MHW)
+               ASKAPCHECK(!outOfBandChannels(), "Frequency selection beyond the band is not supported "
+                          "with 2-dimensional SIGMA column");
                ASKAPASSERT((shape[0] == casacore::Int(itsNumberOfChannels)) &&
                            (shape[1] == casacore::Int(itsNumberOfPols)));
 
                casacore::Array<Float> buf(casacore::IPosition(2,itsNumberOfChannels,itsNumberOfPols));
-               sigmaCol.get(row+itsCurrentTopRow,buf,False);
+               sigmaCol.get(tableRow,buf,False);
 
                // not clear whether we need a transpose of the matrix. This
                // case is not present in any available measurement set
@@ -598,28 +1389,271 @@ void TableConstDataIterator::fillNoise(casacore::Cube<casacore::Complex> &noise)
   } // if-statement checking that SIGMA column is present
 }
 
+/// @brief populate the buffer of real-valued noise figures
+/// @details This is the same information as returned by fillNoise, but only one value
+/// is stored per sample (the noise is the same for real and imaginary parts).
+/// @param[in] noise a reference to the nRow x nChannel x nPol buffer
+///            cube to be filled with the noise figures
+void TableConstDataIterator::fillNoiseReal(casacore::Cube<casacore::Float> &noise) const
+{
+  if (noiseSpectrallyConstant()) {
+      casacore::Matrix<casacore::Float> sigma;
+      fillCompactNoise(sigma);
+      broadcastNoise(sigma, nChannel(), noise);
+      return;
+  }
+  noise.resize(itsNumberOfRows, nChannel(), nPol());
+  if (itsNumberOfRows > 0) {
+      casacore::Array<casacore::Float> sigma;
+      readNoiseChunk(sigma);
+      nativeToAccessorOrder(sigma, noise);
+  }
+}
+
+/// @brief read noise figures for the current chunk in the measurement set order
+/// @details SIGMA_SPECTRUM is used if present, otherwise SIGMA given per polarisation is
+/// expanded to all channels (or 1 is assumed if there is no SIGMA column). The noise is
+/// propagated through channel averaging and polarisation conversion, if required.
+/// With channel averaging, the raw noise is read and averaged in blocks of rows
+/// (see theirRowBlockSize), so the raw cube of the whole chunk is never held in memory.
+/// @param[in] sigma array to fill (resized to nPol() x nChannel() x nRow)
+void TableConstDataIterator::readNoiseChunk(casacore::Array<casacore::Float> &sigma) const
+{
+  const casacore::uInt nChan = nChannel();
+  const casacore::uInt nAvg = channelAveraging();
+  if (nAvg > 1) {
+      // the raw noise and flags are only held for a block of rows at a time, the averaged
+      // noise of each block is written straight into the output
+      sigma.resize(casacore::IPosition(3, itsNumberOfPols, nChan, itsNumberOfRows));
+      const size_t rawPerRow = size_t(itsNumberOfPols) * nChan * nAvg;
+      const casacore::uInt blockRows = casacore::uInt(std::max(theirRowBlockSize / rawPerRow, size_t(1)));
+      for (casacore::uInt row = 0; row < itsNumberOfRows; row += blockRows) {
+           const casacore::uInt nRows = std::min(blockRows, itsNumberOfRows - row);
+           casacore::Array<casacore::Float> raw;
+           readRawNoiseRows(raw, row, nRows);
+           casacore::Array<casacore::Bool> flags;
+           readColumnRows(flags, "FLAG", row, nRows);
+           {
+              TableAccessGuard guard(itsTableMutex);
+              WholeRowFlagger<casacore::Bool> wrFlagger(itsColumns);
+              casacore::Cube<casacore::Bool> flagCube(flags);
+              wrFlagger.flagRowsNative(itsCurrentTopRow + row, flagCube);
+           }
+           // rows are the last axis, so the block of the output is contiguous and
+           // averageNoiseNative writes into it without reallocation
+           casacore::Array<casacore::Float> block = sigma(casacore::IPosition(3, 0, 0, row),
+                  casacore::IPosition(3, itsNumberOfPols - 1, nChan - 1, row + nRows - 1));
+           averageNoiseNative(raw, flags, nAvg, block);
+      }
+  } else if (itsHasSigmaSpectrum) {
+      readColumnChunk(sigma, "SIGMA_SPECTRUM");
+  } else {
+      readRawNoiseRows(sigma, 0, itsNumberOfRows);
+  }
+  if (itsSelector->polarisationsSelected()) {
+      casacore::Array<casacore::Float> converted;
+      convertPolarisationNoiseNative(sigma, polTransform(), converted);
+      sigma.reference(converted);
+  }
+}
+
+/// @brief read the raw noise figures for a range of rows in the measurement set order
+/// @details SIGMA_SPECTRUM is used if present, otherwise SIGMA given per polarisation is
+/// expanded to all raw channels (or 1 is assumed if there is no SIGMA column). No
+/// averaging or polarisation conversion is done.
+/// @param[in] sigma array to fill (resized to nPol x nChannel()*channelAveraging() x nRows)
+/// @param[in] startRow the first row to read (relative to the current chunk)
+/// @param[in] nRows number of rows to read
+void TableConstDataIterator::readRawNoiseRows(casacore::Array<casacore::Float> &sigma,
+                 casacore::uInt startRow, casacore::uInt nRows) const
+{
+  if (itsHasSigmaSpectrum) {
+      readColumnRows(sigma, "SIGMA_SPECTRUM", startRow, nRows);
+      return;
+  }
+  const casacore::uInt nRawChan = nChannel() * channelAveraging();
+  sigma.resize(casacore::IPosition(3, itsNumberOfPols, nRawChan, nRows));
+  sigma.set(1.);
+  if (itsHasSigma) {
+      TableAccessGuard guard(itsTableMutex);
+      const ROArrayColumn<Float> &sigmaCol = itsColumns.arrayColumn<Float>("SIGMA");
+      casacore::Cube<casacore::Float> sigmaCube(sigma);
+      casacore::Vector<Float> buf(itsNumberOfPols);
+      for (uInt row = 0; row<nRows; ++row) {
+           const casacore::rownr_t tableRow = row + startRow + itsCurrentTopRow;
+           ASKAPCHECK(sigmaCol.shape(tableRow).size() == 1,
+                "Expect SIGMA_SPECTRUM or SIGMA given per polarisation, 2-dimensional SIGMA is "
+                "not supported with channel averaging, polarisation conversion or real-valued noise");
+           sigmaCol.get(tableRow,buf,False);
+           for (uInt chan = 0; chan < nRawChan; ++chan) {
+                for (casacore::uInt pol=0; pol<itsNumberOfPols; ++pol) {
+                     sigmaCube(pol,chan,row) = buf(pol);
+                }
+           }
+      }
+  }
+}
+
+/// @brief check whether the noise is the same for all spectral channels
+/// @details This is the case if the noise is given by the SIGMA column per row and
+/// polarisation (or is not given at all) and no channel averaging is done (the noise
+/// of the averaged channel depends on the number of unflagged samples).
+/// @return true if the noise can be represented by fillCompactNoise
+bool TableConstDataIterator::noiseSpectrallyConstant() const
+{
+  if ((channelAveraging() > 1) || itsHasSigmaSpectrum) {
+      return false;
+  }
+  if ((itsNumberOfRows == 0) || !itsHasSigma) {
+      return true;
+  }
+  TableAccessGuard guard(itsTableMutex);
+  return itsColumns.arrayColumn<Float>("SIGMA").shape(itsCurrentTopRow).size() == 1;
+}
+
+/// @brief populate the buffer of noise figures given per row and polarisation
+/// @details This method can only be used if the noise is the same for all spectral
+/// channels (see noiseSpectrallyConstant). The same noise applies to real and imaginary parts.
+/// The SIGMA column is read for the whole chunk with a single call.
+/// @param[in] sigma a reference to the nRow x nPol matrix to be filled with the noise figures
+void TableConstDataIterator::fillCompactNoise(casacore::Matrix<casacore::Float> &sigma) const
+{
+  ASKAPCHECK(noiseSpectrallyConstant(), "Noise is not the same for all spectral channels, "
+             "use fillNoise instead");
+  sigma.resize(itsNumberOfRows, nPol());
+  if (itsNumberOfRows == 0) {
+      return;
+  }
+  // the noise is assembled in the measurement set order with a degenerate channel axis,
+  // so the same helper methods can be used as in the general case
+  casacore::Array<casacore::Float> buf;
+  if (itsHasSigma) {
+      TableAccessGuard guard(itsTableMutex);
+      const ROArrayColumn<Float> &sigmaCol = itsColumns.arrayColumn<Float>("SIGMA");
+      try {
+         sigmaCol.getColumnRange(Slicer(IPosition(1,itsCurrentTopRow),IPosition(1,itsNumberOfRows)),
+                                 buf, True);
+      }
+      catch (const casacore::AipsError &ae) {
+         ASKAPTHROW(DataAccessError, "Unable to read "<<itsNumberOfRows<<" rows of the SIGMA column "
+                    "starting from row "<<itsCurrentTopRow<<", most likely the shape is not "
+                    "conformant across the chunk. AipsError: "<<ae.what());
+      }
+      ASKAPCHECK(buf.shape() == IPosition(2, itsNumberOfPols, itsNumberOfRows),
+                 "SIGMA column is expected to have one value per polarisation, shape is "<<buf.shape());
+      buf.reference(buf.reform(IPosition(3, itsNumberOfPols, 1, itsNumberOfRows)));
+  } else {
+      buf.resize(IPosition(3, itsNumberOfPols, 1, itsNumberOfRows));
+      buf.set(1.);
+  }
+  if (itsSelector->polarisationsSelected()) {
+      casacore::Array<casacore::Float> converted;
+      convertPolarisationNoiseNative(buf, polTransform(), converted);
+      buf.reference(converted);
+  }
+  const casacore::Cube<casacore::Float> bufCube(buf);
+  ASKAPDEBUGASSERT(bufCube.nrow() == nPol());
+  for (casacore::uInt pol = 0; pol < bufCube.nrow(); ++pol) {
+       for (casacore::uInt row = 0; row < itsNumberOfRows; ++row) {
+            sigma(row, pol) = bufCube(pol, 0, row);
+       }
+  }
+}
+
+/// @brief expand the noise given per row and polarisation to all channels
+/// @param[in] sigma nRow x nPol matrix with the noise figures
+/// @param[in] nChan number of spectral channels
+/// @param[out] noise cube to fill (resized to nRow x nChan x nPol)
+void TableConstDataIterator::broadcastNoise(const casacore::Matrix<casacore::Float> &sigma,
+                 casacore::uInt nChan, casacore::Cube<casacore::Float> &noise)
+{
+  const casacore::uInt nRow = sigma.nrow();
+  noise.resize(nRow, nChan, sigma.ncolumn());
+  for (casacore::uInt pol = 0; pol < sigma.ncolumn(); ++pol) {
+       for (casacore::uInt chan = 0; chan < nChan; ++chan) {
+            for (casacore::uInt row = 0; row < nRow; ++row) {
+                 noise(row, chan, pol) = sigma(row, pol);
+            }
+       }
+  }
+}
+
+/// @brief expand the noise given per row and polarisation to all channels
+/// @param[in] sigma nRow x nPol matrix with the noise figures
+/// @param[in] nChan number of spectral channels
+/// @param[out] noise cube to fill (resized to nRow x nChan x nPol)
+void TableConstDataIterator::broadcastNoise(const casacore::Matrix<casacore::Float> &sigma,
+                 casacore::uInt nChan, casacore::Cube<casacore::Complex> &noise)
+{
+  const casacore::uInt nRow = sigma.nrow();
+  noise.resize(nRow, nChan, sigma.ncolumn());
+  // the row is the fastest changing index of both sigma and noise, the inner
+  // loop is over contiguous memory
+  for (casacore::uInt pol = 0; pol < sigma.ncolumn(); ++pol) {
+       for (casacore::uInt chan = 0; chan < nChan; ++chan) {
+            for (casacore::uInt row = 0; row < nRow; ++row) {
+                 const casacore::Float val = sigma(row, pol);
+                 noise(row, chan, pol) = casacore::Complex(val, val);
+            }
+       }
+  }
+}
+
 /// populate the buffer with uvw
 /// @param[in] uvw a reference to vector of rigid vectors (3 elemets,
 ///            u,v and w for each row) to fill
 void TableConstDataIterator::fillUVW(casacore::Vector<casacore::RigidVector<casacore::Double, 3> >&uvw) const
 {
   uvw.resize(itsNumberOfRows);
-
-  ROArrayColumn<Double> uvwCol(itsCurrentIteration,"UVW");
-  // temporary buffer
-  Vector<Double> buf(3);
+  if (itsNumberOfRows == 0) {
+      return;
+  }
+  casacore::Matrix<casacore::Double> buf;
+  readUVWChunk(buf);
   for (uInt row=0;row<itsNumberOfRows;++row) {
-#ifdef ASKAP_DEBUG
-       const casacore::IPosition shape=uvwCol.shape(row);
-       ASKAPDEBUGASSERT(shape.size()==1);
-       ASKAPDEBUGASSERT(shape[0]==3);
-#endif // ASKAP_DEBUG
-       // extract data record for this row, no resizing
-       uvwCol.get(row+itsCurrentTopRow,buf,False);
-       uvw(row) = buf;
+       uvw(row) = buf.column(row);
   }
 }
 
+/// @brief populate the buffer with uvw stored as separate arrays of u, v and w
+/// @details This is the same information as returned by fillUVW, but the UVW column
+/// is de-interleaved into contiguous vectors for each component straight after reading.
+/// @param[in] uvw a reference to the uvw components to fill
+void TableConstDataIterator::fillUVWComponents(UVWComponents<casacore::Double> &uvw) const
+{
+  if (itsNumberOfRows == 0) {
+      uvw.resize(0);
+      return;
+  }
+  casacore::Matrix<casacore::Double> buf;
+  readUVWChunk(buf);
+  uvw.assignNative(buf);
+}
+
+/// @brief read the UVW column for the current chunk
+/// @details All rows of the current chunk are read in one go (or taken from the
+/// read-ahead buffer, if available).
+/// @param[in] uvw matrix to fill (resized to 3 x nRow)
+void TableConstDataIterator::readUVWChunk(casacore::Matrix<casacore::Double> &uvw) const
+{
+  casacore::Array<casacore::Double> buf;
+  if (!itsReadAhead || !itsReadAhead->get("UVW", buf)) {
+      TableAccessGuard guard(itsTableMutex);
+      const ROArrayColumn<Double> &uvwCol = itsColumns.arrayColumn<Double>("UVW");
+      try {
+         uvwCol.getColumnRange(Slicer(IPosition(1,itsCurrentTopRow),IPosition(1,itsNumberOfRows)),
+                               buf, True);
+      }
+      catch (const casacore::AipsError &ae) {
+         ASKAPTHROW(DataAccessError, "Unable to read "<<itsNumberOfRows<<" rows of the UVW column "
+                    "starting from row "<<itsCurrentTopRow<<". AipsError: "<<ae.what());
+      }
+  }
+  ASKAPCHECK(buf.shape() == IPosition(2, 3, itsNumberOfRows),
+             "UVW column is expected to have 3 elements per row, shape of the chunk is "<<buf.shape());
+  uvw.reference(buf);
+}
+
 /// @brief obtain a current spectral window ID
 /// @details This method obtains a spectral window ID corresponding to the
 /// current data description ID and tests its validity
@@ -627,6 +1661,8 @@ void TableConstDataIterator::fillUVW(casacore::Vector<casacore::RigidVector<casa
 casacore::uInt TableConstDataIterator::currentSpWindowID() const
 {
   ASKAPDEBUGASSERT(itsCurrentDataDescID>=0);
+  // subtable handlers may be shared with iterators used in other threads
+  TableAccessGuard guard(itsTableMutex);
   const int spWindowIndex = subtableInfo().getDataDescription().
                             getSpectralWindowID(itsCurrentDataDescID);
   if (spWindowIndex<0) {
@@ -644,6 +1680,7 @@ casacore::uInt TableConstDataIterator::currentSpWindowID() const
 casacore::uInt TableConstDataIterator::currentPolID() const
 {
   ASKAPDEBUGASSERT(itsCurrentDataDescID>=0);
+  TableAccessGuard guard(itsTableMutex);
   const int polIndex = subtableInfo().getDataDescription().
                             getPolarizationID(itsCurrentDataDescID);
   if (polIndex<0) {
@@ -663,6 +1700,7 @@ casacore::uInt TableConstDataIterator::currentPolID() const
 /// @return a reference to direction measure
 const casacore::MDirection& TableConstDataIterator::getCurrentReferenceDir() const
 {
+  TableAccessGuard guard(itsTableMutex);
   const IFieldSubtableHandler &fieldSubtable = subtableInfo().getField();
   if (itsUseFieldID) {
       ASKAPCHECK(itsCurrentFieldID>=0, "Elements of FIELD_ID column should be 0 or positive. You have "<<
@@ -676,62 +1714,67 @@ const casacore::MDirection& TableConstDataIterator::getCurrentReferenceDir() con
 /// @brief obtain selected range of channels
 /// @details A subset spectral channels can be selected for this iterator to work with.
 /// This method returns the number of channels and the first selected channel.
+/// If the frequency selection extends beyond the band of the current spectral window,
+/// the second element is the first selected channel inside the band and the number of
+/// raw channels outside the band is stored in itsLeadingOutOfBand and itsTrailingOutOfBand.
+/// These channels are flagged on read.
 /// @return a pair, first element is the number of channels, second is the first channel
 /// in the full cube
 std::pair<casacore::uInt, casacore::uInt> TableConstDataIterator::getChannelRange() const
 {
   ASKAPDEBUGASSERT(itsSelector);
   if (!itsChannelsSelected) {
-      itsFlagData = true;
+      itsFlagData = false;
+      itsLeadingOutOfBand = 0;
+      itsTrailingOutOfBand = 0;
 
       if (itsSelector->frequenciesSelected()) {
+          // the SPECTRAL_WINDOW subtable is read, serialise with the read-ahead job
+          TableAccessGuard guard(itsTableMutex);
           const std::tuple<int,casacore::MFrequency,double> freqSel = itsSelector->getFrequencySelection();
-          // cannot do multiple channels yet
-          ASKAPCHECK(std::get<0>(freqSel)<=1, "Can only do a single channel in frequency selection mode");
-          // convert frequency in requested frame to MS frame
-          // Using antenna 0 and antenna pointing (= field direction) as reference (or direction ref in MFrequency)
-          // Note this differs from imager which uses current phase centre direction in freq conversion
-          const casacore::MFrequency freqMeas = std::get<1>(freqSel);
-          casacore::MeasRef<casacore::MFrequency> freqRef = freqMeas.getRef();
-          const casacore::Measure *pMeas = freqRef.getFrame().direction();
-          // If the MFrequency in freqSel has a reference direction use that, otherwise use pointing
-          casacore::MDirection velDir = (pMeas ? MDirection(pMeas) : getCurrentReferenceDir());
-          casacore::MeasFrame frame(MEpoch(currentEpoch()),subtableInfo().getAntenna().getPosition(0),velDir);
-          const ITableSpWindowHolder& spWindowSubtable=subtableInfo().getSpWindow();
-          const casacore::MFrequency::Types dataType =
-            casacore::MFrequency::castType(spWindowSubtable.getReferenceFrame(currentSpWindowID()).getType());
-          casacore::MFrequency::Types selType = MFrequency::castType(freqRef.getType());
-          if (selType == casacore::MFrequency::Undefined) {
-              selType = dataType;
-          }
-
-          const casacore::MFrequency::Ref refin(dataType,frame); // the frame of the input channels
-          const casacore::MFrequency::Ref refout(selType,frame); // the frame desired
-          casacore::MFrequency::Convert backw(refout,refin); // from desired to input
-          
-          const MVFrequency requiredFreq = backw(std::get<1>(freqSel)).getValue();
+          const casacore::uInt nChanRequested = casacore::uInt(std::max(std::get<0>(freqSel), 1));
+          const casacore::Double requiredFreq = selectedStartFrequency();
           // Now find corresponding channel
+          const ITableSpWindowHolder& spWindowSubtable=subtableInfo().getSpWindow();
           const casacore::Vector<casacore::Double> dataFreqs(spWindowSubtable.getFrequencies(currentSpWindowID()));
           // assuming linear freq scale
-          itsNumberOfChannelsSelected = 1;
+          itsNumberOfChannelsSelected = nChanRequested;
           itsStartChannelSelected = 0;
+          itsFreqChannelAveraging = 1;
           const uint nFreq = dataFreqs.nelements();
           if (nFreq > 1) {
               const double freqInc = dataFreqs(1) - dataFreqs(0);
               ASKAPDEBUGASSERT(freqInc != 0);
               ASKAPCHECK(abs((dataFreqs(nFreq-1)-dataFreqs(0))/((nFreq-1)*freqInc)-1)<0.001,
                 "Frequency axis non-linear, cannot do frequency selection with current code");
-              const double channel = (requiredFreq - dataFreqs(0)) / freqInc;
+              // non-zero increment means averaging of adjacent channels
+              const double requestedInc = std::get<2>(freqSel);
+              if (requestedInc != 0.) {
+                  ASKAPCHECK(requestedInc * freqInc > 0, "Requested frequency increment of "<<requestedInc<<
+                         " Hz has the sign opposite to that of the channel increment ("<<freqInc<<" Hz)");
+                  itsFreqChannelAveraging = casacore::uInt(std::max(std::lrint(requestedInc / freqInc), 1L));
+              }
+              const long nRaw = long(nChanRequested * itsFreqChannelAveraging);
+              // the start frequency corresponds to the centre of the first (averaged) channel
+              const double channel = (requiredFreq - dataFreqs(0)) / freqInc - 0.5 * (itsFreqChannelAveraging - 1);
               // for now just use nearest channel, but could do linear interpolation between nearest two
-              const int nearestChannel = std::lrint(channel);
-              if (nearestChannel >= 0 && nearestChannel < nFreq) {
-                  itsStartChannelSelected = (uint)nearestChannel;
-                  itsFlagData = false;
+              const long firstChannel = std::lrint(channel);
+              // the part of the selection inside the band, the rest is flagged
+              const long firstInBand = std::max(firstChannel, 0L);
+              const long endInBand = std::min(firstChannel + nRaw, long(nFreq));
+              if (firstInBand < endInBand) {
+                  itsStartChannelSelected = casacore::uInt(firstInBand);
+                  itsLeadingOutOfBand = casacore::uInt(firstInBand - firstChannel);
+                  itsTrailingOutOfBand = casacore::uInt(firstChannel + nRaw - endInBand);
               } else {
-                  if (nearestChannel >= nFreq) {
-                      itsStartChannelSelected = nFreq - 1;
-                  }
+                  // the whole selection is outside the band
+                  itsLeadingOutOfBand = casacore::uInt(nRaw);
+                  itsFlagData = true;
               }
+          } else {
+              // the channel width is unknown, the selection starts at the only channel
+              // available and the remaining channels are outside the band
+              itsTrailingOutOfBand = nChanRequested - 1;
           }
       } else {
           const std::pair<int, int> chanSelection = itsSelector->getChannelSelection();
@@ -739,8 +1782,8 @@ std::pair<casacore::uInt, casacore::uInt> TableConstDataIterator::getChannelRang
                                    casacore::uInt(chanSelection.first) : itsNumberOfChannels;
           itsStartChannelSelected = itsSelector->channelsSelected() ?
                                    casacore::uInt(chanSelection.second) : 0;
-          ASKAPDEBUGASSERT(itsNumberOfChannelsSelected + itsStartChannelSelected <= itsNumberOfChannels);
-          itsFlagData = false;
+          ASKAPDEBUGASSERT(itsNumberOfChannelsSelected * channelAveraging() + itsStartChannelSelected <=
+                           itsNumberOfChannels);
       }
       itsChannelsSelected = true;
   }
@@ -748,13 +1791,97 @@ std::pair<casacore::uInt, casacore::uInt> TableConstDataIterator::getChannelRang
   return std::pair<casacore::uInt, casacore::uInt>(itsNumberOfChannelsSelected,itsStartChannelSelected);
 }
 
+/// @brief number of adjacent channels averaged together on read
+/// @details Averaging is only done if channels are selected with chooseChannels
+/// (and not via frequency selection). Each channel returned by the accessor
+/// corresponds to this number of channels in the measurement set.
+/// @return number of channels to average (1 means no averaging)
+casacore::uInt TableConstDataIterator::channelAveraging() const
+{
+  ASKAPDEBUGASSERT(itsSelector);
+  if (itsSelector->frequenciesSelected()) {
+      // averaging factor is derived from the frequency increment together with the channel range
+      getChannelRange();
+      return itsFreqChannelAveraging;
+  }
+  return itsSelector->channelsSelected() ? itsSelector->getChannelAveraging() : 1;
+}
+
+/// @brief obtain the start frequency of the frequency selection in the frame of the data
+/// @details The conversion engine is set up once per spectral window and frame of the
+/// selection, only the epoch and direction of its measure frame are updated. The result
+/// is reused while the field and the time bucket of the epoch stay the same (the Doppler
+/// shift changes by a tiny fraction of a typical channel width within one bucket).
+/// @return start frequency (in Hz) in the frame of the SPECTRAL_WINDOW subtable
+casacore::Double TableConstDataIterator::selectedStartFrequency() const
+{
+  // duration of the time bucket in seconds
+  const double timeBucket = 60.;
+  const std::tuple<int,casacore::MFrequency,double> freqSel = itsSelector->getFrequencySelection();
+  // convert frequency in requested frame to MS frame
+  // Using antenna 0 and antenna pointing (= field direction) as reference (or direction ref in MFrequency)
+  // Note this differs from imager which uses current phase centre direction in freq conversion
+  const casacore::MFrequency freqMeas = std::get<1>(freqSel);
+  const casacore::MeasRef<casacore::MFrequency> freqRef = freqMeas.getRef();
+  const casacore::uInt spWindow = currentSpWindowID();
+  const casacore::MFrequency::Types dataType =
+    casacore::MFrequency::castType(subtableInfo().getSpWindow().getReferenceFrame(spWindow).getType());
+  casacore::MFrequency::Types selType = casacore::MFrequency::castType(freqRef.getType());
+  if (selType == casacore::MFrequency::Undefined) {
+      selType = dataType;
+  }
+  const casacore::MEpoch epoch = currentEpoch();
+  const casacore::Int64 bucket = casacore::Int64(std::floor(epoch.getValue().get() * 86400. / timeBucket));
+  const casacore::Int fieldID = itsUseFieldID ? itsCurrentFieldID : -1;
+
+  const std::pair<casacore::uInt, casacore::Int> key(spWindow, casacore::Int(selType));
+  std::map<std::pair<casacore::uInt, casacore::Int>, FreqConversionEngine>::iterator it =
+         itsFreqConversionEngines.find(key);
+  if (it == itsFreqConversionEngines.end()) {
+      FreqConversionEngine engine;
+      const casacore::Measure *pMeas = freqRef.getFrame().direction();
+      // If the MFrequency in freqSel has a reference direction use that, otherwise use pointing
+      engine.itsFixedDirection = (pMeas != NULL);
+      const casacore::MDirection velDir = (pMeas ? MDirection(pMeas) : getCurrentReferenceDir());
+      engine.itsFrame = casacore::MeasFrame(epoch,subtableInfo().getAntenna().getPosition(0),velDir);
+      // the frame is shared by the references (and therefore by the converter), so the
+      // engine picks up changes of the epoch and direction
+      const casacore::MFrequency::Ref refin(dataType,engine.itsFrame); // the frame of the input channels
+      const casacore::MFrequency::Ref refout(selType,engine.itsFrame); // the frame desired
+      engine.itsConverter.reset(new casacore::MFrequency::Convert(refout,refin)); // from desired to input
+      engine.itsFieldID = fieldID;
+      engine.itsBucket = bucket;
+      engine.itsFrequency = (*engine.itsConverter)(freqMeas.getValue()).getValue().getValue();
+      itsFreqConversionEngines[key] = engine;
+      return engine.itsFrequency;
+  }
+  FreqConversionEngine &engine = it->second;
+  if ((engine.itsBucket != bucket) || (engine.itsFieldID != fieldID)) {
+      engine.itsFrame.resetEpoch(epoch);
+      if (!engine.itsFixedDirection) {
+          engine.itsFrame.resetDirection(getCurrentReferenceDir());
+      }
+      engine.itsFieldID = fieldID;
+      engine.itsBucket = bucket;
+      engine.itsFrequency = (*engine.itsConverter)(freqMeas.getValue()).getValue().getValue();
+  }
+  return engine.itsFrequency;
+}
+
 /// @brief fill the buffer with the polarisation types
 /// @param[in] stokes a reference to a vector to be filled
 void TableConstDataIterator::fillStokes(casacore::Vector<casacore::Stokes::StokesTypes> &stokes) const
 {
+  // subtables are read here, the read-ahead job may access the table at the same time
+  TableAccessGuard guard(itsTableMutex);
   const ITablePolarisationHolder& polSubtable = subtableInfo().getPolarisation();
 
   ASKAPDEBUGASSERT(itsCurrentDataDescID>=0);
+  if (itsSelector->polarisationsSelected()) {
+      // products are converted on read
+      stokes = itsSelector->getPolarisationSelection().copy();
+      return;
+  }
   const casacore::uInt polID = currentPolID();
   ASKAPASSERT(polSubtable.nPol(polID) == nPol());
   stokes = polSubtable.getTypes(polID).copy();
@@ -764,14 +1891,13 @@ void TableConstDataIterator::fillStokes(casacore::Vector<casacore::Stokes::Stoke
 /// @param[in] freq a reference to a vector to fill
 void TableConstDataIterator::fillFrequency(casacore::Vector<casacore::Double> &freq) const
 {
+  // subtables are read here, the read-ahead job may access the table at the same time
+  TableAccessGuard guard(itsTableMutex);
   ASKAPDEBUGASSERT(itsConverter);
   const ITableSpWindowHolder& spWindowSubtable=subtableInfo().getSpWindow();
   ASKAPDEBUGASSERT(itsCurrentDataDescID>=0);
   const casacore::uInt spWindowID = currentSpWindowID();
 
-  const casacore::uInt nChan = nChannel();
-  const casacore::uInt startChan = startChannel();
-
   // for the time being we don't do the short-cut if a subset of channels
   // is selected without any conversion. In principle it is possible, but
   // we need to take care of constness as taking a slice is not a const
@@ -789,35 +1915,162 @@ void TableConstDataIterator::fillFrequency(casacore::Vector<casacore::Double> &f
 	      "frequency axis ("<<freq.nelements()<<")");
       }
   } else {
-      // have to process element by element as a conversion is required
-      const casacore::MEpoch epoch=currentEpoch();
-      // always use the dish pointing centre, rather than a pointing centre
-      // of each individual feed for frequency conversion. The error is not
-      // huge. If this code will ever work for SKA, this may need to be changed.
-      // Currently use the FIELD table, not the actual pointing. It is probably
-      // correct to use the phase centre for conversion as opposed to the
-      // pointing centre.
-      const casacore::MDirection& antReferenceDir = getCurrentReferenceDir();
-      // currently use the position of the first antenna for convertion.
-      // we may need some average position + a check that they are close
-      // enough to throw an exception if someone gives a VLBI measurement set.
-      itsConverter->setMeasFrame(casacore::MeasFrame(epoch, subtableInfo().
-                     getAntenna().getPosition(0), antReferenceDir));
-
-      freq.resize(nChan);
-      for (uInt ch=0;ch<nChan;++ch) {
-           freq[ch]=itsConverter->frequency(spWindowSubtable.getFrequency(
-	                                    spWindowID,ch+startChan));
+      setSpectralConversionFrame();
+      fillConvertedSpectralAxis(freq, false);
+  }
+}
+
+/// populate the buffer with velocities
+/// @details A rest frequency should be set in the converter, otherwise an exception is thrown
+/// @param[in] vel a reference to a vector to fill
+void TableConstDataIterator::fillVelocity(casacore::Vector<casacore::Double> &vel) const
+{
+  TableAccessGuard guard(itsTableMutex);
+  ASKAPDEBUGASSERT(itsConverter);
+  setSpectralConversionFrame();
+  fillConvertedSpectralAxis(vel, true);
+}
+
+/// @brief set up the measure frame of the converter for the spectral conversions
+/// @details The frame is defined by the current epoch, the position of the first antenna
+/// and the reference direction of the current field
+void TableConstDataIterator::setSpectralConversionFrame() const
+{
+  const casacore::MEpoch epoch=currentEpoch();
+  // always use the dish pointing centre, rather than a pointing centre
+  // of each individual feed for frequency conversion. The error is not
+  // huge. If this code will ever work for SKA, this may need to be changed.
+  // Currently use the FIELD table, not the actual pointing. It is probably
+  // correct to use the phase centre for conversion as opposed to the
+  // pointing centre.
+  const casacore::MDirection& antReferenceDir = getCurrentReferenceDir();
+  // currently use the position of the first antenna for convertion.
+  // we may need some average position + a check that they are close
+  // enough to throw an exception if someone gives a VLBI measurement set.
+  itsConverter->setMeasFrame(casacore::MeasFrame(epoch, subtableInfo().
+                 getAntenna().getPosition(0), antReferenceDir));
+}
+
+/// @brief exact conversion of one channel of the current spectral window
+/// @details Channels outside the band (negative or beyond the last channel) are
+/// extrapolated linearly from the frequency axis of the spectral window.
+/// @param[in] chan channel number (in the full spectral window)
+/// @param[in] velocity true to convert to velocity, false to convert to frequency
+/// @return converted value in units/frame given by the converter
+casacore::Double TableConstDataIterator::convertChannel(casacore::Int chan, bool velocity) const
+{
+  const ITableSpWindowHolder &spWindowSubtable = subtableInfo().getSpWindow();
+  const casacore::MVFrequency value(casacore::Quantity(rawChannelFrequency(chan),
+                                    spWindowSubtable.getFrequencyUnit()));
+  const casacore::MFrequency freq(value, spWindowSubtable.getReferenceFrame(currentSpWindowID()));
+  return velocity ? itsConverter->velocity(freq) : itsConverter->frequency(freq);
+}
+
+/// @brief frequency of a raw channel of the current spectral window
+/// @details Channels outside the band (negative or beyond the last channel) are
+/// extrapolated linearly from the frequency axis of the spectral window.
+/// @param[in] chan channel number (in the full spectral window)
+/// @return frequency in the units and frame of the SPECTRAL_WINDOW subtable
+casacore::Double TableConstDataIterator::rawChannelFrequency(casacore::Int chan) const
+{
+  const casacore::Vector<casacore::Double> &freqs =
+         subtableInfo().getSpWindow().getFrequencies(currentSpWindowID());
+  const casacore::Int nFreq = casacore::Int(freqs.nelements());
+  ASKAPDEBUGASSERT(nFreq > 0);
+  if ((chan >= 0) && (chan < nFreq)) {
+      return freqs[chan];
+  }
+  // the width of a single channel is unknown, all channels are assumed to have the same frequency
+  const casacore::Double freqInc = nFreq > 1 ? freqs[1] - freqs[0] : 0.;
+  return freqs[0] + freqInc * chan;
+}
+
+/// @brief convert the spectral axis of the current chunk
+/// @details Within one chunk, the frame conversion of frequencies is a single Doppler
+/// factor and the conversion to velocity is a linear function of frequency (to a very good
+/// approximation). Therefore, only a few reference channels are converted exactly, the
+/// linear transformation is derived from them and applied to all channels in one pass.
+/// The exact conversion of each channel is done only if the linear approximation fails
+/// the tolerance check at the middle channel. The measure frame of the converter should be
+/// set up prior to the call to this method. Selected channels outside the band are
+/// extrapolated from the frequency axis of the spectral window.
+/// @param[in] out a reference to a vector to fill (resized to nChannel() elements)
+/// @param[in] velocity true to convert to velocity, false to convert to frequency
+void TableConstDataIterator::fillConvertedSpectralAxis(casacore::Vector<casacore::Double> &out,
+                                                       bool velocity) const
+{
+  const casacore::uInt nChan = nChannel();
+  // the first selected raw channel, it is negative if the selection starts below the band
+  const casacore::Int startChan = casacore::Int(startChannel()) - casacore::Int(itsLeadingOutOfBand);
+  // the value for an averaged channel is the mean of the values for the raw channels
+  const casacore::uInt nAvg = channelAveraging();
+  const casacore::uInt nRaw = nChan * nAvg;
+  // the buffer may reference the frequency axis of the subtable (see fillFrequency),
+  // so always write into a new array
+  out.reference(casacore::Vector<casacore::Double>(nChan));
+
+  if (nRaw > 2) {
+      const casacore::Int first = startChan;
+      const casacore::Int last = startChan + casacore::Int(nRaw) - 1;
+      const casacore::Int middle = startChan + casacore::Int(nRaw / 2);
+      // frequencies in the frame and units of the SPECTRAL_WINDOW subtable
+      const casacore::Double freqFirst = rawChannelFrequency(first);
+      const casacore::Double freqLast = rawChannelFrequency(last);
+      if (freqLast != freqFirst) {
+          const casacore::Double valFirst = convertChannel(first, velocity);
+          const casacore::Double valLast = convertChannel(last, velocity);
+          const casacore::Double slope = (valLast - valFirst) / (freqLast - freqFirst);
+          const casacore::Double offset = valFirst - slope * freqFirst;
+          // tolerance is a tiny fraction of the channel spacing
+          const casacore::Double tolerance = 1e-6 * std::abs(valLast - valFirst) / (nRaw - 1);
+          if (std::abs(offset + slope * rawChannelFrequency(middle) - convertChannel(middle, velocity)) <= tolerance) {
+              const casacore::Double scale = slope / nAvg;
+              if (outOfBandChannels()) {
+                  for (casacore::uInt ch = 0; ch < nChan; ++ch) {
+                       casacore::Double sum = 0.;
+                       for (casacore::uInt raw = 0; raw < nAvg; ++raw) {
+                            sum += rawChannelFrequency(startChan + casacore::Int(ch * nAvg + raw));
+                       }
+                       out[ch] = offset + scale * sum;
+                  }
+                  return;
+              }
+              const casacore::Vector<casacore::Double> &rawFreqs =
+                     subtableInfo().getSpWindow().getFrequencies(currentSpWindowID());
+              ASKAPDEBUGASSERT(casacore::uInt(last) < rawFreqs.nelements());
+              bool deleteIt;
+              const casacore::Double *src = rawFreqs.getStorage(deleteIt);
+              const casacore::Double *chanFreqs = src + startChan;
+              for (casacore::uInt ch = 0; ch < nChan; ++ch, chanFreqs += nAvg) {
+                   casacore::Double sum = 0.;
+                   for (casacore::uInt raw = 0; raw < nAvg; ++raw) {
+                        sum += chanFreqs[raw];
+                   }
+                   out[ch] = offset + scale * sum;
+              }
+              rawFreqs.freeStorage(src, deleteIt);
+              return;
+          }
       }
   }
+
+  // exact conversion of each channel
+  for (uInt ch=0;ch<nChan;++ch) {
+       casacore::Double sum = 0.;
+       for (uInt raw = 0; raw < nAvg; ++raw) {
+            sum += convertChannel(startChan + casacore::Int(ch * nAvg + raw), velocity);
+       }
+       out[ch] = sum / nAvg;
+  }
 }
 
 /// @return the time stamp
 casacore::Double TableConstDataIterator::getTime() const
 {
+  TableAccessGuard guard(itsTableMutex);
   // add additional checks in debug mode
   #ifdef ASKAP_DEBUG
-   ROScalarColumn<Double> timeCol(itsCurrentIteration,"TIME");
+   const ROScalarColumn<Double> &timeCol = itsColumns.scalarColumn<Double>("TIME");
    Double time=timeCol(itsCurrentTopRow);
     Vector<Double> allTimes=timeCol.getColumnRange(Slicer(IPosition(1,
                        itsCurrentTopRow),IPosition(1,itsNumberOfRows)));
@@ -829,7 +2082,7 @@ casacore::Double TableConstDataIterator::getTime() const
   #endif
   // end of additional checks
 
-  ROScalarMeasColumn<MEpoch> timeMeasCol(itsCurrentIteration,"TIME");
+  const ROScalarMeasColumn<MEpoch> &timeMeasCol = itsColumns.timeMeasColumn();
   return itsConverter->epoch(timeMeasCol(itsCurrentTopRow));
 }
 
@@ -872,7 +2125,8 @@ void TableConstDataIterator::fillFeed2(casacore::Vector<casacore::uInt> &ids) co
 void TableConstDataIterator::fillVectorOfIDs(casacore::Vector<casacore::uInt> &ids,
                      const casacore::String &name) const
 {
-  ROScalarColumn<Int> col(itsCurrentIteration,name);
+  TableAccessGuard guard(itsTableMutex);
+  const ROScalarColumn<Int> &col = itsColumns.scalarColumn<Int>(name);
   ids.resize(itsNumberOfRows);
   Vector<Int> buf=col.getColumnRange(Slicer(IPosition(1,
                       itsCurrentTopRow),IPosition(1,itsNumberOfRows)));
@@ -899,50 +2153,98 @@ casacore::MEpoch TableConstDataIterator::currentEpoch() const
 /// @brief Fill internal buffer with parallactic angles
 /// @details This buffer holds parallactic angles for all antennas. The buffer
 /// is invalidated when the time changes for an alt-az array, for an equatorial
-/// array it happens only if the pointing changes.
+/// array it happens only if the pointing changes. The reference direction is converted
+/// to HADEC once, the hour angle for other antennas differs by the difference in longitude.
+/// Parallactic angles are then computed analytically for all antennas in one pass.
 /// @param[in] angles a reference to a vector to be filled
 void TableConstDataIterator::fillParallacticAngleCache(casacore::Vector<casacore::Double> &angles) const
 {
-  angles.resize(subtableInfo().getAntenna().getNumberOfAntennas());
+  // subtables are read here, the read-ahead job may access the table at the same time
+  TableAccessGuard guard(itsTableMutex);
+  const IAntennaSubtableHandler &antennas = subtableInfo().getAntenna();
+  const casacore::uInt nAnt = antennas.getNumberOfAntennas();
+  angles.resize(nAnt);
   ASKAPDEBUGASSERT(angles.size());
-  if (subtableInfo().getAntenna().allEquatorial()) {
-      angles.set(0.);
-  } else {
+  angles.set(0.);
+  if (antennas.allEquatorial()) {
+      return;
+  }
 
-  const casacore::MEpoch epoch=currentEpoch();
+  // mount types are checked first, the first alt-az antenna is used for the conversion
+  casacore::uInt refAnt = nAnt;
+  for (casacore::uInt ant = 0; ant < nAnt; ++ant) {
+       const IAntennaSubtableHandler::MountType mount = antennas.getMountType(ant);
+       if (mount == IAntennaSubtableHandler::UNKNOWN) {
+           ASKAPTHROW(DataAccessError,"Unknown mount type "<<antennas.getMount(ant)<<
+              " for antenna "<<ant);
+       }
+       if ((mount == IAntennaSubtableHandler::ALT_AZ) && (refAnt == nAnt)) {
+           refAnt = ant;
+       }
+  }
+  if (refAnt == nAnt) {
+      // equatorial, fixed and X-Y mounts only
+      return;
+  }
 
-  // we need a separate converter for parallactic angle calculations
-  DirectionConverter dirConv((casacore::MDirection::Ref(casacore::MDirection::AZEL)));
-  dirConv.setMeasFrame(epoch);
+  const casacore::MEpoch epoch=currentEpoch();
 
   // we currently use FIELD table to get the pointing direction. This table
   // does not depend on the antenna.
   const casacore::MDirection& antReferenceDir = getCurrentReferenceDir();
 
+  const casacore::Vector<casacore::Double> &latitudes = antennas.getLatitudes();
+  const casacore::Vector<casacore::Double> &longitudes = antennas.getLongitudes();
+  ASKAPDEBUGASSERT((latitudes.nelements() == nAnt) && (longitudes.nelements() == nAnt));
+
+  DirectionConverter dirConv((casacore::MDirection::Ref(casacore::MDirection::HADEC)));
+  dirConv.setMeasFrame(casacore::MeasFrame(antennas.getPosition(refAnt),epoch));
+  const casacore::MVDirection haDec = dirConv(antReferenceDir);
+  // hour angle at zero longitude
+  const double ha0 = haDec.getLong() - longitudes[refAnt];
+  const double sinDec = std::sin(haDec.getLat());
+  const double cosDec = std::cos(haDec.getLat());
+
+  // angles have just been resized, so the storage is contiguous
+  casacore::Double *pAngles = angles.data();
+  const casacore::Double *pLat = latitudes.data();
+  const casacore::Double *pLong = longitudes.data();
+  for (casacore::uInt ant = 0; ant < nAnt; ++ant) {
+       const double ha = ha0 + pLong[ant];
+       const double sinLat = std::sin(pLat[ant]);
+       const double cosLat = std::cos(pLat[ant]);
+       pAngles[ant] = std::atan2(cosLat * std::sin(ha), sinLat * cosDec - cosLat * sinDec * std::cos(ha));
+  }
 
-  for (casacore::uInt ant = 0; ant<angles.size(); ++ant) {
-       const casacore::String &antMount=subtableInfo().getAntenna().
-                                          getMount(ant);
-
-       if (antMount == "ALT-AZ" || antMount == "alt-az")  {
-           casacore::MDirection celestialPole;
-           celestialPole.set(MDirection::Ref(MDirection::HADEC));
-           dirConv.setMeasFrame(casacore::MeasFrame(subtableInfo().getAntenna().
-                              getPosition(ant),epoch));
-           const casacore::Double pAngle=dirConv(antReferenceDir).
-                               positionAngle(dirConv(celestialPole).getValue());
-           angles[ant] = pAngle;
-       } else if (antMount == "FIXED"  ||  antMount == "fixed") {
-           // LOFAR has a fixed antenna mount.
+  // other mounts don't require parallactic angle rotation
+  for (casacore::uInt ant = 0; ant < nAnt; ++ant) {
+       if (antennas.getMountType(ant) != IAntennaSubtableHandler::ALT_AZ) {
            angles[ant] = 0.;
-       } else if (antMount == "X-Y"  ||  antMount == "x-y") {
-           angles[ant] = 0.;
-       } else if (antMount != "EQUATORIAL" && antMount != "equatorial") {
-           ASKAPTHROW(DataAccessError,"Unknown mount type "<<antMount<<
-              " for antenna "<<ant);
+       } else if (itsValidateParallacticAngle) {
+           const casacore::Double reference = measuresParallacticAngle(ant, epoch);
+           const double diff = std::remainder(angles[ant] - reference, casacore::C::_2pi);
+           ASKAPCHECK(std::abs(diff) < 1e-5, "Parallactic angle "<<angles[ant]<<" rad computed for antenna "<<
+                      ant<<" doesn't match "<<reference<<" rad obtained with casacore measures");
        }
-    }
-  } // if all equatorial
+  }
+}
+
+/// @brief compute parallactic angle for one antenna using casacore measures
+/// @details This is the reference implementation used in the validation mode
+/// (see setParallacticAngleValidation).
+/// @param[in] ant antenna index
+/// @param[in] epoch time of the observation
+/// @return parallactic angle in radians
+casacore::Double TableConstDataIterator::measuresParallacticAngle(casacore::uInt ant,
+                        const casacore::MEpoch &epoch) const
+{
+  // we need a separate converter for parallactic angle calculations
+  DirectionConverter dirConv((casacore::MDirection::Ref(casacore::MDirection::AZEL)));
+  dirConv.setMeasFrame(casacore::MeasFrame(subtableInfo().getAntenna().
+                              getPosition(ant),epoch));
+  casacore::MDirection celestialPole;
+  celestialPole.set(MDirection::Ref(MDirection::HADEC));
+  return dirConv(getCurrentReferenceDir()).positionAngle(dirConv(celestialPole).getValue());
 }
 
 
@@ -957,6 +2259,8 @@ void TableConstDataIterator::fillParallacticAngleCache(casacore::Vector<casacore
 /// @param[in] dirs a reference to a vector to fill
 void TableConstDataIterator::fillDirectionCache(casacore::Vector<casacore::MVDirection> &dirs) const
 {
+  // subtables are read here, the read-ahead job may access the table at the same time
+  TableAccessGuard guard(itsTableMutex);
   // the code fills both pointing directions and position angles. For ASKAP, it would
   // probably be a bit faster if we split these two operations between two methods, as
   // position angle will be fixed and will not need as much updating as the pointing.
@@ -986,17 +2290,12 @@ void TableConstDataIterator::fillDirectionCache(casacore::Vector<casacore::MVDir
   const casacore::Vector<casacore::RigidVector<casacore::Double, 2> > &offsets =
                feedSubtable.getAllBeamOffsets(epoch,spWindowID);
 
+  // offsets are applied first, the conversion is done for all elements of the same
+  // antenna at once (or for all elements at once if it doesn't depend on the position)
+  casacore::Vector<casacore::MVDirection> feedPointingCentres(antIDs.nelements());
   for (casacore::uInt element=0;element<antIDs.nelements();++element) {
        const casacore::uInt ant=antIDs[element];
 
-       // if we decide to be paranoid about performance, we can add a method
-       // to the converter to test whether antenna position and/or epoch are
-       // really required to the requested convertion. Because the antenna
-       // position are cached, the overhead of the present straightforward
-       // approach should be relatively minor.
-       itsConverter->setMeasFrame(casacore::MeasFrame(epoch,subtableInfo().
-                     getAntenna().getPosition(ant)));
-
        casacore::RigidVector<casacore::Double, 2> offset = offsets[element];
        ASKAPDEBUGASSERT(ant<parallacticAngles.nelements());
        const casacore::Double posAngle = parallacticAngles[ant];
@@ -1013,11 +2312,51 @@ void TableConstDataIterator::fillDirectionCache(casacore::Vector<casacore::MVDir
            rotMatrix(1,1)=cpa;
            offset*=rotMatrix;
        }
-       casacore::MDirection feedPointingCentre(antReferenceDir);
+       feedPointingCentres[element] = antReferenceDir.getValue();
        // x direction is flipped to convert az-el type frame to ra-dec
-       feedPointingCentre.shift(casacore::MVDirection(-offset(0),
+       feedPointingCentres[element].shift(casacore::MVDirection(-offset(0),
                              offset(1)),casacore::True);
-       itsConverter->direction(feedPointingCentre,dirs[element]);
+  }
+  convertForAllAntennas(antReferenceDir.getRef(), antIDs, feedPointingCentres, dirs);
+}
+
+/// @brief convert directions given for a number of antennas
+/// @details The frame is set up once per epoch if the conversion doesn't depend on
+/// the antenna position, otherwise it is set up once for each run of elements
+/// corresponding to the same antenna (the FEED subtable is usually ordered by antenna).
+/// @param[in] ref reference frame of the input directions
+/// @param[in] antIDs antenna index for each element
+/// @param[in] in input directions, one per element
+/// @param[out] out converted directions (resized to match the input)
+void TableConstDataIterator::convertForAllAntennas(const casacore::MDirection::Ref &ref,
+                 const casacore::Vector<casacore::Int> &antIDs,
+                 const casacore::Vector<casacore::MVDirection> &in,
+                 casacore::Vector<casacore::MVDirection> &out) const
+{
+  ASKAPDEBUGASSERT(itsConverter);
+  ASKAPDEBUGASSERT(antIDs.nelements() == in.nelements());
+  out.resize(in.nelements());
+  if (in.nelements() == 0) {
+      return;
+  }
+  const casacore::MEpoch epoch = currentEpoch();
+  const IAntennaSubtableHandler &antennas = subtableInfo().getAntenna();
+  if (!itsConverter->isDirectionPositionDependent(ref)) {
+      itsConverter->setMeasFrame(casacore::MeasFrame(epoch, antennas.getPosition(antIDs[0])));
+      itsConverter->direction(ref, in, out);
+      return;
+  }
+  casacore::Vector<casacore::MVDirection> buf;
+  for (casacore::uInt start = 0; start < in.nelements(); ) {
+       casacore::uInt stop = start + 1;
+       while ((stop < in.nelements()) && (antIDs[stop] == antIDs[start])) {
+              ++stop;
+       }
+       itsConverter->setMeasFrame(casacore::MeasFrame(epoch, antennas.getPosition(antIDs[start])));
+       const casacore::Slice range(start, stop - start);
+       itsConverter->direction(ref, in(range), buf);
+       out(range) = buf;
+       start = stop;
   }
 }
 
@@ -1114,6 +2453,7 @@ void TableConstDataIterator::fillDishPointing2(casacore::Vector<casacore::MVDire
 /// @param[in] dirs a reference to a vector to fill
 void TableConstDataIterator::fillDishPointingCache(casacore::Vector<casacore::MVDirection> &dirs) const
 {
+  TableAccessGuard guard(itsTableMutex);
   ASKAPDEBUGASSERT(itsConverter);
   const casacore::MEpoch epoch = currentEpoch();
 
@@ -1124,16 +2464,20 @@ void TableConstDataIterator::fillDishPointingCache(casacore::Vector<casacore::MV
   // a dependence (i.e. a large array and AZEL frame requested)
   const casacore::MDirection& antReferenceDir = getCurrentReferenceDir();
 
-  for (casacore::uInt ant = 0; ant<dirs.nelements(); ++ant) {
-       // if we decide to be paranoid about performance, we can add a method
-       // to the converter to test whether antenna position and/or epoch are
-       // really required to the requested convertion. Because the antenna
-       // position are cached, the overhead of the present straightforward
-       // approach should be relatively minor.
-       itsConverter->setMeasFrame(casacore::MeasFrame(epoch,subtableInfo().
-                  getAntenna().getPosition(ant)));
-       itsConverter->direction(antReferenceDir,dirs[ant]);
+  if (!itsConverter->isDirectionPositionDependent(antReferenceDir.getRef())) {
+      // the same direction for all antennas, convert it only once
+      itsConverter->setMeasFrame(casacore::MeasFrame(epoch,subtableInfo().
+                  getAntenna().getPosition(0)));
+      casacore::MVDirection dir;
+      itsConverter->direction(antReferenceDir, dir);
+      dirs.set(dir);
+      return;
   }
+  const casacore::uInt nAnt = dirs.nelements();
+  casacore::Vector<casacore::Int> antIDs(nAnt);
+  casacore::indgen(antIDs);
+  const casacore::Vector<casacore::MVDirection> refDirs(nAnt, antReferenceDir.getValue());
+  convertForAllAntennas(antReferenceDir.getRef(), antIDs, refDirs, dirs);
 }
 
 /// @brief A helper method to fill a given vector with pointing directions.
@@ -1148,6 +2492,7 @@ void TableConstDataIterator::fillVectorOfPointings(
                const casacore::Vector<casacore::uInt> &antIDs,
                const casacore::Vector<casacore::uInt> &feedIDs) const
 {
+  TableAccessGuard guard(itsTableMutex);
   ASKAPDEBUGASSERT(antIDs.nelements() == feedIDs.nelements());
   const casacore::Vector<casacore::MVDirection> &directionCache =
       itsDirectionCache.value(*this,&TableConstDataIterator::fillDirectionCache);
@@ -1188,6 +2533,7 @@ void TableConstDataIterator::fillVectorOfPositionAngles(casacore::Vector<casacor
               const casacore::Vector<casacore::uInt> &antIDs,
               const casacore::Vector<casacore::uInt> &feedIDs) const
 {
+  TableAccessGuard guard(itsTableMutex);
   ASKAPDEBUGASSERT(antIDs.nelements() == feedIDs.nelements());
   const casacore::Vector<casacore::Double> &parallacticAngles = itsParallacticAngleCache.value(*this,
                  &TableConstDataIterator::fillParallacticAngleCache);
@@ -1241,14 +2587,14 @@ casacore::uInt TableConstDataIterator::currentFieldID() const
 /// @return current scan ID
 casacore::uInt TableConstDataIterator::currentScanID() const
 {
-  casacore::Vector<casacore::uInt> ids;
-  fillVectorOfIDs(ids,"SCAN_NUMBER");
-  ASKAPCHECK(ids.nelements()>0, "An attempt to extract scan ID for empty iteration");
-  const casacore::uInt scanID = ids[0];
+  ASKAPCHECK(itsNumberOfRows>0, "An attempt to extract scan ID for empty iteration");
+  TableAccessGuard guard(itsTableMutex);
+  // the whole column is read once per iteration, later calls use the cached runs
+  casacore::rownr_t runEnd = 0;
+  const casacore::Int scanID = itsColumns.intColumnRun("SCAN_NUMBER", itsCurrentTopRow, runEnd);
+  ASKAPDEBUGASSERT(scanID >= 0);
   // do cross-check
-  for (casacore::uInt row=1; row<ids.nelements(); ++row) {
-       ASKAPCHECK(scanID == ids[row], "Scan ID seem to differ for row="<<row<<" of the current iteration; was "<<scanID<<
-                  " now "<<ids[row]);
-  }
-  return scanID;
+  ASKAPCHECK(runEnd >= itsCurrentTopRow + itsNumberOfRows, "Scan ID seem to differ for row="<<
+             runEnd - itsCurrentTopRow<<" of the current iteration; was "<<scanID);
+  return static_cast<casacore::uInt>(scanID);
 }
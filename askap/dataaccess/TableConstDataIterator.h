@@ -37,14 +37,19 @@
 // std includes
 #include <string>
 #include <utility>
+#include <map>
 
 // boost includes
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/recursive_mutex.hpp>
 
 // casa includes
 #include <casacore/tables/Tables/Table.h>
 #include <casacore/tables/Tables/TableIter.h>
 #include <casacore/measures/Measures/Stokes.h>
+#include <casacore/measures/Measures/MFrequency.h>
+#include <casacore/measures/Measures/MeasFrame.h>
+#include <casacore/casa/Arrays/Matrix.h>
 
 
 // own includes
@@ -55,6 +60,11 @@
 #include <askap/dataaccess/TableInfoAccessor.h>
 #include <askap/dataaccess/ITableManager.h>
 #include <askap/dataaccess/CachedAccessorField.tcc>
+#include <askap/dataaccess/TableReadAheadBuffer.h>
+#include <askap/dataaccess/TablePartitionPlan.h>
+#include <askap/dataaccess/TableColumnHandles.h>
+#include <askap/dataaccess/TableTimeIndex.h>
+#include <askap/dataaccess/PackedFlags.h>
 
 namespace askap {
 
@@ -78,12 +88,26 @@ public:
   /// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads
   /// to initialisation of a new UVW Machine
   /// @param[in] maxChunkSize maximum number of rows per accessor
+  /// @param[in] plan shared partition plan, if the iterator should only cover one
+  /// partition of the selected rows (empty shared pointer means no partitioning)
+  /// @param[in] part partition to iterate over (ignored if no partition plan is given)
+  /// @note If the partition plan is given, the selection expression of the selector is
+  /// assumed to be already applied to the partitions.
   TableConstDataIterator(const boost::shared_ptr<ITableManager const>
               &msManager,
               const boost::shared_ptr<ITableDataSelectorImpl const> &sel,
 	      const boost::shared_ptr<IDataConverterImpl const> &conv,
 	      size_t cacheSize = 1, double tolerance = 1e-6,
-	      casacore::uInt maxChunkSize = INT_MAX);
+	      casacore::uInt maxChunkSize = INT_MAX,
+	      const boost::shared_ptr<TablePartitionPlan const> &plan =
+	                    boost::shared_ptr<TablePartitionPlan const>(),
+	      casacore::uInt part = 0);
+
+  /// @brief destructor
+  /// @details The read-ahead job is stopped first. Table objects are reference counted
+  /// and the table may be shared with iterators used in other threads, so they are released
+  /// with the table mutex locked.
+  virtual ~TableConstDataIterator();
 
   /// Restart the iteration from the beginning
   virtual void init();
@@ -101,6 +125,99 @@ public:
   ///         while(it.next()) {} are possible)
   virtual casacore::Bool next();
 
+  /// @brief enable asynchronous read-ahead
+  /// @details When enabled, visibilities, flags, noise and uvw for the next chunk
+  /// are read in a background thread while the current chunk is processed. Only the
+  /// fields requested for the previous chunk are read in advance. At most one chunk is
+  /// read ahead. All access to the table is serialised because casacore tables are not
+  /// thread-safe. Read-ahead should not be used for read-write iteration.
+  /// @param[in] maxMemory maximum memory in bytes for both current and next chunk buffers
+  /// (read-ahead is skipped for the chunks which don't fit)
+  void enableReadAhead(size_t maxMemory);
+
+  /// @brief reduce the memory footprint of the bulk data
+  /// @details In this mode, the single precision and real-valued representations of
+  /// the accessor fields (see TableConstDataAccessor::uvwComponentsFloat, frequencyFloat and
+  /// noiseReal) are filled without keeping the double precision or complex intermediates
+  /// in the accessor cache. Optionally, flags read in advance are held as a bit mask.
+  /// @param[in] compactFlags if true, the read-ahead buffer holds flags as a bit mask
+  /// (this method should be called before enableReadAhead for this to take effect)
+  /// @note This method should be called before setChunkMemoryBudget, as the memory
+  /// estimate per row depends on this mode (an exception is thrown otherwise).
+  void enableReducedFootprint(bool compactFlags = false);
+
+  /// @brief check whether the reduced footprint mode is enabled
+  /// @return true, if the mode is enabled (see enableReducedFootprint)
+  inline bool reducedFootprint() const { return itsReducedFootprint; }
+
+  /// @brief check whether flags read in advance are held as a bit mask
+  /// @return true, if the read-ahead buffer (if any) holds flags as a bit mask
+  inline bool compactFlags() const { return itsCompactFlags; }
+
+  /// @brief limit the memory taken by each chunk
+  /// @details The number of rows per chunk is derived from the memory budget and the
+  /// estimated memory per row (see memoryPerRow), which depends on the number of channels
+  /// and polarisations known after the shape of the data is determined for the current
+  /// DATA_DESC_ID, as well as on the enabled features (read-ahead, reduced footprint mode).
+  /// The limit on the number of rows given in the constructor still applies. At least
+  /// one row is returned in every chunk regardless of the budget.
+  /// @param[in] maxBytes memory budget in bytes (0 means no limit)
+  /// @note This method should be called before enableReadAhead.
+  void setChunkMemoryBudget(size_t maxBytes);
+
+  /// @brief memory budget for each chunk
+  /// @return memory budget in bytes (0 means no limit)
+  inline size_t chunkMemoryBudget() const { return itsChunkMemoryBudget; }
+
+  /// @brief set the number of tangent points in the cache of rotated uvw and delays
+  /// @details Rotated uvw and delays are cached in the accessor for the given number of
+  /// tangent points (see TableConstDataAccessor::setRotatedUVWCacheSize). This is taken into
+  /// account in the memory estimate used with the chunk memory budget.
+  /// @param[in] nTangentPoints a number of tangent points (should be positive)
+  /// @note This method should be called before setChunkMemoryBudget (an exception is
+  /// thrown otherwise).
+  void setRotatedUVWCacheSize(size_t nTangentPoints);
+
+  /// @brief number of tangent points in the cache of rotated uvw and delays
+  /// @return a number of tangent points
+  inline size_t rotatedUVWCacheSize() const { return itsRotatedUVWCacheSize; }
+
+  /// @brief enable or disable validation of parallactic angles
+  /// @details Parallactic angles are computed analytically from the antenna latitudes,
+  /// hour angle and declination. In the validation mode, they are also computed with
+  /// casacore measures for each antenna (which is much slower) and an exception is thrown
+  /// if the results disagree.
+  /// @param[in] validate true to enable the validation mode
+  void setParallacticAngleValidation(bool validate);
+
+  /// @brief check whether parallactic angles are validated
+  /// @return true, if the validation mode is enabled
+  inline bool parallacticAngleValidation() const { return itsValidateParallacticAngle; }
+
+  /// @brief iterate over time steps using the time index
+  /// @details Instead of casacore::TableIterator, which creates a reference table for each
+  /// time step, the TIME column of the selected rows is scanned once and the chunks are served
+  /// as row ranges of the selected table. The iterator is rewound to the start.
+  /// @param[in] index index to use (e.g. obtained from another iterator with the same selection),
+  /// a new index is built if the shared pointer is empty or the index doesn't match the selection
+  void enableTimeIndex(const boost::shared_ptr<TableTimeIndex const> &index =
+                       boost::shared_ptr<TableTimeIndex const>());
+
+  /// @brief obtain the time index
+  /// @details The index can be shared with other iterators using the same selection.
+  /// @return shared pointer to the time index (empty if the time index is not used)
+  inline const boost::shared_ptr<TableTimeIndex const>& timeIndex() const { return itsTimeIndex; }
+
+  /// @brief store the time index in a file
+  /// @details If the directory is set, the time index is loaded from a file in this directory
+  /// on init() (if the file has been written for the same measurement set and selection).
+  /// Otherwise, the index is built and written to the file. This saves the evaluation of the
+  /// selection expression and the scan of the TIME column when the same dataset is processed
+  /// again. It only works for the time index (see enableTimeIndex) and is not used for
+  /// partitioned iteration. The new setting takes effect on the next init().
+  /// @param[in] dir directory to store index files in (an empty string disables index files)
+  inline void setIndexFileDirectory(const std::string &dir) { itsIndexFileDirectory = dir; }
+
   /// methods used in the accessor.
 
   /// @return number of rows in the current accessor
@@ -113,8 +230,11 @@ public:
   /// @return number of channels in the current accessor
   casacore::uInt inline nChannel() const throw() { return getChannelRange().first;}
 
-  /// @return number of channels in the current accessor
-  casacore::uInt inline nPol() const throw() { return itsNumberOfPols;}
+  /// @return number of polarisation products in the current accessor
+  /// @note This can differ from the number of products in the dataset if polarisations
+  /// are selected (and converted) on read
+  casacore::uInt inline nPol() const throw() { return itsSelector->polarisationsSelected() ?
+         casacore::uInt(itsSelector->getPolarisationSelection().nelements()) : itsNumberOfPols;}
 
   /// populate the buffer of visibilities with the values of current
   /// iteration
@@ -128,6 +248,40 @@ public:
   ///            cube to be filled with the noise figures
   void fillNoise(casacore::Cube<casacore::Complex> &noise) const;
 
+  /// @brief populate the buffer of real-valued noise figures
+  /// @details This is the same information as returned by fillNoise, but only one value
+  /// is stored per sample (the noise is the same for real and imaginary parts).
+  /// @param[in] noise a reference to the nRow x nChannel x nPol buffer
+  ///            cube to be filled with the noise figures
+  void fillNoiseReal(casacore::Cube<casacore::Float> &noise) const;
+
+  /// @brief check whether the noise is the same for all spectral channels
+  /// @details This is the case if the noise is given by the SIGMA column per row and
+  /// polarisation (or is not given at all) and no channel averaging is done (the noise
+  /// of the averaged channel depends on the number of unflagged samples).
+  /// @return true if the noise can be represented by fillCompactNoise
+  bool noiseSpectrallyConstant() const;
+
+  /// @brief populate the buffer of noise figures given per row and polarisation
+  /// @details This method can only be used if the noise is the same for all spectral
+  /// channels (see noiseSpectrallyConstant). The same noise applies to real and imaginary parts.
+  /// @param[in] sigma a reference to the nRow x nPol matrix to be filled with the noise figures
+  void fillCompactNoise(casacore::Matrix<casacore::Float> &sigma) const;
+
+  /// @brief expand the noise given per row and polarisation to all channels
+  /// @param[in] sigma nRow x nPol matrix with the noise figures
+  /// @param[in] nChan number of spectral channels
+  /// @param[out] noise cube to fill (resized to nRow x nChan x nPol)
+  static void broadcastNoise(const casacore::Matrix<casacore::Float> &sigma, casacore::uInt nChan,
+                             casacore::Cube<casacore::Float> &noise);
+
+  /// @brief expand the noise given per row and polarisation to all channels
+  /// @param[in] sigma nRow x nPol matrix with the noise figures
+  /// @param[in] nChan number of spectral channels
+  /// @param[out] noise cube to fill (resized to nRow x nChan x nPol)
+  static void broadcastNoise(const casacore::Matrix<casacore::Float> &sigma, casacore::uInt nChan,
+                             casacore::Cube<casacore::Complex> &noise);
+
   /// @brief read flagging information
   /// @details populate the buffer of flags with the information
   /// read in the current iteration
@@ -136,15 +290,48 @@ public:
   ///            bool type)
   void fillFlag(casacore::Cube<casacore::Bool> &flag) const;
 
+  /// @brief read visibilities in the measurement set order
+  /// @details populate the buffer of visibilities with the values of current
+  /// iteration without reordering them
+  /// @param[in] vis a reference to the nPol x nChannel x nRow buffer
+  ///            cube to fill with the complex visibility data
+  void fillVisibilityNative(casacore::Cube<casacore::Complex> &vis) const;
+
+  /// @brief read flagging information in the measurement set order
+  /// @details populate the buffer of flags with the information
+  /// read in the current iteration without reordering it
+  /// @param[in] flag a reference to the nPol x nChannel x nRow buffer
+  ///            cube to fill with the flag information
+  void fillFlagNative(casacore::Cube<casacore::Bool> &flag) const;
+
+  /// @brief read flagging information as a bit mask
+  /// @details This is the same information as returned by fillFlag, but one bit per sample
+  /// is used. Flags are read in blocks of rows (see theirRowBlockSize) and each block is packed
+  /// straight from the buffer in the measurement set order, then FLAG_ROW is applied to whole
+  /// rows of bits.
+  /// @param[in] flag packed flags to fill (nRow x nChannel x nPol)
+  void fillPackedFlag(PackedFlags &flag) const;
+
   /// populate the buffer with uvw
   /// @param[in] uvw a reference to vector of rigid vectors (3 elemets,
   ///            u,v and w for each row) to fill
   void fillUVW(casacore::Vector<casacore::RigidVector<casacore::Double, 3> >&uvw) const;
 
+  /// @brief populate the buffer with uvw stored as separate arrays of u, v and w
+  /// @details This is the same information as returned by fillUVW, but the UVW column
+  /// is de-interleaved into contiguous vectors for each component straight after reading.
+  /// @param[in] uvw a reference to the uvw components to fill
+  void fillUVWComponents(UVWComponents<casacore::Double> &uvw) const;
+
   /// populate the buffer with frequencies
   /// @param[in] freq a reference to a vector to fill
   void fillFrequency(casacore::Vector<casacore::Double> &freq) const;
 
+  /// populate the buffer with velocities
+  /// @details A rest frequency should be set in the converter, otherwise an exception is thrown
+  /// @param[in] vel a reference to a vector to fill
+  void fillVelocity(casacore::Vector<casacore::Double> &vel) const;
+
   /// @return the time stamp in the table's native frame/units
   /// @note this method doesn't do any caching. It reads the table each
   /// time it is called. It is intended for use from the accessor only, where
@@ -238,9 +425,110 @@ protected:
   std::pair<casacore::uInt, casacore::uInt> getChannelRange() const;
 
   /// @brief a short cut to get the first channel in the full cube
+  /// @details If the frequency selection extends beyond the band, this is the first
+  /// selected channel which exists in the spectral window (see outOfBandChannels).
   /// @return the number of the first channel in the full cube
   inline casacore::uInt startChannel() const { return getChannelRange().second;}
 
+  /// @brief check whether some of the selected channels are outside the spectral window
+  /// @details A frequency selection may extend beyond the band of the current spectral
+  /// window. The raw channels outside the band are not read from the table, the data are
+  /// padded instead (flagged, with zero visibility and unit noise).
+  /// @return true, if some of the selected raw channels are outside the band
+  inline bool outOfBandChannels() const
+     { getChannelRange(); return (itsLeadingOutOfBand + itsTrailingOutOfBand) > 0; }
+
+  /// @brief number of selected raw channels which exist in the spectral window
+  /// @details This is the number of raw channels (before averaging) read from the table,
+  /// starting from startChannel().
+  /// @return number of raw channels inside the band
+  inline casacore::uInt inBandChannels() const
+     { return nChannel() * channelAveraging() - itsLeadingOutOfBand - itsTrailingOutOfBand; }
+
+  /// @brief number of adjacent channels averaged together on read
+  /// @details Averaging is only done if channels are selected with chooseChannels
+  /// (and not via frequency selection). Each channel returned by the accessor
+  /// corresponds to this number of channels in the measurement set.
+  /// @return number of channels to average (1 means no averaging)
+  casacore::uInt channelAveraging() const;
+
+  /// @brief check whether polarisation products are converted on read
+  /// @return true, if the products returned by the accessor differ from those in the dataset
+  inline bool polarisationsConverted() const { return itsSelector->polarisationsSelected(); }
+
+  /// @brief obtain the start frequency of the frequency selection in the frame of the data
+  /// @details The conversion engine is set up once per spectral window and frame of the
+  /// selection, only the epoch and direction of its measure frame are updated. The result
+  /// is reused while the field and the time bucket of the epoch stay the same.
+  /// @return start frequency (in Hz) in the frame of the SPECTRAL_WINDOW subtable
+  casacore::Double selectedStartFrequency() const;
+
+  /// @brief set up the measure frame of the converter for the spectral conversions
+  /// @details The frame is defined by the current epoch, the position of the first antenna
+  /// and the reference direction of the current field
+  void setSpectralConversionFrame() const;
+
+  /// @brief convert the spectral axis of the current chunk
+  /// @details Within one chunk, the frame conversion of frequencies is a single Doppler
+  /// factor and the conversion to velocity is a linear function of frequency (to a very good
+  /// approximation). Therefore, only a few reference channels are converted exactly, the
+  /// linear transformation is derived from them and applied to all channels in one pass.
+  /// The exact conversion of each channel is done only if the linear approximation fails
+  /// the tolerance check at the middle channel. The measure frame of the converter should be
+  /// set up prior to the call to this method.
+  /// @param[in] out a reference to a vector to fill (resized to nChannel() elements)
+  /// @param[in] velocity true to convert to velocity, false to convert to frequency
+  void fillConvertedSpectralAxis(casacore::Vector<casacore::Double> &out, bool velocity) const;
+
+  /// @brief exact conversion of one channel of the current spectral window
+  /// @details Channels outside the band (negative or beyond the last channel) are
+  /// extrapolated linearly from the frequency axis of the spectral window.
+  /// @param[in] chan channel number (in the full spectral window)
+  /// @param[in] velocity true to convert to velocity, false to convert to frequency
+  /// @return converted value in units/frame given by the converter
+  casacore::Double convertChannel(casacore::Int chan, bool velocity) const;
+
+  /// @brief frequency of a raw channel of the current spectral window
+  /// @details Channels outside the band (negative or beyond the last channel) are
+  /// extrapolated linearly from the frequency axis of the spectral window.
+  /// @param[in] chan channel number (in the full spectral window)
+  /// @return frequency in the units and frame of the SPECTRAL_WINDOW subtable
+  casacore::Double rawChannelFrequency(casacore::Int chan) const;
+
+  /// @brief pad the data read for the channels inside the band
+  /// @details The array read from the table for inBandChannels() raw channels is
+  /// expanded to all selected raw channels. The channels outside the band are filled
+  /// with the value returned by OutOfBandValue for the given type.
+  /// @param[in] buf array in the measurement set order (nPol x nChannel x nRow) to pad
+  template<typename T>
+  void padOutOfBandChannels(casacore::Array<T> &buf) const;
+
+  /// @brief read a chunk of an array column in the table order
+  /// @details This method reads all rows of the current chunk in one go
+  /// (with a single call to casacore) and returns the data in the order they
+  /// are stored in the measurement set, i.e. nPol x nChannel x nRow. Only selected
+  /// channels are read. If channel averaging is requested, the raw (unaveraged)
+  /// channels are returned, i.e. nChannel() * channelAveraging() of them.
+  /// Selected channels outside the band are padded (see padOutOfBandChannels).
+  /// @param[in] buf array to fill (resized as necessary)
+  /// @param[in] columnName a name of the column to read
+  /// @return true, if the data have been taken from the read-ahead buffer (in this
+  /// case FLAG_ROW is already applied to flags)
+  template<typename T>
+  bool readColumnChunk(casacore::Array<T> &buf, const std::string &columnName) const;
+
+  /// @brief read a range of rows of an array column in the table order
+  /// @details This is the same as readColumnChunk, but only the given rows of the current
+  /// chunk are read (directly from the table). It allows processing of the chunk in blocks
+  /// of rows without holding the whole column in memory. Row-based flags are not applied.
+  /// @param[in] buf array to fill (resized to nPol x nChannel x nRows)
+  /// @param[in] columnName a name of the column to read
+  /// @param[in] startRow the first row to read (relative to the current chunk)
+  /// @param[in] nRows number of rows to read
+  template<typename T>
+  void readColumnRows(casacore::Array<T> &buf, const std::string &columnName,
+                      casacore::uInt startRow, casacore::uInt nRows) const;
+
   /// @brief read an array column of the table into a cube
   /// @details populate the buffer provided with the information
   /// read in the current iteration. This method is templated and can be
@@ -251,6 +539,89 @@ protected:
   template<typename T>
   void fillCube(casacore::Cube<T> &cube, const std::string &columnName) const;
 
+  /// @brief read a chunk of an array column with row-based flags applied
+  /// @details This is a wrapper around readColumnChunk which also takes FLAG_ROW into
+  /// account (for flags only). The result is in the measurement set order and is not averaged.
+  /// @param[in] buf array to fill (resized as necessary)
+  /// @param[in] columnName a name of the column to read
+  template<typename T>
+  void readNativeChunk(casacore::Array<T> &buf, const std::string &columnName) const;
+
+  /// @brief read a chunk of an array column and apply the selection
+  /// @details Channels are averaged and polarisation products are converted if required.
+  /// The result is in the measurement set order and has nPol() polarisations and
+  /// nChannel() channels.
+  /// @param[in] buf array to fill (resized as necessary)
+  /// @param[in] columnName a name of the column to read
+  template<typename T>
+  void readConvertedChunk(casacore::Array<T> &buf, const std::string &columnName) const;
+
+  /// @brief read the UVW column for the current chunk
+  /// @details All rows of the current chunk are read in one go (or taken from the
+  /// read-ahead buffer, if available).
+  /// @param[in] uvw matrix to fill (resized to 3 x nRow)
+  void readUVWChunk(casacore::Matrix<casacore::Double> &uvw) const;
+
+  /// @brief read noise figures for the current chunk in the measurement set order
+  /// @details SIGMA_SPECTRUM is used if present, otherwise SIGMA given per polarisation is
+  /// expanded to all channels (or 1 is assumed if there is no SIGMA column). The noise is
+  /// propagated through channel averaging and polarisation conversion, if required.
+  /// With channel averaging, the raw noise is read and averaged in blocks of rows
+  /// (see theirRowBlockSize), so the raw cube of the whole chunk is never held in memory.
+  /// @param[in] sigma array to fill (resized to nPol() x nChannel() x nRow)
+  void readNoiseChunk(casacore::Array<casacore::Float> &sigma) const;
+
+  /// @brief read the raw noise figures for a range of rows in the measurement set order
+  /// @details SIGMA_SPECTRUM is used if present, otherwise SIGMA given per polarisation is
+  /// expanded to all raw channels (or 1 is assumed if there is no SIGMA column). No
+  /// averaging or polarisation conversion is done.
+  /// @param[in] sigma array to fill (resized to nPol x nChannel()*channelAveraging() x nRows)
+  /// @param[in] startRow the first row to read (relative to the current chunk)
+  /// @param[in] nRows number of rows to read
+  void readRawNoiseRows(casacore::Array<casacore::Float> &sigma, casacore::uInt startRow,
+                        casacore::uInt nRows) const;
+
+  /// @brief maximum number of raw samples processed at once when a chunk is read in blocks of rows
+  /// @details The raw noise figures and flags (for noise averaging and packed flags) are read
+  /// in blocks of rows, so that each block holds no more than this number of samples (at least
+  /// one row is read).
+  static const size_t theirRowBlockSize = 1048576;
+
+  /// @brief average visibilities in the measurement set order
+  /// @details Flags of the current chunk are read to exclude flagged samples from the average.
+  /// @param[in] buf visibilities (nPol x nChannel*nAvg x nRow), replaced by the averaged array
+  void averageChunk(casacore::Array<casacore::Complex> &buf) const;
+
+  /// @brief average flags in the measurement set order
+  /// @details The averaged sample is flagged only if all samples in the bin are flagged
+  /// @param[in] buf flags (nPol x nChannel*nAvg x nRow), replaced by the averaged array
+  void averageChunk(casacore::Array<casacore::Bool> &buf) const;
+
+  /// @brief convert polarisation products of visibilities in the measurement set order
+  /// @param[in] buf visibilities (nPolIn x nChannel x nRow), replaced by the converted array
+  void convertChunk(casacore::Array<casacore::Complex> &buf) const;
+
+  /// @brief convert polarisation products of flags in the measurement set order
+  /// @details An output product is flagged if any input product it depends on is flagged
+  /// @param[in] buf flags (nPolIn x nChannel x nRow), replaced by the converted array
+  void convertChunk(casacore::Array<casacore::Bool> &buf) const;
+
+  /// @brief obtain the matrix of the polarisation conversion
+  /// @details The matrix converts the products stored in the dataset for the current
+  /// DATA_DESC_ID into the products requested via the selector. It is cached until
+  /// DATA_DESC_ID changes.
+  /// @return nPol() x (number of products in the dataset) matrix
+  const casacore::Matrix<casacore::Complex>& polTransform() const;
+
+  /// @brief read an array column of the table into a cube in the table order
+  /// @details This is a version of fillCube which doesn't reorder the data, i.e.
+  /// the cube is nPol x nChannel x nRow like the measurement set itself.
+  /// @param[in] cube a reference to the nPol x nChannel x nRow buffer
+  ///            cube to fill with the information from table
+  /// @param[in] columnName a name of the column to read
+  template<typename T>
+  void fillCubeNative(casacore::Cube<T> &cube, const std::string &columnName) const;
+
   /// @brief A helper method to fill a given vector with pointing directions.
   /// @details fillPointingDir1 and fillPointingDir2 methods do very similar
   /// operations, which differ only by the feedIDs and antennaIDs used.
@@ -301,6 +672,38 @@ protected:
   /// setup accessor for a new iteration
   void setUpIteration();
 
+  /// @brief check whether all time steps have been processed
+  /// @details This method encapsulates the difference between iteration with
+  /// casacore::TableIterator and with the time index
+  /// @return true, if the table iterator (or the position in the time index) is past the end
+  bool timeIterationPastEnd() const throw();
+
+  /// @brief advance the table iterator (or the position in the time index) to the next time step
+  void advanceTimeIteration();
+
+  /// @brief obtain the table and the rows of the time step the table iterator points to
+  /// @details With casacore::TableIterator, the table is the reference table created by
+  /// the iterator and all its rows are used. With the time index, it is the selected table and
+  /// the rows are those of the current time step.
+  /// @param[out] tab table to read the data from
+  /// @param[out] startRow the first row of the time step
+  /// @param[out] endRow the first row after the time step
+  void getTimeIteration(casacore::Table &tab, casacore::rownr_t &startRow,
+                        casacore::rownr_t &endRow) const;
+
+  /// @brief apply the selection using the index file
+  /// @details The persistent time index is loaded from the file (unless the current index
+  /// has the same key) and the selected rows are taken from it. If the file can't be used,
+  /// the selection expression is evaluated, the index is built and written to the file.
+  /// @return table with the selected rows
+  casacore::Table selectRowsWithIndexFile();
+
+  /// @brief activate the read-ahead buffer for the current chunk and schedule the next one
+  /// @details This method does nothing if read-ahead is not enabled. It should be called
+  /// when the iterator is set up for the new chunk, without the table mutex locked. The
+  /// table iterator may be advanced beyond the current iteration here (see itsTabIteratorAhead).
+  void updateReadAhead();
+
   /// @brief method ensures that the chunk has a uniform DATA_DESC_ID
   /// @details This method reduces itsNumberOfRows to achieve
   /// uniform DATA_DESC_ID reading for all rows in the current chunk.
@@ -320,6 +723,26 @@ protected:
   /// (and it sets it up at the first run as well)
   void makeUniformFieldID();
 
+  /// @brief estimate the memory taken by one row of the current chunk
+  /// @details The estimate includes the bulk fields of the accessor (visibilities, flags,
+  /// noise, uvw), per-row metadata and, if enabled, the read-ahead buffers for the current
+  /// and the next chunk. Single precision and compact representations are assumed in the
+  /// reduced footprint mode.
+  /// @return memory in bytes per row
+  size_t memoryPerRow() const;
+
+  /// @brief maximum number of rows allowed by the memory budget
+  /// @details The shape of the current chunk is used, the result never exceeds itsMaxChunkSize
+  /// and is at least 1.
+  /// @return maximum number of rows per chunk
+  casacore::uInt maxRowsWithinBudget() const;
+
+  /// @brief method ensures that the current chunk fits into the memory budget
+  /// @details This method reduces itsNumberOfRows if necessary. It does nothing
+  /// if the memory budget is not set.
+  /// @return true, if itsNumberOfRows has been reduced
+  bool applyMemoryBudget();
+
   /// obtain a reference to the accessor (for derived classes)
   inline const TableConstDataAccessor& getAccessor() const throw()
   { return itsAccessor;}
@@ -335,6 +758,19 @@ protected:
   /// @param[in] dirs a reference to a vector to be filled
   void fillDirectionCache(casacore::Vector<casacore::MVDirection> &dirs) const;
 
+  /// @brief convert directions given for a number of antennas
+  /// @details The frame is set up once per epoch if the conversion doesn't depend on
+  /// the antenna position, otherwise it is set up once for each run of elements
+  /// corresponding to the same antenna (the FEED subtable is usually ordered by antenna).
+  /// @param[in] ref reference frame of the input directions
+  /// @param[in] antIDs antenna index for each element
+  /// @param[in] in input directions, one per element
+  /// @param[out] out converted directions (resized to match the input)
+  void convertForAllAntennas(const casacore::MDirection::Ref &ref,
+                 const casacore::Vector<casacore::Int> &antIDs,
+                 const casacore::Vector<casacore::MVDirection> &in,
+                 casacore::Vector<casacore::MVDirection> &out) const;
+
   /// @brief Fill internal buffer with parallactic angles
   /// @details This buffer holds parallactic angles for all antennae. The buffer
   /// is invalidated when the time changes for an alt-az array, for an equatorial
@@ -342,6 +778,14 @@ protected:
   /// @param[in] angles a reference to a vector to be filled
   void fillParallacticAngleCache(casacore::Vector<casacore::Double> &angles) const;
 
+  /// @brief compute parallactic angle for one antenna using casacore measures
+  /// @details This is the reference implementation used in the validation mode
+  /// (see setParallacticAngleValidation).
+  /// @param[in] ant antenna index
+  /// @param[in] epoch time of the observation
+  /// @return parallactic angle in radians
+  casacore::Double measuresParallacticAngle(casacore::uInt ant, const casacore::MEpoch &epoch) const;
+
   /// @brief fill the buffer with the dish pointing directions
   /// @details The difference from fillDirectionCache is that
   /// this method computes the pointing directions for the dish centre, not for
@@ -375,6 +819,13 @@ protected:
   inline const casacore::Table& getCurrentIteration() const throw()
        {return itsCurrentIteration;}
 
+  /// @brief obtain column objects attached to the current iteration
+  /// @details Derived classes can use this method to avoid creating column objects
+  /// on every call (read-only access)
+  /// @return a const reference to the column handles
+  inline const TableColumnHandles& getCurrentColumns() const throw()
+       {return itsColumns;}
+
   /// @brief obtain the current top row
   /// @details This class uses TableIterator behind the scence. One iteration
   /// of the table iterator may cover more than one iteration of the iterator
@@ -415,6 +866,9 @@ private:
   /// @details Exceeding this tolerance leads to initialisation of a new UVW Machine in the cache
   double itsUVWCacheTolerance;
 
+  /// @brief a number of tangent points in the cache of rotated uvw and delays
+  size_t itsRotatedUVWCacheSize;
+
   /// accessor (a chunk of data)
   /// although the accessor type can be different
   TableConstDataAccessor itsAccessor;
@@ -426,11 +880,20 @@ private:
   casacore::TableIterator itsTabIterator;
   /// current group of data returned by itsTabIterator
   casacore::Table itsCurrentIteration;
+  /// @brief columns of itsCurrentIteration
+  /// @details Column objects are attached once per iteration of the table iterator
+  /// and reused by all fill methods and all chunks of this iteration
+  TableColumnHandles itsColumns;
   /// current row in the itsCurrentIteration projected to the row 0
   /// of the data accessor
   casacore::rownr_t itsCurrentTopRow;
   /// number of rows in the current chunk
   casacore::uInt itsNumberOfRows;
+  /// @brief the first row of the current time step in itsCurrentIteration
+  /// @details It is always zero unless the time index is used
+  casacore::rownr_t itsIterationStartRow;
+  /// @brief the first row after the current time step in itsCurrentIteration
+  casacore::rownr_t itsIterationEndRow;
   /// next two data members show the number of channels and
   /// polarisations in the actual table. Selector controls what
   /// is sent out
@@ -457,6 +920,16 @@ private:
   /// if the latter is present.
   bool itsUseFieldID;
 
+  /// @brief true, if the SIGMA_SPECTRUM column is present in the table
+  /// @details The table description is checked once in init(), so the methods
+  /// filling the noise don't need to access the table while the read-ahead job
+  /// may be reading it.
+  bool itsHasSigmaSpectrum;
+
+  /// @brief true, if the SIGMA column is present in the table
+  /// @details It is set in init() together with itsHasSigmaSpectrum.
+  bool itsHasSigma;
+
   /// @brief cache of pointing directions  for each feed
   /// @details This is an internal buffer for pointing
   /// directions for the whole current cache of the Feed subtable handler
@@ -480,6 +953,96 @@ private:
   mutable bool itsFlagData;
   /// are we at the start?
   mutable bool itsAtStart;
+
+  /// @brief cached matrix of the polarisation conversion (empty if not yet computed)
+  mutable casacore::Matrix<casacore::Complex> itsPolTransform;
+
+  /// @brief number of channels averaged in the frequency selection mode
+  /// @details It is derived from the requested frequency increment together with the channel range
+  mutable casacore::uInt itsFreqChannelAveraging;
+
+  /// @brief number of selected raw channels below the first channel of the band
+  mutable casacore::uInt itsLeadingOutOfBand;
+
+  /// @brief number of selected raw channels above the last channel of the band
+  mutable casacore::uInt itsTrailingOutOfBand;
+
+  /// @brief conversion engine for the selected start frequency
+  /// @details The measure frame is shared with the converter, so the epoch and direction
+  /// can be updated without rebuilding the conversion engine. The last converted frequency
+  /// is kept together with the time bucket and field it corresponds to.
+  struct FreqConversionEngine {
+     /// @brief measure frame used by the converter
+     casacore::MeasFrame itsFrame;
+     /// @brief converter from the selection frame to the frame of the data
+     boost::shared_ptr<casacore::MFrequency::Convert> itsConverter;
+     /// @brief true if the direction is given with the selection (i.e. independent of the field)
+     bool itsFixedDirection;
+     /// @brief field ID the last conversion corresponds to
+     casacore::Int itsFieldID;
+     /// @brief time bucket the last conversion corresponds to
+     casacore::Int64 itsBucket;
+     /// @brief the last converted frequency in Hz
+     casacore::Double itsFrequency;
+  };
+
+  /// @brief conversion engines for the selected start frequency
+  /// @details The key is the spectral window and the frame type of the selection
+  mutable std::map<std::pair<casacore::uInt, casacore::Int>, FreqConversionEngine> itsFreqConversionEngines;
+
+  /// @brief number of steps of the table iterator since init()
+  /// @details It is used to match chunks read in advance (row numbers are relative to
+  /// the current iteration of the table iterator)
+  casacore::uInt itsIterationStep;
+
+  /// @brief true, if itsTabIterator (or itsTimeIndexStep) has been advanced beyond the current iteration
+  /// @details This happens if the next chunk is read in advance and belongs to the next
+  /// iteration of the table iterator. itsCurrentIteration still corresponds to the current chunk.
+  bool itsTabIteratorAhead;
+
+  /// @brief partition plan shared with other iterators (empty if the iterator covers all selected rows)
+  boost::shared_ptr<TablePartitionPlan const> itsPartitionPlan;
+
+  /// @brief partition of itsPartitionPlan covered by this iterator
+  casacore::uInt itsPartition;
+
+  /// @brief true, if the time index is used instead of itsTabIterator
+  bool itsUseTimeIndex;
+
+  /// @brief index of time steps of the selected rows (empty if not used or not built yet)
+  boost::shared_ptr<TableTimeIndex const> itsTimeIndex;
+
+  /// @brief selected table (only used with the time index)
+  casacore::Table itsSelectedTable;
+
+  /// @brief current time step in itsTimeIndex (plays the role of itsTabIterator)
+  casacore::uInt itsTimeIndexStep;
+
+  /// @brief directory for time index files (empty string if index files are not used)
+  std::string itsIndexFileDirectory;
+
+  /// @brief true, if the reduced footprint mode is enabled
+  bool itsReducedFootprint;
+
+  /// @brief true, if the read-ahead buffer should hold flags as a bit mask
+  bool itsCompactFlags;
+
+  /// @brief memory budget in bytes for each chunk (0 means no limit)
+  size_t itsChunkMemoryBudget;
+
+  /// @brief true, if parallactic angles are cross-checked with casacore measures
+  bool itsValidateParallacticAngle;
+
+  /// @brief mutex serialising the access to the table
+  /// @details It is shared with the read-ahead buffer and with the iterators over other
+  /// partitions of the same partition plan (empty shared pointer if the table is only
+  /// accessed from one thread).
+  boost::shared_ptr<boost::recursive_mutex> itsTableMutex;
+
+  /// @brief buffer with the data read in advance (empty shared pointer if read-ahead is disabled)
+  /// @note It should be the last data member, so it is destroyed (and the background
+  /// thread stopped) before the tables it reads from.
+  boost::shared_ptr<TableReadAheadBuffer> itsReadAhead;
 };
 
 
@@ -29,12 +29,16 @@
 /// @author Max Voronkov <maxim.voronkov@csiro.au>
 ///
 
+/// std includes
+#include <algorithm>
+
 /// boost includes
 #include <boost/shared_ptr.hpp>
 
 /// own includes
 #include <askap/dataaccess/TableConstDataSource.h>
 #include <askap/dataaccess/TableConstDataIterator.h>
+#include <askap/dataaccess/TablePartitionPlan.h>
 #include <askap/dataaccess/TableDataSelector.h>
 #include <askap/dataaccess/BasicDataConverter.h>
 #include <askap/dataaccess/DataAccessError.h>
@@ -52,8 +56,11 @@ using namespace casa;
 TableConstDataSource::TableConstDataSource(const std::string &fname,
                const std::string &dataColumn) :
          TableInfoAccessor(casacore::Table(fname), false, dataColumn),
-         itsUVWCacheSize(1), itsUVWCacheTolerance(1e-6),
-         itsMaxChunkSize(INT_MAX) {}
+         itsUVWCacheSize(1), itsUVWCacheTolerance(1e-6), itsRotatedUVWCacheSize(1),
+         itsMaxChunkSize(INT_MAX), itsMaxChunkMemory(0), itsChunkMemoryPerThread(true),
+         itsReadAhead(false), itsReadAheadMemory(theirDefaultReadAheadMemory),
+         itsTimeIndex(false), itsReducedFootprint(false), itsCompactFlags(false),
+         itsValidateParallacticAngle(false) {}
 
 /// @brief obtain the position of the given antenna
 /// @details
@@ -100,6 +107,66 @@ void TableConstDataSource::configureMaxChunkSize(casacore::uInt maxNumRows)
    itsMaxChunkSize = maxNumRows;
 }
 
+/// @brief configure restriction on the memory taken by each chunk
+/// @details The number of rows per chunk is derived from the given memory budget,
+/// the shape of the data (number of channels and polarisations) and enabled features
+/// like read-ahead. The restriction on the number of rows (see configureMaxChunkSize)
+/// still applies.
+/// @param[in] maxBytes maximum memory in bytes per chunk (0 means no restriction, which is the default)
+/// @param[in] perThread if true, each iterator gets the full budget, otherwise the budget is
+/// shared between the iterators returned by one call to createConstIterators
+/// @note The new restriction will apply to any iterator created in the future, but will not
+/// affect iterators already created
+void TableConstDataSource::configureMaxChunkMemory(size_t maxBytes, bool perThread)
+{
+   itsMaxChunkMemory = maxBytes;
+   itsChunkMemoryPerThread = perThread;
+}
+
+/// @brief configure asynchronous read-ahead
+/// @details If enabled, const iterators read visibilities, flags, noise and uvw of
+/// the next chunk in a background thread while the current chunk is processed.
+/// @param[in] enable true to enable read-ahead
+/// @param[in] maxMemory maximum memory in bytes used by the buffers of each iterator
+/// @note The new setting will apply to any const iterator created in the future, but will not
+/// affect iterators already created
+void TableConstDataSource::configureReadAhead(bool enable, size_t maxMemory)
+{
+   ASKAPCHECK(!enable || (maxMemory > 0), "Memory limit for read-ahead buffers should be a positive number");
+   itsReadAhead = enable;
+   itsReadAheadMemory = maxMemory;
+}
+
+/// @brief configure iteration with the time index
+/// @details If enabled, const iterators scan the TIME column of the selected rows once
+/// and serve chunks as row ranges of the selected table instead of creating a reference
+/// table for each time step with casacore::TableIterator.
+/// @param[in] enable true to enable the time index
+/// @param[in] indexDir directory to store the index files in (an empty string means that
+/// the index is not stored)
+/// @note The new setting will apply to any const iterator created in the future, but will not
+/// affect iterators already created.
+void TableConstDataSource::configureTimeIndex(bool enable, const std::string &indexDir)
+{
+   itsTimeIndex = enable;
+   itsTimeIndexDirectory = indexDir;
+}
+
+/// @brief configure the reduced footprint mode
+/// @details If enabled, the single precision and real-valued representations of the
+/// accessor fields (uvw components, frequencies and noise, see TableConstDataAccessor)
+/// are filled without keeping the double precision or complex intermediates in the cache.
+/// Optionally, flags read in advance are held as a bit mask.
+/// @param[in] enable true to enable the reduced footprint mode
+/// @param[in] compactFlags true to hold flags read in advance as a bit mask
+/// @note The new setting will apply to any const iterator created in the future, but will not
+/// affect iterators already created.
+void TableConstDataSource::configureReducedFootprint(bool enable, bool compactFlags)
+{
+   itsReducedFootprint = enable;
+   itsCompactFlags = enable && compactFlags;
+}
+
 /// @brief configure caching of the uvw-machines
 /// @details A number of uvw machines can be cached at the same time. This can
 /// result in a significant performance improvement in the mosaicing case. By default
@@ -117,6 +184,33 @@ void TableConstDataSource::configureUVWMachineCache(size_t cacheSize, double tol
   itsUVWCacheTolerance = tolerance;
 }
 
+/// @brief configure caching of rotated uvw and delays
+/// @details Rotated uvw and delays are cached by the accessor for a number of tangent points
+/// at the same time. This makes alternating access to different tangent points within one
+/// chunk (e.g. for faceted imaging) free after the first access. By default, only one tangent
+/// point is cached.
+/// @param[in] nTangentPoints a number of tangent points (should be positive, default is 1)
+/// @note The new setting will apply to any iterator created in the future, but will not
+/// affect iterators already created.
+void TableConstDataSource::configureRotatedUVWCache(size_t nTangentPoints)
+{
+  ASKAPCHECK(nTangentPoints > 0, "Number of tangent points in the rotated uvw cache should be positive");
+  itsRotatedUVWCacheSize = nTangentPoints;
+}
+
+/// @brief configure validation of parallactic angles
+/// @details Parallactic angles are computed analytically. In the validation mode they
+/// are cross-checked against casacore measures (see
+/// TableConstDataIterator::setParallacticAngleValidation). This is slow and is only
+/// intended for debugging.
+/// @param[in] validate true to enable the validation mode
+/// @note The new setting will apply to any iterator created in the future, but will not
+/// affect iterators already created.
+void TableConstDataSource::configureParallacticAngleValidation(bool validate)
+{
+  itsValidateParallacticAngle = validate;
+}
+
 /// construct a part of the read only object for use in the
 /// derived classes
 /// @note Due to virtual inheritance, TableInfoAccessor will be initialized
@@ -124,8 +218,11 @@ void TableConstDataSource::configureUVWMachineCache(size_t cacheSize, double tol
 /// the compiler happy
 TableConstDataSource::TableConstDataSource() :
          TableInfoAccessor(boost::shared_ptr<ITableManager const>()),
-         itsUVWCacheSize(1), itsUVWCacheTolerance(1e-6),
-         itsMaxChunkSize(INT_MAX) {} 
+         itsUVWCacheSize(1), itsUVWCacheTolerance(1e-6), itsRotatedUVWCacheSize(1),
+         itsMaxChunkSize(INT_MAX), itsMaxChunkMemory(0), itsChunkMemoryPerThread(true),
+         itsReadAhead(false), itsReadAheadMemory(theirDefaultReadAheadMemory),
+         itsTimeIndex(false), itsReducedFootprint(false), itsCompactFlags(false),
+         itsValidateParallacticAngle(false) {} 
 
 /// create a converter object corresponding to this type of the
 /// DataSource. The user can change converting policies (units,
@@ -178,9 +275,94 @@ TableConstDataSource::createConstIterator(const IDataSelectorConstPtr &sel,
        ASKAPTHROW(DataAccessLogicError, "Incompatible selector and/or "<<
                  "converter are received by the createConstIterator method");
    }
-   return boost::shared_ptr<IConstDataIterator>(new TableConstDataIterator(
+   boost::shared_ptr<TableConstDataIterator> it(new TableConstDataIterator(
                 getTableManager(),implSel,implConv,uvwMachineCacheSize(), uvwMachineCacheTolerance(),
                 maxChunkSize()));
+   if (timeIndexEnabled()) {
+       it->setIndexFileDirectory(timeIndexDirectory());
+       it->enableTimeIndex();
+   }
+   if (rotatedUVWCacheSize() > 1) {
+       it->setRotatedUVWCacheSize(rotatedUVWCacheSize());
+   }
+   if (parallacticAngleValidationEnabled()) {
+       it->setParallacticAngleValidation(true);
+   }
+   // the memory estimate used with the budget depends on the reduced footprint mode
+   if (reducedFootprintEnabled()) {
+       it->enableReducedFootprint(compactFlagsEnabled());
+   }
+   if (maxChunkMemory() > 0) {
+       it->setChunkMemoryBudget(maxChunkMemory());
+   }
+   if (readAheadEnabled()) {
+       it->enableReadAhead(readAheadMemory());
+   }
+   return it;
+}
+
+/// @brief get several iterators over disjoint parts of the selected data
+/// @details The selected rows are split into (up to) nParts partitions, each covering
+/// a contiguous range of time stamps with roughly equal number of rows. The selection
+/// and the partition plan are computed once and shared between all iterators created
+/// by this call. The table access of all iterators is serialised via the mutex of the plan,
+/// so the I/O is not parallel, only the processing of the data by the caller is.
+/// @param[in] sel a shared pointer to the selector object defining
+///            which subset of the data is used
+/// @param[in] conv a shared pointer to the converter object defining
+///            reference frames and units to be used
+/// @param[in] nParts desired number of parts (should be positive)
+/// @return a vector of shared pointers to iterators, one per partition
+std::vector<boost::shared_ptr<IConstDataIterator> >
+TableConstDataSource::createConstIterators(const IDataSelectorConstPtr &sel,
+              const IDataConverterConstPtr &conv, casacore::uInt nParts) const
+{
+   ASKAPCHECK(nParts > 0, "Number of parts should be positive");
+   // cast input selector to "implementation" interface
+   boost::shared_ptr<ITableDataSelectorImpl const> implSel=
+           boost::dynamic_pointer_cast<ITableDataSelectorImpl const>(sel);
+   boost::shared_ptr<IDataConverterImpl const> implConv=
+           boost::dynamic_pointer_cast<IDataConverterImpl const>(conv);
+
+   if (!implSel || !implConv) {
+       ASKAPTHROW(DataAccessLogicError, "Incompatible selector and/or "<<
+                 "converter are received by the createConstIterators method");
+   }
+   const casacore::TableExprNode &exprNode = implSel->getTableSelector(implConv);
+   const boost::shared_ptr<TablePartitionPlan const> plan(new TablePartitionPlan(
+                exprNode.isNull() ? table() : table()(exprNode), nParts));
+   std::vector<boost::shared_ptr<IConstDataIterator> > result;
+   result.reserve(plan->nParts());
+   // iterators are expected to be used concurrently, one per thread
+   size_t memoryBudget = maxChunkMemory();
+   if (!chunkMemoryPerThread() && (memoryBudget > 0)) {
+       memoryBudget = std::max(memoryBudget / plan->nParts(), size_t(1));
+   }
+   for (casacore::uInt part = 0; part < plan->nParts(); ++part) {
+        boost::shared_ptr<TableConstDataIterator> it(new TableConstDataIterator(
+                getTableManager(),implSel,implConv,uvwMachineCacheSize(), uvwMachineCacheTolerance(),
+                maxChunkSize(), plan, part));
+        if (timeIndexEnabled()) {
+            it->enableTimeIndex();
+        }
+        if (rotatedUVWCacheSize() > 1) {
+            it->setRotatedUVWCacheSize(rotatedUVWCacheSize());
+        }
+        if (parallacticAngleValidationEnabled()) {
+            it->setParallacticAngleValidation(true);
+        }
+        if (reducedFootprintEnabled()) {
+            it->enableReducedFootprint(compactFlagsEnabled());
+        }
+        if (memoryBudget > 0) {
+            it->setChunkMemoryBudget(memoryBudget);
+        }
+        if (readAheadEnabled()) {
+            it->enableReadAhead(readAheadMemory());
+        }
+        result.push_back(it);
+   }
+   return result;
 }
 
 /// create a selector object corresponding to this type of the
@@ -44,6 +44,7 @@
 
 // std includes
 #include <string>
+#include <vector>
 
 namespace askap {
 
@@ -107,6 +108,29 @@ public:
   
   // we need this to get access to the overloaded syntax in the base class 
   using IConstDataSource::createConstIterator;
+
+  /// @brief get several iterators over disjoint parts of the selected data
+  /// @details The selected rows are split into (up to) nParts partitions, each covering
+  /// a contiguous range of time stamps with roughly equal number of rows. The selection
+  /// and the partition plan are computed once and shared between all iterators created
+  /// by this call. Each iterator has its own accessor and caches, so they can be used
+  /// from different threads. The iterators share the table and the subtable handlers, so
+  /// every access to them is serialised via the mutex of the partition plan.
+  /// @note The I/O is not parallel: at most one iterator (or its read-ahead thread) reads
+  /// the table at any time. casacore tables opened in the same process share one table
+  /// object and its storage managers, which are not thread-safe, so opening the table
+  /// again for each partition wouldn't help. Partitioning only pays off if the processing
+  /// of the data by the caller takes a considerable time compared to the I/O.
+  /// @param[in] sel a shared pointer to the selector object defining
+  ///            which subset of the data is used
+  /// @param[in] conv a shared pointer to the converter object defining
+  ///            reference frames and units to be used
+  /// @param[in] nParts desired number of parts (should be positive)
+  /// @return a vector of shared pointers to iterators, one per partition (the number of
+  ///         partitions can be less than requested if there are not enough distinct time stamps)
+  virtual std::vector<boost::shared_ptr<IConstDataIterator> > createConstIterators(const
+             IDataSelectorConstPtr &sel, const IDataConverterConstPtr &conv,
+             casacore::uInt nParts) const;
  
   /// create a selector object corresponding to this type of the
   /// DataSource
@@ -138,12 +162,86 @@ public:
   /// to initialisation of a new UVW Machine
   void configureUVWMachineCache(size_t cacheSize = 1, double tolerance = 1e-6);
 
+  /// @brief configure caching of rotated uvw and delays
+  /// @details Rotated uvw and delays are cached by the accessor for a number of tangent points
+  /// at the same time. This makes alternating access to different tangent points within one
+  /// chunk (e.g. for faceted imaging) free after the first access. By default, only one tangent
+  /// point is cached. The memory used is reported at the debug level when the accessor is destroyed.
+  /// @param[in] nTangentPoints a number of tangent points (should be positive, default is 1)
+  /// @note The new setting will apply to any iterator created in the future, but will not
+  /// affect iterators already created.
+  void configureRotatedUVWCache(size_t nTangentPoints = 1);
+
+  /// @brief configure validation of parallactic angles
+  /// @details Parallactic angles are computed analytically. In the validation mode they
+  /// are cross-checked against casacore measures (see
+  /// TableConstDataIterator::setParallacticAngleValidation). This is slow and is only
+  /// intended for debugging.
+  /// @param[in] validate true to enable the validation mode
+  /// @note The new setting will apply to any iterator created in the future, but will not
+  /// affect iterators already created.
+  void configureParallacticAngleValidation(bool validate);
+
   /// @brief configure restriction on the chunk size
   /// @param[in] maxNumRows maximum number of rows wanted
   /// @note The new restriction will apply to any iterator created in the future, but will not
   /// affect iterators already created
   void configureMaxChunkSize(casacore::uInt maxNumRows);
 
+  /// @brief configure restriction on the memory taken by each chunk
+  /// @details The number of rows per chunk is derived from the given memory budget,
+  /// the shape of the data (number of channels and polarisations) and enabled features
+  /// like read-ahead. This allows the same setting to be used for datasets with very
+  /// different numbers of channels. The restriction on the number of rows (see
+  /// configureMaxChunkSize) still applies.
+  /// @param[in] maxBytes maximum memory in bytes per chunk (0 means no restriction, which is the default)
+  /// @param[in] perThread if true, each iterator gets the full budget, otherwise the budget is
+  /// shared between the iterators returned by one call to createConstIterators (i.e. it is
+  /// the total for all threads)
+  /// @note The new restriction will apply to any iterator created in the future, but will not
+  /// affect iterators already created
+  void configureMaxChunkMemory(size_t maxBytes, bool perThread = true);
+
+  /// @brief default memory limit for the read-ahead buffers of each iterator (1 GiB)
+  static const size_t theirDefaultReadAheadMemory = 1073741824u;
+
+  /// @brief configure asynchronous read-ahead
+  /// @details If enabled, const iterators read visibilities, flags, noise and uvw of
+  /// the next chunk in a background thread while the current chunk is processed.
+  /// This helps if the processing of each chunk takes time comparable with the disk I/O.
+  /// Read-ahead is disabled by default.
+  /// @param[in] enable true to enable read-ahead
+  /// @param[in] maxMemory maximum memory in bytes used by the buffers of each iterator
+  /// @note The new setting will apply to any const iterator created in the future, but will not
+  /// affect iterators already created. Read-write iterators never read ahead.
+  void configureReadAhead(bool enable, size_t maxMemory = theirDefaultReadAheadMemory);
+
+  /// @brief configure iteration with the time index
+  /// @details If enabled, const iterators scan the TIME column of the selected rows once
+  /// and serve chunks as row ranges of the selected table instead of creating a reference
+  /// table for each time step with casacore::TableIterator. This helps for large measurement
+  /// sets with many time steps. The time index is disabled by default.
+  /// @param[in] enable true to enable the time index
+  /// @param[in] indexDir directory to store the index files in (an empty string means that
+  /// the index is not stored). If given, the index built for a particular selection is written
+  /// to a file and reused by iterators created later (including other processes) with the same
+  /// selection, as long as the measurement set is not modified. Partitioned iterators don't use files.
+  /// @note The new setting will apply to any const iterator created in the future, but will not
+  /// affect iterators already created.
+  void configureTimeIndex(bool enable, const std::string &indexDir = "");
+
+  /// @brief configure the reduced footprint mode
+  /// @details If enabled, the single precision and real-valued representations of the
+  /// accessor fields (uvw components, frequencies and noise, see TableConstDataAccessor)
+  /// are filled without keeping the double precision or complex intermediates in the cache.
+  /// Optionally, flags read in advance are held as a bit mask, which reduces the memory
+  /// taken by the read-ahead buffer. The mode is disabled by default.
+  /// @param[in] enable true to enable the reduced footprint mode
+  /// @param[in] compactFlags true to hold flags read in advance as a bit mask
+  /// @note The new setting will apply to any const iterator created in the future, but will not
+  /// affect iterators already created.
+  void configureReducedFootprint(bool enable, bool compactFlags = false);
+
   /// @brief obtain the position of the given antenna
   /// @details
   /// @param[in] antID antenna index to use, matches indices in the data table
@@ -182,9 +280,50 @@ protected:
   /// @return direction tolerance used for UVW machine cache (in radians)
   inline double uvwMachineCacheTolerance() const {return itsUVWCacheTolerance;}   
 
+  /// @brief number of tangent points in the cache of rotated uvw and delays
+  /// @return a number of tangent points cached by each accessor
+  inline size_t rotatedUVWCacheSize() const {return itsRotatedUVWCacheSize;}
+
   /// @brief current restriction on the chunk size
   /// @return maximum number of rows in the accessor (the current setting, affects future iterators)
   inline casacore::uInt maxChunkSize() const {return itsMaxChunkSize;}
+
+  /// @brief current restriction on the memory per chunk
+  /// @return memory budget in bytes for each iterator created by createConstIterator
+  /// (0 means no restriction)
+  inline size_t maxChunkMemory() const {return itsMaxChunkMemory;}
+
+  /// @brief check whether the memory budget is given per thread
+  /// @return true, if each of the iterators created by createConstIterators gets the full budget
+  inline bool chunkMemoryPerThread() const {return itsChunkMemoryPerThread;}
+
+  /// @brief check whether read-ahead is enabled
+  /// @return true, if const iterators created in the future will read ahead
+  inline bool readAheadEnabled() const {return itsReadAhead;}
+
+  /// @brief memory limit for read-ahead buffers
+  /// @return maximum memory in bytes used by read-ahead buffers of each iterator
+  inline size_t readAheadMemory() const {return itsReadAheadMemory;}
+
+  /// @brief check whether the time index is enabled
+  /// @return true, if const iterators created in the future will use the time index
+  inline bool timeIndexEnabled() const {return itsTimeIndex;}
+
+  /// @brief directory for time index files
+  /// @return directory name (empty string if the index is not stored)
+  inline const std::string& timeIndexDirectory() const {return itsTimeIndexDirectory;}
+
+  /// @brief check whether the reduced footprint mode is enabled
+  /// @return true, if const iterators created in the future will use the reduced footprint mode
+  inline bool reducedFootprintEnabled() const {return itsReducedFootprint;}
+
+  /// @brief check whether flags read in advance are held as a bit mask
+  /// @return true, if the flags are packed (only used in the reduced footprint mode)
+  inline bool compactFlagsEnabled() const {return itsCompactFlags;}
+
+  /// @brief check whether parallactic angles are validated
+  /// @return true, if const iterators created in the future cross-check parallactic angles
+  inline bool parallacticAngleValidationEnabled() const {return itsValidateParallacticAngle;}
   
 private:
   /// @brief a number of uvw machines in the cache (default is 1)
@@ -197,6 +336,8 @@ private:
   /// @details Exceeding this tolerance leads to initialisation of a new UVW Machine in the cache
   double itsUVWCacheTolerance;
 
+  /// @brief a number of tangent points in the cache of rotated uvw and delays (default is 1)
+  size_t itsRotatedUVWCacheSize;
 
   /// @brief maximum number of rows per accessor
   /// @details By default, it is initialised with INT_MAX, which essentially means no restrictions.
@@ -205,6 +346,33 @@ private:
   /// processing chain which do data copy (usually in the temporary code/hacks which technically shouldn't
   /// stay long term in the ideal case).
   casacore::uInt itsMaxChunkSize;
+
+  /// @brief maximum memory in bytes per chunk (0 means no restriction)
+  size_t itsMaxChunkMemory;
+
+  /// @brief true, if each of the concurrent iterators gets the full memory budget
+  bool itsChunkMemoryPerThread;
+
+  /// @brief true, if const iterators should read the next chunk in advance
+  bool itsReadAhead;
+
+  /// @brief maximum memory in bytes used by read-ahead buffers of each iterator
+  size_t itsReadAheadMemory;
+
+  /// @brief true, if const iterators should use the time index
+  bool itsTimeIndex;
+
+  /// @brief directory for time index files (empty string if the index is not stored)
+  std::string itsTimeIndexDirectory;
+
+  /// @brief true if the reduced footprint mode is enabled
+  bool itsReducedFootprint;
+
+  /// @brief true if flags read in advance are held as a bit mask
+  bool itsCompactFlags;
+
+  /// @brief true if parallactic angles are cross-checked with casacore measures
+  bool itsValidateParallacticAngle;
 };
  
 } // namespace accessors
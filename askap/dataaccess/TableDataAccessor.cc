@@ -34,6 +34,7 @@
 /// own includes
 #include <askap/dataaccess/TableDataAccessor.h>
 #include <askap/dataaccess/DataAccessError.h>
+#include <askap/dataaccess/CubeTranspose.h>
 
 using namespace askap;
 using namespace askap::accessors;
@@ -76,7 +77,10 @@ casacore::Cube<casacore::Complex>& TableDataAccessor::rwVisibility()
   // const interface untidy by putting a non-const method there. 
   // It is safe to use const_cast here because we know that the actual buffer
   // is declared mutable in CachedAccessorField.
-  return const_cast<casacore::Cube<casacore::Complex>&>(getROAccessor().visibility());
+  casacore::Cube<casacore::Complex> &vis = const_cast<casacore::Cube<casacore::Complex>&>(getROAccessor().visibility());
+  // cached data in the measurement set order will be out of date
+  itsIterator.getAccessor().invalidateNativeCaches();
+  return vis;
 }
 
 /// Cube of flags corresponding to the output of visibility()
@@ -105,7 +109,40 @@ casacore::Cube<casacore::Bool>& TableDataAccessor::rwFlag()
    // const interface untidy by putting a non-const method there. 
    // It is safe to use const_cast here because we know that the actual buffer
    // is declared mutable in CachedAccessorField.
-   return const_cast<casacore::Cube<casacore::Bool>&>(getROAccessor().flag());
+   casacore::Cube<casacore::Bool> &flags = const_cast<casacore::Cube<casacore::Bool>&>(getROAccessor().flag());
+   // cached data in the measurement set order will be out of date
+   itsIterator.getAccessor().invalidateNativeCaches();
+   return flags;
+}
+
+/// @brief visibilities in the measurement set order
+/// @details The request is passed to the associated const accessor unless
+/// the visibilities have been modified via rwVisibility and not yet
+/// flushed. In the latter case, the cube is formed from the modified data
+/// on each call.
+/// @return a reference to nPol x nChannel x nRow cube, containing
+/// all visibility data
+const casacore::Cube<casacore::Complex>& TableDataAccessor::visibilityNative() const
+{
+  if (itsVisNeedsFlush) {
+      return MetaDataAccessor::visibilityNative();
+  }
+  return getROAccessor().visibilityNative();
+}
+
+/// @brief flags in the measurement set order
+/// @details The request is passed to the associated const accessor unless
+/// the flags have been modified via rwFlag and not yet flushed. In the latter
+/// case, the cube is formed from the modified flags on each call.
+/// @return a reference to nPol x nChannel x nRow cube with flag
+///         information. If True, the corresponding element is flagged.
+const casacore::Cube<casacore::Bool>& TableDataAccessor::flagNative() const
+{
+  if (itsFlagNeedsFlush) {
+      accessorToNativeOrder(flag(), itsFlagNative);
+      return itsFlagNative;
+  }
+  return getROAccessor().flagNative();
 }
 
 
@@ -101,6 +101,22 @@ public:
   ///         information. If True, the corresponding element is flagged.
   virtual casacore::Cube<casacore::Bool>& rwFlag();
 
+  /// @brief visibilities in the measurement set order
+  /// @details The request is passed to the associated const accessor unless
+  /// the visibilities have been modified via rwVisibility and not yet
+  /// flushed. In the latter case, the cube is formed from the modified data
+  /// on each call.
+  /// @return a reference to nPol x nChannel x nRow cube, containing
+  /// all visibility data
+  virtual const casacore::Cube<casacore::Complex>& visibilityNative() const;
+
+  /// @brief flags in the measurement set order
+  /// @details The request is passed to the associated const accessor unless
+  /// the flags have been modified via rwFlag and not yet flushed. In the latter
+  /// case, the cube is formed from the modified flags on each call.
+  /// @return a reference to nPol x nChannel x nRow cube with flag
+  ///         information. If True, the corresponding element is flagged.
+  virtual const casacore::Cube<casacore::Bool>& flagNative() const;
   
   /// this method flush back the data to disk if there are any changes
   void sync() const;
@@ -118,6 +134,9 @@ private:
   /// @note We could have obtained it from the data accessor, but
   /// this approach seems to be more general and works faster.
   const TableDataIterator &itsIterator;  
+
+  /// @brief buffer for modified flags in the measurement set order
+  mutable casacore::Cube<casacore::Bool> itsFlagNative;
 };
 
 
@@ -49,6 +49,7 @@
 // casa includes
 #include <casacore/tables/Tables/ArrayColumn.h>
 #include <casacore/tables/Tables/ScalarColumn.h>
+#include <casacore/casa/Arrays/Slicer.h>
 
 
 namespace askap {
@@ -287,6 +288,11 @@ template<typename T>
 void TableDataIterator::writeCube(const casacore::Cube<T> &cube,
                                   const std::string &colName) const
 {
+  ASKAPCHECK(channelAveraging() == 1, "Writing to the table is not supported if channels are averaged on read");
+  ASKAPCHECK(!polarisationsConverted(),
+             "Writing to the table is not supported if polarisation products are converted on read");
+  ASKAPCHECK(!outOfBandChannels(),
+             "Writing to the table is not supported if the frequency selection extends beyond the band");
   const casacore::uInt nChan = nChannel();
   const casacore::uInt startChan = startChannel();
   // Setup a slicer to extract the specified channel range only
@@ -348,16 +354,19 @@ void TableDataIterator::writeOriginalVis() const
 /// of the interface
 void TableDataIterator::writeOriginalFlag() const
 {
-   const bool rowBasedFlagUsed = getCurrentIteration().tableDesc().isColumn("FLAG_ROW");
+   const bool rowBasedFlagUsed = getCurrentColumns().hasColumn("FLAG_ROW");
    const casacore::Cube<casacore::Bool>& flags = getAccessor().flag();
    if (rowBasedFlagUsed) {
        // check that updated flag doesn't contradict row-based flag
-       casacore::ROScalarColumn<casacore::Bool> rowFlagCol(getCurrentIteration(), "FLAG_ROW");
-       const casacore::Vector<casacore::Bool> rowBasedFlag = rowFlagCol.getColumn();
+       const casacore::ROScalarColumn<casacore::Bool> &rowFlagCol =
+                 getCurrentColumns().scalarColumn<casacore::Bool>("FLAG_ROW");
+       // only the rows of the current chunk are read (the table may cover more than one time step)
        const casacore::rownr_t topRow = getCurrentTopRow();
-       ASKAPDEBUGASSERT(static_cast<casacore::rownr_t>(rowBasedFlag.nelements()) >= topRow+flags.nrow());
+       const casacore::Vector<casacore::Bool> rowBasedFlag = rowFlagCol.getColumnRange(
+                 casacore::Slicer(casacore::IPosition(1, topRow), casacore::IPosition(1, flags.nrow())));
+       ASKAPDEBUGASSERT(rowBasedFlag.nelements() == flags.nrow());
        for (casacore::uInt row = 0; row < flags.nrow(); ++row) {
-            if (rowBasedFlag[row + topRow]) {
+            if (rowBasedFlag[row]) {
                 bool oneUnflagged = false;
                 casacore::Matrix<casacore::Bool> thisRow = flags.yzPlane(row);
                 for (casacore::Matrix<casacore::Bool>::const_iterator ci = thisRow.begin();
@@ -367,7 +376,7 @@ void TableDataIterator::writeOriginalFlag() const
                          break;
                      }
                 }
-                //std::cout<<row<<" "<<rowBasedFlag[row + topRow]<<" "<<oneUnflagged<<std::endl;
+                //std::cout<<row<<" "<<rowBasedFlag[row]<<" "<<oneUnflagged<<std::endl;
                 ASKAPCHECK(!oneUnflagged, "Flag modification attempted to unflag data for the row ("<<
                       row<<") which is flagged via row-based flagging mechanism. This is not supported");
             }
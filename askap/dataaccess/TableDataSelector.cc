@@ -36,6 +36,7 @@
 #include <askap/dataaccess/TableDataSelector.h>
 #include <askap/dataaccess/DataAccessError.h>
 #include <askap/dataaccess/TableTimeStampSelectorImpl.h>
+#include <askap/scimath/utils/PolConverter.h>
 
 using namespace askap;
 using namespace askap::accessors;
@@ -52,7 +53,7 @@ TableDataSelector::TableDataSelector(const
 #ifndef ASKAP_DEBUG
        itsDataColumnName(msManager->defaultDataColumnName()),
 #endif
-       itsChannelSelection(-1,0),itsNFreq(-1)
+       itsChannelSelection(-1,0),itsChannelAveraging(1),itsNFreq(-1)
 {
   ASKAPDEBUGASSERT(msManager);
 #ifdef ASKAP_DEBUG
@@ -114,6 +115,24 @@ const casacore::TableExprNode& TableDataSelector::getTableSelector(const
    return rwTableSelector();
 }
 
+/// @brief obtain a description of the row selection
+/// @details In addition to the criteria handled by TableScalarFieldSelector,
+/// this method accounts for the epoch selection (converted to the table time
+/// using the given converter).
+/// @param[in] conv  a shared pointer to the converter, which is used to sort
+///              out epochs and other measures used in the selection
+/// @return selection key
+std::string TableDataSelector::getSelectionKey(const
+                    boost::shared_ptr<IDataConverterImpl const> &conv) const
+{
+   std::string key = TableScalarFieldSelector::getSelectionKey(conv);
+   if (itsEpochSelector) {
+       itsEpochSelector->setConverter(conv);
+       key += itsEpochSelector->selectionKey();
+   }
+   return key;
+}
+
 /// Choose a subset of spectral channels
 /// @param[in] nChan a number of spectral channels wanted in the output
 /// @param[in] start the number of the first spectral channel to choose
@@ -122,12 +141,11 @@ const casacore::TableExprNode& TableDataSelector::getTableSelector(const
 void TableDataSelector::chooseChannels(casacore::uInt nChan, casacore::uInt start,
                              casacore::uInt nAvg)
 {
-   if (nAvg != 1) {
-       throw DataAccessLogicError("not yet implemented");
-   }
+   ASKAPCHECK(nAvg > 0, "Number of channels to average should be positive");
    ASKAPDEBUGASSERT((nChan>0) && (start>=0));
    itsChannelSelection.first = int(nChan);
    itsChannelSelection.second = int(start);
+   itsChannelAveraging = nAvg;
 }
 
 /// Choose a subset of frequencies. The reference frame is
@@ -145,7 +163,7 @@ void TableDataSelector::chooseFrequencies(casacore::uInt nChan,
          const casacore::MVFrequency &freqInc)
 {
    ASKAPDEBUGASSERT((nChan>0) && (start>=0));
-   ASKAPCHECK(freqInc.near(casacore::MVFrequency(0)), "Non zero frequency increment not yet implemented");
+   // non-zero increment is translated into the number of channels to average by the iterator
    itsNFreq = nChan;
    itsFreqStart = start;
    itsFreqInc = freqInc.getValue();
@@ -170,10 +188,13 @@ void TableDataSelector::chooseVelocities(casacore::uInt nChan,
 
 /// Choose polarization.
 /// @param[in] pols a string describing the wanted polarization
-/// in the output. Allowed values are: I, "IQUV","XXYY","RRLL"
+/// in the output. Allowed values are: I, "IQUV","XXYY","RRLL" and
+/// comma-separated lists of products like "XX,YY". The products stored in the
+/// dataset are converted into the requested ones on read.
 void TableDataSelector::choosePolarizations(const casacore::String &pols)
 {
-   ASKAPTHROW(DataAccessLogicError, "choosePolarizations has not yet been implemented, requested pols="<<pols);
+   itsPolSelection.reference(scimath::PolConverter::fromString(pols));
+   ASKAPCHECK(itsPolSelection.nelements() > 0, "Unable to interpret polarisation selection "<<pols);
 }
 
 /// @brief choose data column
@@ -234,6 +255,34 @@ std::pair<int,int> TableDataSelector::getChannelSelection() const throw()
   return itsChannelSelection;
 }
 
+/// @brief obtain the number of adjacent channels to average
+/// @details This number is given as the nAvg parameter of chooseChannels and is
+/// only meaningful if channelsSelected returns true.
+/// @return number of channels to average (1 means no averaging)
+casacore::uInt TableDataSelector::getChannelAveraging() const throw()
+{
+  return itsChannelAveraging;
+}
+
+/// @brief check whether polarisation selection has been done
+/// @details By default all polarisation products stored in the dataset are returned.
+/// However, if choosePolarizations has been called, the products are converted into
+/// the requested ones on read. This method returns true if this is the case.
+/// @return true, if polarisation products have been selected
+bool TableDataSelector::polarisationsSelected() const throw()
+{
+  return itsPolSelection.nelements() > 0;
+}
+
+/// @brief obtain polarisation selection
+/// @details This method returns the polarisation products requested via
+/// choosePolarizations. The vector is empty if no selection has been done.
+/// @return vector with the requested polarisation products
+const casacore::Vector<casacore::Stokes::StokesTypes>& TableDataSelector::getPolarisationSelection() const throw()
+{
+  return itsPolSelection;
+}
+
 /// @brief check whether frequency selection has been done
 /// @details By default all channels are selected. However, if chooseFrequencies
 /// has been called, less channels are returned. This method returns true if
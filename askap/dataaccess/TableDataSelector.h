@@ -129,7 +129,9 @@ public:
 
   /// Choose polarization.
   /// @param[in] pols a string describing the wanted polarization
-  /// in the output. Allowed values are: I, "IQUV","XXYY","RRLL"
+  /// in the output. Allowed values are: I, "IQUV","XXYY","RRLL" and
+  /// comma-separated lists of products like "XX,YY". The products stored in the
+  /// dataset are converted into the requested ones on read.
   virtual void choosePolarizations(const casacore::String &pols);
 
   /// Obtain a table expression node for selection. This method is
@@ -142,6 +144,16 @@ public:
   virtual const casacore::TableExprNode& getTableSelector(const
                   boost::shared_ptr<IDataConverterImpl const> &conv) const;
 
+  /// @brief obtain a description of the row selection
+  /// @details In addition to the criteria handled by TableScalarFieldSelector,
+  /// this method accounts for the epoch selection (converted to the table time
+  /// using the given converter).
+  /// @param[in] conv  a shared pointer to the converter, which is used to sort
+  ///              out epochs and other measures used in the selection
+  /// @return selection key
+  virtual std::string getSelectionKey(const
+                  boost::shared_ptr<IDataConverterImpl const> &conv) const;
+
   /// @brief choose data column
   /// @details This method allows to choose any table column as the visibility
   /// data column (e.g. DATA, CORRECTED_DATA, etc). Because this is a
@@ -185,6 +197,25 @@ public:
   /// the second element gives the start channel (0-based)
   virtual std::pair<int,int> getChannelSelection() const throw();
 
+  /// @brief obtain the number of adjacent channels to average
+  /// @details This number is given as the nAvg parameter of chooseChannels and is
+  /// only meaningful if channelsSelected returns true.
+  /// @return number of channels to average (1 means no averaging)
+  virtual casacore::uInt getChannelAveraging() const throw();
+
+  /// @brief check whether polarisation selection has been done
+  /// @details By default all polarisation products stored in the dataset are returned.
+  /// However, if choosePolarizations has been called, the products are converted into
+  /// the requested ones on read. This method returns true if this is the case.
+  /// @return true, if polarisation products have been selected
+  virtual bool polarisationsSelected() const throw();
+
+  /// @brief obtain polarisation selection
+  /// @details This method returns the polarisation products requested via
+  /// choosePolarizations. The vector is empty if no selection has been done.
+  /// @return vector with the requested polarisation products
+  virtual const casacore::Vector<casacore::Stokes::StokesTypes>& getPolarisationSelection() const throw();
+
   /// @brief check whether frequency selection has been done
   /// @details By default all channels are selected. However, if chooseFrequencies
   /// has been called, less channels are returned. This method returns true if
@@ -213,6 +244,10 @@ private:
   /// This class actually doesn't care about the meaning of these two numbers and just passes them across.
   /// However, in the TableConstDataIterator we assume the meaning given above.
   std::pair<int, int> itsChannelSelection;
+  /// @brief number of adjacent channels to average (1 means no averaging)
+  casacore::uInt itsChannelAveraging;
+  /// @brief polarisation products requested (empty vector means no selection)
+  casacore::Vector<casacore::Stokes::StokesTypes> itsPolSelection;
   /// Frequency selection
   /// number of Frequencies
   int itsNFreq;
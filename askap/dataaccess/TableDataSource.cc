@@ -101,7 +101,17 @@ boost::shared_ptr<IDataIterator> TableDataSource::createIterator(const
        ASKAPTHROW(DataAccessLogicError, "Incompatible selector and/or "<<
                  "converter are received by the createIterator method");
    }
-   return boost::shared_ptr<IDataIterator>(new TableDataIterator(
+   boost::shared_ptr<TableDataIterator> it(new TableDataIterator(
                 getTableManager(),implSel,implConv,uvwMachineCacheSize(),
-                uvwMachineCacheTolerance(), maxChunkSize())); 
+                uvwMachineCacheTolerance(), maxChunkSize()));
+   if (rotatedUVWCacheSize() > 1) {
+       it->setRotatedUVWCacheSize(rotatedUVWCacheSize());
+   }
+   if (parallacticAngleValidationEnabled()) {
+       it->setParallacticAngleValidation(true);
+   }
+   if (maxChunkMemory() > 0) {
+       it->setChunkMemoryBudget(maxChunkMemory());
+   }
+   return it;
 }
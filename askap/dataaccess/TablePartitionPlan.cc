@@ -0,0 +1,118 @@
+/// @file TablePartitionPlan.cc
+/// @brief split selected rows into contiguous time ranges
+/// @details To traverse a large measurement set with several threads, the
+/// selected rows are split into a number of partitions, each covering a
+/// contiguous range of time stamps. Each partition can then be iterated over
+/// by an independent TableConstDataIterator. The plan is computed once and
+/// shared between all iterators.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#include <askap_accessors.h>
+
+// std includes
+#include <algorithm>
+
+// ASKAPsoft includes
+#include <askap/askap/AskapError.h>
+#include <casacore/tables/Tables/ScalarColumn.h>
+#include <casacore/tables/Tables/RowNumbers.h>
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
+
+// own includes
+#include <askap/dataaccess/TablePartitionPlan.h>
+
+using namespace askap;
+using namespace askap::accessors;
+
+/// @brief construct the plan
+/// @param[in] tab table with the selected rows
+/// @param[in] nParts desired number of partitions (should be positive)
+TablePartitionPlan::TablePartitionPlan(const casacore::Table &tab, casacore::uInt nParts) :
+       itsTableMutex(new boost::recursive_mutex)
+{
+  ASKAPCHECK(nParts > 0, "Number of partitions should be positive");
+  const casacore::rownr_t nRow = tab.nrow();
+  itsBoundaries.reserve(nParts + 1);
+  itsBoundaries.push_back(0);
+  if ((nParts > 1) && (nRow > 1)) {
+      casacore::ScalarColumn<casacore::Double> timeCol(tab, "TIME");
+      const casacore::Vector<casacore::Double> times = timeCol.getColumn();
+      for (casacore::uInt part = 1; part < nParts; ++part) {
+           // the desired boundary is moved forward to the next change of time
+           casacore::rownr_t boundary = std::max(nRow * part / nParts, itsBoundaries.back() + 1);
+           while ((boundary < nRow) && (times[boundary] == times[boundary - 1])) {
+                  ++boundary;
+           }
+           if (boundary >= nRow) {
+               break;
+           }
+           itsBoundaries.push_back(boundary);
+      }
+  }
+  itsBoundaries.push_back(nRow);
+
+  const size_t nActualParts = itsBoundaries.size() - 1;
+  itsPartitions.reserve(nActualParts);
+  if (nActualParts == 1) {
+      itsPartitions.push_back(tab);
+  } else {
+      for (size_t part = 0; part < nActualParts; ++part) {
+           casacore::Vector<casacore::rownr_t> rows(itsBoundaries[part + 1] - itsBoundaries[part]);
+           casacore::indgen(rows, itsBoundaries[part]);
+           itsPartitions.push_back(tab(casacore::RowNumbers(rows)));
+      }
+  }
+}
+
+/// @brief obtain the table for the given partition
+/// @param[in] part partition number (0-based)
+/// @return table with the rows of the given partition
+const casacore::Table& TablePartitionPlan::partition(casacore::uInt part) const
+{
+  ASKAPCHECK(part < itsPartitions.size(), "Partition "<<part<<" doesn't exist, there are only "<<
+             itsPartitions.size()<<" partition(s)");
+  return itsPartitions[part];
+}
+
+/// @brief first row of the given partition
+/// @param[in] part partition number (0-based)
+/// @return the first row of the partition in the table given in the constructor
+casacore::rownr_t TablePartitionPlan::startRow(casacore::uInt part) const
+{
+  ASKAPCHECK(part + 1 < itsBoundaries.size(), "Partition "<<part<<" doesn't exist");
+  return itsBoundaries[part];
+}
+
+/// @brief number of rows in the given partition
+/// @param[in] part partition number (0-based)
+/// @return the number of rows in the partition
+casacore::rownr_t TablePartitionPlan::nRows(casacore::uInt part) const
+{
+  ASKAPCHECK(part + 1 < itsBoundaries.size(), "Partition "<<part<<" doesn't exist");
+  return itsBoundaries[part + 1] - itsBoundaries[part];
+}
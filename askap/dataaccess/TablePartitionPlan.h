@@ -0,0 +1,117 @@
+/// @file TablePartitionPlan.h
+/// @brief split selected rows into contiguous time ranges
+/// @details To traverse a large measurement set with several threads, the
+/// selected rows are split into a number of partitions, each covering a
+/// contiguous range of time stamps. Each partition can then be iterated over
+/// by an independent TableConstDataIterator. The plan is computed once and
+/// shared between all iterators.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#ifndef ASKAP_ACCESSORS_TABLE_PARTITION_PLAN_H
+#define ASKAP_ACCESSORS_TABLE_PARTITION_PLAN_H
+
+// std includes
+#include <vector>
+
+// boost includes
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+
+// casa includes
+#include <casacore/casa/aips.h>
+#include <casacore/tables/Tables/Table.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief split selected rows into contiguous time ranges
+/// @details The selected rows (i.e. the table after the selection expression
+/// has been applied) are split into partitions of roughly equal number of rows.
+/// The boundaries are only placed where the time changes, so all rows with the
+/// same time stamp belong to the same partition (the iterator assumes that each
+/// iteration of the table iterator over TIME is within one partition). As a result,
+/// the number of partitions may be less than requested if there are not enough
+/// distinct time stamps. The sub-tables for all partitions are created in the
+/// constructor, so the plan can be shared between iterators used in different threads.
+/// @note The partitions are reference tables over the same table and the iterators
+/// share the subtable handlers, none of which are thread-safe. The plan provides a
+/// mutex which the iterators lock for every access to the table or subtables, so
+/// only the processing of the data runs concurrently.
+/// @ingroup dataaccess_tab
+class TablePartitionPlan : private boost::noncopyable {
+public:
+  /// @brief construct the plan
+  /// @param[in] tab table with the selected rows
+  /// @param[in] nParts desired number of partitions (should be positive)
+  TablePartitionPlan(const casacore::Table &tab, casacore::uInt nParts);
+
+  /// @brief number of partitions
+  /// @details It can be less than requested in the constructor, but is always 1 or more
+  /// @return actual number of partitions
+  inline casacore::uInt nParts() const { return casacore::uInt(itsPartitions.size()); }
+
+  /// @brief obtain the table for the given partition
+  /// @param[in] part partition number (0-based)
+  /// @return table with the rows of the given partition
+  const casacore::Table& partition(casacore::uInt part) const;
+
+  /// @brief first row of the given partition
+  /// @param[in] part partition number (0-based)
+  /// @return the first row of the partition in the table given in the constructor
+  casacore::rownr_t startRow(casacore::uInt part) const;
+
+  /// @brief number of rows in the given partition
+  /// @param[in] part partition number (0-based)
+  /// @return the number of rows in the partition
+  casacore::rownr_t nRows(casacore::uInt part) const;
+
+  /// @brief mutex serialising the access to the table
+  /// @details It is shared by all iterators working with this plan (and their
+  /// read-ahead buffers, if any).
+  /// @return shared pointer to the mutex
+  inline const boost::shared_ptr<boost::recursive_mutex>& tableMutex() const { return itsTableMutex; }
+
+private:
+  /// @brief boundaries of partitions
+  /// @details Element i is the first row of partition i, the last element is the
+  /// total number of rows (i.e. the size of this vector is the number of partitions + 1)
+  std::vector<casacore::rownr_t> itsBoundaries;
+
+  /// @brief tables corresponding to each partition
+  std::vector<casacore::Table> itsPartitions;
+
+  /// @brief mutex serialising the access to the table from all partitions
+  boost::shared_ptr<boost::recursive_mutex> itsTableMutex;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_TABLE_PARTITION_PLAN_H
@@ -0,0 +1,493 @@
+/// @file TableReadAheadBuffer.cc
+/// @brief background reading of the next chunk of data
+/// @details TableConstDataIterator reads the bulk data (visibilities, flags,
+/// noise and uvw) on demand, when the appropriate field of the accessor is
+/// first requested. Therefore, the processing of the current chunk and the
+/// disk I/O for the next chunk never overlap. This class implements a helper
+/// which reads the next chunk in a separate thread while the current
+/// one is being processed.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#include <askap_accessors.h>
+
+// ASKAPsoft includes
+#include <askap/askap/AskapLogging.h>
+#include <askap/askap/AskapError.h>
+#include <casacore/tables/Tables/ArrayColumn.h>
+#include <casacore/tables/Tables/ScalarColumn.h>
+#include <casacore/casa/Arrays/Cube.h>
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/casa/Arrays/Slicer.h>
+#include <casacore/casa/Arrays/IPosition.h>
+
+// boost includes
+#include <boost/bind.hpp>
+
+// std includes
+#include <utility>
+
+// own includes
+#include <askap/dataaccess/TableReadAheadBuffer.h>
+
+ASKAP_LOGGER(logger, ".dataaccess.readahead");
+
+using namespace askap;
+using namespace askap::accessors;
+
+/// @brief default constructor, makes an empty chunk
+TableReadAheadBuffer::Chunk::Chunk() : itsStep(0), itsTopRow(0), itsNumberOfRows(0),
+     itsStartChannel(0), itsNumberOfChannels(0), itsNumberOfPols(0), itsHasSigmaSpectrum(false) {}
+
+/// @brief check that this chunk covers the given one
+/// @details The data read for this chunk can be used for the given one if it
+/// corresponds to the same iteration step, same top row and channels and has at least
+/// the same number of rows.
+/// @param[in] other chunk to test
+/// @return true if the data of this chunk can be used for the other one
+bool TableReadAheadBuffer::Chunk::covers(const Chunk &other) const
+{
+  return (itsStep == other.itsStep) && (itsTopRow == other.itsTopRow) &&
+         (itsNumberOfRows >= other.itsNumberOfRows) && (itsStartChannel == other.itsStartChannel) &&
+         (itsNumberOfChannels == other.itsNumberOfChannels) && (itsNumberOfPols == other.itsNumberOfPols) &&
+         (itsDataColumn == other.itsDataColumn) && (itsHasSigmaSpectrum == other.itsHasSigmaSpectrum);
+}
+
+/// @brief estimate memory required to hold the given fields
+/// @param[in] fields bit mask of the fields to read
+/// @param[in] packedFlags true, if flags are held as a bit mask
+/// @return the number of bytes required to hold the data
+size_t TableReadAheadBuffer::Chunk::memory(int fields, bool packedFlags) const
+{
+  const size_t nElements = size_t(itsNumberOfRows) * itsNumberOfChannels * itsNumberOfPols;
+  size_t result = 0;
+  if (fields & VISIBILITY) {
+      result += nElements * sizeof(casacore::Complex);
+  }
+  if (fields & FLAG) {
+      result += packedFlags ? (nElements + 63) / 64 * sizeof(casacore::uInt64) :
+                              nElements * sizeof(casacore::Bool);
+  }
+  if ((fields & NOISE) && itsHasSigmaSpectrum) {
+      result += nElements * sizeof(casacore::Float);
+  }
+  if (fields & UVW) {
+      result += size_t(itsNumberOfRows) * 3 * sizeof(casacore::Double);
+  }
+  return result;
+}
+
+/// @brief constructor
+/// @details Starts the background thread
+/// @param[in] maxMemory maximum memory in bytes which can be taken by the buffers
+/// @param[in] packFlags if true, flags are held as a bit mask (one bit per sample
+/// instead of one byte), so a larger chunk fits into the same memory
+/// @param[in] tableMutex mutex serialising the access to the table, it should be shared
+/// with everything else accessing the same table (a new mutex is created if the shared
+/// pointer is empty)
+TableReadAheadBuffer::TableReadAheadBuffer(size_t maxMemory, bool packFlags,
+          const boost::shared_ptr<boost::recursive_mutex> &tableMutex) : itsMaxMemory(maxMemory),
+     itsPackFlags(packFlags), itsTableMutex(tableMutex), itsJobPending(false), itsStopRequested(false),
+     itsJobFailed(false), itsNextFields(0), itsCurrentFields(0), itsRequestedFields(ALL)
+{
+  if (!itsTableMutex) {
+      itsTableMutex.reset(new boost::recursive_mutex);
+  }
+  itsThread.reset(new boost::thread(boost::bind(&TableReadAheadBuffer::run, this)));
+}
+
+/// @brief destructor, stops the background thread
+TableReadAheadBuffer::~TableReadAheadBuffer()
+{
+  {
+     boost::lock_guard<boost::mutex> lock(itsMutex);
+     itsStopRequested = true;
+  }
+  itsCondVar.notify_all();
+  if (itsThread) {
+      itsThread->join();
+  }
+  // the table held for the next chunk is released with the table mutex locked
+  boost::lock_guard<boost::recursive_mutex> tableLock(*itsTableMutex);
+  itsNextChunk = Chunk();
+  itsCurrentChunk = Chunk();
+}
+
+/// @brief main loop of the background thread
+void TableReadAheadBuffer::run()
+{
+  boost::unique_lock<boost::mutex> lock(itsMutex);
+  while (true) {
+     while (!itsJobPending && !itsStopRequested) {
+        itsCondVar.wait(lock);
+     }
+     if (itsStopRequested) {
+         itsJobPending = false;
+         itsCondVar.notify_all();
+         break;
+     }
+     // the main thread doesn't touch the description of the next chunk or the
+     // next buffers while the job is pending, so it is safe to release the lock here.
+     // We must not hold it while waiting for the table access.
+     lock.unlock();
+     bool failed = false;
+     try {
+        readChunk(itsNextChunk, itsNextFields);
+     }
+     catch (const std::exception &ex) {
+        ASKAPLOG_DEBUG_STR(logger, "Read-ahead of the next chunk failed, data will be read directly: "<<ex.what());
+        failed = true;
+     }
+     lock.lock();
+     itsJobFailed = failed;
+     itsJobPending = false;
+     itsCondVar.notify_all();
+  }
+}
+
+/// @brief read the scheduled chunk
+/// @details This method is executed in the background thread, the results are stored
+/// in the "next" buffers.
+/// @param[in] chunk description of the chunk to read
+/// @param[in] fields bit mask of the fields to read
+void TableReadAheadBuffer::readChunk(const Chunk &chunk, int fields)
+{
+  // the table mutex is only held while a column is read, so the main thread
+  // can access the table (e.g. subtables or metadata) between the column reads.
+  // Column objects are created and destroyed with the mutex locked as they
+  // update the reference counters of the table.
+  const casacore::Slicer rowSlicer(casacore::IPosition(1, chunk.itsTopRow),
+                                   casacore::IPosition(1, chunk.itsNumberOfRows));
+  const casacore::Slicer chanSlicer(casacore::Slice(), casacore::Slice(chunk.itsStartChannel,
+                                    chunk.itsNumberOfChannels));
+  // only the general case of 2D cells is handled here, the fields which are not read
+  // will just be read directly by the iterator
+  if (fields & VISIBILITY) {
+      boost::lock_guard<boost::recursive_mutex> tableLock(*itsTableMutex);
+      casacore::ArrayColumn<casacore::Complex> col(chunk.itsTable, chunk.itsDataColumn);
+      if (col.ndim(chunk.itsTopRow) == 2) {
+          col.getColumnRange(rowSlicer, chanSlicer, itsNextVis, casacore::True);
+      } else {
+          itsNextFields &= ~VISIBILITY;
+      }
+  }
+  if (fields & FLAG) {
+      bool read = false;
+      casacore::Vector<casacore::Bool> flagRow;
+      {
+         boost::lock_guard<boost::recursive_mutex> tableLock(*itsTableMutex);
+         casacore::ArrayColumn<casacore::Bool> col(chunk.itsTable, "FLAG");
+         if (col.ndim(chunk.itsTopRow) == 2) {
+             col.getColumnRange(rowSlicer, chanSlicer, itsNextFlag, casacore::True);
+             read = true;
+         }
+      }
+      if (read) {
+          {
+             boost::lock_guard<boost::recursive_mutex> tableLock(*itsTableMutex);
+             if (chunk.itsTable.tableDesc().isColumn("FLAG_ROW")) {
+                 casacore::ScalarColumn<casacore::Bool> flagRowCol(chunk.itsTable, "FLAG_ROW");
+                 flagRowCol.getColumnRange(rowSlicer, flagRow, casacore::True);
+             }
+          }
+          // apply row-based flags here, so the main thread doesn't need to access the table
+          casacore::Cube<casacore::Bool> flags(itsNextFlag);
+          for (casacore::uInt row = 0; row < flagRow.nelements(); ++row) {
+               if (flagRow[row]) {
+                   flags.xyPlane(row) = casacore::True;
+               }
+          }
+          if (itsPackFlags) {
+              itsNextPackedFlag.pack(itsNextFlag);
+              itsNextFlag.resize();
+          }
+      } else {
+          itsNextFields &= ~FLAG;
+      }
+  }
+  if ((fields & NOISE) && chunk.itsHasSigmaSpectrum) {
+      boost::lock_guard<boost::recursive_mutex> tableLock(*itsTableMutex);
+      casacore::ArrayColumn<casacore::Float> col(chunk.itsTable, "SIGMA_SPECTRUM");
+      if (col.ndim(chunk.itsTopRow) == 2) {
+          col.getColumnRange(rowSlicer, chanSlicer, itsNextSigma, casacore::True);
+      } else {
+          itsNextFields &= ~NOISE;
+      }
+  }
+  if (fields & UVW) {
+      boost::lock_guard<boost::recursive_mutex> tableLock(*itsTableMutex);
+      casacore::ArrayColumn<casacore::Double> col(chunk.itsTable, "UVW");
+      col.getColumnRange(rowSlicer, itsNextUVW, casacore::True);
+  }
+}
+
+/// @brief wait until the background job is complete
+/// @param[in] lock lock of itsMutex held by the caller
+void TableReadAheadBuffer::waitForCompletion(boost::unique_lock<boost::mutex> &lock) const
+{
+  ASKAPDEBUGASSERT(lock.owns_lock());
+  while (itsJobPending) {
+     itsCondVar.wait(lock);
+  }
+}
+
+/// @brief make the given chunk current
+/// @details This method waits for the background job to complete (if any). If the chunk
+/// read in the background covers the given one, the data become available via get methods.
+/// Otherwise, the data are discarded and get methods will return false until the next
+/// successful activation.
+/// @param[in] chunk description of the current chunk
+void TableReadAheadBuffer::activate(const Chunk &chunk)
+{
+  boost::unique_lock<boost::mutex> lock(itsMutex);
+  waitForCompletion(lock);
+  itsCurrentVis.resize();
+  itsCurrentFlag.resize();
+  itsCurrentPackedFlag = PackedFlags();
+  itsCurrentSigma.resize();
+  itsCurrentUVW.resize();
+  itsCurrentFields = 0;
+  if (!itsJobFailed && (itsNextFields != 0) && itsNextChunk.covers(chunk)) {
+      itsCurrentFields = itsNextFields;
+      itsCurrentVis.reference(itsNextVis);
+      itsCurrentFlag.reference(itsNextFlag);
+      std::swap(itsCurrentPackedFlag, itsNextPackedFlag);
+      itsCurrentSigma.reference(itsNextSigma);
+      itsCurrentUVW.reference(itsNextUVW);
+  }
+  // the next chunk is not needed any more, release the table and the buffers
+  // (the background thread is idle, it is safe to lock the table mutex here)
+  {
+     boost::lock_guard<boost::recursive_mutex> tableLock(*itsTableMutex);
+     itsCurrentChunk = chunk;
+     itsNextChunk = Chunk();
+  }
+  itsNextFields = 0;
+  itsJobFailed = false;
+  itsNextVis.resize();
+  itsNextFlag.resize();
+  itsNextPackedFlag = PackedFlags();
+  itsNextSigma.resize();
+  itsNextUVW.resize();
+}
+
+/// @brief schedule reading of the next chunk
+/// @details The fields read are those requested since the previous call to this method
+/// (all fields if this is the first chunk after construction or reset). Nothing
+/// is done if the memory required would exceed the limit.
+/// @param[in] chunk description of the chunk to read (the table is transferred to this class)
+void TableReadAheadBuffer::schedule(Chunk &chunk)
+{
+  boost::unique_lock<boost::mutex> lock(itsMutex);
+  waitForCompletion(lock);
+  // fields requested since the last activation define what is read for the next chunk,
+  // the request mask is cleared here so the next chunk starts counting afresh
+  const int fields = itsRequestedFields;
+  itsRequestedFields = 0;
+  // the background thread is idle at this point, so it is safe to copy and release the table
+  // (table objects are reference counted, so this is done with the table mutex locked)
+  boost::unique_lock<boost::recursive_mutex> tableLock(*itsTableMutex);
+  itsNextChunk = chunk;
+  chunk.itsTable = casacore::Table();
+  if ((fields == 0) || (chunk.itsNumberOfRows == 0)) {
+      itsNextChunk = Chunk();
+      return;
+  }
+  if (chunk.memory(fields, itsPackFlags) + itsCurrentChunk.memory(itsCurrentFields, itsPackFlags) > itsMaxMemory) {
+      ASKAPLOG_DEBUG_STR(logger, "Read-ahead of the next chunk of "<<chunk.itsNumberOfRows<<
+                         " rows is skipped as it exceeds the memory limit of "<<itsMaxMemory<<" bytes");
+      itsNextChunk = Chunk();
+      return;
+  }
+  tableLock.unlock();
+  itsNextFields = fields;
+  itsJobFailed = false;
+  itsJobPending = true;
+  lock.unlock();
+  itsCondVar.notify_all();
+}
+
+/// @brief discard all data
+/// @details Waits for the background job to complete and discards all data. The
+/// mask of fields to read is reset to all fields.
+void TableReadAheadBuffer::reset()
+{
+  boost::unique_lock<boost::mutex> lock(itsMutex);
+  waitForCompletion(lock);
+  {
+     boost::lock_guard<boost::recursive_mutex> tableLock(*itsTableMutex);
+     itsCurrentChunk = Chunk();
+     itsNextChunk = Chunk();
+  }
+  itsCurrentFields = 0;
+  itsNextFields = 0;
+  itsRequestedFields = ALL;
+  itsJobFailed = false;
+  itsCurrentVis.resize();
+  itsCurrentFlag.resize();
+  itsCurrentPackedFlag = PackedFlags();
+  itsCurrentSigma.resize();
+  itsCurrentUVW.resize();
+  itsNextVis.resize();
+  itsNextFlag.resize();
+  itsNextPackedFlag = PackedFlags();
+  itsNextSigma.resize();
+  itsNextUVW.resize();
+}
+
+/// @brief helper method to check the column and register the request
+/// @details This method is called with itsMutex locked.
+/// @param[in] column name of the column
+/// @param[in] field corresponding field
+/// @return true, if the data for the given field are available for the current chunk
+bool TableReadAheadBuffer::checkRequest(const std::string &column, int field) const
+{
+  itsRequestedFields |= field;
+  if ((itsCurrentFields & field) == 0) {
+      return false;
+  }
+  switch (field) {
+     case VISIBILITY:
+          return column == itsCurrentChunk.itsDataColumn;
+     case FLAG:
+          return column == "FLAG";
+     case NOISE:
+          return column == "SIGMA_SPECTRUM";
+     case UVW:
+          return column == "UVW";
+     default:
+          ASKAPTHROW(AskapError, "Unexpected field "<<field<<" in TableReadAheadBuffer::checkRequest");
+  }
+  return false;
+}
+
+/// @brief helper method to extract the data for the current chunk
+/// @details The data read in advance may have more rows than the current chunk.
+/// @param[in] in array read in advance (last axis is the row)
+/// @param[in] nRow number of rows in the current chunk
+/// @return array referencing the rows of the current chunk
+template<typename T>
+casacore::Array<T> TableReadAheadBuffer::firstRows(const casacore::Array<T> &in, casacore::uInt nRow)
+{
+  const casacore::IPosition shape = in.shape();
+  ASKAPDEBUGASSERT(shape.nelements() > 0);
+  const size_t lastAxis = shape.nelements() - 1;
+  ASKAPDEBUGASSERT(shape[lastAxis] >= casacore::ssize_t(nRow));
+  if (shape[lastAxis] == casacore::ssize_t(nRow)) {
+      return in;
+  }
+  casacore::IPosition end = shape - 1;
+  end[lastAxis] = nRow - 1;
+  return in(casacore::IPosition(shape.nelements(), 0), end);
+}
+
+/// @brief obtain visibilities read in advance
+/// @param[in] column name of the column
+/// @param[out] buf array to be filled (nPol x nChannel x nRow), references the buffer
+/// @return true if successful, false if the data should be read directly from the table
+bool TableReadAheadBuffer::get(const std::string &column, casacore::Array<casacore::Complex> &buf) const
+{
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  if (!checkRequest(column, VISIBILITY)) {
+      return false;
+  }
+  buf.reference(firstRows(itsCurrentVis, itsCurrentChunk.itsNumberOfRows));
+  return true;
+}
+
+/// @brief obtain flags read in advance
+/// @param[in] column name of the column
+/// @param[out] buf array to be filled (nPol x nChannel x nRow), references the buffer
+/// @return true if successful, false if the data should be read directly from the table
+bool TableReadAheadBuffer::get(const std::string &column, casacore::Array<casacore::Bool> &buf) const
+{
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  if (!checkRequest(column, FLAG)) {
+      return false;
+  }
+  if (itsPackFlags) {
+      // the flags are unpacked into a new array, the bit mask stays in the buffer
+      casacore::Cube<casacore::Bool> flags;
+      if (itsCurrentPackedFlag.nRow() == itsCurrentChunk.itsNumberOfRows) {
+          itsCurrentPackedFlag.unpackNative(flags);
+      } else {
+          PackedFlags rows;
+          rows.assignRows(itsCurrentPackedFlag, itsCurrentChunk.itsNumberOfRows);
+          rows.unpackNative(flags);
+      }
+      buf.reference(flags);
+  } else {
+      buf.reference(firstRows(itsCurrentFlag, itsCurrentChunk.itsNumberOfRows));
+  }
+  return true;
+}
+
+/// @brief obtain flags read in advance as a bit mask
+/// @details Flags set via FLAG_ROW column are already applied to the result.
+/// @param[in] column name of the column
+/// @param[out] flag packed flags to fill (nRow x nChannel x nPol)
+/// @return true if successful, false if the data should be read directly from the table
+bool TableReadAheadBuffer::get(const std::string &column, PackedFlags &flag) const
+{
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  if (!checkRequest(column, FLAG)) {
+      return false;
+  }
+  if (itsPackFlags) {
+      flag.assignRows(itsCurrentPackedFlag, itsCurrentChunk.itsNumberOfRows);
+  } else {
+      flag.pack(firstRows(itsCurrentFlag, itsCurrentChunk.itsNumberOfRows));
+  }
+  return true;
+}
+
+/// @brief obtain noise figures read in advance
+/// @param[in] column name of the column
+/// @param[out] buf array to be filled (nPol x nChannel x nRow), references the buffer
+/// @return true if successful, false if the data should be read directly from the table
+bool TableReadAheadBuffer::get(const std::string &column, casacore::Array<casacore::Float> &buf) const
+{
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  if (!checkRequest(column, NOISE)) {
+      return false;
+  }
+  buf.reference(firstRows(itsCurrentSigma, itsCurrentChunk.itsNumberOfRows));
+  return true;
+}
+
+/// @brief obtain uvw read in advance
+/// @param[in] column name of the column
+/// @param[out] buf array to be filled (3 x nRow), references the buffer
+/// @return true if successful, false if the data should be read directly from the table
+bool TableReadAheadBuffer::get(const std::string &column, casacore::Array<casacore::Double> &buf) const
+{
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  if (!checkRequest(column, UVW)) {
+      return false;
+  }
+  buf.reference(firstRows(itsCurrentUVW, itsCurrentChunk.itsNumberOfRows));
+  return true;
+}
@@ -0,0 +1,313 @@
+/// @file TableReadAheadBuffer.h
+/// @brief background reading of the next chunk of data
+/// @details TableConstDataIterator reads the bulk data (visibilities, flags,
+/// noise and uvw) on demand, when the appropriate field of the accessor is
+/// first requested. Therefore, the processing of the current chunk and the
+/// disk I/O for the next chunk never overlap. This class implements a helper
+/// which reads the next chunk in a separate thread while the current
+/// one is being processed. It holds at most two chunks at any time: the current
+/// one (already read) and the next one (being read or already read in the background).
+/// casacore tables are not thread-safe, so all access to the table
+/// is serialised via the mutex provided by this class. The iterator locks it when
+/// it reads the table itself.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#ifndef ASKAP_ACCESSORS_TABLE_READ_AHEAD_BUFFER_H
+#define ASKAP_ACCESSORS_TABLE_READ_AHEAD_BUFFER_H
+
+// std includes
+#include <string>
+
+// boost includes
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+// casa includes
+#include <casacore/casa/aips.h>
+#include <casacore/casa/Arrays/Array.h>
+#include <casacore/casa/BasicSL/Complex.h>
+#include <casacore/tables/Tables/Table.h>
+
+// own includes
+#include <askap/dataaccess/PackedFlags.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief background reading of the next chunk of data
+/// @details TableConstDataIterator reads the bulk data (visibilities, flags,
+/// noise and uvw) on demand, when the appropriate field of the accessor is
+/// first requested. This class reads the next chunk in a separate thread while
+/// the current one is being processed. It holds at most two chunks at any time:
+/// the current one and the next one. The data are kept in the measurement set
+/// order (as returned by ArrayColumn::getColumnRange).
+/// Only the fields requested by the user for the previous chunk are read for the
+/// next one (all fields are read for the very first chunk).
+/// @note casacore tables are not thread-safe, so all access to the table
+/// is serialised via the mutex returned by tableMutex(). The background job only
+/// holds this mutex while a column is read, so the main thread is not blocked for the
+/// whole read-ahead of the chunk. Methods which wait for
+/// the background job to complete (activate, schedule and reset) should not be
+/// called while this mutex is locked by the caller.
+/// @ingroup dataaccess_tab
+class TableReadAheadBuffer : private boost::noncopyable {
+public:
+
+  /// @brief fields which can be read in advance
+  /// @details Values can be combined as a bit mask
+  enum Fields {
+     VISIBILITY = 1,
+     FLAG = 2,
+     NOISE = 4,
+     UVW = 8,
+     ALL = 15
+  };
+
+  /// @brief description of a chunk of data
+  /// @details This structure describes rows and channels of the chunk to read.
+  /// The iteration step is used to distinguish between different tables returned by
+  /// the table iterator (the row number is relative to the iteration).
+  struct Chunk {
+     /// @brief default constructor, makes an empty chunk
+     Chunk();
+
+     /// @brief check that this chunk covers the given one
+     /// @details The data read for this chunk can be used for the given one if it
+     /// corresponds to the same iteration step, same top row and channels and has at least
+     /// the same number of rows.
+     /// @param[in] other chunk to test
+     /// @return true if the data of this chunk can be used for the other one
+     bool covers(const Chunk &other) const;
+
+     /// @brief estimate memory required to hold the given fields
+     /// @param[in] fields bit mask of the fields to read
+     /// @param[in] packedFlags true, if flags are held as a bit mask
+     /// @return the number of bytes required to hold the data
+     size_t memory(int fields, bool packedFlags = false) const;
+
+     /// @brief the table to read from (current iteration of the table iterator)
+     casacore::Table itsTable;
+     /// @brief iteration step of the table iterator corresponding to itsTable
+     casacore::uInt itsStep;
+     /// @brief the first row in itsTable
+     casacore::rownr_t itsTopRow;
+     /// @brief number of rows to read
+     casacore::uInt itsNumberOfRows;
+     /// @brief the first channel to read
+     casacore::uInt itsStartChannel;
+     /// @brief number of channels to read
+     casacore::uInt itsNumberOfChannels;
+     /// @brief number of polarisation products
+     casacore::uInt itsNumberOfPols;
+     /// @brief name of the column with visibilities
+     std::string itsDataColumn;
+     /// @brief true if SIGMA_SPECTRUM column is present (and should be used for noise)
+     bool itsHasSigmaSpectrum;
+  };
+
+  /// @brief constructor
+  /// @details Starts the background thread
+  /// @param[in] maxMemory maximum memory in bytes which can be taken by the buffers
+  /// @param[in] packFlags if true, flags are held as a bit mask (one bit per sample
+  /// instead of one byte), so a larger chunk fits into the same memory
+  /// @param[in] tableMutex mutex serialising the access to the table, it should be shared
+  /// with everything else accessing the same table (a new mutex is created if the shared
+  /// pointer is empty)
+  explicit TableReadAheadBuffer(size_t maxMemory, bool packFlags = false,
+           const boost::shared_ptr<boost::recursive_mutex> &tableMutex =
+                 boost::shared_ptr<boost::recursive_mutex>());
+
+  /// @brief destructor, stops the background thread
+  ~TableReadAheadBuffer();
+
+  /// @brief make the given chunk current
+  /// @details This method waits for the background job to complete (if any). If the chunk
+  /// read in the background covers the given one, the data become available via get methods.
+  /// Otherwise, the data are discarded and get methods will return false until the next
+  /// successful activation.
+  /// @param[in] chunk description of the current chunk
+  void activate(const Chunk &chunk);
+
+  /// @brief schedule reading of the next chunk
+  /// @details The fields read are those requested since the previous call to this method
+  /// (all fields if this is the first chunk after construction or reset). Nothing
+  /// is done if the memory required would exceed the limit.
+  /// @param[in] chunk description of the chunk to read
+  /// @note The table is transferred to this class (the table object in the chunk is
+  /// reset on exit), so the caller doesn't hold a copy of the table which is being
+  /// read in the background. Table objects are reference counted and the counter is not thread-safe.
+  void schedule(Chunk &chunk);
+
+  /// @brief discard all data
+  /// @details Waits for the background job to complete and discards all data. The
+  /// mask of fields to read is reset to all fields.
+  void reset();
+
+  /// @brief obtain visibilities read in advance
+  /// @param[in] column name of the column
+  /// @param[out] buf array to be filled (nPol x nChannel x nRow), references the buffer
+  /// @return true if successful, false if the data should be read directly from the table
+  bool get(const std::string &column, casacore::Array<casacore::Complex> &buf) const;
+
+  /// @brief obtain flags read in advance
+  /// @details Flags set via FLAG_ROW column are already applied to the result.
+  /// @param[in] column name of the column
+  /// @param[out] buf array to be filled (nPol x nChannel x nRow), references the buffer
+  /// @return true if successful, false if the data should be read directly from the table
+  bool get(const std::string &column, casacore::Array<casacore::Bool> &buf) const;
+
+  /// @brief obtain flags read in advance as a bit mask
+  /// @details Flags set via FLAG_ROW column are already applied to the result.
+  /// @param[in] column name of the column
+  /// @param[out] flag packed flags to fill (nRow x nChannel x nPol)
+  /// @return true if successful, false if the data should be read directly from the table
+  bool get(const std::string &column, PackedFlags &flag) const;
+
+  /// @brief obtain noise figures read in advance
+  /// @param[in] column name of the column
+  /// @param[out] buf array to be filled (nPol x nChannel x nRow), references the buffer
+  /// @return true if successful, false if the data should be read directly from the table
+  bool get(const std::string &column, casacore::Array<casacore::Float> &buf) const;
+
+  /// @brief obtain uvw read in advance
+  /// @param[in] column name of the column
+  /// @param[out] buf array to be filled (3 x nRow), references the buffer
+  /// @return true if successful, false if the data should be read directly from the table
+  bool get(const std::string &column, casacore::Array<casacore::Double> &buf) const;
+
+  /// @brief mutex serialising the access to the table
+  /// @return reference to the mutex
+  inline boost::recursive_mutex& tableMutex() const { return *itsTableMutex; }
+
+protected:
+  /// @brief main loop of the background thread
+  void run();
+
+  /// @brief read the scheduled chunk
+  /// @details This method is executed in the background thread, the results are stored
+  /// in the "next" buffers.
+  /// @param[in] chunk description of the chunk to read
+  /// @param[in] fields bit mask of the fields to read
+  void readChunk(const Chunk &chunk, int fields);
+
+  /// @brief wait until the background job is complete
+  /// @param[in] lock lock of itsMutex held by the caller
+  void waitForCompletion(boost::unique_lock<boost::mutex> &lock) const;
+
+  /// @brief helper method to check the column and register the request
+  /// @param[in] column name of the column
+  /// @param[in] field corresponding field
+  /// @return true, if the data for the given field are available for the current chunk
+  bool checkRequest(const std::string &column, int field) const;
+
+  /// @brief helper method to extract the data for the current chunk
+  /// @details The data read in advance may have more rows than the current chunk.
+  /// @param[in] in array read in advance (last axis is the row)
+  /// @param[in] nRow number of rows in the current chunk
+  /// @return array referencing the rows of the current chunk
+  template<typename T>
+  static casacore::Array<T> firstRows(const casacore::Array<T> &in, casacore::uInt nRow);
+
+private:
+  /// @brief maximum memory in bytes taken by both current and next chunks
+  size_t itsMaxMemory;
+
+  /// @brief true, if flags are held as a bit mask
+  bool itsPackFlags;
+
+  /// @brief mutex protecting the state of this class
+  mutable boost::mutex itsMutex;
+
+  /// @brief condition variable used to signal the change of the state
+  mutable boost::condition_variable itsCondVar;
+
+  /// @brief mutex serialising the access to the table
+  /// @details Table objects are reference counted, so copying or releasing them
+  /// is also done with this mutex locked.
+  boost::shared_ptr<boost::recursive_mutex> itsTableMutex;
+
+  /// @brief true, if a job is scheduled but has not yet been completed
+  bool itsJobPending;
+
+  /// @brief true, if the background thread should finish
+  bool itsStopRequested;
+
+  /// @brief true, if the background job failed (the data will be read directly)
+  bool itsJobFailed;
+
+  /// @brief chunk being read in the background
+  Chunk itsNextChunk;
+
+  /// @brief fields being read in the background
+  int itsNextFields;
+
+  /// @brief current chunk (data can be returned by get methods)
+  Chunk itsCurrentChunk;
+
+  /// @brief fields available for the current chunk
+  int itsCurrentFields;
+
+  /// @brief fields requested by the user since the last activation
+  mutable int itsRequestedFields;
+
+  /// @brief visibilities for the next chunk
+  casacore::Array<casacore::Complex> itsNextVis;
+  /// @brief flags for the next chunk
+  casacore::Array<casacore::Bool> itsNextFlag;
+  /// @brief flags for the next chunk as a bit mask (if itsPackFlags is true)
+  PackedFlags itsNextPackedFlag;
+  /// @brief sigma spectrum for the next chunk
+  casacore::Array<casacore::Float> itsNextSigma;
+  /// @brief uvw for the next chunk
+  casacore::Array<casacore::Double> itsNextUVW;
+
+  /// @brief visibilities for the current chunk
+  casacore::Array<casacore::Complex> itsCurrentVis;
+  /// @brief flags for the current chunk
+  casacore::Array<casacore::Bool> itsCurrentFlag;
+  /// @brief flags for the current chunk as a bit mask (if itsPackFlags is true)
+  PackedFlags itsCurrentPackedFlag;
+  /// @brief sigma spectrum for the current chunk
+  casacore::Array<casacore::Float> itsCurrentSigma;
+  /// @brief uvw for the current chunk
+  casacore::Array<casacore::Double> itsCurrentUVW;
+
+  /// @brief background thread (should be the last data member, so it is
+  /// started after everything else is initialised)
+  boost::shared_ptr<boost::thread> itsThread;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_TABLE_READ_AHEAD_BUFFER_H
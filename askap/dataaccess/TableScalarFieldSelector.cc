@@ -40,6 +40,10 @@
 #include <askap/dataaccess/DataAccessError.h>
 #include <casacore/tables/TaQL/ExprNodeSet.h>
 
+// std includes
+#include <sstream>
+#include <iomanip>
+
 
 using namespace askap;
 using namespace askap::accessors;
@@ -59,6 +63,9 @@ void TableScalarFieldSelector::chooseFeed(casacore::uInt feedID)
                   static_cast<casacore::Int>(feedID)) && (table().col("FEED2") ==
                   static_cast<casacore::Int>(feedID));
    }
+   std::ostringstream os;
+   os<<"FEED="<<feedID;
+   appendSelectionKey(os.str());
 }
 
 /// @brief choose user-defined index
@@ -71,6 +78,9 @@ void TableScalarFieldSelector::chooseUserDefinedIndex(const std::string &column,
    } else {
        itsTableSelector = itsTableSelector && (table().col(column) == value);
    }
+   std::ostringstream os;
+   os<<column<<"="<<value;
+   appendSelectionKey(os.str());
 }
 
 /// Choose a single baseline
@@ -89,6 +99,9 @@ void TableScalarFieldSelector::chooseBaseline(casacore::uInt ant1,
            static_cast<casacore::Int>(ant1)) && (table().col("ANTENNA2") ==
 	   static_cast<casacore::Int>(ant2));
    }
+   std::ostringstream os;
+   os<<"BASELINE="<<ant1<<"-"<<ant2;
+   appendSelectionKey(os.str());
 }
 
 /// Choose all baselines to given antenna
@@ -104,6 +117,9 @@ void TableScalarFieldSelector::chooseAntenna(casacore::uInt ant)
            static_cast<casacore::Int>(ant)) || (table().col("ANTENNA2") ==
 	   static_cast<casacore::Int>(ant)));
    }
+   std::ostringstream os;
+   os<<"ANTENNA="<<ant;
+   appendSelectionKey(os.str());
 }
 
 /// @brief Choose samples corresponding to a uv-distance larger than threshold
@@ -124,6 +140,9 @@ void TableScalarFieldSelector::chooseMinUVDistance(casacore::Double uvDist)
                  (nelements(uvwExprNode) >= 2) && 
                  (sqrt(square(uExprNode) + square(vExprNode)) >= uvDist);
   }
+  std::ostringstream os;
+  os<<"MINUV="<<std::setprecision(17)<<uvDist;
+  appendSelectionKey(os.str());
 }
 
 /// @brief Choose samples corresponding to either zero uv-distance or larger than threshold
@@ -151,6 +170,9 @@ void TableScalarFieldSelector::chooseMinNonZeroUVDistance(casacore::Double uvDis
                  ((sqrt(square(uExprNode) + square(vExprNode)) >= uvDist) || 
                  ((uExprNode == 0.) && (vExprNode == 0.) && (wExprNode == 0.)));
   }
+  std::ostringstream os;
+  os<<"MINNONZEROUV="<<std::setprecision(17)<<uvDist;
+  appendSelectionKey(os.str());
 }
 
 
@@ -172,6 +194,9 @@ void TableScalarFieldSelector::chooseMaxUVDistance(casacore::Double uvDist)
                  (nelements(uvwExprNode) > 2) && 
                  (sqrt(square(uExprNode) + square(vExprNode)) <= uvDist);
   }
+  std::ostringstream os;
+  os<<"MAXUV="<<std::setprecision(17)<<uvDist;
+  appendSelectionKey(os.str());
 }
 
 
@@ -186,6 +211,9 @@ void TableScalarFieldSelector::chooseScanNumber(casacore::uInt scanNumber)
         itsTableSelector = itsTableSelector && (table().col("SCAN_NUMBER") ==
                 static_cast<casacore::Int>(scanNumber));
     }
+    std::ostringstream os;
+    os<<"SCAN="<<scanNumber;
+    appendSelectionKey(os.str());
 }
 
 /// @brief Choose autocorrelations only
@@ -201,6 +229,7 @@ void TableScalarFieldSelector::chooseAutoCorrelations()
                                                table().col("ANTENNA2")) &&
                            (table().col("FEED1") == table().col("FEED2"));
    }
+   appendSelectionKey("AUTO");
 }
   
 /// @brief Choose crosscorrelations only
@@ -215,6 +244,7 @@ void TableScalarFieldSelector::chooseCrossCorrelations()
                                                table().col("ANTENNA2")) ||
                            (table().col("FEED1") != table().col("FEED2"))) ;
    }
+   appendSelectionKey("CROSS");
 }
 
 /// Choose a single spectral window (also known as IF).
@@ -244,6 +274,9 @@ void TableScalarFieldSelector::chooseSpectralWindow(casacore::uInt spWinID)
      // is thrown within the table selection.
      itsTableSelector=(table().col("DATA_DESC_ID") == -1) && False;
    }   
+   std::ostringstream os;
+   os<<"SPW="<<spWinID;
+   appendSelectionKey(os.str());
 }
  
 /// @brief Obtain a table expression node for selection. 
@@ -266,3 +299,20 @@ casacore::TableExprNode& TableScalarFieldSelector::rwTableSelector() const
   return itsTableSelector;
 }
 
+/// @brief obtain a description of the row selection
+/// @details This method returns a string which uniquely describes the rows selected
+/// by getTableSelector. Each choose method adds its criterion to this string.
+/// @return selection key
+std::string TableScalarFieldSelector::getSelectionKey(const
+            boost::shared_ptr<IDataConverterImpl const> &) const
+{
+  return itsSelectionKey;
+}
+
+/// @brief add a criterion to the selection key
+/// @param[in] criterion description of the criterion added to the table selection expression
+void TableScalarFieldSelector::appendSelectionKey(const std::string &criterion)
+{
+  itsSelectionKey += criterion + ";";
+}
+
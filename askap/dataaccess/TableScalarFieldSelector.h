@@ -140,6 +140,14 @@ public:
   /// @return a const reference to table expression node object
   virtual const casacore::TableExprNode& getTableSelector(const
                boost::shared_ptr<IDataConverterImpl const> &conv) const;
+
+  /// @brief obtain a description of the row selection
+  /// @details This method returns a string which uniquely describes the rows selected
+  /// by getTableSelector. Each choose method adds its criterion to this string.
+  /// @param[in] conv  a shared pointer to the converter (unused in this class)
+  /// @return selection key
+  virtual std::string getSelectionKey(const
+               boost::shared_ptr<IDataConverterImpl const> &conv) const;
       
 protected:
   /// @brief get read-write access to expression node
@@ -147,9 +155,16 @@ protected:
   ///
   casacore::TableExprNode& rwTableSelector() const;
 
+  /// @brief add a criterion to the selection key
+  /// @param[in] criterion description of the criterion added to the table selection expression
+  void appendSelectionKey(const std::string &criterion);
+
 private:
   /// a current table selection expression (cache)
   mutable casacore::TableExprNode  itsTableSelector;  
+
+  /// @brief description of all criteria added to itsTableSelector (see getSelectionKey)
+  std::string itsSelectionKey;
 };
   
 } // namespace accessors
@@ -0,0 +1,568 @@
+/// @file TableTimeIndex.cc
+/// @brief index of time stamps of the selected rows
+/// @details By default, TableConstDataIterator uses casacore::TableIterator to group
+/// rows with the same time stamp. Each step of the table iterator creates a reference
+/// table, which is a significant fixed cost per time stamp for large measurement sets.
+/// This class scans the TIME column once, in bulk, and stores the range of rows for each
+/// time stamp. The iterator can then serve chunks directly as row ranges of the selected
+/// table. The index can be reused across init() calls and shared between iterators.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#include <askap_accessors.h>
+
+// std includes
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// ASKAPsoft includes
+#include <askap/askap/AskapError.h>
+#include <askap/askap/AskapLogging.h>
+#include <casacore/tables/Tables/ScalarColumn.h>
+#include <casacore/tables/Tables/RowNumbers.h>
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
+#include <casacore/casa/OS/File.h>
+#include <casacore/casa/OS/Directory.h>
+#include <casacore/casa/OS/DirectoryIterator.h>
+#include <casacore/casa/OS/Path.h>
+
+// own includes
+#include <askap/dataaccess/TableTimeIndex.h>
+
+ASKAP_LOGGER(logger, ".casaAccessors");
+
+using namespace askap;
+using namespace askap::accessors;
+
+namespace {
+
+/// @brief magic string at the start of the index file
+const char theIndexFileMagic[8] = {'A','S','K','A','P','T','I','X'};
+
+/// @brief version of the file format
+const casacore::uInt theIndexFileVersion = 1;
+
+/// @brief marker to detect files written on a machine with different byte order
+const casacore::uInt theEndianMarker = 0x01020304;
+
+/// @brief names of integer columns stored in the persistent index
+const char* theRunColumns[] = {"DATA_DESC_ID", "FIELD_ID"};
+
+/// @brief append a value to the buffer
+/// @param[in] buf buffer
+/// @param[in] value value to append (in the native byte order)
+template<typename T>
+void appendValue(std::string &buf, const T &value)
+{
+  buf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/// @brief append a vector to the buffer
+/// @details The size is written first, followed by the elements
+/// @param[in] buf buffer
+/// @param[in] vec vector to append
+template<typename T>
+void appendVector(std::string &buf, const std::vector<T> &vec)
+{
+  appendValue(buf, casacore::uInt64(vec.size()));
+  if (vec.size() > 0) {
+      buf.append(reinterpret_cast<const char*>(&vec[0]), vec.size() * sizeof(T));
+  }
+}
+
+/// @brief append a string to the buffer
+/// @param[in] buf buffer
+/// @param[in] str string to append
+void appendString(std::string &buf, const std::string &str)
+{
+  appendValue(buf, casacore::uInt64(str.size()));
+  buf.append(str);
+}
+
+/// @brief helper class to extract values from the buffer with bounds checking
+struct BufferReader {
+  /// @brief set up the reader
+  /// @param[in] buf buffer to read from
+  explicit BufferReader(const std::string &buf) : itsBuf(buf), itsPos(0) {}
+
+  /// @brief read raw bytes
+  /// @param[in] dest destination
+  /// @param[in] size number of bytes to read
+  /// @return false if the buffer is too short
+  bool read(void *dest, size_t size) {
+     if (size > itsBuf.size() - itsPos) {
+         return false;
+     }
+     if (size > 0) {
+         std::memcpy(dest, itsBuf.data() + itsPos, size);
+     }
+     itsPos += size;
+     return true;
+  }
+
+  /// @brief read a value
+  /// @param[out] value value to read
+  /// @return false if the buffer is too short
+  template<typename T>
+  bool read(T &value) { return read(&value, sizeof(T)); }
+
+  /// @brief read a vector written by appendVector
+  /// @param[out] vec vector to read
+  /// @return false if the buffer is too short
+  template<typename T>
+  bool read(std::vector<T> &vec) {
+     casacore::uInt64 size = 0;
+     if (!read(size) || (size > (itsBuf.size() - itsPos) / sizeof(T))) {
+         return false;
+     }
+     vec.resize(size);
+     return size > 0 ? read(&vec[0], size * sizeof(T)) : true;
+  }
+
+  /// @brief read a string written by appendString
+  /// @param[out] str string to read
+  /// @return false if the buffer is too short
+  bool read(std::string &str) {
+     casacore::uInt64 size = 0;
+     if (!read(size) || (size > itsBuf.size() - itsPos)) {
+         return false;
+     }
+     str.assign(itsBuf, itsPos, size);
+     itsPos += size;
+     return true;
+  }
+
+  /// @brief check that the whole buffer has been read
+  /// @return true if there is nothing left
+  bool atEnd() const { return itsPos == itsBuf.size(); }
+
+private:
+  /// @brief buffer to read from
+  const std::string &itsBuf;
+  /// @brief current position
+  size_t itsPos;
+};
+
+/// @brief initial value of the 64-bit FNV-1a hash
+const casacore::uInt64 theHashSeed = 14695981039346656037ULL;
+
+/// @brief update the 64-bit FNV-1a hash with the given bytes
+/// @param[in] hash current value of the hash
+/// @param[in] data bytes to add
+/// @param[in] size number of bytes
+/// @return updated hash
+casacore::uInt64 updateHash(casacore::uInt64 hash, const void *data, size_t size)
+{
+  const unsigned char *bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i) {
+       hash ^= bytes[i];
+       hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+/// @brief checksum of the row numbers
+/// @param[in] rows row numbers
+/// @return checksum
+casacore::uInt64 rowChecksum(const casacore::Vector<casacore::rownr_t> &rows)
+{
+  casacore::uInt64 hash = theHashSeed;
+  for (casacore::Vector<casacore::rownr_t>::const_iterator ci = rows.begin(); ci != rows.end(); ++ci) {
+       const casacore::rownr_t row = *ci;
+       hash = updateHash(hash, &row, sizeof(row));
+  }
+  return hash;
+}
+
+/// @brief check that the vector is a valid list of boundaries
+/// @details Boundaries should start from zero, be strictly increasing and end at the given row
+/// @param[in] boundaries vector to check
+/// @param[in] nRow number of rows
+/// @return true if the boundaries are valid
+bool validBoundaries(const std::vector<casacore::rownr_t> &boundaries, casacore::rownr_t nRow)
+{
+  if (boundaries.empty() || (boundaries.back() != nRow)) {
+      return false;
+  }
+  if ((boundaries.size() > 1) && (boundaries.front() != 0)) {
+      return false;
+  }
+  for (size_t i = 1; i < boundaries.size(); ++i) {
+       if (boundaries[i] <= boundaries[i - 1]) {
+           return false;
+       }
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+/// @brief build the index
+/// @details The TIME column is read with a single call.
+/// @param[in] tab table with the selected rows
+/// @param[in] selectionKey description of the selection (see ITableDataSelectorImpl::getSelectionKey),
+/// it is used to check that the index matches the selection of another iterator
+TableTimeIndex::TableTimeIndex(const casacore::Table &tab, const std::string &selectionKey) :
+      itsSelectionKey(selectionKey), itsRowChecksum(rowChecksum(tab.rowNumbers())), itsMSRows(0),
+      itsLoadedFromFile(false)
+{
+  const casacore::rownr_t nRow = tab.nrow();
+  if (nRow > 0) {
+      casacore::ScalarColumn<casacore::Double> timeCol(tab, "TIME");
+      const casacore::Vector<casacore::Double> times = timeCol.getColumn();
+      ASKAPDEBUGASSERT(times.nelements() == nRow);
+      itsBoundaries.push_back(0);
+      itsTimes.push_back(times[0]);
+      for (casacore::rownr_t row = 1; row < nRow; ++row) {
+           if (times[row] != times[row - 1]) {
+               itsBoundaries.push_back(row);
+               itsTimes.push_back(times[row]);
+           }
+      }
+  }
+  itsBoundaries.push_back(nRow);
+}
+
+/// @brief first row of the given time step
+/// @param[in] step time step (0-based)
+/// @return the first row of the time step
+casacore::rownr_t TableTimeIndex::startRow(casacore::uInt step) const
+{
+  ASKAPDEBUGASSERT(step < itsTimes.size());
+  return itsBoundaries[step];
+}
+
+/// @brief end of the given time step
+/// @param[in] step time step (0-based)
+/// @return the first row after the time step
+casacore::rownr_t TableTimeIndex::endRow(casacore::uInt step) const
+{
+  ASKAPDEBUGASSERT(step < itsTimes.size());
+  return itsBoundaries[step + 1];
+}
+
+/// @brief time stamp of the given time step
+/// @param[in] step time step (0-based)
+/// @return value of the TIME column (in the units of the table)
+casacore::Double TableTimeIndex::time(casacore::uInt step) const
+{
+  ASKAPCHECK(step < itsTimes.size(), "Time step "<<step<<" doesn't exist, there are only "<<
+             itsTimes.size()<<" time step(s)");
+  return itsTimes[step];
+}
+
+/// @brief check that the index is consistent with the given table
+/// @details The number of rows, a checksum of the row numbers (in the root table) and
+/// the time stamps of the first and the last step are compared, so an index built for a
+/// different selection with the same number of rows is detected without reading the whole
+/// TIME column. The selection key is compared as well, unless the index is persistent
+/// (the key of a persistent index already includes the selection).
+/// @param[in] tab table to check
+/// @param[in] selectionKey description of the selection (see ITableDataSelectorImpl::getSelectionKey)
+/// @return true if the index can be used with the given table
+bool TableTimeIndex::matches(const casacore::Table &tab, const std::string &selectionKey) const
+{
+  if (tab.nrow() != nRows()) {
+      return false;
+  }
+  if (itsKey.empty() && (selectionKey != itsSelectionKey)) {
+      return false;
+  }
+  if (rowChecksum(tab.rowNumbers()) != itsRowChecksum) {
+      return false;
+  }
+  if (nRows() == 0) {
+      return true;
+  }
+  casacore::ScalarColumn<casacore::Double> timeCol(tab, "TIME");
+  return (timeCol(0) == itsTimes.front()) && (timeCol(nRows() - 1) == itsTimes.back());
+}
+
+/// @brief build a persistent index
+/// @details In addition to the time steps, the row numbers of the selected rows in the
+/// measurement set and the runs of DATA_DESC_ID and FIELD_ID are stored.
+/// @param[in] tab table with the selected rows
+/// @param[in] ms measurement set the selection has been applied to
+/// @param[in] key key describing the measurement set and the selection (see makeKey)
+TableTimeIndex::TableTimeIndex(const casacore::Table &tab, const casacore::Table &ms,
+                               const std::string &key) : TableTimeIndex(tab)
+{
+  ASKAPCHECK(!key.empty(), "Persistent time index requires a non-empty key");
+  itsKey = key;
+  itsMSRows = ms.nrow();
+  if (tab.nrow() != itsMSRows) {
+      const casacore::Vector<casacore::rownr_t> rows = tab.rowNumbers(ms);
+      itsRowNumbers.assign(rows.begin(), rows.end());
+  }
+  for (size_t col = 0; col < sizeof(theRunColumns) / sizeof(theRunColumns[0]); ++col) {
+       const std::string name(theRunColumns[col]);
+       if (tab.actualTableDesc().isColumn(name)) {
+           casacore::ScalarColumn<casacore::Int> intCol(tab, name);
+           TableColumnHandles::buildColumnRuns(intCol.getColumn(), itsColumnRuns[name]);
+       }
+  }
+}
+
+/// @brief empty index, used when the index is loaded from a file
+TableTimeIndex::TableTimeIndex() : itsRowChecksum(rowChecksum(casacore::Vector<casacore::rownr_t>())),
+      itsMSRows(0), itsLoadedFromFile(false) {}
+
+/// @brief load the index from a file
+/// @details The file is read with a single call and validated. Nothing is thrown if the file
+/// doesn't exist, is corrupted or has been written for a different key.
+/// @param[in] fileName name of the file
+/// @param[in] key expected key (see makeKey)
+/// @return shared pointer to the index (empty if the file can't be used)
+boost::shared_ptr<TableTimeIndex const> TableTimeIndex::load(const std::string &fileName,
+                                                             const std::string &key)
+{
+  std::ifstream is(fileName.c_str(), std::ios::in | std::ios::binary);
+  if (!is) {
+      return boost::shared_ptr<TableTimeIndex const>();
+  }
+  is.seekg(0, std::ios::end);
+  const std::streamoff size = is.tellg();
+  is.seekg(0, std::ios::beg);
+  std::string buf(size > 0 ? size_t(size) : 0, '\0');
+  if ((size <= 0) || !is.read(&buf[0], size)) {
+      ASKAPLOG_WARN_STR(logger, "Unable to read time index file "<<fileName<<", it will be rebuilt");
+      return boost::shared_ptr<TableTimeIndex const>();
+  }
+  boost::shared_ptr<TableTimeIndex> index(new TableTimeIndex);
+  if (!index->parse(buf, key)) {
+      ASKAPLOG_WARN_STR(logger, "Time index file "<<fileName<<
+                        " is invalid or outdated, it will be rebuilt");
+      return boost::shared_ptr<TableTimeIndex const>();
+  }
+  index->itsLoadedFromFile = true;
+  ASKAPLOG_INFO_STR(logger, "Loaded time index with "<<index->nSteps()<<" time steps from "<<fileName);
+  return index;
+}
+
+/// @brief parse the content of the index file
+/// @param[in] buf content of the file
+/// @param[in] key expected key
+/// @return true if successful, false if the content is not valid or the key doesn't match
+bool TableTimeIndex::parse(const std::string &buf, const std::string &key)
+{
+  BufferReader reader(buf);
+  char magic[sizeof(theIndexFileMagic)];
+  casacore::uInt version = 0, marker = 0, rowSize = 0;
+  if (!reader.read(magic, sizeof(magic)) || std::memcmp(magic, theIndexFileMagic, sizeof(magic)) ||
+      !reader.read(version) || (version != theIndexFileVersion) ||
+      !reader.read(marker) || (marker != theEndianMarker) ||
+      !reader.read(rowSize) || (rowSize != sizeof(casacore::rownr_t))) {
+      return false;
+  }
+  if (!reader.read(itsKey) || (itsKey != key) || !reader.read(itsMSRows) ||
+      !reader.read(itsBoundaries) || !reader.read(itsTimes) || !reader.read(itsRowNumbers)) {
+      return false;
+  }
+  if (itsBoundaries.empty() || (itsBoundaries.size() != itsTimes.size() + 1) ||
+      !validBoundaries(itsBoundaries, itsBoundaries.back())) {
+      return false;
+  }
+  // row numbers are not stored if all rows are selected (or none)
+  if (itsRowNumbers.empty() ? ((nRows() != 0) && (nRows() != itsMSRows)) :
+                              (itsRowNumbers.size() != nRows())) {
+      return false;
+  }
+  for (std::vector<casacore::rownr_t>::const_iterator ci = itsRowNumbers.begin();
+       ci != itsRowNumbers.end(); ++ci) {
+       if (*ci >= itsMSRows) {
+           return false;
+       }
+  }
+  casacore::uInt nColumns = 0;
+  if (!reader.read(nColumns)) {
+      return false;
+  }
+  for (casacore::uInt col = 0; col < nColumns; ++col) {
+       std::string name;
+       TableColumnHandles::ColumnRuns runs;
+       if (!reader.read(name) || !reader.read(runs.itsStartRows) || !reader.read(runs.itsValues)) {
+           return false;
+       }
+       if ((runs.itsStartRows.size() != runs.itsValues.size() + 1) ||
+           !validBoundaries(runs.itsStartRows, nRows())) {
+           return false;
+       }
+       itsColumnRuns[name] = runs;
+  }
+  // row numbers are only stored if a subset of rows is selected
+  if (itsRowNumbers.empty()) {
+      casacore::Vector<casacore::rownr_t> rows(nRows());
+      indgen(rows);
+      itsRowChecksum = rowChecksum(rows);
+  } else {
+      itsRowChecksum = rowChecksum(casacore::Vector<casacore::rownr_t>(itsRowNumbers));
+  }
+  return reader.atEnd() && !itsKey.empty();
+}
+
+/// @brief store the index in a file
+/// @details The file is written under a temporary name and then renamed, so other
+/// processes never see a partially written file. Errors are reported in the log only,
+/// as the index is just an optimisation.
+/// @param[in] fileName name of the file
+/// @return true if the index has been written successfully
+bool TableTimeIndex::save(const std::string &fileName) const
+{
+  ASKAPCHECK(!itsKey.empty(), "Only a persistent time index can be stored in a file");
+  std::string buf;
+  buf.append(theIndexFileMagic, sizeof(theIndexFileMagic));
+  appendValue(buf, theIndexFileVersion);
+  appendValue(buf, theEndianMarker);
+  appendValue(buf, casacore::uInt(sizeof(casacore::rownr_t)));
+  appendString(buf, itsKey);
+  appendValue(buf, itsMSRows);
+  appendVector(buf, itsBoundaries);
+  appendVector(buf, itsTimes);
+  appendVector(buf, itsRowNumbers);
+  appendValue(buf, casacore::uInt(itsColumnRuns.size()));
+  for (std::map<std::string, TableColumnHandles::ColumnRuns>::const_iterator ci = itsColumnRuns.begin();
+       ci != itsColumnRuns.end(); ++ci) {
+       appendString(buf, ci->first);
+       appendVector(buf, ci->second.itsStartRows);
+       appendVector(buf, ci->second.itsValues);
+  }
+
+  std::ostringstream tmpName;
+  tmpName<<fileName<<".tmp"<<getpid();
+  {
+    std::ofstream os(tmpName.str().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (os) {
+        os.write(buf.data(), buf.size());
+    }
+    if (!os) {
+        ASKAPLOG_WARN_STR(logger, "Unable to write time index file "<<tmpName.str());
+        std::remove(tmpName.str().c_str());
+        return false;
+    }
+  }
+  if (std::rename(tmpName.str().c_str(), fileName.c_str()) != 0) {
+      ASKAPLOG_WARN_STR(logger, "Unable to rename "<<tmpName.str()<<" to "<<fileName);
+      std::remove(tmpName.str().c_str());
+      return false;
+  }
+  ASKAPLOG_INFO_STR(logger, "Time index with "<<nSteps()<<" time steps has been written to "<<fileName);
+  return true;
+}
+
+/// @brief make a key describing the measurement set and the selection
+/// @details The key includes the name and the number of rows of the measurement set and a
+/// checksum of the names, sizes and modification times (with sub-second resolution, where
+/// available) of all files of the main table, i.e. the table description and the column
+/// files (the lock file is excluded). Any change to the main table, even within the same second, gives a different key.
+/// @param[in] ms measurement set
+/// @param[in] selectionKey description of the selection (see ITableDataSelectorImpl::getSelectionKey)
+/// @return key string
+std::string TableTimeIndex::makeKey(const casacore::Table &ms, const std::string &selectionKey)
+{
+  // the directory is not read in any particular order, sort files by name
+  std::map<std::string, std::string> fileStats;
+  const casacore::File tableDir(ms.tableName());
+  if (tableDir.isDirectory()) {
+      for (casacore::DirectoryIterator it((casacore::Directory(tableDir))); !it.pastEnd(); ++it) {
+           struct stat st;
+           // subtables are in subdirectories, they don't affect the index. The lock file is
+           // updated whenever the table is opened, the data don't change
+           if (!it.file().isRegular() || (it.name() == "table.lock") ||
+               (::stat(it.file().path().absoluteName().c_str(), &st) != 0)) {
+               continue;
+           }
+           #ifdef __APPLE__
+           const long nsec = st.st_mtimespec.tv_nsec;
+           #else
+           const long nsec = st.st_mtim.tv_nsec;
+           #endif
+           std::ostringstream os;
+           os<<st.st_size<<":"<<st.st_mtime<<"."<<std::setw(9)<<std::setfill('0')<<nsec;
+           fileStats[it.name()] = os.str();
+      }
+  }
+  casacore::uInt64 hash = theHashSeed;
+  for (std::map<std::string, std::string>::const_iterator ci = fileStats.begin();
+       ci != fileStats.end(); ++ci) {
+       const std::string entry = ci->first + "=" + ci->second + ";";
+       hash = updateHash(hash, entry.data(), entry.size());
+  }
+  std::ostringstream os;
+  os<<ms.tableName()<<";"<<ms.nrow()<<";"<<fileStats.size()<<":"<<std::hex<<std::setw(16)<<
+      std::setfill('0')<<hash<<std::dec<<";"<<selectionKey;
+  return os.str();
+}
+
+/// @brief make a name of the index file
+/// @details The name is composed of the base name of the measurement set and a hash of the key,
+/// so indices for different selections can coexist in the same directory.
+/// @param[in] dir directory to store index files in
+/// @param[in] ms measurement set
+/// @param[in] key key describing the measurement set and the selection (see makeKey)
+/// @return file name
+std::string TableTimeIndex::fileName(const std::string &dir, const casacore::Table &ms,
+                                     const std::string &key)
+{
+  // 64-bit FNV-1a hash of the key
+  const casacore::uInt64 hash = updateHash(theHashSeed, key.data(), key.size());
+  std::ostringstream os;
+  os<<dir<<"/"<<casacore::Path(ms.tableName()).baseName()<<"."<<std::hex<<std::setw(16)<<
+      std::setfill('0')<<hash<<".idx";
+  return os.str();
+}
+
+/// @brief obtain the selected rows
+/// @details This method only works for a persistent index.
+/// @param[in] ms measurement set the index has been built for
+/// @return table with the selected rows
+casacore::Table TableTimeIndex::selectRows(const casacore::Table &ms) const
+{
+  ASKAPCHECK(!itsKey.empty(), "Selected rows are only known for a persistent time index");
+  ASKAPCHECK(ms.nrow() == itsMSRows, "Time index has been built for a table with "<<itsMSRows<<
+             " rows, the table given has "<<ms.nrow()<<" rows");
+  if (itsRowNumbers.empty() && (nRows() == itsMSRows)) {
+      return ms;
+  }
+  return ms(casacore::RowNumbers(casacore::Vector<casacore::rownr_t>(itsRowNumbers)));
+}
+
+/// @brief pass runs of integer columns to the column handles
+/// @details This method does nothing if the index is not persistent. The handles should be
+/// attached to the table with the selected rows.
+/// @param[in] columns column handles to set the runs for
+void TableTimeIndex::setColumnRuns(TableColumnHandles &columns) const
+{
+  for (std::map<std::string, TableColumnHandles::ColumnRuns>::const_iterator ci = itsColumnRuns.begin();
+       ci != itsColumnRuns.end(); ++ci) {
+       columns.setColumnRuns(ci->first, ci->second);
+  }
+}
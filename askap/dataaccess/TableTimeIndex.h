@@ -0,0 +1,227 @@
+/// @file TableTimeIndex.h
+/// @brief index of time stamps of the selected rows
+/// @details By default, TableConstDataIterator uses casacore::TableIterator to group
+/// rows with the same time stamp. Each step of the table iterator creates a reference
+/// table, which is a significant fixed cost per time stamp for large measurement sets.
+/// This class scans the TIME column once, in bulk, and stores the range of rows for each
+/// time stamp. The iterator can then serve chunks directly as row ranges of the selected
+/// table. The index can be reused across init() calls and shared between iterators.
+/// It can also be stored in a file next to the data to avoid the selection and the scan
+/// when the same measurement set is processed again with the same selection.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#ifndef ASKAP_ACCESSORS_TABLE_TIME_INDEX_H
+#define ASKAP_ACCESSORS_TABLE_TIME_INDEX_H
+
+// std includes
+#include <vector>
+#include <string>
+#include <map>
+
+// boost includes
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+// casa includes
+#include <casacore/casa/aips.h>
+#include <casacore/tables/Tables/Table.h>
+
+// own includes
+#include <askap/dataaccess/TableColumnHandles.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief index of time stamps of the selected rows
+/// @details Rows are grouped in the same way as casacore::TableIterator over TIME does
+/// without sorting, i.e. each step is a run of consecutive rows with exactly the same
+/// time stamp. The index is immutable after construction, so it can be shared between
+/// iterators used in different threads.
+/// A persistent index (built with a key) also stores the row numbers of the selected rows in
+/// the measurement set and the runs of DATA_DESC_ID and FIELD_ID, so the selection
+/// expression doesn't need to be evaluated and these columns don't need to be read when the
+/// index is loaded from a file. The key describes the measurement set (name, number of rows
+/// and a checksum of the sizes and modification times of the files of the main table) and
+/// the selection, a file with a different key is ignored.
+/// @ingroup dataaccess_tab
+class TableTimeIndex : private boost::noncopyable {
+public:
+  /// @brief build the index
+  /// @details The TIME column is read with a single call.
+  /// @param[in] tab table with the selected rows
+  /// @param[in] selectionKey description of the selection (see ITableDataSelectorImpl::getSelectionKey),
+  /// it is used to check that the index matches the selection of another iterator
+  explicit TableTimeIndex(const casacore::Table &tab, const std::string &selectionKey = std::string());
+
+  /// @brief build a persistent index
+  /// @details In addition to the time steps, the row numbers of the selected rows in the
+  /// measurement set and the runs of DATA_DESC_ID and FIELD_ID are stored.
+  /// @param[in] tab table with the selected rows
+  /// @param[in] ms measurement set the selection has been applied to
+  /// @param[in] key key describing the measurement set and the selection (see makeKey)
+  TableTimeIndex(const casacore::Table &tab, const casacore::Table &ms, const std::string &key);
+
+  /// @brief load the index from a file
+  /// @details The file is read with a single call and validated. Nothing is thrown if the file
+  /// doesn't exist, is corrupted or has been written for a different key.
+  /// @param[in] fileName name of the file
+  /// @param[in] key expected key (see makeKey)
+  /// @return shared pointer to the index (empty if the file can't be used)
+  static boost::shared_ptr<TableTimeIndex const> load(const std::string &fileName,
+                                                      const std::string &key);
+
+  /// @brief store the index in a file
+  /// @details The file is written under a temporary name and then renamed, so other
+  /// processes never see a partially written file. Errors are reported in the log only,
+  /// as the index is just an optimisation.
+  /// @param[in] fileName name of the file
+  /// @return true if the index has been written successfully
+  bool save(const std::string &fileName) const;
+
+  /// @brief make a key describing the measurement set and the selection
+  /// @details The key includes the name and the number of rows of the measurement set and a
+  /// checksum of the names, sizes and modification times (with sub-second resolution, where
+  /// available) of all files of the main table, i.e. the table description and the column
+  /// files (the lock file is excluded).
+  /// @param[in] ms measurement set
+  /// @param[in] selectionKey description of the selection (see ITableDataSelectorImpl::getSelectionKey)
+  /// @return key string
+  static std::string makeKey(const casacore::Table &ms, const std::string &selectionKey);
+
+  /// @brief make a name of the index file
+  /// @details The name is composed of the base name of the measurement set and a hash of the key,
+  /// so indices for different selections can coexist in the same directory.
+  /// @param[in] dir directory to store index files in
+  /// @param[in] ms measurement set
+  /// @param[in] key key describing the measurement set and the selection (see makeKey)
+  /// @return file name
+  static std::string fileName(const std::string &dir, const casacore::Table &ms,
+                              const std::string &key);
+
+  /// @brief key of the persistent index
+  /// @return key given at construction (empty string if the index is not persistent)
+  inline const std::string& key() const { return itsKey; }
+
+  /// @brief check whether the index has been loaded from a file
+  /// @return true if the index has been obtained with load, false if it has been built
+  inline bool loadedFromFile() const { return itsLoadedFromFile; }
+
+  /// @brief obtain the selected rows
+  /// @details This method only works for a persistent index.
+  /// @param[in] ms measurement set the index has been built for
+  /// @return table with the selected rows
+  casacore::Table selectRows(const casacore::Table &ms) const;
+
+  /// @brief pass runs of integer columns to the column handles
+  /// @details This method does nothing if the index is not persistent. The handles should be
+  /// attached to the table with the selected rows.
+  /// @param[in] columns column handles to set the runs for
+  void setColumnRuns(TableColumnHandles &columns) const;
+
+  /// @brief number of time steps
+  /// @return number of distinct runs of time stamps
+  inline casacore::uInt nSteps() const { return casacore::uInt(itsTimes.size()); }
+
+  /// @brief total number of rows covered by the index
+  /// @return number of rows in the table the index has been built for
+  inline casacore::rownr_t nRows() const { return itsBoundaries.back(); }
+
+  /// @brief first row of the given time step
+  /// @param[in] step time step (0-based)
+  /// @return the first row of the time step
+  casacore::rownr_t startRow(casacore::uInt step) const;
+
+  /// @brief end of the given time step
+  /// @param[in] step time step (0-based)
+  /// @return the first row after the time step
+  casacore::rownr_t endRow(casacore::uInt step) const;
+
+  /// @brief time stamp of the given time step
+  /// @param[in] step time step (0-based)
+  /// @return value of the TIME column (in the units of the table)
+  casacore::Double time(casacore::uInt step) const;
+
+  /// @brief check that the index is consistent with the given table
+  /// @details The number of rows, a checksum of the row numbers (in the root table) and
+  /// the time stamps of the first and the last step are compared, so an index built for a
+  /// different selection with the same number of rows is detected without reading the whole
+  /// TIME column. The selection key is compared as well, unless the index is persistent
+  /// (the key of a persistent index already includes the selection).
+  /// @param[in] tab table to check
+  /// @param[in] selectionKey description of the selection (see ITableDataSelectorImpl::getSelectionKey)
+  /// @return true if the index can be used with the given table
+  bool matches(const casacore::Table &tab, const std::string &selectionKey) const;
+
+protected:
+  /// @brief empty index, used when the index is loaded from a file
+  TableTimeIndex();
+
+  /// @brief parse the content of the index file
+  /// @param[in] buf content of the file
+  /// @param[in] key expected key
+  /// @return true if successful, false if the content is not valid or the key doesn't match
+  bool parse(const std::string &buf, const std::string &key);
+
+private:
+  /// @brief boundaries of time steps
+  /// @details Element i is the first row of step i, the last element is the
+  /// total number of rows (i.e. the size of this vector is the number of steps + 1)
+  std::vector<casacore::rownr_t> itsBoundaries;
+
+  /// @brief time stamp of each step
+  std::vector<casacore::Double> itsTimes;
+
+  /// @brief key of the persistent index (empty string if the index is not persistent)
+  std::string itsKey;
+
+  /// @brief description of the selection the index has been built for
+  /// @details It is only used for an index which is not persistent
+  std::string itsSelectionKey;
+
+  /// @brief checksum of the row numbers (in the root table) of the rows covered by the index
+  casacore::uInt64 itsRowChecksum;
+
+  /// @brief number of rows in the measurement set
+  casacore::rownr_t itsMSRows;
+
+  /// @brief row numbers of the selected rows in the measurement set
+  /// @details Empty if all rows are selected (or the index is not persistent)
+  std::vector<casacore::rownr_t> itsRowNumbers;
+
+  /// @brief runs of integer columns indexed by column name (empty if the index is not persistent)
+  std::map<std::string, TableColumnHandles::ColumnRuns> itsColumnRuns;
+
+  /// @brief true if the index has been loaded from a file
+  bool itsLoadedFromFile;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_TABLE_TIME_INDEX_H
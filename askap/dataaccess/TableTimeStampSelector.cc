@@ -40,6 +40,10 @@
 #include <casacore/measures/Measures/MCEpoch.h>
 #include <casacore/measures/Measures/MeasConvert.h>
 
+// std includes
+#include <sstream>
+#include <iomanip>
+
 // own includes
 #include <askap/dataaccess/TableTimeStampSelector.h>
 #include <askap/dataaccess/DataAccessError.h>
@@ -77,3 +81,16 @@ void TableTimeStampSelector::updateTableExpression(casacore::TableExprNode &tex)
          "TableTimeStampSelector::updateTableExpression: "<<ex.what());
   }
 }
+
+/// @brief obtain a description of the selection
+/// @details The key contains the start and stop times in the table frame
+/// (the converter should be set prior to the call to this method).
+/// @return a string which uniquely describes the selection
+std::string TableTimeStampSelector::selectionKey() const
+{
+  const std::pair<casacore::MEpoch, casacore::MEpoch> startAndStop = getStartAndStop();
+  std::ostringstream os;
+  os<<"TIME="<<std::setprecision(17)<<tableTime(startAndStop.first)<<"-"<<
+      tableTime(startAndStop.second)<<";";
+  return os.str();
+}
@@ -72,6 +72,12 @@ public:
    /// @param tex a reference to table expression to use
    virtual void updateTableExpression(casacore::TableExprNode &tex) const;
 
+   /// @brief obtain a description of the selection
+   /// @details The key contains the start and stop times in the table frame
+   /// (the converter should be set prior to the call to this method).
+   /// @return a string which uniquely describes the selection
+   virtual std::string selectionKey() const;
+
 protected:
   
    /// @brief This method has to be overriden in derived classes.
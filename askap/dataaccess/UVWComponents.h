@@ -0,0 +1,150 @@
+/// @file UVWComponents.h
+/// @brief uvw coordinates stored as separate arrays of u, v and w
+/// @details The accessor returns uvw coordinates as a vector of 3-element rigid vectors,
+/// i.e. u, v and w of the same row are adjacent in memory. Vectorised gridding code
+/// processes many rows at once and is better served by three contiguous arrays, one per
+/// component (structure of arrays). This class holds such arrays, optionally in single
+/// precision, and converts from the representations used elsewhere in the accessor code.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#ifndef ASKAP_ACCESSORS_UVW_COMPONENTS_H
+#define ASKAP_ACCESSORS_UVW_COMPONENTS_H
+
+// casa includes
+#include <casacore/casa/aips.h>
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/scimath/Mathematics/RigidVector.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief uvw coordinates stored as separate arrays of u, v and w
+/// @details Each component is stored in its own contiguous vector with one element per
+/// accessor row. The template parameter defines the precision, casacore::Double and
+/// casacore::Float are expected. Unlike casacore arrays, copies of this class are
+/// always deep (the arrays are not shared between objects).
+/// @ingroup dataaccess
+template<typename T>
+class UVWComponents {
+public:
+  /// @brief construct an empty object
+  UVWComponents();
+
+  /// @brief construct the object for the given number of rows
+  /// @details The coordinates are not initialised
+  /// @param[in] nRow number of rows
+  explicit UVWComponents(casacore::uInt nRow);
+
+  /// @brief copy constructor
+  /// @details We need it because copies of casacore arrays share the storage
+  /// @param[in] other another instance to copy from
+  UVWComponents(const UVWComponents<T> &other);
+
+  /// @brief assignment operator
+  /// @details We need it because copies of casacore arrays share the storage
+  /// @param[in] other another instance to copy from
+  UVWComponents<T>& operator=(const UVWComponents<T> &other);
+
+  /// @brief change the number of rows
+  /// @details The coordinates are not initialised
+  /// @param[in] nRow new number of rows
+  void resize(casacore::uInt nRow);
+
+  /// @return number of rows
+  inline casacore::uInt nelements() const { return itsU.nelements(); }
+
+  /// @return contiguous vector of u coordinates (one per row)
+  inline const casacore::Vector<T>& u() const { return itsU; }
+
+  /// @return contiguous vector of v coordinates (one per row)
+  inline const casacore::Vector<T>& v() const { return itsV; }
+
+  /// @return contiguous vector of w coordinates (one per row)
+  inline const casacore::Vector<T>& w() const { return itsW; }
+
+  /// @brief direct access to the storage of u coordinates
+  /// @details This is intended for bulk operations filling all rows in one pass.
+  /// @return pointer to the first element of the contiguous vector of u coordinates
+  inline T* uData() { return itsU.data(); }
+
+  /// @brief direct access to the storage of v coordinates
+  /// @return pointer to the first element of the contiguous vector of v coordinates
+  inline T* vData() { return itsV.data(); }
+
+  /// @brief direct access to the storage of w coordinates
+  /// @return pointer to the first element of the contiguous vector of w coordinates
+  inline T* wData() { return itsW.data(); }
+
+  /// @brief set coordinates of a single row
+  /// @param[in] row row to set
+  /// @param[in] u u-coordinate
+  /// @param[in] v v-coordinate
+  /// @param[in] w w-coordinate
+  inline void set(casacore::uInt row, casacore::Double u, casacore::Double v, casacore::Double w)
+     { itsU[row] = T(u); itsV[row] = T(v); itsW[row] = T(w); }
+
+  /// @brief set coordinates from the vector of rigid vectors
+  /// @details The object is resized to match the input.
+  /// @param[in] uvw vector of uvw's as returned by IConstDataAccessor::uvw()
+  void assign(const casacore::Vector<casacore::RigidVector<casacore::Double, 3> > &uvw);
+
+  /// @brief set coordinates from the buffer in the measurement set order
+  /// @details The UVW column read for a number of rows has the shape 3 x nRow.
+  /// The object is resized to match the input.
+  /// @param[in] uvw 3 x nRow matrix with the coordinates
+  void assignNative(const casacore::Matrix<casacore::Double> &uvw);
+
+  /// @brief set coordinates from an object of a different precision
+  /// @details The object is resized to match the input.
+  /// @param[in] other another instance to convert from
+  template<typename From>
+  void assignFrom(const UVWComponents<From> &other);
+
+  /// @brief convert coordinates into the vector of rigid vectors
+  /// @param[out] uvw vector to fill (resized to the number of rows)
+  void toRigidVectors(casacore::Vector<casacore::RigidVector<casacore::Double, 3> > &uvw) const;
+
+private:
+  /// @brief u coordinates
+  casacore::Vector<T> itsU;
+
+  /// @brief v coordinates
+  casacore::Vector<T> itsV;
+
+  /// @brief w coordinates
+  casacore::Vector<T> itsW;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#include <askap/dataaccess/UVWComponents.tcc>
+
+#endif // #ifndef ASKAP_ACCESSORS_UVW_COMPONENTS_H
@@ -0,0 +1,167 @@
+/// @file UVWComponents.tcc
+/// @brief uvw coordinates stored as separate arrays of u, v and w
+/// @details The accessor returns uvw coordinates as a vector of 3-element rigid vectors,
+/// i.e. u, v and w of the same row are adjacent in memory. Vectorised gridding code
+/// processes many rows at once and is better served by three contiguous arrays, one per
+/// component (structure of arrays). This file contains the implementation of the
+/// template class holding such arrays.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#ifndef ASKAP_ACCESSORS_UVW_COMPONENTS_TCC
+#define ASKAP_ACCESSORS_UVW_COMPONENTS_TCC
+
+// own includes
+#include <askap/askap/AskapError.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief construct an empty object
+template<typename T>
+UVWComponents<T>::UVWComponents() {}
+
+/// @brief construct the object for the given number of rows
+/// @details The coordinates are not initialised
+/// @param[in] nRow number of rows
+template<typename T>
+UVWComponents<T>::UVWComponents(casacore::uInt nRow) : itsU(nRow), itsV(nRow), itsW(nRow) {}
+
+/// @brief copy constructor
+/// @details We need it because copies of casacore arrays share the storage
+/// @param[in] other another instance to copy from
+template<typename T>
+UVWComponents<T>::UVWComponents(const UVWComponents<T> &other) : itsU(other.itsU.copy()),
+         itsV(other.itsV.copy()), itsW(other.itsW.copy()) {}
+
+/// @brief assignment operator
+/// @details We need it because copies of casacore arrays share the storage
+/// @param[in] other another instance to copy from
+template<typename T>
+UVWComponents<T>& UVWComponents<T>::operator=(const UVWComponents<T> &other)
+{
+  if (&other != this) {
+      itsU.assign(other.itsU.copy());
+      itsV.assign(other.itsV.copy());
+      itsW.assign(other.itsW.copy());
+  }
+  return *this;
+}
+
+/// @brief change the number of rows
+/// @details The coordinates are not initialised
+/// @param[in] nRow new number of rows
+template<typename T>
+void UVWComponents<T>::resize(casacore::uInt nRow)
+{
+  if (nRow != nelements()) {
+      itsU.resize(nRow);
+      itsV.resize(nRow);
+      itsW.resize(nRow);
+  }
+}
+
+/// @brief set coordinates from the vector of rigid vectors
+/// @details The object is resized to match the input.
+/// @param[in] uvw vector of uvw's as returned by IConstDataAccessor::uvw()
+template<typename T>
+void UVWComponents<T>::assign(const casacore::Vector<casacore::RigidVector<casacore::Double, 3> > &uvw)
+{
+  const casacore::uInt nRow = uvw.nelements();
+  resize(nRow);
+  for (casacore::uInt row = 0; row < nRow; ++row) {
+       const casacore::RigidVector<casacore::Double, 3> &rowUVW = uvw[row];
+       set(row, rowUVW(0), rowUVW(1), rowUVW(2));
+  }
+}
+
+/// @brief set coordinates from the buffer in the measurement set order
+/// @details The UVW column read for a number of rows has the shape 3 x nRow.
+/// The object is resized to match the input.
+/// @param[in] uvw 3 x nRow matrix with the coordinates
+template<typename T>
+void UVWComponents<T>::assignNative(const casacore::Matrix<casacore::Double> &uvw)
+{
+  ASKAPCHECK(uvw.nrow() == 3, "Expect 3 x nRow matrix with uvw's, you have shape "<<uvw.shape());
+  const casacore::uInt nRow = uvw.ncolumn();
+  resize(nRow);
+  if (nRow == 0) {
+      return;
+  }
+  bool deleteIn, deleteU, deleteV, deleteW;
+  const casacore::Double *src = uvw.getStorage(deleteIn);
+  T *dstU = itsU.getStorage(deleteU);
+  T *dstV = itsV.getStorage(deleteV);
+  T *dstW = itsW.getStorage(deleteW);
+  // de-interleave in one pass over the input
+  for (casacore::uInt row = 0; row < nRow; ++row) {
+       const casacore::Double *rowUVW = src + 3 * size_t(row);
+       dstU[row] = T(rowUVW[0]);
+       dstV[row] = T(rowUVW[1]);
+       dstW[row] = T(rowUVW[2]);
+  }
+  uvw.freeStorage(src, deleteIn);
+  itsU.putStorage(dstU, deleteU);
+  itsV.putStorage(dstV, deleteV);
+  itsW.putStorage(dstW, deleteW);
+}
+
+/// @brief set coordinates from an object of a different precision
+/// @details The object is resized to match the input.
+/// @param[in] other another instance to convert from
+template<typename T> template<typename From>
+void UVWComponents<T>::assignFrom(const UVWComponents<From> &other)
+{
+  const casacore::uInt nRow = other.nelements();
+  resize(nRow);
+  for (casacore::uInt row = 0; row < nRow; ++row) {
+       itsU[row] = T(other.u()[row]);
+       itsV[row] = T(other.v()[row]);
+       itsW[row] = T(other.w()[row]);
+  }
+}
+
+/// @brief convert coordinates into the vector of rigid vectors
+/// @param[out] uvw vector to fill (resized to the number of rows)
+template<typename T>
+void UVWComponents<T>::toRigidVectors(casacore::Vector<casacore::RigidVector<casacore::Double, 3> > &uvw) const
+{
+  const casacore::uInt nRow = nelements();
+  uvw.resize(nRow);
+  for (casacore::uInt row = 0; row < nRow; ++row) {
+       casacore::RigidVector<casacore::Double, 3> &rowUVW = uvw[row];
+       rowUVW(0) = itsU[row];
+       rowUVW(1) = itsV[row];
+       rowUVW(2) = itsW[row];
+  }
+}
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_UVW_COMPONENTS_TCC
@@ -32,6 +32,15 @@
 #include <askap/dataaccess/UVWMachineCache.h>
 #include <askap/askap/AskapError.h>
 
+// std includes
+#include <cmath>
+
+// boost includes
+#include <boost/functional/hash.hpp>
+
+// casa includes
+#include <casacore/casa/BasicSL/Constants.h>
+
 // for logging
 #include <askap_accessors.h>
 #include <askap/askap/AskapLogging.h>
@@ -47,22 +56,23 @@ using namespace askap::accessors;
 /// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads 
 /// to initialisation of a new UVW Machine
 UVWMachineCache::UVWMachineCache(size_t cacheSize, double tolerance) : itsCache(cacheSize),
-      itsTangentPoints(cacheSize), itsPhaseCentres(cacheSize), 
-      itsOldestElement(0), itsTolerance(tolerance)
+      itsTangentPoints(cacheSize), itsPhaseCentres(cacheSize),
+      itsHits(0u), itsMisses(0u), itsEvictions(0u),
+      itsOldestElement(0), itsTolerance(tolerance), itsSquaredChordTolerance(squaredChord(tolerance))
 {
   ASKAPASSERT(cacheSize>=1);
   ASKAPDEBUGASSERT(tolerance>0);
   ASKAPDEBUGASSERT(itsCache.size() == itsTangentPoints.size());
   ASKAPDEBUGASSERT(itsCache.size() == itsPhaseCentres.size());
+  itsIndex.reserve(cacheSize);
 }
 
 /// @brief destructor to print some stats
-/// @details This method writes in the log cache utilisation statistics
+/// @details This method writes in the log cache utilisation statistics and the values of
+/// hit, miss and eviction counters
 UVWMachineCache::~UVWMachineCache()
 {
-#ifdef _OPENMP
    boost::shared_lock<boost::shared_mutex> lock(itsMutex);
-#endif
    
    if (itsCache.size()) {
        size_t cntUsed = 0;
@@ -71,7 +81,9 @@ UVWMachineCache::~UVWMachineCache()
                 ++cntUsed;
             }
        }
-       ASKAPLOG_DEBUG_STR(logger, "UVW-Machine cache utilisation: used "<<cntUsed<<" cache(s) out of "<<itsCache.size()<<" available");
+       ASKAPLOG_DEBUG_STR(logger, "UVW-Machine cache utilisation: used "<<cntUsed<<" cache(s) out of "<<
+                          itsCache.size()<<" available; "<<hits()<<" hit(s), "<<misses()<<" miss(es), "<<
+                          evictions()<<" eviction(s)");
    }
 }
 
@@ -81,20 +93,44 @@ UVWMachineCache::~UVWMachineCache()
 /// @param[in] phaseCentre direction to the input phase centre
 /// @param[in] tangent direction to tangent point
 /// @return a const reference to uvw machine 
+/// @note The reference remains valid until the machine is removed from the cache
 const UVWMachineCache::machineType& UVWMachineCache::machine(const casacore::MDirection &phaseCentre,
                                                  const casacore::MDirection &tangent) const
-{  
-#ifdef _OPENMP
-   boost::upgrade_lock<boost::shared_mutex> lock(itsMutex);
-#endif
+{
+   // the machine is also held by itsCache, so it outlives the shared pointer returned here
+   return *sharedMachine(phaseCentre, tangent);
+}
+
+/// @brief obtain shared machine for a particular tangent point and phase centre
+/// @details The read-only copy of the cache is searched first, this doesn't require locking.
+/// The cache is only locked if a new machine is needed. The returned pointer keeps the machine
+/// alive after it is removed from the cache.
+/// @param[in] phaseCentre direction to the input phase centre
+/// @param[in] tangent direction to tangent point
+/// @return a shared pointer to uvw machine
+boost::shared_ptr<UVWMachineCache::machineType const> UVWMachineCache::sharedMachine(
+             const casacore::MDirection &phaseCentre, const casacore::MDirection &tangent) const
+{
+   {
+      const boost::shared_ptr<SnapshotType const> snapshot = boost::atomic_load(&itsSnapshot);
+      if (snapshot) {
+          typedef SnapshotType::const_iterator SnapshotIterator;
+          const std::pair<SnapshotIterator, SnapshotIterator> candidates =
+                snapshot->equal_range(hashKey(phaseCentre, tangent));
+          for (SnapshotIterator ci = candidates.first; ci != candidates.second; ++ci) {
+               if (compare(tangent, ci->second.itsTangentPoint) && compare(phaseCentre, ci->second.itsPhaseCentre)) {
+                   itsHits.fetch_add(1u, std::memory_order_relaxed);
+                   return ci->second.itsMachine;
+               }
+          }
+      }
+   }
+
+   boost::unique_lock<boost::shared_mutex> lock(itsMutex);
     
    const size_t index = getIndex(phaseCentre,tangent);
    boost::shared_ptr<machineType> &machinePtr = itsCache[index];
    if (!machinePtr) {
-#ifdef _OPENMP
-       boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(lock);
-       ASKAPDEBUGASSERT(!machinePtr);
-#endif
        // need to set up a new machine here
        machinePtr.reset(new machineType(tangent, phaseCentre, false, false));
        // swap the arguments in the uvw machine call. It gives the correct result on real data
@@ -102,7 +138,29 @@ const UVWMachineCache::machineType& UVWMachineCache::machine(const casacore::MDi
        // also set the fourth parameter, project, to false, as we do not want to reproject to the input frame.
        // machinePtr.reset(new machineType(phaseCentre, tangent, false, true));
    }
-   return *machinePtr;
+   // a new machine or a new key for the existing one
+   publishSnapshot();
+   return machinePtr;
+}
+
+/// @brief replace the read-only copy of the cache used for lookups
+/// @details This method is only called with the mutex locked.
+void UVWMachineCache::publishSnapshot() const
+{
+   boost::shared_ptr<SnapshotType> snapshot(new SnapshotType);
+   snapshot->reserve(itsIndex.size());
+   for (std::unordered_multimap<size_t, size_t>::const_iterator ci = itsIndex.begin(); ci != itsIndex.end(); ++ci) {
+        const size_t index = ci->second;
+        ASKAPDEBUGASSERT(index < itsCache.size());
+        if (itsCache[index]) {
+            CacheEntry entry;
+            entry.itsTangentPoint = itsTangentPoints[index];
+            entry.itsPhaseCentre = itsPhaseCentres[index];
+            entry.itsMachine = itsCache[index];
+            snapshot->insert(std::make_pair(ci->first, entry));
+        }
+   }
+   boost::atomic_store(&itsSnapshot, boost::shared_ptr<SnapshotType const>(snapshot));
 }
 
 /// @brief a helper method to check whether two directions are matching
@@ -117,7 +175,10 @@ const UVWMachineCache::machineType& UVWMachineCache::machine(const casacore::MDi
 /// @return true, if they are matching
 bool UVWMachineCache::compare(const casacore::MDirection &dir1, const casacore::MDirection &dir2) const
 {
-  return compare(dir1,dir2,itsTolerance);
+  if (dir1.getRef().getType() != dir2.getRef().getType()) {
+      return false;
+  }
+  return squaredChord(dir1.getValue(), dir2.getValue()) < itsSquaredChordTolerance;
 }
 
 /// @brief a helper method to check whether two directions are matching
@@ -135,22 +196,86 @@ bool UVWMachineCache::compare(const casacore::MDirection &dir1, const casacore::
    if (dir1.getRef().getType() != dir2.getRef().getType()) {
        return false;
    }
-   return dir1.getValue().separation(dir2.getValue()) < tolerance;
+   return squaredChord(dir1.getValue(), dir2.getValue()) < squaredChord(tolerance);
+}
+
+/// @brief square of the chord between two directions
+/// @details The chord is a monotonic function of the angular separation, but it can be computed
+/// from the direction cosines without trigonometric functions.
+/// @param[in] dir1 first direction
+/// @param[in] dir2 second direction
+/// @return square of the distance between the points on the unit sphere
+double UVWMachineCache::squaredChord(const casacore::MVDirection &dir1, const casacore::MVDirection &dir2)
+{
+   double result = 0.;
+   for (casacore::uInt dim = 0; dim < 3; ++dim) {
+        const double diff = dir1(dim) - dir2(dim);
+        result += diff * diff;
+   }
+   return result;
 }
 
+/// @brief square of the chord corresponding to the given angle
+/// @param[in] angle angular separation in radians
+/// @return square of the distance between the points on the unit sphere
+double UVWMachineCache::squaredChord(double angle)
+{
+   // the chord is 2 sin(angle / 2), angles beyond pi match any direction
+   if (angle >= casacore::C::pi) {
+       return 4. + 1e-6;
+   }
+   const double halfChord = std::sin(angle / 2.);
+   return 4. * halfChord * halfChord;
+}
+
+/// @brief hash of the pair of directions
+/// @details Direction cosines are quantised with the step equal to the tolerance, so matching
+/// directions have the same hash unless they are on the opposite sides of a step boundary.
+/// @param[in] phaseCentre direction to the input phase centre
+/// @param[in] tangent direction to tangent point
+/// @return hash value
+size_t UVWMachineCache::hashKey(const casacore::MDirection &phaseCentre,
+                                const casacore::MDirection &tangent) const
+{
+   size_t result = 0;
+   boost::hash_combine(result, phaseCentre.getRef().getType());
+   boost::hash_combine(result, tangent.getRef().getType());
+   const casacore::MVDirection &pc = phaseCentre.getValue();
+   const casacore::MVDirection &tp = tangent.getValue();
+   for (casacore::uInt dim = 0; dim < 3; ++dim) {
+        boost::hash_combine(result, std::floor(pc(dim) / itsTolerance));
+        boost::hash_combine(result, std::floor(tp(dim) / itsTolerance));
+   }
+   return result;
+}
 
 /// @brief obtain the index corresponding to a particular tangent point
 /// @details If the cache entry needs updating, the appropriate shared pointer will
-/// be reset. This method updates itsTangentPoints, if necessary.
+/// be reset. This method updates itsTangentPoints, if necessary. The hash index is
+/// searched first. If the directions are not found there (the matching directions may
+/// be quantised differently if they are close to the step boundary), all cached
+/// directions are searched before a new entry is made.
 /// @param[in] phaseCentre direction to the input phase centre
 /// @param[in] tangent direction to tangent point
 /// @return cache index
 size_t UVWMachineCache::getIndex(const casacore::MDirection &phaseCentre, 
                                  const casacore::MDirection &tangent) const
 {
-   // this method is protected and is only called after the upgrade_lock has been acquired.
+   // this method is protected and is only called after the lock has been acquired.
    // Therefore, we don't need any more locks here.
    
+   const size_t key = hashKey(phaseCentre, tangent);
+   typedef std::unordered_multimap<size_t, size_t>::const_iterator IndexIterator;
+   const std::pair<IndexIterator, IndexIterator> candidates = itsIndex.equal_range(key);
+   for (IndexIterator ci = candidates.first; ci != candidates.second; ++ci) {
+        const size_t index = ci->second;
+        ASKAPDEBUGASSERT(index < itsCache.size());
+        if (compare(tangent, itsTangentPoints[index]) && compare(phaseCentre, itsPhaseCentres[index])) {
+            itsHits.fetch_add(1u, std::memory_order_relaxed);
+            return index;
+        }
+   }
+
    // search from the newest element backwards (i.e. most likely the match is the most
    // recently used tangent point)
    for (int pos=0; pos<int(itsTangentPoints.size()); ++pos) {
@@ -160,13 +285,29 @@ size_t UVWMachineCache::getIndex(const casacore::MDirection &phaseCentre,
             index += int(itsCache.size());
         }
         ASKAPDEBUGASSERT((index>=0) && (index<int(itsTangentPoints.size())));
-        if (compare(tangent, itsTangentPoints[index]) && compare(phaseCentre, itsPhaseCentres[index])) {
+        if (itsCache[index] && compare(tangent, itsTangentPoints[index]) &&
+            compare(phaseCentre, itsPhaseCentres[index])) {
+            itsHits.fetch_add(1u, std::memory_order_relaxed);
+            // directions have been quantised differently, the next lookup will be done via the index
+            itsIndex.insert(std::make_pair(key, size_t(index)));
             return size_t(index);
         }
    }
    // there has been no match, need to replace itsOldestElement   
+   itsMisses.fetch_add(1u, std::memory_order_relaxed);
    ASKAPDEBUGASSERT(itsOldestElement<itsCache.size());
    const size_t result = itsOldestElement++;
+   if (itsCache[result]) {
+       itsEvictions.fetch_add(1u, std::memory_order_relaxed);
+   }
+   // remove the old entry (with all its keys) from the index
+   for (IndexIterator ci = itsIndex.begin(); ci != itsIndex.end();) {
+        if (ci->second == result) {
+            ci = itsIndex.erase(ci);
+        } else {
+            ++ci;
+        }
+   }
    // machine needs updating
    itsCache[result].reset(); 
    if (itsOldestElement >= itsCache.size()) {
@@ -175,6 +316,6 @@ size_t UVWMachineCache::getIndex(const casacore::MDirection &phaseCentre,
    }
    itsTangentPoints[result] = tangent;
    itsPhaseCentres[result] = phaseCentre;
+   itsIndex.insert(std::make_pair(key, result));
    return result;
 }
-
@@ -34,14 +34,13 @@
 
 // std includes
 #include <vector>
+#include <atomic>
+#include <unordered_map>
 
 // boost includes
 #include <boost/shared_ptr.hpp>
 #include <boost/noncopyable.hpp>
-
-#ifdef _OPENMP
 #include <boost/thread/shared_mutex.hpp>
-#endif
 
 // casa includes
 #include <casacore/measures/Measures/MDirection.h>
@@ -57,6 +56,9 @@ namespace accessors {
 /// @details
 /// This class maintains the cache of UVW Machines (a pair of tangent point and phase centre directions 
 /// is  the key). The number of machines cached and the direction tolerance are specified as parameters.
+/// Cached machines are found via the hash of quantised directions. Lookups are done in a read-only
+/// copy of the cache (replaced as a whole when a new machine is added), so the requests served
+/// by the machines already in the cache don't lock the mutex.
 /// @ingroup dataaccess
 struct UVWMachineCache : public boost::noncopyable {
    
@@ -75,7 +77,8 @@ struct UVWMachineCache : public boost::noncopyable {
    explicit UVWMachineCache(size_t cacheSize = 1, double tolerance = 1e-6);
    
    /// @brief destructor to print some stats
-   /// @details This method writes in the log cache utilisation statistics
+   /// @details This method writes in the log cache utilisation statistics and the values of
+   /// hit, miss and eviction counters
    ~UVWMachineCache();
    
    /// @brief obtain machine for a particular tangent point and phase centre
@@ -83,8 +86,31 @@ struct UVWMachineCache : public boost::noncopyable {
    /// @param[in] phaseCentre direction to the input phase centre
    /// @param[in] tangent direction to tangent point
    /// @return a const reference to uvw machine 
+   /// @note The reference remains valid until the machine is removed from the cache
    const machineType& machine(const casacore::MDirection &phaseCentre, 
                                    const casacore::MDirection &tangent) const;
+
+   /// @brief obtain shared machine for a particular tangent point and phase centre
+   /// @details This method is equivalent to machine, but the returned pointer keeps the machine
+   /// alive after it is removed from the cache. It should be used if the cache is shared between
+   /// threads, as another thread can evict the machine while it is in use.
+   /// @param[in] phaseCentre direction to the input phase centre
+   /// @param[in] tangent direction to tangent point
+   /// @return a shared pointer to uvw machine
+   boost::shared_ptr<machineType const> sharedMachine(const casacore::MDirection &phaseCentre,
+                                   const casacore::MDirection &tangent) const;
+
+   /// @brief number of requests served by a machine already in the cache
+   /// @return number of cache hits so far
+   inline size_t hits() const { return itsHits.load(std::memory_order_relaxed); }
+
+   /// @brief number of requests which required a new machine
+   /// @return number of cache misses so far
+   inline size_t misses() const { return itsMisses.load(std::memory_order_relaxed); }
+
+   /// @brief number of machines removed from the cache to free space for a new one
+   /// @return number of evictions so far
+   inline size_t evictions() const { return itsEvictions.load(std::memory_order_relaxed); }
    
    /// @brief a helper method to check whether two directions are matching
    /// @details It always return false if the reference frames are different (although
@@ -118,8 +144,45 @@ protected:
    /// @param[in] tangent direction to tangent point
    /// @return cache index
    size_t getIndex(const casacore::MDirection &phaseCentre, const casacore::MDirection &tangent) const;
-   
+
+   /// @brief hash of the pair of directions
+   /// @details Direction cosines are quantised with the step equal to the tolerance, so matching
+   /// directions have the same hash unless they are on the opposite sides of a step boundary.
+   /// @param[in] phaseCentre direction to the input phase centre
+   /// @param[in] tangent direction to tangent point
+   /// @return hash value
+   size_t hashKey(const casacore::MDirection &phaseCentre, const casacore::MDirection &tangent) const;
+
+   /// @brief square of the chord between two directions
+   /// @details The chord is a monotonic function of the angular separation, but it can be computed
+   /// from the direction cosines without trigonometric functions.
+   /// @param[in] dir1 first direction
+   /// @param[in] dir2 second direction
+   /// @return square of the distance between the points on the unit sphere
+   static double squaredChord(const casacore::MVDirection &dir1, const casacore::MVDirection &dir2);
+
+   /// @brief square of the chord corresponding to the given angle
+   /// @param[in] angle angular separation in radians
+   /// @return square of the distance between the points on the unit sphere
+   static double squaredChord(double angle);
+
+   /// @brief replace the read-only copy of the cache used for lookups
+   /// @details This method is only called with the mutex locked.
+   void publishSnapshot() const;
+
 private:
+   /// @brief cached machine together with its key directions
+   struct CacheEntry {
+      /// @brief tangent point
+      casacore::MDirection itsTangentPoint;
+      /// @brief phase centre
+      casacore::MDirection itsPhaseCentre;
+      /// @brief the machine (shared with itsCache)
+      boost::shared_ptr<machineType> itsMachine;
+   };
+
+   /// @brief type of the read-only copy of the cache (hash key is mapped to the cache entry)
+   typedef std::unordered_multimap<size_t, CacheEntry> SnapshotType;
 
    /// @brief the actual cache of uvw machines
    /// @note We're using a plain vector-based cache here instead of the std queue because we
@@ -132,6 +195,25 @@ private:
 
    /// @brief cached phase centre directions
    mutable std::vector<casacore::MDirection> itsPhaseCentres;
+
+   /// @brief index of cached machines, hash key is mapped to the index in itsCache
+   /// @details The same element can be found via more than one key if the matching directions
+   /// have been quantised differently.
+   mutable std::unordered_multimap<size_t, size_t> itsIndex;
+
+   /// @brief read-only copy of the cache used for lookups without locking
+   /// @details The copy is never modified, it is replaced (atomically) when the cache changes.
+   /// The machines are shared with itsCache.
+   mutable boost::shared_ptr<SnapshotType const> itsSnapshot;
+
+   /// @brief number of cache hits
+   mutable std::atomic<size_t> itsHits;
+
+   /// @brief number of cache misses
+   mutable std::atomic<size_t> itsMisses;
+
+   /// @brief number of evictions
+   mutable std::atomic<size_t> itsEvictions;
    
    /// @brief index of the oldest element in the cache
    mutable size_t itsOldestElement;
@@ -139,11 +221,14 @@ private:
    /// @brief direction tolerance
    /// @details It determines whether we a new machine has to be created
    double itsTolerance; 
+
+   /// @brief square of the chord corresponding to the tolerance
+   double itsSquaredChordTolerance;
  
-#ifdef _OPENMP  
    /// @brief mutex to synchronise cache access
+   /// @details It is only locked when a new machine is added, so it is present regardless
+   /// of whether the cache is used from OpenMP or from other threads.
    mutable boost::shared_mutex itsMutex;
-#endif
 };
 
 } // namespace accessors
@@ -34,10 +34,16 @@
 #include <askap/dataaccess/UVWRotationHandler.h>
 #include <askap/askap/AskapError.h>
 
+// std includes
+#include <vector>
+
 #include <casacore/measures/Measures/MeasFrame.h>
 #include <casacore/measures/Measures/MEpoch.h>
 #include <askap/askap/AskapUtil.h>
 
+#include <askap_accessors.h>
+#include <askap/askap/AskapLogging.h>
+ASKAP_LOGGER(logger, ".dataaccess");
 
 using namespace askap;
 using namespace askap::accessors;
@@ -47,8 +53,29 @@ using namespace askap::accessors;
 /// @param[in] cacheSize a number of uvw machines in the cache (default is 1)
 /// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads
 /// to initialisation of a new UVW Machine and recompute of the rotated uvws/delays
-UVWRotationHandler::UVWRotationHandler(size_t cacheSize, double tolerance) :
-         UVWMachineCache(cacheSize, tolerance), itsValid(false) {}
+/// @param[in] nTangentPoints a number of tangent points for which rotated uvws and delays
+/// are cached at the same time (default is 1)
+UVWRotationHandler::UVWRotationHandler(size_t cacheSize, double tolerance, size_t nTangentPoints) :
+         UVWMachineCache(cacheSize, tolerance), itsNextEntry(0)
+{
+  ASKAPCHECK(nTangentPoints > 0, "Number of tangent points in the rotated uvw cache should be positive");
+  itsEntries.resize(nTangentPoints);
+}
+
+/// @brief destructor, reports the memory used by the cache of rotated uvws
+UVWRotationHandler::~UVWRotationHandler()
+{
+  if (itsEntries.size() > 1) {
+      size_t cntUsed = 0;
+      for (std::vector<RotatedUVWEntry>::const_iterator ci = itsEntries.begin(); ci != itsEntries.end(); ++ci) {
+           if (ci->itsValid) {
+               ++cntUsed;
+           }
+      }
+      ASKAPLOG_DEBUG_STR(logger, "Rotated uvw cache utilisation: used "<<cntUsed<<" tangent point(s) out of "<<
+                         itsEntries.size()<<", memory "<<memoryUsage()<<" bytes");
+  }
+}
 
 
 /// @brief invalidate the cache
@@ -60,7 +87,80 @@ void UVWRotationHandler::invalidate() const
    boost::unique_lock<boost::shared_mutex> lock(itsMutex);
 #endif
 
-   itsValid = false;
+   for (std::vector<RotatedUVWEntry>::iterator it = itsEntries.begin(); it != itsEntries.end(); ++it) {
+        it->itsValid = false;
+        it->itsFloatValid = false;
+   }
+}
+
+/// @brief change the number of tangent points cached at the same time
+/// @details Rotated uvws and delays are cached for a number of tangent points, so
+/// alternating access to different tangent points (e.g. for faceted imaging) within one
+/// chunk doesn't require recalculation. When the cache is full, the entry filled earliest
+/// is replaced. The cache is invalidated by this call and references obtained earlier
+/// are no longer valid.
+/// @param[in] nTangentPoints a number of tangent points (should be positive)
+void UVWRotationHandler::setTangentPointCacheSize(size_t nTangentPoints)
+{
+   ASKAPCHECK(nTangentPoints > 0, "Number of tangent points in the rotated uvw cache should be positive");
+#ifdef _OPENMP
+   boost::unique_lock<boost::shared_mutex> lock(itsMutex);
+#endif
+   itsEntries.clear();
+   itsEntries.resize(nTangentPoints);
+   itsNextEntry = 0;
+}
+
+/// @brief memory used by the cache of rotated uvws and delays
+/// @details Only the buffers filled for the current chunk are counted.
+/// @return memory in bytes
+size_t UVWRotationHandler::memoryUsage() const
+{
+#ifdef _OPENMP
+   boost::shared_lock<boost::shared_mutex> lock(itsMutex);
+#endif
+   size_t result = 0;
+   for (std::vector<RotatedUVWEntry>::const_iterator ci = itsEntries.begin(); ci != itsEntries.end(); ++ci) {
+        if (ci->itsValid) {
+            result += ci->itsRotatedUVWs.nelements() * sizeof(casacore::RigidVector<casacore::Double, 3>) +
+                      3 * ci->itsRotatedUVWComponents.nelements() * sizeof(casacore::Double) +
+                      ci->itsDelays.nelements() * sizeof(casacore::Double);
+            if (ci->itsFloatValid) {
+                result += 3 * ci->itsRotatedUVWComponentsFloat.nelements() * sizeof(casacore::Float);
+            }
+            for (std::list<ShiftedDelays>::const_iterator sdi = ci->itsShiftedDelays.begin();
+                 sdi != ci->itsShiftedDelays.end(); ++sdi) {
+                 result += sdi->itsDelays.nelements() * sizeof(casacore::Double);
+            }
+        }
+   }
+   return result;
+}
+
+/// @brief find the entry for the given tangent point
+/// @details The caller is expected to hold the lock.
+/// @param[in] tangent direction to the tangent point
+/// @return index of the valid entry or the cache size, if the tangent point is not cached
+size_t UVWRotationHandler::findEntry(const casacore::MDirection &tangent) const
+{
+   for (size_t index = 0; index < itsEntries.size(); ++index) {
+        if (itsEntries[index].itsValid && compare(tangent, itsEntries[index].itsTangentPoint)) {
+            return index;
+        }
+   }
+   return itsEntries.size();
+}
+
+/// @brief obtain the entry filled by uvw for the given tangent point
+/// @details The caller is expected to hold the lock.
+/// @param[in] tangent direction to the tangent point
+/// @return reference to the entry
+UVWRotationHandler::RotatedUVWEntry& UVWRotationHandler::filledEntry(const casacore::MDirection &tangent) const
+{
+   const size_t index = findEntry(tangent);
+   ASKAPCHECK(index < itsEntries.size(),
+              "This should not happen, suspect race condition with number of threads exceeding number of cache elements");
+   return itsEntries[index];
 }
 
 
@@ -85,17 +185,23 @@ const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& UVWRotation
   boost::upgrade_lock<boost::shared_mutex> lock(itsMutex);
 #endif
 
-  if (!itsValid || !compare(tangent, itsTangentPoint)) {
+  size_t index = findEntry(tangent);
+  if (index == itsEntries.size()) {
 #ifdef _OPENMP
      boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(lock);
 #endif
-     // have to fill itsRotatedUVW
+     // have to fill the entry replaced in the round-robin fashion
+     index = itsNextEntry;
+     itsNextEntry = (itsNextEntry + 1) % itsEntries.size();
+     RotatedUVWEntry &entry = itsEntries[index];
      const casacore::uInt nSamples = acc.nRow();
-     itsRotatedUVWs.resize(nSamples);
-     itsDelays.resize(nSamples);
-     itsTangentPoint = tangent;
-     itsImageCentre = tangent;
-     itsValid = true;
+     entry.itsRotatedUVWs.resize(nSamples);
+     entry.itsRotatedUVWComponents.resize(nSamples);
+     entry.itsDelays.resize(nSamples);
+     entry.itsTangentPoint = tangent;
+     entry.itsShiftedDelays.clear();
+     entry.itsValid = true;
+     entry.itsFloatValid = false;
      // just copy rotation code from TableVisGridder for a moment
      const casacore::Vector<casacore::RigidVector<double, 3> >& uvwVector = acc.uvw();
      //casacore::Vector<casacore::MVDirection> pointingDir1Vector =
@@ -118,43 +224,167 @@ const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& UVWRotation
      pointingDir1Vector.set(casacore::MVDirection(tmpra,tmpdec));
      */
      //
-     casacore::Vector<double> uvwBuffer(3);
-     const UVWMachineCache::machineType * uvwm;
+     // rows are split into blocks sharing the same pointing direction (i.e. the same uvw machine),
+     // the transform is set up once for each direction and applied to whole blocks
+     std::vector<casacore::MVDirection> groupDirections;
+     std::vector<RotationGroup> groups;
+     std::vector<RotationBlock> blocks;
+     casacore::uInt group = 0;
      for (casacore::uInt row=0; row<nSamples; ++row) {
-          const casacore::RigidVector<double, 3> &uvwRow = uvwVector(row);
           /// @todo Decide what to do about pointingDir1!=pointingDir2
-          for (int i=0; i<3; ++i) {
-               uvwBuffer(i) = (i<2 ? -1. : 1.) * uvwRow(i);
-          }
-
-          /// @note we actually pass MVDirection as MDirection. The code had just been
-          /// copied, so this bug had been here for a while. It means that J2000 is
-          /// hard coded in the next line (quite implicitly).
-          //const UVWMachineCache::machineType& uvwm = machine(pointingDir1Vector(row),itsTangentPoint);
           // Optimise the common case where all pointingdirs are the same
           if (row==0 || pointingDir1Vector(row)!=pointingDir1Vector(row-1)) {
-              uvwm = &machine(pointingDir1Vector(row),itsTangentPoint);
+              const casacore::MVDirection &dir = pointingDir1Vector(row);
+              for (group = 0; group < groupDirections.size(); ++group) {
+                   if (groupDirections[group] == dir) {
+                       break;
+                   }
+              }
+              if (group == groupDirections.size()) {
+                  /// @note we actually pass MVDirection as MDirection. The code had just been
+                  /// copied, so this bug had been here for a while. It means that J2000 is
+                  /// hard coded in the next line (quite implicitly).
+                  groupDirections.push_back(dir);
+                  groups.push_back(RotationGroup());
+                  setUpGroup(machine(dir,tangent), groups.back());
+              }
           }
-          uvwm->convertUVW(itsDelays(row), uvwBuffer);
-
-          // the following line is to be commented out if we swap arguments in the uvw machine call
-          // (swapping the sign of uvw's above is another way to achieve a similar outcome
-          //itsDelays(row) *= -1;
-          //
-
-          for (int i=0; i<3; ++i) {
-               itsRotatedUVWs(row)(i) = (i<2 ? -1. : 1.) * uvwBuffer(i);
+          if (blocks.empty() || (blocks.back().itsGroup != group) ||
+              (blocks.back().itsNRows >= theirMaxBlockSize)) {
+              blocks.push_back(RotationBlock(row, group));
           }
+          ++blocks.back().itsNRows;
+     }
 
+     casacore::Bool deleteIt;
+     const casacore::RigidVector<casacore::Double, 3> *in = uvwVector.getStorage(deleteIt);
+     casacore::RigidVector<casacore::Double, 3> *out = entry.itsRotatedUVWs.data();
+     casacore::Double *u = entry.itsRotatedUVWComponents.uData();
+     casacore::Double *v = entry.itsRotatedUVWComponents.vData();
+     casacore::Double *w = entry.itsRotatedUVWComponents.wData();
+     casacore::Double *delay = entry.itsDelays.data();
+     const int nBlocks = int(blocks.size());
+#ifdef _OPENMP
+     #pragma omp parallel for schedule(static) if (nSamples >= theirMinRowsForThreads)
+#endif
+     for (int block = 0; block < nBlocks; ++block) {
+          const casacore::uInt start = blocks[block].itsStartRow;
+          rotateBlock(groups[blocks[block].itsGroup], in + start, blocks[block].itsNRows, out + start,
+                      u + start, v + start, w + start, delay + start);
      }
+     uvwVector.freeStorage(in, deleteIt);
+  }
+  return itsEntries[index].itsRotatedUVWs;
+}
+
+/// @brief set up the linear transform for the given uvw machine
+/// @details The machine is applied to unit vectors along each axis (with the sign convention
+/// used for uvw rotation in this class), which gives columns of the rotation matrix and
+/// the delay coefficients.
+/// @param[in] machine uvw machine
+/// @param[out] group transform to set up
+void UVWRotationHandler::setUpGroup(const machineType &machine, RotationGroup &group)
+{
+  casacore::Vector<casacore::Double> uvwBuffer(3);
+  for (int col = 0; col < 3; ++col) {
+       // the sign of u and v is swapped before and after the machine is applied
+       // (this is another way to swap arguments in the uvw machine call)
+       uvwBuffer.set(0.);
+       uvwBuffer(col) = col < 2 ? -1. : 1.;
+       machine.convertUVW(group.itsDelay[col], uvwBuffer);
+       for (int row = 0; row < 3; ++row) {
+            group.itsMatrix[3 * row + col] = (row < 2 ? -1. : 1.) * uvwBuffer(row);
+       }
   }
-  return itsRotatedUVWs;
+}
+
+/// @brief apply the transform to a block of rows
+/// @details The loop has no branches and no calls, so it can be vectorised by the compiler.
+/// @param[in] group transform to apply
+/// @param[in] in input uvw for the first row of the block
+/// @param[in] nRows number of rows in the block
+/// @param[out] out rotated uvw
+/// @param[out] u rotated u-coordinates
+/// @param[out] v rotated v-coordinates
+/// @param[out] w rotated w-coordinates
+/// @param[out] delay delays associated with the rotation
+void UVWRotationHandler::rotateBlock(const RotationGroup &group, const casacore::RigidVector<casacore::Double, 3> *in,
+               casacore::uInt nRows, casacore::RigidVector<casacore::Double, 3> *out,
+               casacore::Double *u, casacore::Double *v, casacore::Double *w, casacore::Double *delay)
+{
+  // local copies, so the compiler doesn't have to assume that the outputs overlap the transform
+  const casacore::Double m00 = group.itsMatrix[0], m01 = group.itsMatrix[1], m02 = group.itsMatrix[2];
+  const casacore::Double m10 = group.itsMatrix[3], m11 = group.itsMatrix[4], m12 = group.itsMatrix[5];
+  const casacore::Double m20 = group.itsMatrix[6], m21 = group.itsMatrix[7], m22 = group.itsMatrix[8];
+  const casacore::Double d0 = group.itsDelay[0], d1 = group.itsDelay[1], d2 = group.itsDelay[2];
+  for (casacore::uInt row = 0; row < nRows; ++row) {
+       const casacore::Double uIn = in[row](0);
+       const casacore::Double vIn = in[row](1);
+       const casacore::Double wIn = in[row](2);
+       const casacore::Double uOut = m00 * uIn + m01 * vIn + m02 * wIn;
+       const casacore::Double vOut = m10 * uIn + m11 * vIn + m12 * wIn;
+       const casacore::Double wOut = m20 * uIn + m21 * vIn + m22 * wIn;
+       out[row](0) = uOut;
+       out[row](1) = vOut;
+       out[row](2) = wOut;
+       u[row] = uOut;
+       v[row] = vOut;
+       w[row] = wOut;
+       delay[row] = d0 * uIn + d1 * vIn + d2 * wIn;
+  }
+}
+
+/// @brief obtain rotated uvws stored as separate arrays of u, v and w
+/// @details This is the same information as returned by uvw(), both representations
+/// are filled at the same time and are valid until invalidate is called.
+/// @param[in] acc const reference to the input accessor (need phase centre info, uvw, etc)
+/// @param[in] tangent direction to the tangent point
+/// @return const reference to rotated uvw components
+const UVWComponents<casacore::Double>& UVWRotationHandler::uvwComponents(const IConstDataAccessor &acc,
+               const casacore::MDirection &tangent) const
+{
+  uvw(acc, tangent);
+
+#ifdef _OPENMP
+  boost::shared_lock<boost::shared_mutex> lock(itsMutex);
+#endif
+  const RotatedUVWEntry &entry = filledEntry(tangent);
+
+  ASKAPDEBUGASSERT(entry.itsRotatedUVWComponents.nelements() == acc.nRow());
+  return entry.itsRotatedUVWComponents;
+}
+
+/// @brief obtain rotated uvws stored as separate arrays of u, v and w in single precision
+/// @details The single precision copy is made from the double precision components on demand
+/// and cached until the rotated uvws are recalculated.
+/// @param[in] acc const reference to the input accessor (need phase centre info, uvw, etc)
+/// @param[in] tangent direction to the tangent point
+/// @return const reference to rotated uvw components
+const UVWComponents<casacore::Float>& UVWRotationHandler::uvwComponentsFloat(const IConstDataAccessor &acc,
+               const casacore::MDirection &tangent) const
+{
+  uvw(acc, tangent);
+
+#ifdef _OPENMP
+  boost::upgrade_lock<boost::shared_mutex> lock(itsMutex);
+#endif
+  RotatedUVWEntry &entry = filledEntry(tangent);
+
+  if (!entry.itsFloatValid) {
+#ifdef _OPENMP
+      boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(lock);
+#endif
+      entry.itsRotatedUVWComponentsFloat.assignFrom(entry.itsRotatedUVWComponents);
+      entry.itsFloatValid = true;
+  }
+  return entry.itsRotatedUVWComponentsFloat;
 }
 
 /// @brief obtain delays corresponding to rotation
 /// @details
 /// Use parameters in the given accessor to compute delays. This method calls rotatedUVWs and does
 /// some extra job on the delays if tangent != imageCentre
+/// (the result is cached separately for each image centre until invalidate is called)
 /// @param[in] acc const reference to the input accessor (need phase centre info, uvw, etc)
 /// @param[in] tangent direction to the tangent point
 /// @param[in] imageCentre direction to the image centre
@@ -168,11 +398,10 @@ const casacore::Vector<casacore::Double>& UVWRotationHandler::delays(const ICons
 
 #ifdef _OPENMP
   boost::upgrade_lock<boost::shared_mutex> lock(itsMutex);
-  ASKAPCHECK(compare(tangent, itsTangentPoint) && itsValid,
-             "This should not happen, suspect race condition with number of threads exceeding number of cache elements");
 #endif
+  RotatedUVWEntry &entry = filledEntry(tangent);
 
-  ASKAPDEBUGASSERT(itsDelays.nelements() == acc.nRow());
+  ASKAPDEBUGASSERT(entry.itsDelays.nelements() == acc.nRow());
 
   ASKAPCHECK(imageCentre.getRef().getType() == casacore::MDirection::J2000,
       "This is a cautionary assertion because a number of places in the code implicitly assume J2000 for "
@@ -180,43 +409,49 @@ const casacore::Vector<casacore::Double>& UVWRotationHandler::delays(const ICons
       "frame information to UVWMachines as well as to invalidate cache when say the time changes if it is required for conversion. "
       "This work has not been done and is beyond the scope for ASKAP.");
 
-  if (!compare(itsImageCentre, imageCentre)) {
+  if (compare(tangent, imageCentre)) {
+      return entry.itsDelays;
+  }
+  for (std::list<ShiftedDelays>::const_iterator ci = entry.itsShiftedDelays.begin();
+       ci != entry.itsShiftedDelays.end(); ++ci) {
+       if (compare(ci->itsImageCentre, imageCentre)) {
+           return ci->itsDelays;
+       }
+  }
 
 #ifdef _OPENMP
-      boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(lock);
+  boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(lock);
 #endif
 
-      // we have to apply extra shift
-      ASKAPCHECK(itsImageCentre.getRef().getType() == imageCentre.getRef().getType(),
-                 "image centres in UVWRotationHandler::delays are not supposed to be in different frames");
-
-      const casacore::MVDirection oldCentre(itsImageCentre.getValue());
-      const casacore::MVDirection newCentre(imageCentre.getValue());
-      const casacore::MVDirection tangentCentre(tangent.getValue());
-      // offsets to get the new image centre
-      const double dl = sin(newCentre.getLong()-tangentCentre.getLong())*cos(newCentre.getLat())-
-                        sin(oldCentre.getLong()-tangentCentre.getLong())*cos(oldCentre.getLat());
-      const double dm = sin(newCentre.getLat())*cos(tangentCentre.getLat()) -
-              cos(newCentre.getLat())*sin(tangentCentre.getLat())
-                   *cos(newCentre.getLong()-tangentCentre.getLong()) -
-              sin(oldCentre.getLat())*cos(tangentCentre.getLat()) +
-              cos(oldCentre.getLat())*sin(tangentCentre.getLat())
-                   *cos(oldCentre.getLong()-tangentCentre.getLong());
-
-      //ASKAPCHECK((abs(dl)<1e-6) && (abs(dm)<1e-6), "dl, dm are non-zero: "<<dl<<" "<<dm);
-      /*
-      const double dl = sin(newCentre.getLong()-oldCentre.getLong())*cos(newCentre.getLat());
-      const double dm = sin(newCentre.getLat())*cos(oldCentre.getLat()) -
-              cos(newCentre.getLat())*sin(oldCentre.getLat())
-                   *cos(newCentre.getLong()-oldCentre.getLong());
-      */
-      const casacore::uInt nSamples = itsDelays.nelements();
-      ASKAPDEBUGASSERT(nSamples == uvwBuffer.nelements());
-      for (casacore::uInt row=0; row<nSamples; ++row) {
-           itsDelays(row) += uvwBuffer(row)(0)*dl + uvwBuffer(row)(1)*dm;
-      }
-      // now delays are recalculated to correspond to the new image centre
-      itsImageCentre = imageCentre;
+  // we have to apply extra shift
+  ASKAPCHECK(tangent.getRef().getType() == imageCentre.getRef().getType(),
+             "image centre and tangent point in UVWRotationHandler::delays are not supposed to be in different frames");
+
+  const casacore::MVDirection newCentre(imageCentre.getValue());
+  const casacore::MVDirection tangentCentre(tangent.getValue());
+  // offsets of the image centre from the tangent point
+  const double dl = sin(newCentre.getLong()-tangentCentre.getLong())*cos(newCentre.getLat());
+  const double dm = sin(newCentre.getLat())*cos(tangentCentre.getLat()) -
+          cos(newCentre.getLat())*sin(tangentCentre.getLat())
+               *cos(newCentre.getLong()-tangentCentre.getLong());
+
+  entry.itsShiftedDelays.push_back(ShiftedDelays());
+  ShiftedDelays &shifted = entry.itsShiftedDelays.back();
+  shifted.itsImageCentre = imageCentre;
+  const casacore::uInt nSamples = entry.itsDelays.nelements();
+  ASKAPDEBUGASSERT(nSamples == uvwBuffer.nelements());
+  shifted.itsDelays.resize(nSamples);
+  casacore::Bool deleteIt;
+  const casacore::RigidVector<casacore::Double, 3> *uvwPtr = uvwBuffer.getStorage(deleteIt);
+  const casacore::Double *delayPtr = entry.itsDelays.data();
+  casacore::Double *shiftedPtr = shifted.itsDelays.data();
+  const int nRows = int(nSamples);
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(static) if (nSamples >= theirMinRowsForThreads)
+#endif
+  for (int row=0; row<nRows; ++row) {
+       shiftedPtr[row] = delayPtr[row] + uvwPtr[row](0)*dl + uvwPtr[row](1)*dm;
   }
-  return itsDelays;
+  uvwBuffer.freeStorage(uvwPtr, deleteIt);
+  return shifted.itsDelays;
 }
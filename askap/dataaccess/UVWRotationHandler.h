@@ -1,3 +1,12 @@
+      /// @brief delays for image centres different from the tangent point
+      /// @details
+      /// If the image centre is different from the tangent point, an additional translation
+      /// in the tangent plane is needed for the faceting to work. This is equivalent to uvw-dependent
+      /// delay, which is added to itsDelays (calculated for the image centre at the tangent point).
+      /// Each image centre gets its own buffer, so alternating access to different image centres
+      /// doesn't accumulate round-off errors or change the buffers returned earlier. The list
+      /// keeps references to the buffers valid when new image centres are added.
+      std::list<ShiftedDelays> itsShiftedDelays;
 /// @file
 /// @brief all logic behind uvw rotations and associated delays
 /// @details
@@ -36,8 +45,13 @@
 
 #include <askap/dataaccess/UVWMachineCache.h>
 #include <askap/dataaccess/IConstDataAccessor.h>
+#include <askap/dataaccess/UVWComponents.h>
 #include <casacore/measures/Measures/MDirection.h>
 
+// std includes
+#include <vector>
+#include <list>
+
 #ifdef _OPENMP
 // boost includes
 #include <boost/thread/shared_mutex.hpp>
@@ -61,13 +75,36 @@ struct UVWRotationHandler : protected UVWMachineCache {
    /// @param[in] cacheSize a number of uvw machines in the cache (default is 1)
    /// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads 
    /// to initialisation of a new UVW Machine and recompute of the rotated uvws/delays
-   explicit UVWRotationHandler(size_t cacheSize = 1, double tolerance = 1e-6);
+   /// @param[in] nTangentPoints a number of tangent points for which rotated uvws and delays
+   /// are cached at the same time (default is 1)
+   explicit UVWRotationHandler(size_t cacheSize = 1, double tolerance = 1e-6, size_t nTangentPoints = 1);
+
+   /// @brief destructor, reports the memory used by the cache of rotated uvws
+   ~UVWRotationHandler();
 
    /// @brief invalidate the cache
    /// @details A call to this method invalidates the cache (for each accessor row) of rotated
    /// uvws and delays. Nothing is done for uvw machines as UVWMachineCache takes care of this.
    /// This method is const as effectively non-const operations are only for caching purposes.
    void invalidate() const;
+
+   /// @brief change the number of tangent points cached at the same time
+   /// @details Rotated uvws and delays are cached for a number of tangent points, so
+   /// alternating access to different tangent points (e.g. for faceted imaging) within one
+   /// chunk doesn't require recalculation. When the cache is full, the entry filled earliest
+   /// is replaced. The cache is invalidated by this call and references obtained earlier
+   /// are no longer valid.
+   /// @param[in] nTangentPoints a number of tangent points (should be positive)
+   void setTangentPointCacheSize(size_t nTangentPoints);
+
+   /// @brief number of tangent points cached at the same time
+   /// @return a number of tangent points
+   inline size_t tangentPointCacheSize() const { return itsEntries.size(); }
+
+   /// @brief memory used by the cache of rotated uvws and delays
+   /// @details Only the buffers filled for the current chunk are counted.
+   /// @return memory in bytes
+   size_t memoryUsage() const;
    
    /// @brief obtain rotated uvws
    /// @details
@@ -80,10 +117,29 @@ struct UVWRotationHandler : protected UVWMachineCache {
    const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& uvw(const IConstDataAccessor &acc, 
                const casacore::MDirection &tangent) const;
 
+   /// @brief obtain rotated uvws stored as separate arrays of u, v and w
+   /// @details This is the same information as returned by uvw(), both representations
+   /// are filled at the same time and are valid until invalidate is called.
+   /// @param[in] acc const reference to the input accessor (need phase centre info, uvw, etc)
+   /// @param[in] tangent direction to the tangent point
+   /// @return const reference to rotated uvw components
+   const UVWComponents<casacore::Double>& uvwComponents(const IConstDataAccessor &acc,
+               const casacore::MDirection &tangent) const;
+
+   /// @brief obtain rotated uvws stored as separate arrays of u, v and w in single precision
+   /// @details The single precision copy is made from the double precision components on demand
+   /// and cached until the rotated uvws are recalculated.
+   /// @param[in] acc const reference to the input accessor (need phase centre info, uvw, etc)
+   /// @param[in] tangent direction to the tangent point
+   /// @return const reference to rotated uvw components
+   const UVWComponents<casacore::Float>& uvwComponentsFloat(const IConstDataAccessor &acc,
+               const casacore::MDirection &tangent) const;
+
    /// @brief obtain delays corresponding to rotation
    /// @details
    /// Use parameters in the given accessor to compute delays. This method calls rotatedUVWs and does
    /// some extra job on the delays if tangent != imageCentre
+   /// (the result is cached separately for each image centre until invalidate is called)
    /// @param[in] acc const reference to the input accessor (need phase centre info, uvw, etc)
    /// @param[in] tangent direction to the tangent point
    /// @param[in] imageCentre direction to the image centre
@@ -92,34 +148,129 @@ struct UVWRotationHandler : protected UVWMachineCache {
    /// is called explicitly when recalculation is needed (i.e. iterator moved to the next iteration, etc)
    const casacore::Vector<casacore::Double>& delays(const IConstDataAccessor &acc, 
                const casacore::MDirection &tangent, const casacore::MDirection &imageCentre) const;
-                  
+
+protected:
+   /// @brief linear transform applied to all rows with the same pointing direction
+   /// @details Rotated uvw and the associated delay are linear functions of the input uvw.
+   /// The transform is obtained from the uvw machine once per pointing direction, so the rows
+   /// can be processed in blocks without calling the machine for each row.
+   struct RotationGroup {
+      /// @brief rotation matrix (row-major) applied to the input uvw
+      casacore::Double itsMatrix[9];
+      /// @brief coefficients for the delay (dot product with the input uvw)
+      casacore::Double itsDelay[3];
+   };
+
+   /// @brief contiguous block of rows sharing the same transform
+   struct RotationBlock {
+      /// @brief construct an empty block
+      /// @param[in] start first row of the block
+      /// @param[in] group index of the transform
+      RotationBlock(casacore::uInt start, casacore::uInt group) : itsStartRow(start), itsNRows(0), itsGroup(group) {}
+      /// @brief first row of the block
+      casacore::uInt itsStartRow;
+      /// @brief number of rows in the block
+      casacore::uInt itsNRows;
+      /// @brief index of the transform
+      casacore::uInt itsGroup;
+   };
+
+   /// @brief set up the linear transform for the given uvw machine
+   /// @details The machine is applied to unit vectors along each axis (with the sign convention
+   /// used for uvw rotation in this class), which gives columns of the rotation matrix and
+   /// the delay coefficients.
+   /// @param[in] machine uvw machine
+   /// @param[out] group transform to set up
+   static void setUpGroup(const machineType &machine, RotationGroup &group);
+
+   /// @brief apply the transform to a block of rows
+   /// @details The loop has no branches and no calls, so it can be vectorised by the compiler.
+   /// @param[in] group transform to apply
+   /// @param[in] in input uvw for the first row of the block
+   /// @param[in] nRows number of rows in the block
+   /// @param[out] out rotated uvw
+   /// @param[out] u rotated u-coordinates
+   /// @param[out] v rotated v-coordinates
+   /// @param[out] w rotated w-coordinates
+   /// @param[out] delay delays associated with the rotation
+   static void rotateBlock(const RotationGroup &group, const casacore::RigidVector<casacore::Double, 3> *in,
+               casacore::uInt nRows, casacore::RigidVector<casacore::Double, 3> *out,
+               casacore::Double *u, casacore::Double *v, casacore::Double *w, casacore::Double *delay);
+
 private:
-   /// @brief rotated uvw coordinates
-   mutable casacore::Vector<casacore::RigidVector<casacore::Double, 3> > itsRotatedUVWs;
-   
-   /// @brief internal buffer for delay associated with uvw rotation
-   mutable casacore::Vector<casacore::Double> itsDelays;
-   
-   /// @brief flag that rotated uvws and delays are up to date
-   /// @details If this field is uptodate itsDelays contain some valid information too.
-   mutable bool itsValid;
+   /// @brief maximum number of rows in one block
+   static const casacore::uInt theirMaxBlockSize = 1024;
+
+   /// @brief minimum number of rows for the blocks to be distributed between threads
+   static const casacore::uInt theirMinRowsForThreads = 8192;
+
+   /// @brief delays for an image centre different from the tangent point
+   struct ShiftedDelays {
+      /// @brief image centre used to calculate the delays
+      casacore::MDirection itsImageCentre;
+
+      /// @brief delays including the translation to the image centre
+      casacore::Vector<casacore::Double> itsDelays;
+   };
+
+   /// @brief rotated uvws and delays for one tangent point
+   struct RotatedUVWEntry {
+      /// @brief construct an invalid entry
+      RotatedUVWEntry() : itsFloatValid(false), itsValid(false) {}
+
+      /// @brief rotated uvw coordinates
+      casacore::Vector<casacore::RigidVector<casacore::Double, 3> > itsRotatedUVWs;
+
+      /// @brief rotated uvw coordinates stored as separate arrays of u, v and w
+      UVWComponents<casacore::Double> itsRotatedUVWComponents;
+
+      /// @brief single precision copy of the rotated uvw components
+      UVWComponents<casacore::Float> itsRotatedUVWComponentsFloat;
+
+      /// @brief flag that the single precision copy of the rotated uvws is up to date
+      /// @details It is only true if itsValid is true as well.
+      bool itsFloatValid;
+
+      /// @brief delays associated with uvw rotation
+      casacore::Vector<casacore::Double> itsDelays;
+
+      /// @brief flag that rotated uvws and delays are up to date
+      bool itsValid;
+
+      /// @brief tangent point for which this entry is valid
+      casacore::MDirection itsTangentPoint;
+
+      /// @brief current image centre used to calculate delays
+      /// @details
+      /// If the image centre changes (and is different from tangent point), an additional translation
+      /// in the tangent plane is needed for the faceting to work. This is equivalent to uvw-dependent
+      /// delay. The delays method adds an extra delay if necessary. Theoretically, the image centre can
+      /// be changed any number of times without recomputing delays. Although if the number of changes
+      /// is too large some round-off errors may accumulate as we just add some extra delay to the
+      /// cache following every change to this field.
+      casacore::MDirection itsImageCentre;
+   };
+
+   /// @brief find the entry for the given tangent point
+   /// @details The caller is expected to hold the lock.
+   /// @param[in] tangent direction to the tangent point
+   /// @return index of the valid entry or the cache size, if the tangent point is not cached
+   size_t findEntry(const casacore::MDirection &tangent) const;
+
+   /// @brief obtain the entry filled by uvw for the given tangent point
+   /// @details The caller is expected to hold the lock.
+   /// @param[in] tangent direction to the tangent point
+   /// @return reference to the entry
+   RotatedUVWEntry& filledEntry(const casacore::MDirection &tangent) const;
+
+   /// @brief cached rotated uvws and delays, one entry per tangent point
+   /// @details The vector is only resized in setTangentPointCacheSize, so references to
+   /// the buffers of an entry stay valid until the entry is replaced or invalidated.
+   mutable std::vector<RotatedUVWEntry> itsEntries;
+
+   /// @brief index of the entry to be replaced when the cache is full
+   mutable size_t itsNextEntry;
 
-   /// @brief tangnet point for which this cache is valid
-   /// @details
-   /// Rotation depends on the tangent point. Cache of UVW Machines returns the appropriate machine,
-   /// but we also have to recompute the cache of results of it changes.
-   mutable casacore::MDirection itsTangentPoint;
-   
-   /// @brief current image centre used to calculate delays
-   /// @details
-   /// If the image centre changes (and is different from tangent point), an additional translation
-   /// in the tangent plane is needed for the faceting to work. This is equivalent to uvw-dependent
-   /// delay. This method adds an extra delay if necessary. Theoretically, the image centre can
-   /// be changed any number of times without recomputing delays. Although if the number of changes
-   /// is too large some round-off errors may accumulate as we just add some extra delay to the
-   /// cache following every change to this field.
-   mutable casacore::MDirection itsImageCentre;
-   
 #ifdef _OPENMP
    /// @brief mutex to synchronise cache access for all threads 
    mutable boost::shared_mutex itsMutex;
@@ -0,0 +1,290 @@
+/// @file WPlaneSchedule.cc
+/// @brief precomputed schedule of the best fit w-planes
+/// @details For a fixed array tracking a fixed direction, the best fit plane w=Au+Bv is a
+/// deterministic function of time (i.e. hour angle). This class predicts the plane
+/// coefficients from the antenna layout and the tangent point for the whole observation
+/// and splits it into validity windows, each with a single plane keeping the w-term
+/// deviation within the tolerance. It is used by BestWPlaneDataAccessor to avoid the
+/// fit for each chunk and allows imagers to plan the regridding ahead of time.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#include <askap_accessors.h>
+
+// std includes
+#include <cmath>
+
+// ASKAPsoft includes
+#include <askap/askap/AskapError.h>
+#include <askap/askap/AskapLogging.h>
+#include <casacore/casa/BasicSL/Constants.h>
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/measures/Measures/MeasFrame.h>
+#include <casacore/measures/Measures/MEpoch.h>
+#include <casacore/measures/Measures/MPosition.h>
+#include <casacore/measures/Measures/MCDirection.h>
+#include <casacore/measures/Measures/MCPosition.h>
+
+// own includes
+#include <askap/dataaccess/WPlaneSchedule.h>
+
+ASKAP_LOGGER(logger, ".dataaccess");
+
+using namespace askap;
+using namespace askap::accessors;
+
+namespace {
+
+/// @brief uvw frame at one time sample
+/// @details Unit vectors along u, v and w in the Earth-fixed frame
+struct UVWFrame {
+  /// @brief u-axis
+  double itsU[3];
+  /// @brief v-axis
+  double itsV[3];
+  /// @brief w-axis (direction to the tangent point)
+  double itsW[3];
+};
+
+/// @brief dot product of two 3-element vectors
+/// @param[in] a first vector
+/// @param[in] b second vector
+/// @return dot product
+inline double dot(const double *a, const double *b)
+{
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+/// @brief quadratic form with the symmetric 3x3 matrix
+/// @param[in] a first vector
+/// @param[in] matrix matrix (row-major)
+/// @param[in] b second vector
+/// @return a^T matrix b
+inline double quadraticForm(const double *a, const double *matrix, const double *b)
+{
+  double result = 0.;
+  for (int row = 0; row < 3; ++row) {
+       result += a[row] * dot(matrix + 3 * row, b);
+  }
+  return result;
+}
+
+/// @brief fit the plane for the given time sample
+/// @details The sums of the least-squares problem for all baselines are quadratic forms
+/// of the covariance matrix of the baseline vectors.
+/// @param[in] frame uvw frame for the time sample
+/// @param[in] covariance covariance matrix of the baseline vectors (row-major)
+/// @param[out] coeffA fit coefficient A
+/// @param[out] coeffB fit coefficient B
+/// @return false if the determinant is too close to zero (the coefficients are not changed in this case)
+bool fitPlane(const UVWFrame &frame, const double *covariance, double &coeffA, double &coeffB)
+{
+  const double su2 = quadraticForm(frame.itsU, covariance, frame.itsU);
+  const double sv2 = quadraticForm(frame.itsV, covariance, frame.itsV);
+  const double suv = quadraticForm(frame.itsU, covariance, frame.itsV);
+  const double suw = quadraticForm(frame.itsU, covariance, frame.itsW);
+  const double svw = quadraticForm(frame.itsV, covariance, frame.itsW);
+  // same threshold as used by BestWPlaneDataAccessor
+  const double D = su2 * sv2 - suv * suv;
+  if (fabs(D) < 1e-7) {
+      return false;
+  }
+  coeffA = (sv2 * suw - suv * svw) / D;
+  coeffB = (su2 * svw - suv * suw) / D;
+  return true;
+}
+
+/// @brief the largest deviation of the w-term from the plane for all baselines
+/// @details The deviation for a baseline is the difference of projections of the two antenna
+/// positions on the same vector, so the largest deviation is the range of these projections.
+/// @param[in] frame uvw frame for the time sample
+/// @param[in] positions antenna positions relative to their mean (3 elements per antenna)
+/// @param[in] coeffA fit coefficient A
+/// @param[in] coeffB fit coefficient B
+/// @return the largest deviation in metres
+double maxDeviation(const UVWFrame &frame, const std::vector<double> &positions, double coeffA, double coeffB)
+{
+  double normal[3];
+  for (int dim = 0; dim < 3; ++dim) {
+       normal[dim] = frame.itsW[dim] - coeffA * frame.itsU[dim] - coeffB * frame.itsV[dim];
+  }
+  double minProj = 0., maxProj = 0.;
+  for (size_t ant = 0; ant < positions.size() / 3; ++ant) {
+       const double proj = dot(normal, &positions[3 * ant]);
+       if ((ant == 0) || (proj < minProj)) {
+           minProj = proj;
+       }
+       if ((ant == 0) || (proj > maxProj)) {
+           maxProj = proj;
+       }
+  }
+  return maxProj - minProj;
+}
+
+} // anonymous namespace
+
+/// @brief compute the schedule
+/// @param[in] antennas antenna subtable handler (all antennas are used)
+/// @param[in] tangent tangent point (uvw are rotated to this direction)
+/// @param[in] startTime start of the observation (seconds since MJD 0, UTC)
+/// @param[in] stopTime end of the observation (seconds since MJD 0, UTC)
+/// @param[in] tolerance w-term tolerance in wavelengths
+/// @param[in] maxFrequency the largest frequency in Hz (to convert the tolerance into metres)
+/// @param[in] timeStep time step in seconds to sample the geometry
+WPlaneSchedule::WPlaneSchedule(const IAntennaSubtableHandler &antennas, const casacore::MDirection &tangent,
+                 double startTime, double stopTime, double tolerance, double maxFrequency, double timeStep)
+{
+  ASKAPCHECK(stopTime >= startTime, "The end of the observation ("<<stopTime<<
+             ") should not precede its start ("<<startTime<<")");
+  ASKAPCHECK(timeStep > 0., "Time step should be positive, you have "<<timeStep);
+  ASKAPCHECK(maxFrequency > 0., "Frequency should be positive, you have "<<maxFrequency);
+  const double tolInMetres = tolerance * casacore::C::c / maxFrequency;
+  const casacore::uInt nAnt = antennas.getNumberOfAntennas();
+  ASKAPCHECK(nAnt > 0, "At least one antenna is required to compute the w-plane schedule");
+
+  // antenna positions in the Earth-fixed frame relative to their mean
+  std::vector<double> positions(3 * nAnt);
+  double mean[3] = {0., 0., 0.};
+  for (casacore::uInt ant = 0; ant < nAnt; ++ant) {
+       const casacore::Vector<casacore::Double> xyz = casacore::MPosition::Convert(antennas.getPosition(ant),
+                 casacore::MPosition::Ref(casacore::MPosition::ITRF))().getValue().getValue();
+       for (int dim = 0; dim < 3; ++dim) {
+            positions[3 * ant + dim] = xyz[dim];
+            mean[dim] += xyz[dim] / nAnt;
+       }
+  }
+  for (casacore::uInt ant = 0; ant < nAnt; ++ant) {
+       for (int dim = 0; dim < 3; ++dim) {
+            positions[3 * ant + dim] -= mean[dim];
+       }
+  }
+  // the sum of b*b^T over all baselines is nAnt times the sum over antennas relative to the mean
+  double covariance[9];
+  for (int row = 0; row < 3; ++row) {
+       for (int col = 0; col < 3; ++col) {
+            double sum = 0.;
+            for (casacore::uInt ant = 0; ant < nAnt; ++ant) {
+                 sum += positions[3 * ant + row] * positions[3 * ant + col];
+            }
+            covariance[3 * row + col] = nAnt * sum;
+       }
+  }
+
+  // uvw frame for each time sample, the last sample is at the end of the observation
+  const size_t nSamples = size_t(ceil((stopTime - startTime) / timeStep)) + 1;
+  std::vector<double> times(nSamples);
+  std::vector<UVWFrame> frames(nSamples);
+  const casacore::MPosition refPosition(casacore::MVPosition(mean[0], mean[1], mean[2]), casacore::MPosition::ITRF);
+  casacore::MeasFrame measFrame(casacore::MEpoch(casacore::MVEpoch(startTime / 86400.), casacore::MEpoch::UTC),
+                                refPosition);
+  casacore::MDirection::Convert converter(tangent.getRef(),
+                                casacore::MDirection::Ref(casacore::MDirection::ITRF, measFrame));
+  for (size_t sample = 0; sample < nSamples; ++sample) {
+       times[sample] = sample + 1 < nSamples ? startTime + sample * timeStep : stopTime;
+       measFrame.resetEpoch(casacore::MEpoch(casacore::MVEpoch(times[sample] / 86400.), casacore::MEpoch::UTC));
+       const casacore::Vector<casacore::Double> dir = converter(tangent.getValue()).getValue().getValue();
+       // v-axis is towards the pole of the frame of the tangent point
+       const casacore::Vector<casacore::Double> pole = converter(casacore::MVDirection(0., 0., 1.)).getValue().getValue();
+       UVWFrame &frame = frames[sample];
+       for (int dim = 0; dim < 3; ++dim) {
+            frame.itsW[dim] = dir[dim];
+       }
+       frame.itsU[0] = pole[1] * dir[2] - pole[2] * dir[1];
+       frame.itsU[1] = pole[2] * dir[0] - pole[0] * dir[2];
+       frame.itsU[2] = pole[0] * dir[1] - pole[1] * dir[0];
+       const double norm = sqrt(dot(frame.itsU, frame.itsU));
+       ASKAPCHECK(norm > 0., "The tangent point is too close to the pole, unable to define the uvw frame");
+       for (int dim = 0; dim < 3; ++dim) {
+            frame.itsU[dim] /= norm;
+       }
+       frame.itsV[0] = frame.itsW[1] * frame.itsU[2] - frame.itsW[2] * frame.itsU[1];
+       frame.itsV[1] = frame.itsW[2] * frame.itsU[0] - frame.itsW[0] * frame.itsU[2];
+       frame.itsV[2] = frame.itsW[0] * frame.itsU[1] - frame.itsW[1] * frame.itsU[0];
+  }
+
+  // split the observation into windows
+  double coeffA = 0.;
+  double coeffB = 0.;
+  size_t first = 0;
+  while (true) {
+     fitPlane(frames[first], covariance, coeffA, coeffB);
+     // move the fit time ahead while the deviation at the start of the window is within the tolerance
+     size_t centre = first;
+     for (size_t sample = first + 1; sample < nSamples; ++sample) {
+          double testA = coeffA;
+          double testB = coeffB;
+          if (!fitPlane(frames[sample], covariance, testA, testB) ||
+              (maxDeviation(frames[first], positions, testA, testB) > tolInMetres)) {
+              break;
+          }
+          coeffA = testA;
+          coeffB = testB;
+          centre = sample;
+     }
+     // the plane is used while the deviation is within the tolerance
+     size_t last = centre;
+     while ((last + 1 < nSamples) && (maxDeviation(frames[last + 1], positions, coeffA, coeffB) <= tolInMetres)) {
+            ++last;
+     }
+     const size_t next = last > first ? last : first + 1;
+     Window window;
+     window.itsStart = times[first];
+     window.itsStop = next < nSamples ? times[next] : stopTime;
+     window.itsCoeffA = coeffA;
+     window.itsCoeffB = coeffB;
+     itsWindows.push_back(window);
+     // the last sample is the end of the observation, it is included in the last window
+     if (next + 1 >= nSamples) {
+         break;
+     }
+     first = next;
+  }
+  ASKAPLOG_DEBUG_STR(logger, "W-plane schedule: "<<itsWindows.size()<<" plane(s) for "<<(stopTime - startTime)<<
+                     " seconds of observation, tolerance "<<tolInMetres<<" metres");
+}
+
+/// @brief find the validity window for the given time
+/// @param[in] time time in seconds since MJD 0 (UTC)
+/// @return window index or size() if the time is outside the schedule
+size_t WPlaneSchedule::find(double time) const
+{
+  ASKAPDEBUGASSERT(itsWindows.size() > 0);
+  if ((time < itsWindows.front().itsStart) || (time > itsWindows.back().itsStop)) {
+      return itsWindows.size();
+  }
+  // binary search for the first window ending after the given time
+  size_t low = 0;
+  size_t high = itsWindows.size() - 1;
+  while (low < high) {
+     const size_t middle = (low + high) / 2;
+     if (itsWindows[middle].itsStop > time) {
+         high = middle;
+     } else {
+         low = middle + 1;
+     }
+  }
+  return low;
+}
@@ -0,0 +1,137 @@
+/// @file WPlaneSchedule.h
+/// @brief precomputed schedule of the best fit w-planes
+/// @details For a fixed array tracking a fixed direction, the best fit plane w=Au+Bv is a
+/// deterministic function of time (i.e. hour angle). This class predicts the plane
+/// coefficients from the antenna layout and the tangent point for the whole observation
+/// and splits it into validity windows, each with a single plane keeping the w-term
+/// deviation within the tolerance. It is used by BestWPlaneDataAccessor to avoid the
+/// fit for each chunk and allows imagers to plan the regridding ahead of time.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+///
+
+#ifndef ASKAP_ACCESSORS_W_PLANE_SCHEDULE_H
+#define ASKAP_ACCESSORS_W_PLANE_SCHEDULE_H
+
+// std includes
+#include <vector>
+
+// boost includes
+#include <boost/noncopyable.hpp>
+
+// casa includes
+#include <casacore/casa/aips.h>
+#include <casacore/measures/Measures/MDirection.h>
+
+// own includes
+#include <askap/dataaccess/IAntennaSubtableHandler.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief precomputed schedule of the best fit w-planes
+/// @details The geometry is sampled with the given time step. For each sample, the uvw
+/// frame of the tangent point is obtained in the Earth-fixed (ITRF) frame, with the v-axis
+/// towards the pole of the frame of the tangent point (as uvw are rotated by the accessor).
+/// As uvw are linear in the baseline vector, the sums of the least-squares problem for all
+/// baselines and the largest deviation from a plane are obtained from the antenna positions
+/// alone (i.e. the cost doesn't depend on the number of baselines). Like the predictive mode of
+/// BestWPlaneDataAccessor, each plane is chosen to be the best fit at the latest time for which
+/// the deviation at the start of the window is still within the tolerance, so the deviation
+/// decreases first and then grows to the tolerance again by the end of the window.
+/// The schedule is immutable after construction and can be shared between adapters.
+/// @note The model ignores the effects not captured by the rigid rotation of the array
+/// (e.g. the difference between the pointing directions of the beams). The adapter checks
+/// the actual deviation and fits a new plane if the scheduled one is not good enough.
+/// @ingroup dataaccess
+class WPlaneSchedule : private boost::noncopyable {
+public:
+  /// @brief compute the schedule
+  /// @param[in] antennas antenna subtable handler (all antennas are used)
+  /// @param[in] tangent tangent point (uvw are rotated to this direction)
+  /// @param[in] startTime start of the observation (seconds since MJD 0, UTC)
+  /// @param[in] stopTime end of the observation (seconds since MJD 0, UTC)
+  /// @param[in] tolerance w-term tolerance in wavelengths
+  /// @param[in] maxFrequency the largest frequency in Hz (to convert the tolerance into metres)
+  /// @param[in] timeStep time step in seconds to sample the geometry
+  WPlaneSchedule(const IAntennaSubtableHandler &antennas, const casacore::MDirection &tangent,
+                 double startTime, double stopTime, double tolerance, double maxFrequency,
+                 double timeStep = 10.);
+
+  /// @brief number of validity windows
+  /// @return number of windows (at least one)
+  inline size_t size() const { return itsWindows.size(); }
+
+  /// @brief start of the validity window
+  /// @param[in] window window index
+  /// @return start time in seconds since MJD 0 (UTC)
+  inline double startTime(size_t window) const { return itsWindows[window].itsStart; }
+
+  /// @brief end of the validity window
+  /// @details The window includes its start but not the end (except for the last window)
+  /// @param[in] window window index
+  /// @return end time in seconds since MJD 0 (UTC)
+  inline double stopTime(size_t window) const { return itsWindows[window].itsStop; }
+
+  /// @brief plane coefficient A for the validity window
+  /// @details We fit w=Au+Bv, this method returns the coefficient A
+  /// @param[in] window window index
+  /// @return fit coefficient A
+  inline double coeffA(size_t window) const { return itsWindows[window].itsCoeffA; }
+
+  /// @brief plane coefficient B for the validity window
+  /// @details We fit w=Au+Bv, this method returns the coefficient B
+  /// @param[in] window window index
+  /// @return fit coefficient B
+  inline double coeffB(size_t window) const { return itsWindows[window].itsCoeffB; }
+
+  /// @brief find the validity window for the given time
+  /// @param[in] time time in seconds since MJD 0 (UTC)
+  /// @return window index or size() if the time is outside the schedule
+  size_t find(double time) const;
+
+private:
+  /// @brief validity window of a plane
+  struct Window {
+    /// @brief start time
+    double itsStart;
+    /// @brief end time
+    double itsStop;
+    /// @brief fit coefficient A
+    double itsCoeffA;
+    /// @brief fit coefficient B
+    double itsCoeffB;
+  };
+
+  /// @brief validity windows in the order of time
+  std::vector<Window> itsWindows;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_W_PLANE_SCHEDULE_H
@@ -43,6 +43,40 @@ namespace askap {
 
 namespace accessors {
 
+/// @brief helper class giving access to the plane subtraction of BestWPlaneDataAccessor
+struct PlaneSubtractionTester : public BestWPlaneDataAccessor {
+  /// @brief constructor
+  /// @param[in] tolerance w-term tolerance in wavelengths
+  explicit PlaneSubtractionTester(const double tolerance) : BestWPlaneDataAccessor(tolerance) {}
+
+  /// @brief subtract the current plane and fit a new one in a single pass
+  /// @param[in] uvw a vector with uvw's
+  /// @param[out] coeffA fit coefficient A
+  /// @param[out] coeffB fit coefficient B
+  /// @return the largest w-term deviation from the current plane
+  double fusedPass(const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& uvw,
+                   double &coeffA, double &coeffB) const {
+     PlaneFitSums sums;
+     const double maxDeviation = subtractPlane(uvw, sums);
+     CPPUNIT_ASSERT(sums.solve(coeffA, coeffB));
+     return maxDeviation;
+  }
+
+  /// @brief get the largest deviation from the current plane and fit a new one in separate passes
+  /// @param[in] uvw a vector with uvw's
+  /// @param[out] coeffA fit coefficient A
+  /// @param[out] coeffB fit coefficient B
+  /// @return the largest w-term deviation from the current plane
+  double twoPasses(const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& uvw,
+                   double &coeffA, double &coeffB) const {
+     const double maxDeviation = maxWDeviation(uvw);
+     PlaneFitSums sums;
+     accumulateFit(uvw, sums);
+     CPPUNIT_ASSERT(sums.solve(coeffA, coeffB));
+     return maxDeviation;
+  }
+};
+
 class DataAccessorAdapterTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(DataAccessorAdapterTest);
   CPPUNIT_TEST(onDemandBufferDATest);
@@ -53,6 +87,7 @@ class DataAccessorAdapterTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(daAdapterConstTest);
   CPPUNIT_TEST_EXCEPTION(daAdapterNonConstTest, AskapError);
   CPPUNIT_TEST(bestWPlaneAdapterTest);
+  CPPUNIT_TEST(fusedPlaneSubtractionTest);
   CPPUNIT_TEST_EXCEPTION(nonCoplanarTest, AskapError);
   CPPUNIT_TEST(noiseAdapterTest);
   CPPUNIT_TEST(flagAdapterTest);
@@ -242,6 +277,64 @@ public:
       CPPUNIT_ASSERT_DOUBLES_EQUAL(-3.7, acc2.coeffA(), 1e-7);
       CPPUNIT_ASSERT_DOUBLES_EQUAL(-0.05, acc2.coeffB(), 1e-7);
       CPPUNIT_ASSERT(cm != acc2.planeChangeMonitor());
+      // separate arrays of u, v and w should match rotatedUVW
+      const casacore::MDirection fakeTangent(acc.dishPointing1()[0], casacore::MDirection::J2000);
+      const UVWComponents<casacore::Double> &uvwComp = acc2.rotatedUVWComponents(fakeTangent);
+      const UVWComponents<casacore::Float> &uvwCompFloat = acc2.rotatedUVWComponentsFloat(fakeTangent);
+      const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& uvw = acc2.rotatedUVW(fakeTangent);
+      CPPUNIT_ASSERT_EQUAL(acc2.nRow(), uvwComp.nelements());
+      CPPUNIT_ASSERT_EQUAL(acc2.nRow(), uvwCompFloat.nelements());
+      for (casacore::uInt row=0; row<acc2.nRow(); ++row) {
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(uvw[row](0), uvwComp.u()[row], 1e-7);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(uvw[row](1), uvwComp.v()[row], 1e-7);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(uvw[row](2), uvwComp.w()[row], 1e-7);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(uvw[row](0), uvwCompFloat.u()[row], 1e-3);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(uvw[row](1), uvwCompFloat.v()[row], 1e-3);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(uvw[row](2), uvwCompFloat.w()[row], 1e-3);
+      }
+  }
+  
+  /// @brief subtraction of the plane and the fit done in a single pass should match separate passes
+  void fusedPlaneSubtractionTest() {
+      DataAccessorStub acc(true);
+      makeCoplanar(acc, 1.3, -0.4);
+      PlaneSubtractionTester acc2(1);
+      acc2.associate(acc);
+      // the plane is fitted here
+      testZeroW(acc2);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(1.3, acc2.coeffA(), 1e-7);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(-0.4, acc2.coeffB(), 1e-7);
+      // a different, slightly non-coplanar layout
+      makeCoplanar(acc, -0.7, 0.5);
+      for (casacore::uInt row=0; row<acc.nRow(); ++row) {
+           acc.itsUVW[row](2) += 0.01 * (double(row % 3) - 1.);
+      }
+      double fusedA = 0., fusedB = 0., twoPassA = 0., twoPassB = 0.;
+      const double twoPassDeviation = acc2.twoPasses(acc.itsUVW, twoPassA, twoPassB);
+      const double fusedDeviation = acc2.fusedPass(acc.itsUVW, fusedA, fusedB);
+      CPPUNIT_ASSERT(fusedDeviation > 0.1);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(twoPassDeviation, fusedDeviation, 1e-9 * twoPassDeviation);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(twoPassA, fusedA, 1e-9);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(twoPassB, fusedB, 1e-9);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(-0.7, fusedA, 1e-2);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, fusedB, 1e-2);
+      // the plane subtracted by the fused pass is the current one, the coefficients are not changed
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(1.3, acc2.coeffA(), 1e-7);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(-0.4, acc2.coeffB(), 1e-7);
+      // the buffers are filled by the fused pass (the stub hasn't been associated again, so
+      // they are not recalculated)
+      const casacore::MDirection fakeTangent(acc.dishPointing1()[0], casacore::MDirection::J2000);
+      const casacore::Vector<casacore::RigidVector<casacore::Double, 3> >& uvw = acc2.rotatedUVW(fakeTangent);
+      const UVWComponents<casacore::Double> &uvwComp = acc2.rotatedUVWComponents(fakeTangent);
+      CPPUNIT_ASSERT_EQUAL(acc.nRow(), uvw.nelements());
+      CPPUNIT_ASSERT_EQUAL(acc.nRow(), uvwComp.nelements());
+      for (casacore::uInt row=0; row<acc.nRow(); ++row) {
+           const double expectedW = acc.itsUVW[row](2) - 1.3 * acc.itsUVW[row](0) + 0.4 * acc.itsUVW[row](1);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(acc.itsUVW[row](0), uvw[row](0), 1e-7);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(acc.itsUVW[row](1), uvw[row](1), 1e-7);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedW, uvw[row](2), 1e-7);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedW, uvwComp.w()[row], 1e-7);
+      }
   }
   
   void nonCoplanarTest() 
@@ -61,6 +61,7 @@ class DataConverterTest : public CppUnit::TestFixture {
    CPPUNIT_TEST_SUITE(DataConverterTest);
    CPPUNIT_TEST(testEpochConversion);
    CPPUNIT_TEST(testDirectionConversion);
+   CPPUNIT_TEST(testBatchDirectionConversion);
    CPPUNIT_TEST_EXCEPTION(testMissingFrame,std::exception);
    CPPUNIT_TEST(testFrequencyConversion);
    CPPUNIT_TEST(testVelocityConversion);
@@ -144,6 +145,41 @@ public:
     CPPUNIT_ASSERT(result.separation(direction)<1e-7);
    }
 
+   /// test conversion of a number of directions at once
+   void testBatchDirectionConversion()
+   {
+    casacore::Vector<casacore::MVDirection> in(3);
+    in[0] = casacore::MVDirection(casacore::Quantity(30.,"deg"), casacore::Quantity(-50.,"deg"));
+    in[1] = casacore::MVDirection(casacore::Quantity(31.,"deg"), casacore::Quantity(-50.,"deg"));
+    in[2] = casacore::MVDirection(casacore::Quantity(30.,"deg"), casacore::Quantity(-49.,"deg"));
+    const casacore::MDirection::Ref j2000Ref(casacore::MDirection::J2000);
+    const casacore::MDirection::Ref galRef(casacore::MDirection::GALACTIC);
+    casacore::Vector<casacore::MVDirection> result;
+
+    // J2000 to J2000 is short-circuited and doesn't need a frame
+    itsConverter->setDirectionFrame(j2000Ref);
+    CPPUNIT_ASSERT(!itsConverter->isDirectionPositionDependent(j2000Ref));
+    CPPUNIT_ASSERT(!itsConverter->isDirectionPositionDependent(galRef));
+    itsConverter->direction(j2000Ref, in, result);
+    CPPUNIT_ASSERT_EQUAL(in.nelements(), result.nelements());
+    for (casacore::uInt elem = 0; elem < in.nelements(); ++elem) {
+         CPPUNIT_ASSERT(result[elem].separation(in[elem]) < 1e-12);
+    }
+
+    // the batch conversion should match the conversion of individual directions
+    const casacore::MeasFrame someFrame=getSomeFrame(WHERE_AND_WHEN);
+    itsConverter->setDirectionFrame(casacore::MDirection::Ref(casacore::MDirection::AZEL));
+    CPPUNIT_ASSERT(itsConverter->isDirectionPositionDependent(j2000Ref));
+    itsConverter->setMeasFrame(someFrame);
+    itsConverter->direction(j2000Ref, in, result);
+    CPPUNIT_ASSERT_EQUAL(in.nelements(), result.nelements());
+    for (casacore::uInt elem = 0; elem < in.nelements(); ++elem) {
+         casacore::MVDirection single;
+         itsConverter->direction(casacore::MDirection(in[elem], j2000Ref), single);
+         CPPUNIT_ASSERT(result[elem].separation(single) < 1e-10);
+    }
+   }
+
    /// test Frequency conversion
    void testFrequencyConversion()
    {
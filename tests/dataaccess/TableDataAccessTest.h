@@ -30,15 +30,34 @@
 
 // boost includes
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
 
 // casa includes
 #include <casacore/tables/Tables/Table.h>
 #include <casacore/tables/Tables/TableError.h>
+#include <casacore/tables/Tables/RowNumbers.h>
+#include <casacore/tables/Tables/TableDesc.h>
+#include <casacore/tables/Tables/SetupNewTab.h>
+#include <casacore/tables/Tables/ScaColDesc.h>
+#include <casacore/tables/Tables/ArrColDesc.h>
+#include <casacore/tables/Tables/ScalarColumn.h>
+#include <casacore/tables/Tables/ArrayColumn.h>
+#include <casacore/tables/Tables/TableRecord.h>
+#include <casacore/casa/Containers/Record.h>
+#include <casacore/casa/OS/Directory.h>
 #include <casacore/casa/OS/EnvVar.h>
+#include <casacore/casa/OS/File.h>
+#include <casacore/casa/Arrays/ArrayLogical.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
+#include <casacore/casa/BasicSL/Constants.h>
 
 // std includes
 #include <string>
+#include <algorithm>
 #include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
 
 // cppunit includes
 #include <cppunit/extensions/HelperMacros.h>
@@ -49,12 +68,385 @@
 #include <askap/dataaccess/TableDataSource.h>
 #include <askap/dataaccess/IConstDataSource.h>
 #include <askap/dataaccess/TableConstDataIterator.h>
+#include <askap/dataaccess/TableTimeIndex.h>
+#include <askap/dataaccess/FeedSubtableHandler.h>
+#include <askap/dataaccess/PackedFlags.h>
+#include <askap/dataaccess/UVWComponents.h>
+#include <askap/dataaccess/UVWMachineCache.h>
+#include <askap/dataaccess/UVWRotationHandler.h>
+#include <askap/dataaccess/WPlaneSchedule.h>
+#include <askap/dataaccess/BestWPlaneDataAccessor.h>
+#include <askap/dataaccess/ChannelAveraging.h>
+#include <askap/scimath/utils/PolConverter.h>
 #include "TableTestRunner.h"
 
 namespace askap {
 
 namespace accessors {
 
+/// @brief summary of one chunk used to compare iterations done in different threads
+struct ChunkSummary {
+  /// @brief time stamp of the chunk
+  casacore::Double itsTime;
+  /// @brief number of rows
+  casacore::uInt itsNRow;
+  /// @brief sum of visibility amplitudes
+  casacore::Double itsVisSum;
+  /// @brief number of flagged samples
+  size_t itsNFlagged;
+  /// @brief frequency of the first channel
+  casacore::Double itsFreq;
+  /// @brief pointing direction of the first antenna in the first row
+  casacore::MVDirection itsPointingDir;
+};
+
+/// @brief helper functor iterating over one partition in a separate thread
+/// @details All fields used in ChunkSummary are read for each chunk, so both the bulk
+/// data and the subtables are accessed. Exceptions are caught and reported via the flag,
+/// as they can't be propagated across threads.
+struct PartitionReader {
+  /// @brief constructor
+  /// @param[in] it iterator over the partition
+  /// @param[in] result vector to fill with chunk summaries
+  /// @param[in] failed flag to set if an exception is thrown
+  PartitionReader(const boost::shared_ptr<IConstDataIterator> &it, std::vector<ChunkSummary> &result,
+                  bool &failed) : itsIterator(it), itsResult(result), itsFailed(failed) {}
+
+  /// @brief iterate over the partition
+  void operator()() const {
+     try {
+        for (IConstDataSharedIter it(itsIterator); it != it.end(); ++it) {
+             ChunkSummary summary;
+             summary.itsTime = it->time();
+             summary.itsNRow = it->nRow();
+             summary.itsVisSum = casacore::sum(casacore::amplitude(it->visibility()));
+             summary.itsNFlagged = casacore::ntrue(it->flag());
+             summary.itsFreq = it->frequency()[0];
+             summary.itsPointingDir = it->pointingDir1()[0];
+             itsResult.push_back(summary);
+        }
+     }
+     catch (const std::exception &) {
+        itsFailed = true;
+     }
+  }
+private:
+  boost::shared_ptr<IConstDataIterator> itsIterator;
+  std::vector<ChunkSummary> &itsResult;
+  bool &itsFailed;
+};
+
+/// @brief compare the first chunks of two data sources
+/// @details Iterators over both data sources are stepped together and the functor is called
+/// with the accessors of each chunk. The optional selector is used for both iterators, so
+/// it should be created by the first data source (both sources may be the same object).
+/// @param[in] ds data source tested
+/// @param[in] dsRef data source giving the reference values
+/// @param[in] compare functor called with the accessor of ds and that of dsRef
+/// @param[in] sel optional selector, all rows are iterated over if it is empty
+/// @param[in] maxChunks number of chunks to compare
+template<typename Compare>
+void compareChunks(const IConstDataSource &ds, const IConstDataSource &dsRef, const Compare &compare,
+                   const IDataSelectorConstPtr &sel = IDataSelectorConstPtr(), size_t maxChunks = 5)
+{
+  IConstDataSharedIter it = sel ? ds.createConstIterator(sel) : ds.createConstIterator();
+  IConstDataSharedIter itRef = sel ? dsRef.createConstIterator(sel) : dsRef.createConstIterator();
+  for (size_t chunk = 0; (it != it.end()) && (chunk < maxChunks); ++it, ++itRef, ++chunk) {
+       CPPUNIT_ASSERT(itRef != itRef.end());
+       compare(*it, *itRef);
+  }
+}
+
+/// @brief packed flags should give the same information as the flag cube read from the table
+struct PackedFlagComparison {
+  void operator()(const IConstDataAccessor &acc, const IConstDataAccessor &ref) const {
+     const PackedFlags &flags = dynamic_cast<const TableConstDataAccessor&>(acc).packedFlag();
+     CPPUNIT_ASSERT_EQUAL(acc.nRow(), flags.nRow());
+     CPPUNIT_ASSERT_EQUAL(acc.nChannel(), flags.nChannel());
+     CPPUNIT_ASSERT_EQUAL(acc.nPol(), flags.nPol());
+     // the cube is unpacked from the bit mask here, ref reads it from the table
+     const casacore::Cube<casacore::Bool> &flagCube = acc.flag();
+     CPPUNIT_ASSERT(allEQ(flagCube, ref.flag()));
+     CPPUNIT_ASSERT_EQUAL(size_t(ntrue(flagCube)), flags.nFlagged());
+     for (casacore::uInt row = 0; row < flags.nRow(); ++row) {
+          CPPUNIT_ASSERT_EQUAL(bool(flagCube(row, 0, 0)), flags(row, 0, 0));
+     }
+  }
+};
+
+/// @brief the compact noise should match the noise cube read from the table for every channel
+struct CompactNoiseComparison {
+  void operator()(const IConstDataAccessor &acc, const IConstDataAccessor &ref) const {
+     const TableConstDataAccessor &tableAcc = dynamic_cast<const TableConstDataAccessor&>(acc);
+     if (!tableAcc.noiseSpectrallyConstant()) {
+         // the dataset has the noise given per channel
+         return;
+     }
+     const casacore::Matrix<casacore::Float> &sigma = tableAcc.compactNoise();
+     CPPUNIT_ASSERT_EQUAL(acc.nRow(), sigma.nrow());
+     CPPUNIT_ASSERT_EQUAL(acc.nPol(), sigma.ncolumn());
+     // the cube is expanded from the compact noise here, ref reads it from the table
+     const casacore::Cube<casacore::Complex> &noise = acc.noise();
+     CPPUNIT_ASSERT(allEQ(noise, ref.noise()));
+     for (casacore::uInt row = 0; row < acc.nRow(); ++row) {
+          for (casacore::uInt chan = 0; chan < acc.nChannel(); ++chan) {
+               for (casacore::uInt pol = 0; pol < acc.nPol(); ++pol) {
+                    CPPUNIT_ASSERT_DOUBLES_EQUAL(sigma(row, pol), real(noise(row, chan, pol)), 1e-6);
+                    CPPUNIT_ASSERT_DOUBLES_EQUAL(sigma(row, pol), imag(noise(row, chan, pol)), 1e-6);
+               }
+          }
+     }
+  }
+};
+
+/// @brief separate arrays of u, v and w should match uvw returned as rigid vectors
+struct UVWComponentsComparison {
+  /// @brief constructor
+  /// @param[in] dir tangent point used for the rotated uvw
+  explicit UVWComponentsComparison(const casacore::MDirection &dir) : itsDir(dir) {}
+
+  void operator()(const IConstDataAccessor &acc, const IConstDataAccessor &ref) const {
+     const TableConstDataAccessor &tableAcc = dynamic_cast<const TableConstDataAccessor&>(acc);
+     // components are read from the table here, ref reads uvw as rigid vectors
+     const UVWComponents<casacore::Double> &uvwComp = tableAcc.uvwComponents();
+     const UVWComponents<casacore::Float> &uvwCompFloat = tableAcc.uvwComponentsFloat();
+     const casacore::Vector<casacore::RigidVector<casacore::Double, 3> > &uvw = ref.uvw();
+     CPPUNIT_ASSERT_EQUAL(acc.nRow(), uvwComp.nelements());
+     CPPUNIT_ASSERT_EQUAL(acc.nRow(), uvwCompFloat.nelements());
+     for (casacore::uInt row = 0; row < acc.nRow(); ++row) {
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(uvw[row](0), uvwComp.u()[row], 1e-9);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(uvw[row](1), uvwComp.v()[row], 1e-9);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(uvw[row](2), uvwComp.w()[row], 1e-9);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(uvw[row](0), uvwCompFloat.u()[row], 1e-3);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(uvw[row](1), uvwCompFloat.v()[row], 1e-3);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(uvw[row](2), uvwCompFloat.w()[row], 1e-3);
+     }
+     // rotated uvw components are filled together with rotatedUVW
+     const UVWComponents<casacore::Double> &rotComp = tableAcc.rotatedUVWComponents(itsDir);
+     const casacore::Vector<casacore::RigidVector<casacore::Double, 3> > &rotUVW = ref.rotatedUVW(itsDir);
+     CPPUNIT_ASSERT_EQUAL(acc.nRow(), rotComp.nelements());
+     for (casacore::uInt row = 0; row < acc.nRow(); ++row) {
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(rotUVW[row](0), rotComp.u()[row], 1e-6);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(rotUVW[row](1), rotComp.v()[row], 1e-6);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(rotUVW[row](2), rotComp.w()[row], 1e-6);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(rotUVW[row](2), tableAcc.rotatedUVWComponentsFloat(itsDir).w()[row], 1e-3);
+     }
+  }
+private:
+  casacore::MDirection itsDir;
+};
+
+/// @brief fields of the reduced footprint mode should match those read in the normal mode
+struct ReducedFootprintComparison {
+  void operator()(const IConstDataAccessor &acc, const IConstDataAccessor &ref) const {
+     const TableConstDataAccessor &tableAcc = dynamic_cast<const TableConstDataAccessor&>(acc);
+     // ref is the normal mode accessor, all fields are read with full precision
+     const casacore::Vector<casacore::Float> &freq = tableAcc.frequencyFloat();
+     CPPUNIT_ASSERT_EQUAL(ref.nChannel(), freq.nelements());
+     for (casacore::uInt chan = 0; chan < freq.nelements(); ++chan) {
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(1., freq[chan] / ref.frequency()[chan], 1e-6);
+     }
+     const UVWComponents<casacore::Float> &uvw = tableAcc.uvwComponentsFloat();
+     CPPUNIT_ASSERT_EQUAL(ref.nRow(), uvw.nelements());
+     for (casacore::uInt row = 0; row < uvw.nelements(); ++row) {
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(ref.uvw()[row](0), uvw.u()[row], 1e-3);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(ref.uvw()[row](1), uvw.v()[row], 1e-3);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(ref.uvw()[row](2), uvw.w()[row], 1e-3);
+     }
+     const casacore::Cube<casacore::Float> &noise = tableAcc.noiseReal();
+     CPPUNIT_ASSERT(noise.shape() == ref.noise().shape());
+     CPPUNIT_ASSERT(allEQ(noise, real(ref.noise())));
+     // flags are held as a bit mask in the read-ahead buffer
+     const PackedFlags &flags = tableAcc.packedFlag();
+     CPPUNIT_ASSERT_EQUAL(ref.nRow(), flags.nRow());
+     CPPUNIT_ASSERT(allEQ(acc.flag(), ref.flag()));
+     CPPUNIT_ASSERT_EQUAL(size_t(ntrue(ref.flag())), flags.nFlagged());
+  }
+};
+
+/// @brief rotated uvw and delays should match the result of the uvw machine applied to each row
+struct UVWRotationComparison {
+  /// @brief constructor
+  /// @param[in] dir tangent point and image centre
+  explicit UVWRotationComparison(const casacore::MDirection &dir) : itsDir(dir) {}
+
+  void operator()(const IConstDataAccessor &acc, const IConstDataAccessor &ref) const {
+     // uvw and pointing directions are taken from ref, which doesn't rotate anything
+     const casacore::Vector<casacore::RigidVector<casacore::Double, 3> > &uvw = ref.uvw();
+     const casacore::Vector<casacore::RigidVector<casacore::Double, 3> > &rotUVW = acc.rotatedUVW(itsDir);
+     const casacore::Vector<casacore::Double> &delays = acc.uvwRotationDelay(itsDir, itsDir);
+     CPPUNIT_ASSERT_EQUAL(acc.nRow(), rotUVW.nelements());
+     CPPUNIT_ASSERT_EQUAL(acc.nRow(), delays.nelements());
+     casacore::Vector<casacore::Double> buf(3);
+     for (casacore::uInt row = 0; row < acc.nRow(); ++row) {
+          // the sign convention is the same as in UVWRotationHandler
+          const casacore::MDirection pointingDir(ref.pointingDir1()[row], casacore::MDirection::J2000);
+          const UVWMachineCache::machineType machine(itsDir, pointingDir, false, false);
+          buf(0) = -uvw[row](0);
+          buf(1) = -uvw[row](1);
+          buf(2) = uvw[row](2);
+          casacore::Double delay = 0.;
+          machine.convertUVW(delay, buf);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(-buf(0), rotUVW[row](0), 1e-6);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(-buf(1), rotUVW[row](1), 1e-6);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(buf(2), rotUVW[row](2), 1e-6);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(delay, delays[row], 1e-6);
+     }
+  }
+private:
+  casacore::MDirection itsDir;
+};
+
+/// @brief rotated uvw cached for two tangent points should match those of a single-entry cache
+/// @details Delays for different image centres on the same tangent point are checked as well.
+struct MultiTangentComparison {
+  /// @brief constructor
+  /// @param[in] dir1 first tangent point
+  /// @param[in] dir2 second tangent point, also used as the image centre
+  /// @param[in] dir3 third tangent point, which replaces one of the cached entries
+  MultiTangentComparison(const casacore::MDirection &dir1, const casacore::MDirection &dir2,
+                         const casacore::MDirection &dir3) : itsDir1(dir1), itsDir2(dir2), itsDir3(dir3) {}
+
+  void operator()(const IConstDataAccessor &acc, const IConstDataAccessor &ref) const {
+     const casacore::Vector<casacore::RigidVector<casacore::Double, 3> > &rotUVW1 = acc.rotatedUVW(itsDir1);
+     const casacore::Vector<casacore::Double> &delays1 = acc.uvwRotationDelay(itsDir1, itsDir2);
+     const casacore::Vector<casacore::RigidVector<casacore::Double, 3> > &rotUVW2 = acc.rotatedUVW(itsDir2);
+     CPPUNIT_ASSERT(dynamic_cast<const TableConstDataAccessor&>(acc).rotatedUVWMemory() > 0);
+     // both tangent points are cached, the buffers are not recalculated
+     CPPUNIT_ASSERT(&rotUVW1 == &acc.rotatedUVW(itsDir1));
+     CPPUNIT_ASSERT(&delays1 == &acc.uvwRotationDelay(itsDir1, itsDir2));
+     CPPUNIT_ASSERT(&rotUVW2 == &acc.rotatedUVW(itsDir2));
+     CPPUNIT_ASSERT(&rotUVW1 != &rotUVW2);
+     // the results should match those obtained with a single tangent point in the cache
+     for (int pass = 0; pass < 2; ++pass) {
+          const casacore::MDirection &dir = pass == 0 ? itsDir1 : itsDir2;
+          const casacore::Vector<casacore::RigidVector<casacore::Double, 3> > &rotUVW = acc.rotatedUVW(dir);
+          const casacore::Vector<casacore::RigidVector<casacore::Double, 3> > &rotUVWRef = ref.rotatedUVW(dir);
+          const casacore::Vector<casacore::Double> &delays = acc.uvwRotationDelay(dir, itsDir2);
+          const casacore::Vector<casacore::Double> &delaysRef = ref.uvwRotationDelay(dir, itsDir2);
+          CPPUNIT_ASSERT_EQUAL(rotUVWRef.nelements(), rotUVW.nelements());
+          CPPUNIT_ASSERT_EQUAL(delaysRef.nelements(), delays.nelements());
+          for (casacore::uInt row = 0; row < acc.nRow(); ++row) {
+               for (casacore::uInt coord = 0; coord < 3; ++coord) {
+                    CPPUNIT_ASSERT_DOUBLES_EQUAL(rotUVWRef[row](coord), rotUVW[row](coord), 1e-6);
+               }
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(delaysRef[row], delays[row], 1e-6);
+          }
+     }
+     // delays for two image centres on the same tangent point are cached separately, alternating
+     // between them should give the same result as a fresh handler for each image centre
+     const UVWRotationHandler freshHandler2, freshHandler3;
+     const casacore::Vector<casacore::Double> &freshDelays2 = freshHandler2.delays(ref, itsDir1, itsDir2);
+     const casacore::Vector<casacore::Double> &freshDelays3 = freshHandler3.delays(ref, itsDir1, itsDir3);
+     const casacore::Vector<casacore::Double> &delays2 = acc.uvwRotationDelay(itsDir1, itsDir2);
+     const casacore::Vector<casacore::Double> &delays3 = acc.uvwRotationDelay(itsDir1, itsDir3);
+     CPPUNIT_ASSERT(&delays2 != &delays3);
+     for (int pass = 0; pass < 3; ++pass) {
+          CPPUNIT_ASSERT(&delays2 == &acc.uvwRotationDelay(itsDir1, itsDir2));
+          CPPUNIT_ASSERT(&delays3 == &acc.uvwRotationDelay(itsDir1, itsDir3));
+          CPPUNIT_ASSERT_EQUAL(freshDelays2.nelements(), delays2.nelements());
+          CPPUNIT_ASSERT_EQUAL(freshDelays3.nelements(), delays3.nelements());
+          for (casacore::uInt row = 0; row < acc.nRow(); ++row) {
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(freshDelays2[row], delays2[row], 1e-9);
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(freshDelays3[row], delays3[row], 1e-9);
+          }
+     }
+     // the third tangent point replaces the entry filled earliest
+     acc.rotatedUVW(itsDir3);
+     CPPUNIT_ASSERT(&rotUVW2 == &acc.rotatedUVW(itsDir2));
+  }
+private:
+  casacore::MDirection itsDir1;
+  casacore::MDirection itsDir2;
+  casacore::MDirection itsDir3;
+};
+
+/// @brief a synthetic FEED subtable
+/// @details The FEED subtable is created in a temporary directory together with an empty main
+/// table referring to it via the FEED keyword. Both are removed in the destructor. Rows are
+/// defined by the start and stop times in days, so the interval boundaries are exact in seconds.
+struct SyntheticFeedTable {
+  /// @brief create empty tables
+  SyntheticFeedTable() {
+     char dirTemplate[] = "/tmp/tFeedTableXXXXXX";
+     CPPUNIT_ASSERT(mkdtemp(dirTemplate) != NULL);
+     itsDir = dirTemplate;
+     const casacore::Vector<casacore::String> units(1, casacore::String("s"));
+     casacore::ScalarColumnDesc<casacore::Double> timeDesc("TIME");
+     timeDesc.rwKeywordSet().define("QuantumUnits", units);
+     casacore::Record measInfo;
+     measInfo.define("type", casacore::String("epoch"));
+     measInfo.define("Ref", casacore::String("UTC"));
+     timeDesc.rwKeywordSet().defineRecord("MEASINFO", measInfo);
+     casacore::ScalarColumnDesc<casacore::Double> intervalDesc("INTERVAL");
+     intervalDesc.rwKeywordSet().define("QuantumUnits", units);
+     casacore::TableDesc feedDesc;
+     feedDesc.addColumn(timeDesc);
+     feedDesc.addColumn(intervalDesc);
+     feedDesc.addColumn(casacore::ScalarColumnDesc<casacore::Int>("SPECTRAL_WINDOW_ID"));
+     feedDesc.addColumn(casacore::ScalarColumnDesc<casacore::Int>("ANTENNA_ID"));
+     feedDesc.addColumn(casacore::ScalarColumnDesc<casacore::Int>("FEED_ID"));
+     feedDesc.addColumn(casacore::ArrayColumnDesc<casacore::Double>("BEAM_OFFSET"));
+     feedDesc.addColumn(casacore::ArrayColumnDesc<casacore::Double>("RECEPTOR_ANGLE"));
+     casacore::SetupNewTable feedMaker(itsDir + "/FEED", feedDesc, casacore::Table::New);
+     itsFeed = casacore::Table(feedMaker);
+     casacore::SetupNewTable mainMaker(itsDir + "/MAIN", casacore::TableDesc(), casacore::Table::New);
+     itsMain = casacore::Table(mainMaker);
+     itsMain.rwKeywordSet().defineTable("FEED", itsFeed);
+  }
+
+  /// @brief close the tables and remove the temporary directory
+  ~SyntheticFeedTable() {
+     itsMain = casacore::Table();
+     itsFeed = casacore::Table();
+     casacore::Directory(itsDir).removeRecursive();
+  }
+
+  /// @brief add a row with two receptors having the same offset and angle
+  /// @param[in] startDay start of the validity interval (MJD in days)
+  /// @param[in] stopDay end of the validity interval (MJD in days)
+  /// @param[in] spWindow spectral window ID, -1 means any spectral window
+  /// @param[in] ant antenna ID
+  /// @param[in] feed feed ID
+  /// @param[in] x offset along the first axis (in radians)
+  /// @param[in] y offset along the second axis (in radians)
+  /// @param[in] pa receptor angle (in radians)
+  void addRow(casacore::Double startDay, casacore::Double stopDay, casacore::Int spWindow,
+              casacore::Int ant, casacore::Int feed, casacore::Double x, casacore::Double y,
+              casacore::Double pa) {
+     const casacore::rownr_t row = itsFeed.nrow();
+     itsFeed.addRow();
+     casacore::ScalarColumn<casacore::Double>(itsFeed, "TIME").put(row, (startDay + stopDay) * 43200.);
+     casacore::ScalarColumn<casacore::Double>(itsFeed, "INTERVAL").put(row, (stopDay - startDay) * 86400.);
+     casacore::ScalarColumn<casacore::Int>(itsFeed, "SPECTRAL_WINDOW_ID").put(row, spWindow);
+     casacore::ScalarColumn<casacore::Int>(itsFeed, "ANTENNA_ID").put(row, ant);
+     casacore::ScalarColumn<casacore::Int>(itsFeed, "FEED_ID").put(row, feed);
+     casacore::Matrix<casacore::Double> offsets(2, 2);
+     offsets.row(0) = x;
+     offsets.row(1) = y;
+     casacore::ArrayColumn<casacore::Double>(itsFeed, "BEAM_OFFSET").put(row, offsets);
+     casacore::ArrayColumn<casacore::Double>(itsFeed, "RECEPTOR_ANGLE").put(row,
+                casacore::Vector<casacore::Double>(2, pa));
+  }
+
+  /// @brief main table with all rows written to the FEED subtable
+  const casacore::Table& table() {
+     itsFeed.flush();
+     itsMain.flush();
+     return itsMain;
+  }
+
+  /// @brief UTC epoch for the given MJD in days
+  static casacore::MEpoch epoch(casacore::Double day) {
+     return casacore::MEpoch(casacore::MVEpoch(casacore::Quantity(day, "d")),
+                             casacore::MEpoch::Ref(casacore::MEpoch::UTC));
+  }
+private:
+  std::string itsDir;
+  casacore::Table itsFeed;
+  casacore::Table itsMain;
+};
+
 class TableDataAccessTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(TableDataAccessTest);
@@ -69,15 +461,38 @@ class TableDataAccessTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(spWindowTest);
   CPPUNIT_TEST(polarisationTest);
   CPPUNIT_TEST(feedTest);
+  CPPUNIT_TEST(feedIntervalTest);
   CPPUNIT_TEST(fieldTest);
   CPPUNIT_TEST(antennaTest);
   CPPUNIT_TEST(antennaPositionShortcutTest);
+  CPPUNIT_TEST(parallacticAngleTest);
   CPPUNIT_TEST(originalVisRewriteTest);
   CPPUNIT_TEST(originalFlagRewriteTest);
   CPPUNIT_TEST(readOnlyTest);
   CPPUNIT_TEST(channelSelectionTest);
   CPPUNIT_TEST(freqSelectionTest);
+  CPPUNIT_TEST(multiFreqSelectionTest);
+  CPPUNIT_TEST(outOfBandFreqSelectionTest);
   CPPUNIT_TEST(chunkSizeTest);
+  CPPUNIT_TEST(nativeOrderTest);
+  CPPUNIT_TEST(readAheadTest);
+  CPPUNIT_TEST(partitionTest);
+  CPPUNIT_TEST(partitionThreadTest);
+  CPPUNIT_TEST(timeIndexTest);
+  CPPUNIT_TEST(timeIndexFileTest);
+  CPPUNIT_TEST(packedFlagTest);
+  CPPUNIT_TEST(compactNoiseTest);
+  CPPUNIT_TEST(uvwComponentsTest);
+  CPPUNIT_TEST(reducedFootprintTest);
+  CPPUNIT_TEST(chunkMemoryTest);
+  CPPUNIT_TEST(footprintBudgetTest);
+  CPPUNIT_TEST(uvwRotationTest);
+  CPPUNIT_TEST(multiTangentTest);
+  CPPUNIT_TEST(wPlaneScheduleTest);
+  CPPUNIT_TEST(channelAveragingTest);
+  CPPUNIT_TEST(averagingKernelTest);
+  CPPUNIT_TEST(polConversionTest);
+  CPPUNIT_TEST(spectralAxisConversionTest);
   CPPUNIT_TEST_SUITE_END();
 public:
 
@@ -109,12 +524,16 @@ public:
   void polarisationTest();
   /// test access to the feed subtable
   void feedTest();
+  /// @brief test of the FEED subtable index with time and spectral window dependence
+  void feedIntervalTest();
   /// test access to the field subtable
   void fieldTest();
   /// test access to the antenna subtable
   void antennaTest();
   /// test access to antenna positions via a shortcut method
   void antennaPositionShortcutTest();
+  /// test of analytic parallactic angles against casacore measures
+  void parallacticAngleTest();
   /// test to rewrite original visibilities
   void originalVisRewriteTest();
   /// test to rewrite original flags
@@ -123,8 +542,49 @@ public:
   void channelSelectionTest();
   /// test read/write with frequency selection
   void freqSelectionTest();
+  /// test of frequency selection of several channels with and without averaging
+  void multiFreqSelectionTest();
+  void outOfBandFreqSelectionTest();
   /// test restriction of the chunk size
   void chunkSizeTest();
+  /// test of visibilities and flags in the measurement set order
+  void nativeOrderTest();
+  /// @brief test of the asynchronous read-ahead
+  void readAheadTest();
+  /// @brief test of iterators over disjoint parts of the dataset
+  void partitionTest();
+  /// @brief test of iterators over partitions used concurrently
+  void partitionThreadTest();
+  /// @brief test of iteration with the time index
+  void timeIndexTest();
+  /// @brief test of the time index stored in a file
+  void timeIndexFileTest();
+  /// @brief test of flags stored as a bit mask
+  void packedFlagTest();
+  /// @brief test of the noise given per row and polarisation
+  void compactNoiseTest();
+  /// @brief test of uvw stored as separate arrays of u, v and w
+  void uvwComponentsTest();
+  /// @brief test of the reduced footprint mode
+  void reducedFootprintTest();
+  /// @brief test of the chunk size derived from the memory budget
+  void chunkMemoryTest();
+  /// @brief test of the memory budget combined with the reduced footprint mode
+  void footprintBudgetTest();
+  /// @brief test of uvw rotation done in blocks of rows
+  void uvwRotationTest();
+  /// @brief test of the cache of rotated uvw for several tangent points
+  void multiTangentTest();
+  /// @brief test of the precomputed schedule of w-planes
+  void wPlaneScheduleTest();
+  /// @brief test of channel averaging on read
+  void channelAveragingTest();
+  /// @brief test of the averaging kernels with synthetic data
+  void averagingKernelTest();
+  /// @brief test of polarisation conversion on read
+  void polConversionTest();
+  /// @brief test of frequency and velocity conversion of the spectral axis
+  void spectralAxisConversionTest();
 protected:
   void doBufferTest() const;
 private:
@@ -242,6 +702,844 @@ void TableDataAccessTest::chunkSizeTest()
 }
 
 
+/// test of visibilities and flags in the measurement set order
+void TableDataAccessTest::nativeOrderTest()
+{
+   TableConstDataSource ds(TableTestRunner::msName());
+   IDataSelectorPtr sel = ds.createSelector();
+   sel->chooseChannels(5, 2);
+   // native cubes are requested first and, therefore, are read directly from the table
+   for (IConstDataSharedIter it=ds.createConstIterator();it!=it.end();++it) {
+        const casacore::Cube<casacore::Complex> &visNative = it->visibilityNative();
+        const casacore::Cube<casacore::Bool> &flagNative = it->flagNative();
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(it->nPol()), visNative.nrow());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(13), visNative.ncolumn());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(it->nRow()), visNative.nplane());
+        CPPUNIT_ASSERT(visNative.shape() == flagNative.shape());
+        const casacore::Cube<casacore::Complex> &vis = it->visibility();
+        const casacore::Cube<casacore::Bool> &flag = it->flag();
+        for (casacore::uInt row = 0; row < vis.nrow(); ++row) {
+             for (casacore::uInt chan = 0; chan < vis.ncolumn(); ++chan) {
+                  for (casacore::uInt pol = 0; pol < vis.nplane(); ++pol) {
+                       CPPUNIT_ASSERT(abs(vis(row,chan,pol) - visNative(pol,chan,row)) < 1e-7);
+                       CPPUNIT_ASSERT_EQUAL(flag(row,chan,pol), flagNative(pol,chan,row));
+                  }
+             }
+        }
+   }
+   // the same with channel selection, now cubes in the accessor order are requested first
+   for (IConstDataSharedIter it=ds.createConstIterator(sel);it!=it.end();++it) {
+        const casacore::Cube<casacore::Complex> &vis = it->visibility();
+        const casacore::Cube<casacore::Bool> &flag = it->flag();
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(5), vis.ncolumn());
+        const casacore::Cube<casacore::Complex> &visNative = it->visibilityNative();
+        const casacore::Cube<casacore::Bool> &flagNative = it->flagNative();
+        CPPUNIT_ASSERT(visNative.shape() == flagNative.shape());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(5), visNative.ncolumn());
+        for (casacore::uInt row = 0; row < vis.nrow(); ++row) {
+             for (casacore::uInt chan = 0; chan < vis.ncolumn(); ++chan) {
+                  for (casacore::uInt pol = 0; pol < vis.nplane(); ++pol) {
+                       CPPUNIT_ASSERT(abs(vis(row,chan,pol) - visNative(pol,chan,row)) < 1e-7);
+                       CPPUNIT_ASSERT_EQUAL(flag(row,chan,pol), flagNative(pol,chan,row));
+                  }
+             }
+        }
+   }
+}
+
+/// test that iteration with read-ahead gives the same data as the ordinary iteration
+void TableDataAccessTest::readAheadTest()
+{
+   TableConstDataSource ds(TableTestRunner::msName());
+   TableConstDataSource dsAhead(TableTestRunner::msName());
+   // restrict the chunk size to have more than one chunk per time step, so both
+   // cases (next chunk in the same or in the next iteration of the table iterator) are tested
+   ds.configureMaxChunkSize(7);
+   dsAhead.configureMaxChunkSize(7);
+   dsAhead.configureReadAhead(true);
+   IDataSelectorPtr sel = ds.createSelector();
+   sel->chooseChannels(5, 2);
+   IConstDataSharedIter it = ds.createConstIterator(sel);
+   IConstDataSharedIter itAhead = dsAhead.createConstIterator(sel);
+   casacore::uInt count = 0;
+   for (; it != it.end(); ++it, ++itAhead, ++count) {
+        CPPUNIT_ASSERT(itAhead != itAhead.end());
+        CPPUNIT_ASSERT_EQUAL(it->nRow(), itAhead->nRow());
+        CPPUNIT_ASSERT_EQUAL(it->time(), itAhead->time());
+        CPPUNIT_ASSERT(it->visibility().shape() == itAhead->visibility().shape());
+        // skip some fields for a few chunks to check that the read-ahead adapts to
+        // the fields actually used
+        if (count % 4 != 1) {
+            CPPUNIT_ASSERT(allEQ(it->flag(), itAhead->flag()));
+            CPPUNIT_ASSERT(allEQ(it->flagNative(), itAhead->flagNative()));
+            CPPUNIT_ASSERT(allNear(it->noise(), itAhead->noise(), 1e-7));
+        }
+        for (casacore::uInt row = 0; row < it->nRow(); ++row) {
+             CPPUNIT_ASSERT_EQUAL(it->antenna1()[row], itAhead->antenna1()[row]);
+             CPPUNIT_ASSERT_EQUAL(it->antenna2()[row], itAhead->antenna2()[row]);
+             for (casacore::uInt dim = 0; dim < 3; ++dim) {
+                  CPPUNIT_ASSERT_DOUBLES_EQUAL(it->uvw()[row](dim), itAhead->uvw()[row](dim), 1e-9);
+             }
+        }
+        CPPUNIT_ASSERT(allNear(it->visibility(), itAhead->visibility(), 1e-7));
+   }
+   CPPUNIT_ASSERT(itAhead == itAhead.end());
+   CPPUNIT_ASSERT(count > 0);
+   // restart the iteration with read-ahead, the data read in advance have to be discarded
+   itAhead.init();
+   it.init();
+   CPPUNIT_ASSERT(itAhead != itAhead.end());
+   CPPUNIT_ASSERT(allNear(it->visibility(), itAhead->visibility(), 1e-7));
+}
+
+/// test that iterators over partitions cover the same data as the ordinary iterator
+void TableDataAccessTest::partitionTest()
+{
+   TableConstDataSource ds(TableTestRunner::msName());
+   IDataSelectorPtr sel = ds.createSelector();
+   sel->chooseCrossCorrelations();
+   std::vector<casacore::Double> times;
+   casacore::uInt nRowsTotal = 0;
+   for (IConstDataSharedIter it=ds.createConstIterator(sel);it!=it.end();++it) {
+        times.push_back(it->time());
+        nRowsTotal += it->nRow();
+   }
+   CPPUNIT_ASSERT(times.size() > 3);
+
+   const std::vector<boost::shared_ptr<IConstDataIterator> > iters =
+          ds.createConstIterators(sel, ds.createConverter(), 3);
+   CPPUNIT_ASSERT_EQUAL(size_t(3), iters.size());
+   size_t chunk = 0;
+   casacore::uInt nRowsPartitioned = 0;
+   for (size_t part = 0; part < iters.size(); ++part) {
+        IConstDataSharedIter it(iters[part]);
+        CPPUNIT_ASSERT(it != it.end());
+        for (; it != it.end(); ++it, ++chunk) {
+             // partitions are contiguous in time and do not overlap
+             CPPUNIT_ASSERT(chunk < times.size());
+             CPPUNIT_ASSERT_DOUBLES_EQUAL(times[chunk], it->time(), 1e-6);
+             CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(it->nRow()), it->visibility().nrow());
+             nRowsPartitioned += it->nRow();
+        }
+   }
+   CPPUNIT_ASSERT_EQUAL(times.size(), chunk);
+   CPPUNIT_ASSERT_EQUAL(nRowsTotal, nRowsPartitioned);
+
+   // more parts than time stamps
+   const std::vector<boost::shared_ptr<IConstDataIterator> > manyIters =
+          ds.createConstIterators(sel, ds.createConverter(), times.size() + 10);
+   CPPUNIT_ASSERT_EQUAL(times.size(), manyIters.size());
+}
+
+/// @brief test of iterators over partitions used concurrently
+/// @details Each partition is processed in its own thread (with read-ahead enabled, so there
+/// is yet another thread per partition reading the table). The results should be identical
+/// to those obtained with the ordinary iterator.
+void TableDataAccessTest::partitionThreadTest()
+{
+   TableConstDataSource ds(TableTestRunner::msName());
+   IDataSelectorPtr sel = ds.createSelector();
+   sel->chooseCrossCorrelations();
+   ds.configureMaxChunkSize(7);
+   std::vector<ChunkSummary> expected;
+   bool failed = false;
+   PartitionReader(ds.createConstIterator(sel), expected, failed)();
+   CPPUNIT_ASSERT(!failed);
+   CPPUNIT_ASSERT(expected.size() > 3);
+
+   ds.configureReadAhead(true);
+   const std::vector<boost::shared_ptr<IConstDataIterator> > iters =
+          ds.createConstIterators(sel, ds.createConverter(), 3);
+   CPPUNIT_ASSERT_EQUAL(size_t(3), iters.size());
+   std::vector<std::vector<ChunkSummary> > results(iters.size());
+   // std::vector<bool> is not suitable as each thread needs a reference to its own flag
+   bool failures[3] = {false, false, false};
+   boost::thread_group threads;
+   for (size_t part = 0; part < iters.size(); ++part) {
+        threads.create_thread(PartitionReader(iters[part], results[part], failures[part]));
+   }
+   threads.join_all();
+
+   size_t chunk = 0;
+   for (size_t part = 0; part < results.size(); ++part) {
+        CPPUNIT_ASSERT(!failures[part]);
+        CPPUNIT_ASSERT(results[part].size() > 0);
+        for (size_t i = 0; i < results[part].size(); ++i, ++chunk) {
+             CPPUNIT_ASSERT(chunk < expected.size());
+             const ChunkSummary &res = results[part][i];
+             const ChunkSummary &exp = expected[chunk];
+             CPPUNIT_ASSERT_DOUBLES_EQUAL(exp.itsTime, res.itsTime, 1e-6);
+             CPPUNIT_ASSERT_EQUAL(exp.itsNRow, res.itsNRow);
+             CPPUNIT_ASSERT_DOUBLES_EQUAL(exp.itsVisSum, res.itsVisSum, 1e-6 * std::max(exp.itsVisSum, 1.));
+             CPPUNIT_ASSERT_EQUAL(exp.itsNFlagged, res.itsNFlagged);
+             CPPUNIT_ASSERT_DOUBLES_EQUAL(exp.itsFreq, res.itsFreq, 1e-3);
+             CPPUNIT_ASSERT(exp.itsPointingDir.separation(res.itsPointingDir) < 1e-9);
+        }
+   }
+   CPPUNIT_ASSERT_EQUAL(expected.size(), chunk);
+}
+
+/// @brief test of iteration with the time index
+/// @details Chunks (including those of restricted size) should be the same as with the table iterator
+void TableDataAccessTest::timeIndexTest()
+{
+   TableConstDataSource ds(TableTestRunner::msName());
+   IDataSelectorPtr sel = ds.createSelector();
+   sel->chooseCrossCorrelations();
+   ds.configureMaxChunkSize(7);
+   IConstDataSharedIter it = ds.createConstIterator(sel);
+   ds.configureTimeIndex(true);
+   IConstDataSharedIter itIndexed = ds.createConstIterator(sel);
+   boost::shared_ptr<TableConstDataIterator> actualIt = itIndexed.dynamicCast<TableConstDataIterator>();
+   CPPUNIT_ASSERT(actualIt);
+   const boost::shared_ptr<TableTimeIndex const> index = actualIt->timeIndex();
+   CPPUNIT_ASSERT(index);
+   CPPUNIT_ASSERT(index->nSteps() > 3);
+   size_t chunk = 0;
+   for (; it != it.end(); ++it, ++itIndexed, ++chunk) {
+        CPPUNIT_ASSERT(itIndexed != itIndexed.end());
+        CPPUNIT_ASSERT_EQUAL(it->nRow(), itIndexed->nRow());
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(it->time(), itIndexed->time(), 1e-6);
+        for (casacore::uInt row = 0; row < it->nRow(); ++row) {
+             CPPUNIT_ASSERT_EQUAL(it->antenna1()[row], itIndexed->antenna1()[row]);
+             CPPUNIT_ASSERT_EQUAL(it->antenna2()[row], itIndexed->antenna2()[row]);
+        }
+        CPPUNIT_ASSERT(allEQ(it->visibility(), itIndexed->visibility()));
+        CPPUNIT_ASSERT(allEQ(it->flag(), itIndexed->flag()));
+   }
+   CPPUNIT_ASSERT(itIndexed == itIndexed.end());
+   CPPUNIT_ASSERT(chunk > index->nSteps());
+
+   // the index is reused after init and can be shared with another iterator
+   itIndexed.init();
+   CPPUNIT_ASSERT(actualIt->timeIndex() == index);
+   boost::shared_ptr<TableConstDataIterator> otherIt =
+          IConstDataSharedIter(ds.createConstIterator(sel)).dynamicCast<TableConstDataIterator>();
+   CPPUNIT_ASSERT(otherIt);
+   otherIt->enableTimeIndex(index);
+   CPPUNIT_ASSERT(otherIt->timeIndex() == index);
+   CPPUNIT_ASSERT(otherIt->hasMore());
+   CPPUNIT_ASSERT_DOUBLES_EQUAL((**actualIt).time(), (**otherIt).time(), 1e-6);
+
+   // an index built for a different selection is detected, even if the number of rows
+   // is the same
+   const casacore::Table ms(TableTestRunner::msName());
+   const casacore::rownr_t nRow = ms.nrow();
+   CPPUNIT_ASSERT(nRow > 3);
+   casacore::Vector<casacore::rownr_t> rows(nRow - 1);
+   indgen(rows);
+   const casacore::Table firstRows = ms(casacore::RowNumbers(rows));
+   // the same number of rows and the same first row, but a different subset of rows
+   rows[1] = nRow - 2;
+   rows[nRow - 2] = nRow - 1;
+   std::sort(rows.begin(), rows.end());
+   const casacore::Table otherRows = ms(casacore::RowNumbers(rows));
+   const TableTimeIndex firstIndex(firstRows, "first");
+   CPPUNIT_ASSERT(firstIndex.matches(firstRows, "first"));
+   CPPUNIT_ASSERT(!firstIndex.matches(firstRows, "other"));
+   CPPUNIT_ASSERT(!firstIndex.matches(otherRows, "first"));
+}
+
+/// @brief test of the time index stored in a file
+/// @details The index written by the first iterator should be loaded by the next one
+/// with the same selection and give the same chunks
+void TableDataAccessTest::timeIndexFileTest()
+{
+   // index files are written into a temporary directory, which is removed at the end
+   char dirTemplate[] = "/tmp/tTimeIndexXXXXXX";
+   CPPUNIT_ASSERT(mkdtemp(dirTemplate) != NULL);
+   const std::string indexDir(dirTemplate);
+   const std::string keyBefore = TableTimeIndex::makeKey(casacore::Table(TableTestRunner::msName()), "test");
+
+   TableConstDataSource ds(TableTestRunner::msName());
+   IDataSelectorPtr sel = ds.createSelector();
+   sel->chooseCrossCorrelations();
+   IConstDataSharedIter it = ds.createConstIterator(sel);
+   ds.configureTimeIndex(true, indexDir);
+   boost::shared_ptr<TableConstDataIterator> writingIt =
+          IConstDataSharedIter(ds.createConstIterator(sel)).dynamicCast<TableConstDataIterator>();
+   CPPUNIT_ASSERT(writingIt);
+   const boost::shared_ptr<TableTimeIndex const> index = writingIt->timeIndex();
+   CPPUNIT_ASSERT(index);
+   CPPUNIT_ASSERT(!index->key().empty());
+   // there was no file, so the index has been built and written
+   CPPUNIT_ASSERT(!index->loadedFromFile());
+   const casacore::Table ms(TableTestRunner::msName());
+   const std::string fileName = TableTimeIndex::fileName(indexDir, ms, index->key());
+   CPPUNIT_ASSERT(casacore::File(fileName).isRegular());
+   const casacore::uInt writeTime = casacore::File(fileName).modifyTime();
+
+   IConstDataSharedIter itLoaded = ds.createConstIterator(sel);
+   boost::shared_ptr<TableConstDataIterator> actualIt = itLoaded.dynamicCast<TableConstDataIterator>();
+   CPPUNIT_ASSERT(actualIt);
+   const boost::shared_ptr<TableTimeIndex const> loadedIndex = actualIt->timeIndex();
+   CPPUNIT_ASSERT(loadedIndex);
+   CPPUNIT_ASSERT(loadedIndex != index);
+   // the second iterator has used the file rather than building the index again
+   CPPUNIT_ASSERT(loadedIndex->loadedFromFile());
+   CPPUNIT_ASSERT_EQUAL(index->key(), loadedIndex->key());
+   CPPUNIT_ASSERT_EQUAL(writeTime, casacore::File(fileName).modifyTime());
+   CPPUNIT_ASSERT_EQUAL(index->nSteps(), loadedIndex->nSteps());
+   CPPUNIT_ASSERT_EQUAL(index->nRows(), loadedIndex->nRows());
+   for (; it != it.end(); ++it, ++itLoaded) {
+        CPPUNIT_ASSERT(itLoaded != itLoaded.end());
+        CPPUNIT_ASSERT_EQUAL(it->nRow(), itLoaded->nRow());
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(it->time(), itLoaded->time(), 1e-6);
+        for (casacore::uInt row = 0; row < it->nRow(); ++row) {
+             CPPUNIT_ASSERT_EQUAL(it->antenna1()[row], itLoaded->antenna1()[row]);
+             CPPUNIT_ASSERT_EQUAL(it->antenna2()[row], itLoaded->antenna2()[row]);
+        }
+        CPPUNIT_ASSERT(allEQ(it->visibility(), itLoaded->visibility()));
+        CPPUNIT_ASSERT_EQUAL(it->frequency().nelements(), itLoaded->frequency().nelements());
+   }
+   CPPUNIT_ASSERT(itLoaded == itLoaded.end());
+   // the key doesn't change while the table is only read (i.e. the lock file is ignored)
+   CPPUNIT_ASSERT_EQUAL(keyBefore, TableTimeIndex::makeKey(ms, "test"));
+
+   // a different selection is stored in a different file
+   sel->chooseFeed(0);
+   boost::shared_ptr<TableConstDataIterator> otherIt =
+          IConstDataSharedIter(ds.createConstIterator(sel)).dynamicCast<TableConstDataIterator>();
+   CPPUNIT_ASSERT(otherIt);
+   CPPUNIT_ASSERT(otherIt->timeIndex());
+   CPPUNIT_ASSERT(!otherIt->timeIndex()->loadedFromFile());
+   CPPUNIT_ASSERT(otherIt->timeIndex()->key() != index->key());
+   const std::string otherFileName = TableTimeIndex::fileName(indexDir, ms, otherIt->timeIndex()->key());
+   CPPUNIT_ASSERT(otherFileName != fileName);
+   CPPUNIT_ASSERT(std::remove(fileName.c_str()) == 0);
+   CPPUNIT_ASSERT(std::remove(otherFileName.c_str()) == 0);
+   CPPUNIT_ASSERT(rmdir(indexDir.c_str()) == 0);
+}
+
+/// @brief test of flags stored as a bit mask
+/// @details Packed flags should give the same information as the cube of flags
+void TableDataAccessTest::packedFlagTest()
+{
+   // row flagging and packing for a shape which is not a multiple of the word size
+   PackedFlags packed(5, 7, 3);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), packed.nFlagged());
+   packed.flagRow(2);
+   packed.set(4, 6, 2, true);
+   CPPUNIT_ASSERT_EQUAL(size_t(7 * 3 + 1), packed.nFlagged());
+   casacore::Cube<casacore::Bool> cube;
+   packed.unpack(cube);
+   CPPUNIT_ASSERT(cube.shape() == casacore::IPosition(3, 5, 7, 3));
+   CPPUNIT_ASSERT(allEQ(cube.yzPlane(2), casacore::True));
+   CPPUNIT_ASSERT(cube(4, 6, 2));
+   CPPUNIT_ASSERT_EQUAL(size_t(7 * 3 + 1), size_t(ntrue(cube)));
+   casacore::Cube<casacore::Bool> native;
+   packed.unpackNative(native);
+   PackedFlags repacked;
+   repacked.pack(native);
+   CPPUNIT_ASSERT(repacked.words() == packed.words());
+
+   // packing in blocks of rows gives the same bit mask as packing all rows at once
+   CPPUNIT_ASSERT_EQUAL(casacore::uInt(64), PackedFlags::rowAlignment(7, 3));
+   CPPUNIT_ASSERT_EQUAL(casacore::uInt(2), PackedFlags::rowAlignment(16, 2));
+   CPPUNIT_ASSERT_EQUAL(casacore::uInt(1), PackedFlags::rowAlignment(32, 4));
+   casacore::Cube<casacore::Bool> pattern(2, 16, 7);
+   for (casacore::uInt row = 0; row < pattern.nplane(); ++row) {
+        for (casacore::uInt chan = 0; chan < pattern.ncolumn(); ++chan) {
+             for (casacore::uInt pol = 0; pol < pattern.nrow(); ++pol) {
+                  pattern(pol, chan, row) = ((row * 5 + chan * 3 + pol) % 7 == 0);
+             }
+        }
+   }
+   PackedFlags whole;
+   whole.pack(pattern);
+   PackedFlags blocks(7, 16, 2, true);
+   for (casacore::uInt row = 0; row < 7; row += 2) {
+        const casacore::uInt nRows = std::min(2u, 7 - row);
+        const casacore::Array<casacore::Bool> block = pattern(casacore::IPosition(3, 0, 0, row),
+                      casacore::IPosition(3, 1, 15, row + nRows - 1)).copy();
+        blocks.packRows(block, row);
+   }
+   CPPUNIT_ASSERT(blocks.words() == whole.words());
+   CPPUNIT_ASSERT_EQUAL(whole.nFlagged(), size_t(ntrue(pattern)));
+
+   TableConstDataSource ds(TableTestRunner::msName());
+   compareChunks(ds, ds, PackedFlagComparison());
+}
+
+/// @brief test of the noise given per row and polarisation
+/// @details The compact noise should match the noise cube for every channel
+void TableDataAccessTest::compactNoiseTest()
+{
+   TableConstDataSource ds(TableTestRunner::msName());
+   IDataSelectorPtr sel = ds.createSelector();
+   sel->chooseChannels(5, 2);
+   compareChunks(ds, ds, CompactNoiseComparison(), sel);
+   // noise of averaged channels depends on flags
+   sel->chooseChannels(2, 0, 2);
+   IConstDataSharedIter itAvg = ds.createConstIterator(sel);
+   CPPUNIT_ASSERT(itAvg != itAvg.end());
+   CPPUNIT_ASSERT(!dynamic_cast<const TableConstDataAccessor&>(*itAvg).noiseSpectrallyConstant());
+}
+
+/// test that separate arrays of u, v and w match uvw returned as rigid vectors
+void TableDataAccessTest::uvwComponentsTest()
+{
+   TableConstDataSource ds(TableTestRunner::msName());
+   const casacore::MDirection testDir(casacore::MVDirection(0.12345,-0.12345), casacore::MDirection::J2000);
+   compareChunks(ds, ds, UVWComponentsComparison(testDir));
+}
+
+/// test that single precision and real-valued fields of the reduced footprint mode
+/// match the fields obtained in the normal mode
+void TableDataAccessTest::reducedFootprintTest()
+{
+   TableConstDataSource ds(TableTestRunner::msName());
+   ds.configureReducedFootprint(true, true);
+   ds.configureReadAhead(true);
+   TableConstDataSource dsRef(TableTestRunner::msName());
+   compareChunks(ds, dsRef, ReducedFootprintComparison());
+}
+
+/// @brief test of the chunk size derived from the memory budget
+/// @details The same rows should be returned regardless of the budget, the number
+/// of rows per chunk should depend on the number of channels
+void TableDataAccessTest::chunkMemoryTest()
+{
+   TableConstDataSource ds(TableTestRunner::msName());
+   casacore::uInt nRowsTotal = 0;
+   casacore::uInt maxRows = 0;
+   for (IConstDataSharedIter it=ds.createConstIterator(); it!=it.end(); ++it) {
+        nRowsTotal += it->nRow();
+        maxRows = std::max(maxRows, it->nRow());
+   }
+   CPPUNIT_ASSERT(maxRows > 1);
+   // a budget too small for a single row still gives one row per chunk
+   ds.configureMaxChunkMemory(1);
+   casacore::uInt nRows = 0;
+   for (IConstDataSharedIter it=ds.createConstIterator(); it!=it.end(); ++it) {
+        CPPUNIT_ASSERT_EQUAL(1u, it->nRow());
+        CPPUNIT_ASSERT_EQUAL(size_t(1), it->visibility().nrow());
+        ++nRows;
+   }
+   CPPUNIT_ASSERT_EQUAL(nRowsTotal, nRows);
+   // fewer channels mean more rows for the same budget
+   const size_t budget = 1048576;
+   ds.configureMaxChunkMemory(budget);
+   IDataSelectorPtr sel = ds.createSelector();
+   sel->chooseChannels(1, 0);
+   IConstDataSharedIter itNarrow = ds.createConstIterator(sel);
+   IConstDataSharedIter itWide = ds.createConstIterator();
+   CPPUNIT_ASSERT(itNarrow != itNarrow.end());
+   CPPUNIT_ASSERT(itWide != itWide.end());
+   CPPUNIT_ASSERT(itWide->nRow() <= itNarrow->nRow());
+   nRows = 0;
+   for (; itWide != itWide.end(); ++itWide) {
+        nRows += itWide->nRow();
+   }
+   CPPUNIT_ASSERT_EQUAL(nRowsTotal, nRows);
+   // the budget shared between concurrent iterators is the same as the reduced budget per thread
+   ds.configureMaxChunkMemory(budget, false);
+   const std::vector<boost::shared_ptr<IConstDataIterator> > iters =
+          ds.createConstIterators(ds.createSelector(), ds.createConverter(), 3);
+   CPPUNIT_ASSERT(iters.size() > 0);
+   ds.configureMaxChunkMemory(budget / iters.size());
+   IConstDataSharedIter itShared(iters[0]);
+   IConstDataSharedIter itPerThread = ds.createConstIterator();
+   CPPUNIT_ASSERT(itShared != itShared.end());
+   CPPUNIT_ASSERT_EQUAL(itPerThread->nRow(), itShared->nRow());
+}
+
+/// @brief test of the memory budget combined with the reduced footprint mode
+/// @details The budget should be applied with the memory estimate of the reduced footprint
+/// mode from the first chunk on. Therefore, no chunk can be longer than the first chunk with
+/// the same time stamp and shape, and the reduced footprint mode allows at least as many rows per chunk
+/// as the normal mode with the same budget.
+void TableDataAccessTest::footprintBudgetTest()
+{
+   TableConstDataSource ds(TableTestRunner::msName());
+   casacore::uInt nRowsTotal = 0;
+   for (IConstDataSharedIter it=ds.createConstIterator(); it!=it.end(); ++it) {
+        nRowsTotal += it->nRow();
+   }
+   TableConstDataSource dsReduced(TableTestRunner::msName());
+   dsReduced.configureReducedFootprint(true, true);
+   // budgets from a few rows to a few hundred rows per chunk
+   for (size_t budget = 2048; budget <= 1048576; budget *= 4) {
+        ds.configureMaxChunkMemory(budget);
+        dsReduced.configureMaxChunkMemory(budget);
+        IConstDataSharedIter itNormal = ds.createConstIterator();
+        IConstDataSharedIter it = dsReduced.createConstIterator();
+        const boost::shared_ptr<TableConstDataIterator> tableIt = it.dynamicCast<TableConstDataIterator>();
+        CPPUNIT_ASSERT(tableIt);
+        CPPUNIT_ASSERT(tableIt->reducedFootprint());
+        CPPUNIT_ASSERT_EQUAL(budget, tableIt->chunkMemoryBudget());
+        CPPUNIT_ASSERT(it != it.end());
+        CPPUNIT_ASSERT(itNormal != itNormal.end());
+        CPPUNIT_ASSERT(it->nRow() >= itNormal->nRow());
+        casacore::uInt nRows = 0;
+        casacore::uInt firstChunkRows = 0;
+        casacore::Double firstChunkTime = 0.;
+        casacore::uInt firstChunkSamples = 0;
+        for (; it != it.end(); ++it) {
+             const casacore::uInt nSamples = it->nChannel() * it->nPol();
+             if ((nRows == 0) || (it->time() != firstChunkTime) || (nSamples != firstChunkSamples)) {
+                 firstChunkTime = it->time();
+                 firstChunkSamples = nSamples;
+                 firstChunkRows = it->nRow();
+             }
+             CPPUNIT_ASSERT(it->nRow() <= firstChunkRows);
+             nRows += it->nRow();
+        }
+        CPPUNIT_ASSERT_EQUAL(nRowsTotal, nRows);
+   }
+   // the memory estimate depends on the reduced footprint mode and the size of the rotated
+   // uvw cache, so they can't be changed after the budget is set
+   boost::shared_ptr<TableConstDataIterator> budgetIt =
+          IConstDataSharedIter(ds.createConstIterator()).dynamicCast<TableConstDataIterator>();
+   CPPUNIT_ASSERT(budgetIt);
+   CPPUNIT_ASSERT(budgetIt->chunkMemoryBudget() > 0);
+   CPPUNIT_ASSERT_THROW(budgetIt->enableReducedFootprint(), AskapError);
+   CPPUNIT_ASSERT_THROW(budgetIt->setRotatedUVWCacheSize(2), AskapError);
+   CPPUNIT_ASSERT(!budgetIt->reducedFootprint());
+}
+
+/// @brief test of uvw rotation done in blocks of rows
+/// @details Rotated uvw and delays should match the result of the uvw machine applied to each row
+void TableDataAccessTest::uvwRotationTest()
+{
+   TableConstDataSource ds(TableTestRunner::msName());
+   const casacore::MDirection testDir(casacore::MVDirection(0.12345,-0.12345), casacore::MDirection::J2000);
+   compareChunks(ds, ds, UVWRotationComparison(testDir));
+}
+
+/// @brief test of the cache of rotated uvw for several tangent points
+void TableDataAccessTest::multiTangentTest()
+{
+   TableConstDataSource ds(TableTestRunner::msName());
+   ds.configureRotatedUVWCache(2);
+   const casacore::MDirection dir1(casacore::MVDirection(0.12345,-0.12345), casacore::MDirection::J2000);
+   const casacore::MDirection dir2(casacore::MVDirection(0.2,-0.1), casacore::MDirection::J2000);
+   const casacore::MDirection dir3(casacore::MVDirection(0.3,-0.2), casacore::MDirection::J2000);
+   TableConstDataSource dsRef(TableTestRunner::msName());
+   compareChunks(ds, dsRef, MultiTangentComparison(dir1, dir2, dir3));
+}
+
+/// @brief test of the precomputed schedule of w-planes
+void TableDataAccessTest::wPlaneScheduleTest()
+{
+   TableConstDataSource ds(TableTestRunner::msName());
+   itsTableInfoAccessor.reset(new TableInfoAccessor(
+               casacore::Table(TableTestRunner::msName()),false));
+   const IAntennaSubtableHandler &antennas = itsTableInfoAccessor->subtableInfo().getAntenna();
+   IConstDataSharedIter it = ds.createConstIterator();
+   const casacore::MDirection tangent(it->dishPointing1()[0], casacore::MDirection::J2000);
+   const double startTime = it->time();
+   const double stopTime = startTime + 3600.;
+   const double maxFreq = casacore::max(it->frequency());
+   const WPlaneSchedule schedule(antennas, tangent, startTime, stopTime, 1000., maxFreq, 60.);
+   CPPUNIT_ASSERT(schedule.size() > 0);
+   // windows are contiguous and cover the whole observation
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(startTime, schedule.startTime(0), 1e-6);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(stopTime, schedule.stopTime(schedule.size() - 1), 1e-6);
+   for (size_t window = 0; window < schedule.size(); ++window) {
+        CPPUNIT_ASSERT(schedule.stopTime(window) > schedule.startTime(window));
+        if (window > 0) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(schedule.stopTime(window - 1), schedule.startTime(window), 1e-6);
+        }
+        CPPUNIT_ASSERT_EQUAL(window, schedule.find(schedule.startTime(window)));
+        CPPUNIT_ASSERT_EQUAL(window, schedule.find(0.5 * (schedule.startTime(window) + schedule.stopTime(window))));
+   }
+   CPPUNIT_ASSERT_EQUAL(schedule.size(), schedule.find(startTime - 1.));
+   CPPUNIT_ASSERT_EQUAL(schedule.size(), schedule.find(stopTime + 1.));
+
+   // the plane fitted to the first chunk alone (zero tolerance forces the fit) and its residual
+   const casacore::Vector<casacore::RigidVector<casacore::Double, 3> > &uvw = it->rotatedUVW(tangent);
+   BestWPlaneDataAccessor fitAcc(0., false);
+   fitAcc.associate(*it);
+   const casacore::Vector<casacore::RigidVector<casacore::Double, 3> > &fitUVW = fitAcc.rotatedUVW(tangent);
+   CPPUNIT_ASSERT_EQUAL(uvw.nelements(), fitUVW.nelements());
+   double maxW = 0., fitDeviation = 0.;
+   for (casacore::uInt row = 0; row < uvw.nelements(); ++row) {
+        maxW = std::max(maxW, fabs(uvw[row](2)));
+        fitDeviation = std::max(fitDeviation, fabs(fitUVW[row](2)));
+   }
+   // the array should be close to coplanar, the tolerance is chosen between the residual of the
+   // fit and the w-term without any plane subtracted, so a new fit is required for the first chunk
+   CPPUNIT_ASSERT(2. * fitDeviation < maxW);
+   const double tolInMetres = sqrt(std::max(fitDeviation, 1e-6 * maxW) * maxW);
+   const double tolerance = tolInMetres * maxFreq / casacore::C::c;
+
+   // without the schedule, the plane is fitted to the first chunk and the residual meets the tolerance
+   BestWPlaneDataAccessor plainAcc(tolerance);
+   scimath::ChangeMonitor cm = plainAcc.planeChangeMonitor();
+   plainAcc.associate(*it);
+   const casacore::Vector<casacore::RigidVector<casacore::Double, 3> > &plainUVW = plainAcc.rotatedUVW(tangent);
+   CPPUNIT_ASSERT(cm != plainAcc.planeChangeMonitor());
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(fitAcc.coeffA(), plainAcc.coeffA(), 1e-12);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(fitAcc.coeffB(), plainAcc.coeffB(), 1e-12);
+   for (casacore::uInt row = 0; row < plainUVW.nelements(); ++row) {
+        CPPUNIT_ASSERT(fabs(plainUVW[row](2)) <= fitDeviation + 1e-9);
+   }
+   // the same data meet the tolerance with the fitted plane, so there is no refit
+   cm = plainAcc.planeChangeMonitor();
+   plainAcc.associate(*it);
+   plainAcc.rotatedUVW(tangent);
+   CPPUNIT_ASSERT(cm == plainAcc.planeChangeMonitor());
+
+   // the scheduled plane for the first chunk and the plane fitted to this chunk both leave
+   // residuals within the tolerance, so they can't differ by more than twice the tolerance
+   // on any baseline
+   const boost::shared_ptr<WPlaneSchedule const> realisticSchedule(new WPlaneSchedule(antennas, tangent,
+               startTime, stopTime, tolerance, maxFreq, 10.));
+   const size_t window = realisticSchedule->find(it->time());
+   CPPUNIT_ASSERT(window < realisticSchedule->size());
+   const double scheduledA = realisticSchedule->coeffA(window);
+   const double scheduledB = realisticSchedule->coeffB(window);
+   double scheduledDeviation = 0.;
+   for (casacore::uInt row = 0; row < uvw.nelements(); ++row) {
+        scheduledDeviation = std::max(scheduledDeviation,
+                  fabs(uvw[row](2) - scheduledA * uvw[row](0) - scheduledB * uvw[row](1)));
+        const double planeDifference = (scheduledA - fitAcc.coeffA()) * uvw[row](0) +
+                                       (scheduledB - fitAcc.coeffB()) * uvw[row](1);
+        CPPUNIT_ASSERT(fabs(planeDifference) <= 2. * tolInMetres);
+   }
+
+   // the adapter takes the plane from the schedule if it meets the tolerance, otherwise a new
+   // plane is fitted
+   BestWPlaneDataAccessor acc(tolerance);
+   acc.setPlaneSchedule(realisticSchedule);
+   CPPUNIT_ASSERT(acc.planeSchedule() == realisticSchedule);
+   acc.associate(*it);
+   const casacore::Vector<casacore::RigidVector<casacore::Double, 3> > &scheduledUVW = acc.rotatedUVW(tangent);
+   if (scheduledDeviation < tolInMetres) {
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(scheduledA, acc.coeffA(), 1e-12);
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(scheduledB, acc.coeffB(), 1e-12);
+   } else {
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(fitAcc.coeffA(), acc.coeffA(), 1e-12);
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(fitAcc.coeffB(), acc.coeffB(), 1e-12);
+   }
+   for (casacore::uInt row = 0; row < scheduledUVW.nelements(); ++row) {
+        CPPUNIT_ASSERT(fabs(scheduledUVW[row](2)) < tolInMetres);
+   }
+}
+}
+
+/// test that averaged channels match the average of the raw channels computed here
+void TableDataAccessTest::channelAveragingTest()
+{
+   TableConstDataSource ds(TableTestRunner::msName());
+   const casacore::uInt nAvg = 3;
+   const casacore::uInt nChan = 4;
+   IDataSelectorPtr rawSel = ds.createSelector();
+   rawSel->chooseChannels(nChan * nAvg, 1);
+   IDataSelectorPtr avgSel = ds.createSelector();
+   avgSel->chooseChannels(nChan, 1, nAvg);
+   IConstDataSharedIter it = ds.createConstIterator(rawSel);
+   IConstDataSharedIter itAvg = ds.createConstIterator(avgSel);
+   for (; it != it.end(); ++it, ++itAvg) {
+        CPPUNIT_ASSERT(itAvg != itAvg.end());
+        CPPUNIT_ASSERT_EQUAL(nChan, itAvg->nChannel());
+        const casacore::Cube<casacore::Complex> &vis = it->visibility();
+        const casacore::Cube<casacore::Bool> &flag = it->flag();
+        const casacore::Cube<casacore::Complex> &noise = it->noise();
+        const casacore::Cube<casacore::Complex> &visAvg = itAvg->visibility();
+        const casacore::Cube<casacore::Bool> &flagAvg = itAvg->flag();
+        const casacore::Cube<casacore::Complex> &noiseAvg = itAvg->noise();
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(nChan), visAvg.ncolumn());
+        CPPUNIT_ASSERT(visAvg.shape() == flagAvg.shape());
+        CPPUNIT_ASSERT(visAvg.shape() == noiseAvg.shape());
+        const casacore::Cube<casacore::Complex> &visAvgNative = itAvg->visibilityNative();
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(nChan), visAvgNative.ncolumn());
+        for (casacore::uInt chan = 0; chan < nChan; ++chan) {
+             double freq = 0.;
+             for (casacore::uInt raw = 0; raw < nAvg; ++raw) {
+                  freq += it->frequency()[chan * nAvg + raw];
+             }
+             CPPUNIT_ASSERT_DOUBLES_EQUAL(freq / nAvg, itAvg->frequency()[chan], 1e-3);
+        }
+        for (casacore::uInt row = 0; row < vis.nrow(); ++row) {
+             for (casacore::uInt chan = 0; chan < nChan; ++chan) {
+                  for (casacore::uInt pol = 0; pol < vis.nplane(); ++pol) {
+                       casacore::Complex sum(0.,0.), sumAll(0.,0.);
+                       float sumSq = 0., sumSqAll = 0.;
+                       casacore::uInt nGood = 0;
+                       for (casacore::uInt raw = chan * nAvg; raw < (chan + 1) * nAvg; ++raw) {
+                            const float sigma = real(noise(row, raw, pol));
+                            sumAll += vis(row, raw, pol);
+                            sumSqAll += sigma * sigma;
+                            if (!flag(row, raw, pol)) {
+                                sum += vis(row, raw, pol);
+                                sumSq += sigma * sigma;
+                                ++nGood;
+                            }
+                       }
+                       CPPUNIT_ASSERT_EQUAL(nGood == 0, flagAvg(row, chan, pol));
+                       const casacore::Complex expectedVis = nGood > 0 ? sum / float(nGood) : sumAll / float(nAvg);
+                       const float expectedNoise = nGood > 0 ? sqrt(sumSq) / nGood : sqrt(sumSqAll) / nAvg;
+                       CPPUNIT_ASSERT(abs(visAvg(row, chan, pol) - expectedVis) < 1e-5);
+                       CPPUNIT_ASSERT(abs(visAvgNative(pol, chan, row) - expectedVis) < 1e-5);
+                       CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedNoise, real(noiseAvg(row, chan, pol)), 1e-5);
+                       CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedNoise, imag(noiseAvg(row, chan, pol)), 1e-5);
+                  }
+             }
+        }
+   }
+   CPPUNIT_ASSERT(itAvg == itAvg.end());
+}
+
+/// @brief test of the averaging kernels with synthetic data
+/// @details Some bins are partially flagged and one is fully flagged, so all branches of
+/// the kernels are exercised. The results are compared with a straightforward per-sample
+/// computation done here.
+void TableDataAccessTest::averagingKernelTest()
+{
+   const casacore::uInt nPol = 2;
+   const casacore::uInt nAvg = 3;
+   const casacore::uInt nChan = 4;
+   const casacore::uInt nRow = 3;
+   casacore::Cube<casacore::Complex> vis(nPol, nChan * nAvg, nRow);
+   casacore::Cube<casacore::Float> sigma(nPol, nChan * nAvg, nRow);
+   casacore::Cube<casacore::Bool> flags(nPol, nChan * nAvg, nRow, casacore::False);
+   for (casacore::uInt row = 0; row < nRow; ++row) {
+        for (casacore::uInt chan = 0; chan < nChan * nAvg; ++chan) {
+             for (casacore::uInt pol = 0; pol < nPol; ++pol) {
+                  vis(pol, chan, row) = casacore::Complex(chan + 10. * row, pol - 0.5 * chan);
+                  sigma(pol, chan, row) = 1. + 0.1 * chan + 0.01 * pol + row;
+                  // flag every 5th sample
+                  flags(pol, chan, row) = ((chan + pol + row) % 5 == 0);
+             }
+        }
+   }
+   // fully flagged bin: second output channel of the second polarisation in the last row
+   for (casacore::uInt raw = nAvg; raw < 2 * nAvg; ++raw) {
+        flags(1, raw, nRow - 1) = casacore::True;
+   }
+   casacore::Array<casacore::Complex> visAvg;
+   averageChannelsNative(vis, flags, nAvg, visAvg);
+   casacore::Array<casacore::Float> sigmaAvg;
+   averageNoiseNative(sigma, flags, nAvg, sigmaAvg);
+   casacore::Array<casacore::Bool> flagAvg;
+   averageFlagsNative(flags, nAvg, flagAvg);
+   const casacore::IPosition outShape(3, nPol, nChan, nRow);
+   CPPUNIT_ASSERT(visAvg.shape() == outShape);
+   CPPUNIT_ASSERT(sigmaAvg.shape() == outShape);
+   CPPUNIT_ASSERT(flagAvg.shape() == outShape);
+   const casacore::Cube<casacore::Complex> visAvgCube(visAvg);
+   const casacore::Cube<casacore::Float> sigmaAvgCube(sigmaAvg);
+   const casacore::Cube<casacore::Bool> flagAvgCube(flagAvg);
+   size_t nFullyFlagged = 0;
+   for (casacore::uInt row = 0; row < nRow; ++row) {
+        for (casacore::uInt chan = 0; chan < nChan; ++chan) {
+             for (casacore::uInt pol = 0; pol < nPol; ++pol) {
+                  casacore::Complex sum(0.,0.), sumAll(0.,0.);
+                  float sumSq = 0., sumSqAll = 0.;
+                  casacore::uInt nGood = 0;
+                  for (casacore::uInt raw = chan * nAvg; raw < (chan + 1) * nAvg; ++raw) {
+                       sumAll += vis(pol, raw, row);
+                       sumSqAll += sigma(pol, raw, row) * sigma(pol, raw, row);
+                       if (!flags(pol, raw, row)) {
+                           sum += vis(pol, raw, row);
+                           sumSq += sigma(pol, raw, row) * sigma(pol, raw, row);
+                           ++nGood;
+                       }
+                  }
+                  if (nGood == 0) {
+                      ++nFullyFlagged;
+                  }
+                  CPPUNIT_ASSERT_EQUAL(nGood == 0, flagAvgCube(pol, chan, row));
+                  const casacore::Complex expectedVis = nGood > 0 ? sum / float(nGood) : sumAll / float(nAvg);
+                  const float expectedNoise = nGood > 0 ? sqrt(sumSq) / nGood : sqrt(sumSqAll) / nAvg;
+                  CPPUNIT_ASSERT(abs(visAvgCube(pol, chan, row) - expectedVis) < 1e-5);
+                  CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedNoise, sigmaAvgCube(pol, chan, row), 1e-5);
+             }
+        }
+   }
+   CPPUNIT_ASSERT_EQUAL(size_t(1), nFullyFlagged);
+}
+
+/// test that Stokes I obtained on read matches the conversion of XX and YY done here
+void TableDataAccessTest::polConversionTest()
+{
+   TableConstDataSource ds(TableTestRunner::msName());
+   IDataSelectorPtr rawSel = ds.createSelector();
+   rawSel->chooseChannels(5, 2);
+   IDataSelectorPtr iSel = ds.createSelector();
+   iSel->chooseChannels(5, 2);
+   iSel->choosePolarizations("I");
+   IConstDataSharedIter it = ds.createConstIterator(rawSel);
+   IConstDataSharedIter itI = ds.createConstIterator(iSel);
+   CPPUNIT_ASSERT(it != it.end());
+   CPPUNIT_ASSERT_EQUAL(casacore::uInt(2), it->nPol());
+   const scimath::PolConverter polConv(it->stokes(), itI->stokes());
+   // coefficients of the conversion
+   casacore::Vector<casacore::Complex> coeffs(2);
+   for (casacore::uInt pol = 0; pol < 2; ++pol) {
+        casacore::Vector<casacore::Complex> unit(2, casacore::Complex(0.,0.));
+        unit[pol] = casacore::Complex(1.,0.);
+        coeffs[pol] = polConv(unit)[0];
+   }
+   for (; it != it.end(); ++it, ++itI) {
+        CPPUNIT_ASSERT(itI != itI.end());
+        CPPUNIT_ASSERT_EQUAL(casacore::uInt(1), itI->nPol());
+        CPPUNIT_ASSERT_EQUAL(size_t(1), itI->stokes().nelements());
+        CPPUNIT_ASSERT(itI->stokes()[0] == casacore::Stokes::I);
+        const casacore::Cube<casacore::Complex> &vis = it->visibility();
+        const casacore::Cube<casacore::Bool> &flag = it->flag();
+        const casacore::Cube<casacore::Complex> &noise = it->noise();
+        const casacore::Cube<casacore::Complex> &visI = itI->visibility();
+        const casacore::Cube<casacore::Bool> &flagI = itI->flag();
+        const casacore::Cube<casacore::Complex> &noiseI = itI->noise();
+        CPPUNIT_ASSERT_EQUAL(size_t(1), visI.nplane());
+        CPPUNIT_ASSERT(visI.shape() == flagI.shape());
+        CPPUNIT_ASSERT(visI.shape() == noiseI.shape());
+        CPPUNIT_ASSERT_EQUAL(size_t(1), itI->visibilityNative().nrow());
+        for (casacore::uInt row = 0; row < vis.nrow(); ++row) {
+             for (casacore::uInt chan = 0; chan < vis.ncolumn(); ++chan) {
+                  const casacore::Complex expectedVis = coeffs[0] * vis(row, chan, 0) +
+                                                        coeffs[1] * vis(row, chan, 1);
+                  const float sigma0 = real(noise(row, chan, 0));
+                  const float sigma1 = real(noise(row, chan, 1));
+                  const float expectedNoise = sqrt(norm(coeffs[0]) * sigma0 * sigma0 +
+                                                   norm(coeffs[1]) * sigma1 * sigma1);
+                  CPPUNIT_ASSERT(abs(visI(row, chan, 0) - expectedVis) < 1e-5);
+                  CPPUNIT_ASSERT_EQUAL(flag(row, chan, 0) || flag(row, chan, 1), flagI(row, chan, 0));
+                  CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedNoise, real(noiseI(row, chan, 0)), 1e-5);
+             }
+        }
+   }
+   CPPUNIT_ASSERT(itI == itI.end());
+}
+
+/// @brief test of frequency and velocity conversion of the spectral axis
+/// @details The spectral axis of a chunk with several channels is obtained via the
+/// linear approximation, while the single channel chunk is converted exactly. Both
+/// should give the same result.
+void TableDataAccessTest::spectralAxisConversionTest()
+{
+   TableConstDataSource ds(TableTestRunner::msName());
+   IDataConverterPtr conv=ds.createConverter();
+   conv->setFrequencyFrame(casacore::MFrequency::Ref(casacore::MFrequency::BARY),"MHz");
+   conv->setVelocityFrame(casacore::MRadialVelocity::Ref(casacore::MRadialVelocity::LSRK),"km/s");
+   conv->setRestFrequency(casacore::MVFrequency(casacore::Quantity(1420.405752, "MHz")));
+   IDataSelectorPtr bandSel = ds.createSelector();
+   bandSel->chooseChannels(5, 2);
+   IDataSelectorPtr chanSel = ds.createSelector();
+   chanSel->chooseChannels(1, 4);
+   IConstDataSharedIter it = ds.createConstIterator(bandSel, conv);
+   IConstDataSharedIter itChan = ds.createConstIterator(chanSel, conv);
+   // a few iterations are sufficient, the frame changes with time
+   for (int iter = 0; (iter < 4) && (it != it.end()); ++iter, ++it, ++itChan) {
+        CPPUNIT_ASSERT(itChan != itChan.end());
+        const casacore::Vector<casacore::Double> &freq = it->frequency();
+        const casacore::Vector<casacore::Double> &vel = it->velocity();
+        CPPUNIT_ASSERT_EQUAL(size_t(5), freq.nelements());
+        CPPUNIT_ASSERT_EQUAL(size_t(5), vel.nelements());
+        CPPUNIT_ASSERT_EQUAL(size_t(1), itChan->frequency().nelements());
+        CPPUNIT_ASSERT_EQUAL(size_t(1), itChan->velocity().nelements());
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(itChan->frequency()[0], freq[2], 1e-9);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(itChan->velocity()[0], vel[2], 1e-6);
+        // frequency and velocity axes should be monotonic and in the opposite directions
+        for (casacore::uInt chan = 1; chan < freq.nelements(); ++chan) {
+             CPPUNIT_ASSERT((freq[chan] - freq[chan - 1]) * (vel[chan] - vel[chan - 1]) < 0);
+        }
+   }
+}
+
 /// test of correlation type selection
 void TableDataAccessTest::corrTypeSelectionTest()
 {
@@ -476,6 +1774,110 @@ void TableDataAccessTest::feedTest()
        }
        CPPUNIT_ASSERT(fabs(feedSubtable.getBeamPA(time,0,0,feed))<1e-5);
   }
+  // the values are taken from the precomputed interval, the index matrix should be
+  // consistent with antenna and feed IDs
+  CPPUNIT_ASSERT(!feedSubtable.newBeamDetails(time,0));
+  const casacore::Vector<casacore::Int> &antIDs = feedSubtable.getAntennaIDs(time,0);
+  const casacore::Vector<casacore::Int> &feedIDs = feedSubtable.getFeedIDs(time,0);
+  const casacore::Matrix<casacore::Int> &indices = feedSubtable.getIndices();
+  CPPUNIT_ASSERT_EQUAL(antIDs.nelements(), feedIDs.nelements());
+  CPPUNIT_ASSERT_EQUAL(antIDs.nelements(), feedSubtable.getAllBeamOffsets(time,0).nelements());
+  CPPUNIT_ASSERT_EQUAL(antIDs.nelements(), feedSubtable.getAllBeamPAs(time,0).nelements());
+  for (casacore::uInt elem = 0; elem < antIDs.nelements(); ++elem) {
+       CPPUNIT_ASSERT_EQUAL(casacore::Int(elem), indices(antIDs[elem], feedIDs[elem]));
+  }
+}
+
+/// @brief test of the FEED subtable index with time and spectral window dependence
+void TableDataAccessTest::feedIntervalTest()
+{
+  const casacore::Double day = 50257.;
+  SyntheticFeedTable feedTable;
+  // two adjacent intervals with different offsets for any spectral window, a gap and
+  // the third interval with zero offsets. Feed 2 is defined for spectral window 1 only.
+  for (casacore::Int feed = 0; feed < 2; ++feed) {
+       feedTable.addRow(day, day + 0.25, -1, 0, feed, 0.01 * (feed + 1), 0., 0.);
+       feedTable.addRow(day + 0.25, day + 0.5, -1, 0, feed, 0., 0.02 * (feed + 1), 0.5);
+       feedTable.addRow(day + 0.75, day + 1., -1, 0, feed, 0., 0., 0.);
+  }
+  feedTable.addRow(day, day + 0.25, 1, 0, 2, 0.03, 0.03, 1.);
+  const FeedSubtableHandler handler(feedTable.table());
+
+  // first interval
+  const casacore::MEpoch time1 = SyntheticFeedTable::epoch(day + 0.1);
+  CPPUNIT_ASSERT(handler.newBeamDetails(time1, 0));
+  CPPUNIT_ASSERT_EQUAL(size_t(2), size_t(handler.getAllBeamOffsets(time1, 0).nelements()));
+  CPPUNIT_ASSERT(!handler.newBeamDetails(time1, 0));
+  CPPUNIT_ASSERT(!handler.allBeamOffsetsZero(time1, 0));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.02, handler.getBeamOffset(time1, 0, 0, 1)(0), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0., handler.getBeamOffset(time1, 0, 0, 1)(1), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0., handler.getBeamPA(time1, 0, 0, 1), 1e-12);
+  CPPUNIT_ASSERT_THROW(handler.getBeamOffset(time1, 0, 0, 2), DataAccessError);
+  // the table has rows specific to a spectral window, so the cache is not reused for other windows
+  CPPUNIT_ASSERT(handler.newBeamDetails(time1, 1));
+  CPPUNIT_ASSERT_EQUAL(size_t(3), size_t(handler.getAllBeamOffsets(time1, 1).nelements()));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.01, handler.getBeamOffset(time1, 1, 0, 0)(0), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.03, handler.getBeamOffset(time1, 1, 0, 2)(0), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.03, handler.getBeamOffset(time1, 1, 0, 2)(1), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1., handler.getBeamPA(time1, 1, 0, 2), 1e-12);
+  const casacore::Matrix<casacore::Int> &indices = handler.getIndices();
+  CPPUNIT_ASSERT_EQUAL(casacore::uInt(1), casacore::uInt(indices.nrow()));
+  CPPUNIT_ASSERT_EQUAL(casacore::uInt(3), casacore::uInt(indices.ncolumn()));
+  CPPUNIT_ASSERT(handler.newBeamDetails(time1, 0));
+  // spectral window without specific rows
+  CPPUNIT_ASSERT_EQUAL(size_t(2), size_t(handler.getAllBeamOffsets(time1, 2).nelements()));
+  CPPUNIT_ASSERT_THROW(handler.getBeamPA(time1, 2, 0, 2), DataAccessError);
+
+  // second interval, the same rows for all spectral windows
+  const casacore::MEpoch time2 = SyntheticFeedTable::epoch(day + 0.4);
+  for (casacore::uInt spWindow = 0; spWindow < 3; ++spWindow) {
+       CPPUNIT_ASSERT_EQUAL(size_t(2), size_t(handler.getAllBeamOffsets(time2, spWindow).nelements()));
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(0., handler.getBeamOffset(time2, spWindow, 0, 1)(0), 1e-12);
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(0.04, handler.getBeamOffset(time2, spWindow, 0, 1)(1), 1e-12);
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, handler.getBeamPA(time2, spWindow, 0, 1), 1e-12);
+       CPPUNIT_ASSERT_THROW(handler.getBeamOffset(time2, spWindow, 0, 2), DataAccessError);
+  }
+  // gap between the second and the third intervals
+  CPPUNIT_ASSERT_THROW(handler.getAllBeamOffsets(SyntheticFeedTable::epoch(day + 0.6), 0),
+                       DataAccessError);
+  // third interval
+  const casacore::MEpoch time3 = SyntheticFeedTable::epoch(day + 0.9);
+  CPPUNIT_ASSERT(handler.allBeamOffsetsZero(time3, 0));
+  CPPUNIT_ASSERT(handler.allBeamOffsetsZero(time3, 1));
+  // outside of the table
+  CPPUNIT_ASSERT_THROW(handler.getAllBeamOffsets(SyntheticFeedTable::epoch(day - 0.1), 0),
+                       DataAccessError);
+  CPPUNIT_ASSERT_THROW(handler.getAllBeamOffsets(SyntheticFeedTable::epoch(day + 1.1), 0),
+                       DataAccessError);
+
+  // at the boundary between adjacent intervals the later one is used, both after a lookup
+  // without the cache and with either of the intervals in the cache
+  const casacore::MEpoch boundary = SyntheticFeedTable::epoch(day + 0.25);
+  for (casacore::uInt spWindow = 0; spWindow < 2; ++spWindow) {
+       const FeedSubtableHandler freshHandler(feedTable.table());
+       CPPUNIT_ASSERT_EQUAL(size_t(2), size_t(freshHandler.getAllBeamOffsets(boundary, spWindow).nelements()));
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(0.04, freshHandler.getBeamOffset(boundary, spWindow, 0, 1)(1), 1e-12);
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, freshHandler.getBeamPA(boundary, spWindow, 0, 1), 1e-12);
+       handler.getAllBeamOffsets(time1, spWindow);
+       CPPUNIT_ASSERT(handler.newBeamDetails(boundary, spWindow));
+       CPPUNIT_ASSERT_EQUAL(size_t(2), size_t(handler.getAllBeamOffsets(boundary, spWindow).nelements()));
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(0.04, handler.getBeamOffset(boundary, spWindow, 0, 1)(1), 1e-12);
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, handler.getBeamPA(boundary, spWindow, 0, 1), 1e-12);
+       handler.getAllBeamOffsets(time2, spWindow);
+       CPPUNIT_ASSERT(!handler.newBeamDetails(boundary, spWindow));
+  }
+  // start and stop times without an adjacent interval belong to the interval
+  const FeedSubtableHandler freshHandler(feedTable.table());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.01, freshHandler.getBeamOffset(SyntheticFeedTable::epoch(day), 0, 0, 0)(0),
+                               1e-12);
+  const casacore::MEpoch stop2 = SyntheticFeedTable::epoch(day + 0.5);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.04, freshHandler.getBeamOffset(stop2, 0, 0, 1)(1), 1e-12);
+  handler.getAllBeamOffsets(time2, 0);
+  CPPUNIT_ASSERT(!handler.newBeamDetails(stop2, 0));
+  const casacore::MEpoch stop3 = SyntheticFeedTable::epoch(day + 1.);
+  CPPUNIT_ASSERT(freshHandler.allBeamOffsetsZero(stop3, 0));
+  handler.getAllBeamOffsets(time3, 0);
+  CPPUNIT_ASSERT(!handler.newBeamDetails(stop3, 0));
 }
 
 /// test access to the field subtable
@@ -549,6 +1951,7 @@ void TableDataAccessTest::antennaTest()
                       subtableInfo().getAntenna();
   for (casacore::uInt ant=0;ant<6;++ant) {
        CPPUNIT_ASSERT(antennaSubtable.getMount(ant) == "ALT-AZ");
+       CPPUNIT_ASSERT(antennaSubtable.getMountType(ant) == IAntennaSubtableHandler::ALT_AZ);
       for (casacore::uInt ant2=0; ant2<ant; ++ant2) {
            CPPUNIT_ASSERT(antennaSubtable.getPosition(ant).getValue().
               separation(antennaSubtable.getPosition(ant2).getValue(),"deg").
@@ -588,6 +1991,29 @@ void TableDataAccessTest::antennaPositionShortcutTest() {
   }
 }
 
+/// test of analytic parallactic angles against casacore measures
+void TableDataAccessTest::parallacticAngleTest()
+{
+  TableConstDataSource ds(TableTestRunner::msName());
+  ds.configureParallacticAngleValidation(true);
+  TableConstDataSource dsRef(TableTestRunner::msName());
+  IConstDataSharedIter itRef = dsRef.createConstIterator();
+  IConstDataSharedIter it = ds.createConstIterator();
+  boost::shared_ptr<TableConstDataIterator> tabIt = it.dynamicCast<TableConstDataIterator>();
+  CPPUNIT_ASSERT(tabIt);
+  CPPUNIT_ASSERT(tabIt->parallacticAngleValidation());
+  for (; it != it.end(); ++it, ++itRef) {
+       CPPUNIT_ASSERT(itRef != itRef.end());
+       // an exception is thrown in the validation mode if the angles disagree
+       const casacore::Vector<casacore::Float> &pa1 = it->feed1PA();
+       const casacore::Vector<casacore::Float> &pa1Ref = itRef->feed1PA();
+       CPPUNIT_ASSERT_EQUAL(pa1Ref.nelements(), pa1.nelements());
+       for (casacore::uInt row = 0; row < pa1.nelements(); ++row) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(pa1Ref[row], pa1[row], 1e-6);
+       }
+  }
+}
+
 /// test read/write with channel selection
 void TableDataAccessTest::channelSelectionTest()
 {
@@ -723,6 +2149,136 @@ void TableDataAccessTest::freqSelectionTest()
   }
 }
 
+void TableDataAccessTest::multiFreqSelectionTest()
+{
+  TableConstDataSource ds(TableTestRunner::msName());
+  IConstDataSharedIter fullIt = ds.createConstIterator();
+  const casacore::Vector<casacore::Double> freqs = fullIt->frequency().copy();
+  CPPUNIT_ASSERT_EQUAL(size_t(13), freqs.nelements());
+  const double inc = freqs(1) - freqs(0);
+  IDataSelectorPtr sel = ds.createSelector();
+  sel->chooseFrequencies(3, casacore::MVFrequency(freqs(2)), 0.);
+  IDataSelectorPtr avgSel = ds.createSelector();
+  // two channels, each is an average of two adjacent channels of the dataset, the
+  // first one starts at the same channel as the selection above
+  avgSel->chooseFrequencies(2, casacore::MVFrequency(freqs(2) + 0.5 * inc), casacore::MVFrequency(2. * inc));
+  IConstDataSharedIter it = ds.createConstIterator(sel);
+  IConstDataSharedIter itAvg = ds.createConstIterator(avgSel);
+  for (; fullIt != fullIt.end(); ++fullIt, ++it, ++itAvg) {
+       CPPUNIT_ASSERT(it != it.end());
+       CPPUNIT_ASSERT(itAvg != itAvg.end());
+       CPPUNIT_ASSERT_EQUAL(casacore::uInt(3), it->nChannel());
+       CPPUNIT_ASSERT_EQUAL(casacore::uInt(2), itAvg->nChannel());
+       const casacore::Vector<casacore::Double> &freq = it->frequency();
+       const casacore::Vector<casacore::Double> &freqAvg = itAvg->frequency();
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(inc, freq(1) - freq(0), 1e-3 * fabs(inc));
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(inc, freq(2) - freq(1), 1e-3 * fabs(inc));
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5 * (freq(0) + freq(1)), freqAvg(0), 1e-3 * fabs(inc));
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(2. * inc, freqAvg(1) - freqAvg(0), 1e-3 * fabs(inc));
+       const casacore::Cube<casacore::Complex> &vis = it->visibility();
+       const casacore::Cube<casacore::Bool> &flag = it->flag();
+       const casacore::Cube<casacore::Complex> &visAvg = itAvg->visibility();
+       const casacore::Cube<casacore::Complex> &fullVis = fullIt->visibility();
+       CPPUNIT_ASSERT_EQUAL(size_t(3), vis.ncolumn());
+       CPPUNIT_ASSERT_EQUAL(size_t(2), visAvg.ncolumn());
+       // start channel in the full cube
+       casacore::uInt start = 0;
+       while ((start < freqs.nelements()) && (fabs(fullIt->frequency()(start) - freq(0)) > 1e-3 * fabs(inc))) {
+              ++start;
+       }
+       CPPUNIT_ASSERT(start + 3 <= freqs.nelements());
+       for (casacore::uInt row = 0; row < vis.nrow(); ++row) {
+            for (casacore::uInt pol = 0; pol < vis.nplane(); ++pol) {
+                 for (casacore::uInt chan = 0; chan < vis.ncolumn(); ++chan) {
+                      CPPUNIT_ASSERT(abs(vis(row, chan, pol) - fullVis(row, start + chan, pol)) < 1e-7);
+                 }
+                 if (!flag(row, 0, pol) && !flag(row, 1, pol)) {
+                     const casacore::Complex expected = (vis(row, 0, pol) + vis(row, 1, pol)) / 2.f;
+                     CPPUNIT_ASSERT(abs(visAvg(row, 0, pol) - expected) < 1e-5);
+                 }
+            }
+       }
+  }
+  CPPUNIT_ASSERT(it == it.end());
+  CPPUNIT_ASSERT(itAvg == itAvg.end());
+}
+
+void TableDataAccessTest::outOfBandFreqSelectionTest()
+{
+  TableConstDataSource ds(TableTestRunner::msName());
+  IConstDataSharedIter fullIt = ds.createConstIterator();
+  const casacore::Vector<casacore::Double> freqs = fullIt->frequency().copy();
+  CPPUNIT_ASSERT_EQUAL(size_t(13), freqs.nelements());
+  const double inc = freqs(1) - freqs(0);
+  // 15 channels starting one channel below the band, i.e. one channel is outside the
+  // band on either side (more channels than the spectral window has)
+  IDataSelectorPtr wideSel = ds.createSelector();
+  wideSel->chooseFrequencies(15, casacore::MVFrequency(freqs(0) - inc), 0.);
+  // the whole selection is above the band
+  IDataSelectorPtr outSel = ds.createSelector();
+  outSel->chooseFrequencies(2, casacore::MVFrequency(freqs(12) + 5. * inc), 0.);
+  IConstDataSharedIter wideIt = ds.createConstIterator(wideSel);
+  IConstDataSharedIter outIt = ds.createConstIterator(outSel);
+  for (; fullIt != fullIt.end(); ++fullIt, ++wideIt, ++outIt) {
+       CPPUNIT_ASSERT(wideIt != wideIt.end());
+       CPPUNIT_ASSERT(outIt != outIt.end());
+       CPPUNIT_ASSERT_EQUAL(casacore::uInt(15), wideIt->nChannel());
+       CPPUNIT_ASSERT_EQUAL(casacore::uInt(2), outIt->nChannel());
+       // the spectral axis is extrapolated beyond the band
+       const casacore::Vector<casacore::Double> &freq = wideIt->frequency();
+       const casacore::Vector<casacore::Double> &fullFreq = fullIt->frequency();
+       CPPUNIT_ASSERT_EQUAL(size_t(15), freq.nelements());
+       for (casacore::uInt chan = 0; chan < fullFreq.nelements(); ++chan) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(fullFreq(chan), freq(chan + 1), 1e-3 * fabs(inc));
+       }
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(fullFreq(0) - inc, freq(0), 1e-3 * fabs(inc));
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(fullFreq(12) + inc, freq(14), 1e-3 * fabs(inc));
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(fullFreq(12) + 5. * inc, outIt->frequency()(0), 1e-3 * fabs(inc));
+
+       // channels inside the band are read, those outside are flagged
+       const casacore::Cube<casacore::Complex> &vis = wideIt->visibility();
+       const casacore::Cube<casacore::Bool> &flag = wideIt->flag();
+       const casacore::Cube<casacore::Complex> &noise = wideIt->noise();
+       const casacore::Cube<casacore::Complex> &fullVis = fullIt->visibility();
+       const casacore::Cube<casacore::Bool> &fullFlag = fullIt->flag();
+       CPPUNIT_ASSERT_EQUAL(fullVis.nrow(), vis.nrow());
+       CPPUNIT_ASSERT_EQUAL(size_t(15), vis.ncolumn());
+       CPPUNIT_ASSERT_EQUAL(size_t(15), flag.ncolumn());
+       CPPUNIT_ASSERT_EQUAL(size_t(15), noise.ncolumn());
+       for (casacore::uInt row = 0; row < vis.nrow(); ++row) {
+            for (casacore::uInt pol = 0; pol < vis.nplane(); ++pol) {
+                 CPPUNIT_ASSERT(flag(row, 0, pol));
+                 CPPUNIT_ASSERT(flag(row, 14, pol));
+                 CPPUNIT_ASSERT(abs(vis(row, 0, pol)) < 1e-7);
+                 CPPUNIT_ASSERT(abs(vis(row, 14, pol)) < 1e-7);
+                 for (casacore::uInt chan = 0; chan < fullVis.ncolumn(); ++chan) {
+                      CPPUNIT_ASSERT(abs(vis(row, chan + 1, pol) - fullVis(row, chan, pol)) < 1e-7);
+                      CPPUNIT_ASSERT_EQUAL(fullFlag(row, chan, pol), flag(row, chan + 1, pol));
+                 }
+            }
+       }
+       // packed flags are padded the same way
+       const TableConstDataAccessor &acc = dynamic_cast<const TableConstDataAccessor&>(*wideIt);
+       const PackedFlags &packed = acc.packedFlag();
+       for (casacore::uInt row = 0; row < flag.nrow(); ++row) {
+            for (casacore::uInt chan = 0; chan < flag.ncolumn(); ++chan) {
+                 for (casacore::uInt pol = 0; pol < flag.nplane(); ++pol) {
+                      CPPUNIT_ASSERT_EQUAL(flag(row, chan, pol), packed(row, chan, pol));
+                 }
+            }
+       }
+
+       // nothing is inside the band for the second selection, all data are flagged
+       const casacore::Cube<casacore::Bool> &outFlag = outIt->flag();
+       const casacore::Cube<casacore::Complex> &outVis = outIt->visibility();
+       CPPUNIT_ASSERT_EQUAL(size_t(2), outVis.ncolumn());
+       CPPUNIT_ASSERT(allEQ(outFlag, casacore::True));
+       CPPUNIT_ASSERT(allEQ(outVis, casacore::Complex(0., 0.)));
+  }
+  CPPUNIT_ASSERT(wideIt == wideIt.end());
+  CPPUNIT_ASSERT(outIt == outIt.end());
+}
+
 void TableDataAccessTest::originalFlagRewriteTest()
 {
    TableDataSource tds(TableTestRunner::msName(), TableDataSource::WRITE_PERMITTED);
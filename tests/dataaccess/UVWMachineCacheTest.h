@@ -44,6 +44,10 @@
 
 
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <vector>
+#include <exception>
 
 namespace askap {
 
@@ -56,6 +60,8 @@ class UVWMachineCacheTest : public CppUnit::TestFixture {
    CPPUNIT_TEST(oneElementCacheTest);
    CPPUNIT_TEST(twoElementsCacheTest);
    CPPUNIT_TEST(uvwMachineFrameConvTest);
+   CPPUNIT_TEST(countersTest);
+   CPPUNIT_TEST(concurrentAccessTest);
    CPPUNIT_TEST_SUITE_END();
 public:
    void setUp() {
@@ -235,6 +241,71 @@ public:
       itsMachineCache.reset(new UVWMachineCache(2,1e-6));
       testCaching();
    }
+
+   void countersTest() {
+      itsMachineCache.reset(new UVWMachineCache(2,1e-6));
+      const casacore::MDirection dir1(casacore::MVDirection(0.123456, -0.123456), casacore::MDirection::J2000);
+      const casacore::MDirection dir2(casacore::MVDirection(-0.123456, -0.123456), casacore::MDirection::J2000);
+      const casacore::MDirection dir3(casacore::MVDirection(1.123456, -0.2), casacore::MDirection::J2000);
+      // within the tolerance from dir2
+      casacore::MDirection dir2Shifted(dir2);
+      dir2Shifted.shift(3e-7, 3e-7, casacore::True);
+      const accessors::UVWMachineCache::machineType &machine = itsMachineCache->machine(dir1,dir2);
+      CPPUNIT_ASSERT_EQUAL(&machine, &itsMachineCache->machine(dir1,dir2));
+      CPPUNIT_ASSERT_EQUAL(&machine, &itsMachineCache->machine(dir1,dir2Shifted));
+      CPPUNIT_ASSERT_EQUAL(size_t(1), itsMachineCache->misses());
+      CPPUNIT_ASSERT_EQUAL(size_t(2), itsMachineCache->hits());
+      itsMachineCache->machine(dir2,dir1);
+      itsMachineCache->machine(dir3,dir1);
+      CPPUNIT_ASSERT_EQUAL(size_t(3), itsMachineCache->misses());
+      CPPUNIT_ASSERT_EQUAL(size_t(1), itsMachineCache->evictions());
+      // the machine for dir2, dir1 is still cached, the one for dir1, dir2 has been evicted
+      itsMachineCache->machine(dir2,dir1);
+      CPPUNIT_ASSERT_EQUAL(size_t(3), itsMachineCache->hits());
+      itsMachineCache->machine(dir1,dir2);
+      CPPUNIT_ASSERT_EQUAL(size_t(4), itsMachineCache->misses());
+      CPPUNIT_ASSERT_EQUAL(size_t(2), itsMachineCache->evictions());
+      // frames are compared as well
+      const casacore::MDirection dir2B1950(dir2.getValue(), casacore::MDirection::B1950);
+      itsMachineCache->machine(dir1,dir2B1950);
+      CPPUNIT_ASSERT_EQUAL(size_t(5), itsMachineCache->misses());
+   }
+   
+   void concurrentAccessTest() {
+      // 4 pairs of directions don't fit into the cache, so there are evictions
+      itsMachineCache.reset(new UVWMachineCache(3,1e-6));
+      const size_t nPairs = 4;
+      std::vector<casacore::MDirection> phaseCentres, tangents;
+      std::vector<boost::shared_ptr<accessors::UVWMachineCache::machineType> > expected;
+      for (size_t pair = 0; pair < nPairs; ++pair) {
+           phaseCentres.push_back(casacore::MDirection(casacore::MVDirection(0.1 * pair, -0.5 + 0.1 * pair),
+                                  casacore::MDirection::J2000));
+           tangents.push_back(casacore::MDirection(casacore::MVDirection(0.1 * pair + 0.05, -0.5),
+                              casacore::MDirection::J2000));
+           expected.push_back(boost::shared_ptr<accessors::UVWMachineCache::machineType>(
+                   new accessors::UVWMachineCache::machineType(tangents[pair], phaseCentres[pair], false, false)));
+      }
+      // each thread starts with a different pair, consecutive calls request the same machine,
+      // so there are hits as well
+      const size_t nThreads = 4;
+      const size_t callsPerThread = 100;
+      const size_t nCalls = nThreads * callsPerThread;
+      // std::vector<int> is fine here, each thread increments its own element
+      std::vector<int> nWrong(nThreads, 0);
+      boost::thread_group threads;
+      for (size_t thread = 0; thread < nThreads; ++thread) {
+           threads.create_thread(CacheClient(*itsMachineCache, phaseCentres, tangents, expected,
+                                 thread * callsPerThread, callsPerThread, nWrong[thread]));
+      }
+      threads.join_all();
+      for (size_t thread = 0; thread < nThreads; ++thread) {
+           CPPUNIT_ASSERT_EQUAL(0, nWrong[thread]);
+      }
+      CPPUNIT_ASSERT_EQUAL(nCalls, itsMachineCache->hits() + itsMachineCache->misses());
+      CPPUNIT_ASSERT(itsMachineCache->hits() > 0);
+      CPPUNIT_ASSERT(itsMachineCache->misses() >= nPairs);
+      CPPUNIT_ASSERT(itsMachineCache->evictions() > 0);
+   }
    
 protected:
    void testCaching() const {
@@ -261,17 +332,77 @@ protected:
    }
    
    static void compareMachines(const accessors::UVWMachineCache::machineType &m1, const accessors::UVWMachineCache::machineType &m2) {
+       CPPUNIT_ASSERT(machinesMatch(m1, m2));
+   }   
+
+   /// @brief check that two machines give the same uvw and delay
+   /// @details This method doesn't throw, so it can be used in parallel sections.
+   /// @param[in] m1 first machine
+   /// @param[in] m2 second machine
+   /// @return true, if the results match
+   static bool machinesMatch(const accessors::UVWMachineCache::machineType &m1, const accessors::UVWMachineCache::machineType &m2) {
        casacore::Vector<double> uvw(3);
        uvw[0]=1000.0; uvw[1]=-3250.0; uvw[2]=12.5;
        casacore::Vector<double> uvwCopy(uvw.copy());
        double delay = 0, delayCopy = 0;
        m1.convertUVW(delay, uvw);
        m2.convertUVW(delayCopy,uvwCopy);
-       CPPUNIT_ASSERT(fabs(delay-delayCopy)<1e-6);
+       if (fabs(delay-delayCopy) >= 1e-6) {
+           return false;
+       }
        for (size_t dim=0;dim<3;++dim) {
-            CPPUNIT_ASSERT(fabs(uvw[dim]-uvwCopy[dim])<1e-6);
+            if (fabs(uvw[dim]-uvwCopy[dim]) >= 1e-6) {
+                return false;
+            }
        }
-   }   
+       return true;
+   }
+
+   /// @brief helper functor requesting machines from the cache in a separate thread
+   /// @details Calls are split into blocks of 8 requesting the same pair of directions.
+   /// Mismatches are counted rather than asserted, as exceptions can't be propagated across threads.
+   struct CacheClient {
+      /// @brief constructor
+      /// @param[in] cache cache to test
+      /// @param[in] phaseCentres phase centre for each pair of directions
+      /// @param[in] tangents tangent point for each pair of directions
+      /// @param[in] expected machine built by hand for each pair of directions
+      /// @param[in] firstCall number of the first call, it defines the first pair requested
+      /// @param[in] nCalls number of calls to make
+      /// @param[in] nWrong counter of wrong or missing machines and exceptions
+      CacheClient(const UVWMachineCache &cache, const std::vector<casacore::MDirection> &phaseCentres,
+                  const std::vector<casacore::MDirection> &tangents,
+                  const std::vector<boost::shared_ptr<UVWMachineCache::machineType> > &expected,
+                  size_t firstCall, size_t nCalls, int &nWrong) : itsCache(cache),
+                  itsPhaseCentres(phaseCentres), itsTangents(tangents), itsExpected(expected),
+                  itsFirstCall(firstCall), itsNCalls(nCalls), itsNWrong(nWrong) {}
+
+      /// @brief make the calls
+      void operator()() const {
+         try {
+            for (size_t call = itsFirstCall; call < itsFirstCall + itsNCalls; ++call) {
+                 const size_t pair = (call / 8) % itsPhaseCentres.size();
+                 // the shared pointer keeps the machine alive if another thread evicts it
+                 const boost::shared_ptr<UVWMachineCache::machineType const> machine =
+                       itsCache.sharedMachine(itsPhaseCentres[pair], itsTangents[pair]);
+                 if (!machine || !machinesMatch(*machine, *itsExpected[pair])) {
+                     ++itsNWrong;
+                 }
+            }
+         }
+         catch (const std::exception &) {
+            ++itsNWrong;
+         }
+      }
+   private:
+      const UVWMachineCache &itsCache;
+      const std::vector<casacore::MDirection> &itsPhaseCentres;
+      const std::vector<casacore::MDirection> &itsTangents;
+      const std::vector<boost::shared_ptr<UVWMachineCache::machineType> > &itsExpected;
+      size_t itsFirstCall;
+      size_t itsNCalls;
+      int &itsNWrong;
+   };
    
 private:   
    boost::shared_ptr<UVWMachineCache> itsMachineCache;